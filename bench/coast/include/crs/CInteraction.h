@@ -0,0 +1,25 @@
+/** \file
+ * Stand-in for the COAST header of the same name, used by make bench to
+ * build the interface without a COAST installation.
+ */
+#ifndef __CRS_CINTERACTION_H__
+#define __CRS_CINTERACTION_H__
+
+namespace crs {
+
+/** Hadronic interaction, with the member layout of COAST. */
+struct CInteraction {
+    double x;
+    double y;
+    double z;
+    double etot;
+    double sigma;
+    double kela;
+    int projId;
+    int targetId;
+};
+
+}
+
+
+#endif
@@ -0,0 +1,27 @@
+/** \file
+ * Stand-in for the COAST header of the same name, used by make bench to
+ * build the interface without a COAST installation.
+ */
+#ifndef __CRS_CPARTICLE_H__
+#define __CRS_CPARTICLE_H__
+
+namespace crs {
+
+/** Particle at the beginning or end of a track, with the member layout of
+ * COAST. */
+struct CParticle {
+    double x;
+    double y;
+    double z;
+    double depth;
+    double time;
+    double energy;
+    double weight;
+    int particleId;
+    int hadronicGeneration;
+};
+
+}
+
+
+#endif
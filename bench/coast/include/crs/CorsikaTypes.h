@@ -0,0 +1,15 @@
+/** \file
+ * Stand-in for the COAST header of the same name, used by make bench to
+ * build the interface without a COAST installation.
+ */
+#ifndef __CRS_CORSIKATYPES_H__
+#define __CRS_CORSIKATYPES_H__
+
+/** CORSIKA single precision floating point type. */
+typedef float CREAL;
+
+/** CORSIKA integer type. */
+typedef int CINT;
+
+
+#endif
@@ -0,0 +1,12 @@
+/** \file
+ * Stand-in for the COAST header of the same name, used by make bench to
+ * build the interface without a COAST installation. The interface accesses
+ * subblocks as raw CREAL arrays, so no declarations are needed.
+ */
+#ifndef __CRS_TSUBBLOCK_H__
+#define __CRS_TSUBBLOCK_H__
+
+#include <crs/CorsikaTypes.h>
+
+
+#endif
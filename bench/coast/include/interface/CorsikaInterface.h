@@ -0,0 +1,25 @@
+/** \file
+ * Stand-in for the COAST header of the same name, used by make bench to
+ * build the interface without a COAST installation.
+ */
+#ifndef __INTERFACE_CORSIKAINTERFACE_H__
+#define __INTERFACE_CORSIKAINTERFACE_H__
+
+#include <crs/CorsikaTypes.h>
+#include <crs/CInteraction.h>
+#include <crs/CParticle.h>
+
+extern "C" {
+
+void inida_(const char * filename, const bool & thinning, const bool & curved,
+            const bool & slant, const bool & stackinput,
+            const bool & preshower, int str_length);
+void wrida_(const CREAL * DataSubBlock);
+void cloda_();
+void interaction_(const crs::CInteraction & info);
+void track_(const crs::CParticle & pre, const crs::CParticle & post);
+
+}
+
+
+#endif
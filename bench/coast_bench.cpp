@@ -0,0 +1,221 @@
+/** \file
+ * Microbenchmark of the per-callback overhead of the interface.
+ *
+ * Calls wrida_(...), interaction_(...) and track_(...) of libCOAST.so with
+ * the override.py of the given directory and prints one JSON object per
+ * callback: ns per call, calls per second and heap allocations per call
+ * (C++ operator new and all python allocator domains).
+ *
+ * Usage: coast_bench OVERRIDE_DIRECTORY [CALLS]
+ */
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <interface/CorsikaInterface.h>
+#include <crs/CorsikaTypes.h>
+#include <crs/CInteraction.h>
+#include <crs/CParticle.h>
+
+
+// allocation counting
+
+namespace {
+
+std::atomic<std::uint64_t> allocations{0};
+
+struct CountingAllocator {
+    PyMemAllocatorDomain domain;
+    PyMemAllocatorEx original;
+};
+
+CountingAllocator pythonAllocators[] = {
+    {PYMEM_DOMAIN_RAW, {}}, {PYMEM_DOMAIN_MEM, {}}, {PYMEM_DOMAIN_OBJ, {}}
+};
+
+void * countingMalloc(void * context, std::size_t size) {
+    auto * allocator = static_cast<CountingAllocator *>(context);
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return allocator->original.malloc(allocator->original.ctx, size);
+}
+
+void * countingCalloc(void * context, std::size_t count, std::size_t size) {
+    auto * allocator = static_cast<CountingAllocator *>(context);
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return allocator->original.calloc(allocator->original.ctx, count, size);
+}
+
+void * countingRealloc(void * context, void * pointer, std::size_t size) {
+    auto * allocator = static_cast<CountingAllocator *>(context);
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return allocator->original.realloc(allocator->original.ctx, pointer, size);
+}
+
+void countingFree(void * context, void * pointer) {
+    auto * allocator = static_cast<CountingAllocator *>(context);
+    allocator->original.free(allocator->original.ctx, pointer);
+}
+
+// hooks that forward to the previous allocator may be installed after
+// python is initialized
+void hookPythonAllocators() {
+    for (auto & allocator : pythonAllocators) {
+        PyMem_GetAllocator(allocator.domain, &allocator.original);
+        PyMemAllocatorEx hook = {&allocator, countingMalloc, countingCalloc,
+                                 countingRealloc, countingFree};
+        PyMem_SetAllocator(allocator.domain, &hook);
+    }
+}
+
+void unhookPythonAllocators() {
+    for (auto & allocator : pythonAllocators) {
+        PyMem_SetAllocator(allocator.domain, &allocator.original);
+    }
+}
+
+}
+
+
+// not inlined, such that callers see matching new and delete
+[[gnu::noinline]] void * operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    void * pointer = std::malloc(size == 0 ? 1 : size);
+    if (pointer == NULL) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+[[gnu::noinline]] void operator delete(void * pointer) noexcept {
+    std::free(pointer);
+}
+
+[[gnu::noinline]] void operator delete(void * pointer,
+                                       std::size_t) noexcept {
+    std::free(pointer);
+}
+
+
+// benchmarks
+
+namespace {
+
+// "EVTH" interpreted as CORSIKA single precision float
+constexpr float EVENT_HEADER = 217433.078125f;
+
+struct Result {
+    std::uint64_t calls;
+    double seconds;
+    std::uint64_t allocations;
+};
+
+
+template <typename Call>
+Result measure(std::uint64_t calls, Call call) {
+    // warm up caches, lazily created objects and capture flags
+    for (std::uint64_t i = 0; i < calls / 10 + 1; ++i) {
+        call(i);
+    }
+
+    allocations.store(0);
+    const auto start = std::chrono::steady_clock::now();
+    for (std::uint64_t i = 0; i < calls; ++i) {
+        call(i);
+    }
+    const auto stop = std::chrono::steady_clock::now();
+
+    return {calls, std::chrono::duration<double>(stop - start).count(),
+            allocations.load()};
+}
+
+
+void print(const std::string & scenario, const char * callback,
+           const Result & result) {
+    std::printf("{\"scenario\": \"%s\", \"callback\": \"%s\", "
+                "\"calls\": %llu, \"ns_per_call\": %.2f, "
+                "\"calls_per_s\": %.0f, \"allocations_per_call\": %.3f}\n",
+                scenario.c_str(), callback,
+                static_cast<unsigned long long>(result.calls),
+                result.seconds * 1e9 / result.calls,
+                result.calls / result.seconds,
+                static_cast<double>(result.allocations) / result.calls);
+}
+
+}
+
+
+int main(int argc, char ** argv) {
+    if (argc < 2 || argc > 3) {
+        std::fprintf(stderr, "usage: %s OVERRIDE_DIRECTORY [CALLS]\n",
+                     argv[0]);
+        return 2;
+    }
+
+    std::string directory = argv[1];
+    while (directory.size() > 1 && directory.back() == '/') {
+        directory.pop_back();
+    }
+    const std::string scenario = directory.substr(directory.rfind('/') + 1);
+    const std::uint64_t calls = argc == 3 ? std::strtoull(argv[2], NULL, 10)
+                                          : 1000000;
+    if (calls == 0) {
+        std::fprintf(stderr, "number of calls has to be > 0\n");
+        return 2;
+    }
+
+    setenv("CORSIKA_PYTHON_INTERFACE", directory.c_str(), 1);
+
+    const char filename[] = "DAT000001";
+    const bool thinning = true;
+    const bool unused = false;
+    inida_(filename, thinning, unused, unused, unused, unused,
+           sizeof(filename) - 1);
+
+    // one event header followed by particle subblocks
+    std::vector<CREAL> subblocks(2 * 39 * 8, 0.0f);
+    subblocks[0] = EVENT_HEADER;
+    subblocks[1] = 1.0f;
+    for (int line = 0; line < 39; ++line) {
+        CREAL * particle = subblocks.data() + 39 * 8 + line * 8;
+        particle[0] = 5001.0f;
+        particle[1] = 1.0f;
+        particle[4] = 100.0f * line;
+        particle[7] = 1.0f;
+    }
+    wrida_(subblocks.data());
+
+    crs::CParticle pre = {0.0, 0.0, 1e6, 10.0, 0.0, 1e3, 1.0, 5, 1};
+    crs::CParticle post = {0.0, 0.0, 0.9e6, 20.0, 3.3e-3, 9e2, 1.0, 5, 1};
+    crs::CInteraction info = {0.0, 0.0, 1e6, 1e6, 300.0, 0.5, 14, 16};
+
+    hookPythonAllocators();
+
+    const Result write = measure(calls / 10 + 1, [&](std::uint64_t) {
+        wrida_(subblocks.data() + 39 * 8);
+    });
+    const Result interaction = measure(calls, [&](std::uint64_t i) {
+        info.etot = 1e6 + i;
+        interaction_(info);
+    });
+    const Result track = measure(calls, [&](std::uint64_t i) {
+        pre.energy = 1e3 + i;
+        track_(pre, post);
+    });
+
+    unhookPythonAllocators();
+    cloda_();
+
+    print(scenario, "write", write);
+    print(scenario, "interaction", interaction);
+    print(scenario, "track", track);
+    return 0;
+}
@@ -0,0 +1,2 @@
+"""Benchmark case: the no-op interface.DefaultOverride, which disables
+capturing after the first call of each callback."""
@@ -0,0 +1,25 @@
+"""Benchmark case: all captures disabled in init()."""
+import interface
+
+
+class DisabledOverride(interface.Override):
+
+    def init(self):
+        interface.disableWrite()
+        interface.disableInteraction()
+        interface.disableTrack()
+
+    def close(self):
+        pass
+
+    def write(self, subblock):
+        pass
+
+    def interaction(self, info):
+        pass
+
+    def track(self, pre, post):
+        pass
+
+
+interface.patch(DisabledOverride)
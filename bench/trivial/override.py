@@ -0,0 +1,26 @@
+"""Benchmark case: a user override that counts every call."""
+import interface
+
+
+class TrivialOverride(interface.Override):
+
+    def __init__(self):
+        self.calls = 0
+
+    def init(self):
+        pass
+
+    def close(self):
+        pass
+
+    def write(self, subblock):
+        self.calls += 1
+
+    def interaction(self, info):
+        self.calls += 1
+
+    def track(self, pre, post):
+        self.calls += 1
+
+
+interface.patch(TrivialOverride)
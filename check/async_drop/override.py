@@ -0,0 +1,49 @@
+"""Check: asynchronous mode with the drop policy under backpressure.
+
+The consumer is slower than CORSIKA, such that particle subblocks and
+tracks are dropped, but every shower still begins and ends exactly once.
+"""
+import os
+import time
+
+import interface
+
+
+class AsyncDropOverride(interface.Override):
+
+    def __init__(self):
+        self.begins = []
+        self.ends = []
+
+    def init(self):
+        # the smallest ring, which holds about 50 thinned subblocks
+        interface.setAsyncMode(1, "drop")
+
+    def close(self):
+        showers = list(range(1, int(os.environ["COAST_CHECK_SHOWERS"]) + 1))
+        dropped = interface.getAsyncDropped()
+        if dropped["write"] == 0:
+            raise AssertionError("no subblocks were dropped, the check "
+                                 "needs a slower consumer")
+        if self.begins != showers or self.ends != showers:
+            raise AssertionError(
+                "shower_begin for {} and shower_end for {}, expected {}"
+                .format(self.begins, self.ends, showers))
+
+    def shower_begin(self, header):
+        self.begins.append(header.eventNumber)
+
+    def shower_end(self, trailer):
+        self.ends.append(trailer.eventNumber)
+
+    def write(self, subblock):
+        time.sleep(1e-4)
+
+    def interaction(self, info):
+        pass
+
+    def track(self, pre, post):
+        pass
+
+
+interface.patch(AsyncDropOverride)
@@ -0,0 +1,67 @@
+"""Check: the native block writer round trip through BlockReader.
+
+Every subblock passed to write() is found again, in the same order and
+bit for bit, in the blocks of the file, and the index groups them by shower
+and type.
+"""
+import os
+import tempfile
+
+import interface
+
+
+class BlockRoundTripOverride(interface.Override):
+
+    def __init__(self):
+        self.directory = tempfile.TemporaryDirectory()
+        self.path = os.path.join(self.directory.name, "check.blk")
+        self.subblocks = []
+
+    def init(self):
+        # small blocks, such that showers span several of them
+        interface.setBlockWriter(self.path, 1, 64)
+
+    def close(self):
+        showers = list(range(1, int(os.environ["COAST_CHECK_SHOWERS"]) + 1))
+        with interface.BlockReader(self.path) as reader:
+            if reader.entries != 8:
+                raise AssertionError("{} entries per particle line, expected "
+                                     "8 of a thinned run"
+                                     .format(reader.entries))
+            if reader.showers() != showers:
+                raise AssertionError("showers {} in the file, expected {}"
+                                     .format(reader.showers(), showers))
+
+            blocks = sorted(reader.blocks(), key=lambda block: block.first)
+            data = b"".join(block.decompress() for block in blocks)
+            if data != b"".join(self.subblocks):
+                raise AssertionError(
+                    "{} subblocks in the file differ from the {} subblocks "
+                    "passed to write()".format(
+                        sum(block.subblocks for block in blocks),
+                        len(self.subblocks)))
+
+            for shower in showers:
+                particles = reader.particles(shower)
+                if len(particles) != 200 * 39:
+                    raise AssertionError(
+                        "{} particle lines of shower {}, expected {}"
+                        .format(len(particles), shower, 200 * 39))
+                if particles[38, 0] != 5001 or particles[38, 4] != 3800:
+                    raise AssertionError(
+                        "last line of shower {} has description {} and x {}"
+                        .format(shower, particles[38, 0], particles[38, 4]))
+                del particles
+        self.directory.cleanup()
+
+    def write(self, subblock):
+        self.subblocks.append(bytes(subblock))
+
+    def interaction(self, info):
+        pass
+
+    def track(self, pre, post):
+        pass
+
+
+interface.patch(BlockRoundTripOverride)
@@ -0,0 +1,114 @@
+/** \file
+ * Functional checks of the interface against a synthetic CORSIKA run.
+ *
+ * Calls inida_(...), wrida_(...), interaction_(...), track_(...) and
+ * cloda_() of libCOAST.so with the override.py of the given directory for a
+ * run of several showers. The override checks its expectations in close()
+ * and raises on failure, which makes the driver exit with status 1. The
+ * number of showers is passed to the override in the environment variable
+ * COAST_CHECK_SHOWERS.
+ *
+ * Usage: coast_check OVERRIDE_DIRECTORY [SHOWERS]
+ */
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <string>
+#include <vector>
+
+#include <interface/CorsikaInterface.h>
+#include <crs/CorsikaTypes.h>
+#include <crs/CInteraction.h>
+#include <crs/CParticle.h>
+
+
+namespace {
+
+// block markers interpreted as CORSIKA single precision float
+constexpr float RUN_HEADER = 211285.28125f;
+constexpr float EVENT_HEADER = 217433.078125f;
+constexpr float EVENT_END = 3397.391845703125f;
+constexpr float RUN_END = 3301.33251953125f;
+
+constexpr int ENTRIES = 8;
+constexpr int PARTICLE_SUBBLOCKS = 200;
+constexpr int TRACKS = 1000;
+
+
+void writeMarker(std::vector<CREAL> & subblock, float marker, int number) {
+    std::fill(subblock.begin(), subblock.end(), 0.0f);
+    subblock[0] = marker;
+    subblock[1] = number;
+    wrida_(subblock.data());
+}
+
+
+void run(int showers) {
+    const char filename[] = "DAT000001";
+    const bool thinning = true;
+    const bool unused = false;
+    inida_(filename, thinning, unused, unused, unused, unused,
+           sizeof(filename) - 1);
+
+    std::vector<CREAL> subblock(39 * ENTRIES, 0.0f);
+    std::vector<CREAL> particles(39 * ENTRIES, 0.0f);
+    for (int line = 0; line < 39; ++line) {
+        CREAL * particle = particles.data() + line * ENTRIES;
+        particle[0] = 5001.0f;
+        particle[4] = 100.0f * line;
+        particle[7] = 1.0f;
+    }
+
+    crs::CParticle pre = {0.0, 0.0, 1e6, 10.0, 0.0, 1e3, 1.0, 5, 1};
+    crs::CParticle post = {0.0, 0.0, 0.9e6, 20.0, 3.3e-3, 9e2, 1.0, 5, 1};
+    crs::CInteraction info = {0.0, 0.0, 1e6, 1e6, 300.0, 0.5, 14, 16};
+
+    writeMarker(subblock, RUN_HEADER, 1);
+    for (int shower = 1; shower <= showers; ++shower) {
+        writeMarker(subblock, EVENT_HEADER, shower);
+        interaction_(info);
+        for (int i = 0; i < TRACKS; ++i) {
+            track_(pre, post);
+        }
+        for (int i = 0; i < PARTICLE_SUBBLOCKS; ++i) {
+            wrida_(particles.data());
+        }
+        writeMarker(subblock, EVENT_END, shower);
+    }
+    writeMarker(subblock, RUN_END, 1);
+
+    cloda_();
+}
+
+}
+
+
+int main(int argc, char ** argv) {
+    if (argc < 2 || argc > 3) {
+        std::fprintf(stderr, "usage: %s OVERRIDE_DIRECTORY [SHOWERS]\n",
+                     argv[0]);
+        return 2;
+    }
+
+    const int showers = argc == 3 ? std::atoi(argv[2]) : 3;
+    if (showers <= 0) {
+        std::fprintf(stderr, "number of showers has to be > 0\n");
+        return 2;
+    }
+
+    setenv("CORSIKA_PYTHON_INTERFACE", argv[1], 1);
+    setenv("COAST_CHECK_SHOWERS", std::to_string(showers).c_str(), 1);
+
+    try {
+        run(showers);
+    }
+    catch (const std::exception & e) {
+        std::fprintf(stderr, "coast_check: %s failed: %s\n", argv[1],
+                     e.what());
+        return 1;
+    }
+
+    std::fprintf(stderr, "coast_check: %s passed\n", argv[1]);
+    return 0;
+}
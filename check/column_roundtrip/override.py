@@ -0,0 +1,83 @@
+"""Check: the native column writer round trip through ColumnReader.
+
+The file holds every track and interaction of the synthetic run with the
+values passed to track_(...) and interaction_(...), grouped by shower and
+species into chunks.
+"""
+import os
+import tempfile
+
+import interface
+
+
+TRACKS = 1000
+
+TRACK_VALUES = {
+    "pre.z": 1e6, "pre.depth": 10.0, "pre.time": 0.0, "pre.energy": 1e3,
+    "post.z": 0.9e6, "post.depth": 20.0, "post.time": 3.3e-3,
+    "post.energy": 9e2, "post.weight": 1.0, "post.particleID": 5,
+    "post.hadronicGeneration": 1
+}
+
+INTERACTION_VALUES = {
+    "z": 1e6, "labEnergy": 1e6, "crossSection": 300.0, "elasticity": 0.5,
+    "projectileID": 14, "targetID": 16
+}
+
+
+class ColumnRoundTripOverride(interface.Override):
+
+    def __init__(self):
+        self.directory = tempfile.TemporaryDirectory()
+        self.path = os.path.join(self.directory.name, "check.col")
+
+    def init(self):
+        # small chunks, such that showers span several of them
+        interface.setColumnWriter(self.path, 256)
+
+    def close(self):
+        showers = list(range(1, int(os.environ["COAST_CHECK_SHOWERS"]) + 1))
+        with interface.ColumnReader(self.path) as reader:
+            for stream in ("track", "interaction"):
+                if reader.showers(stream) != showers:
+                    raise AssertionError(
+                        "{} showers {} in the file, expected {}".format(
+                            stream, reader.showers(stream), showers))
+
+            if reader.species("track") != [5]:
+                raise AssertionError("track species {}, expected [5]"
+                                     .format(reader.species("track")))
+            if len(reader.chunks("track", showers=[1])) != 4:
+                raise AssertionError("{} track chunks of shower 1, expected "
+                                     "4 of at most 256 rows".format(
+                                         len(reader.chunks("track",
+                                                           showers=[1]))))
+
+            self.compare(reader, "track", TRACK_VALUES,
+                         TRACKS * len(showers))
+            self.compare(reader, "interaction", INTERACTION_VALUES,
+                         len(showers))
+        self.directory.cleanup()
+
+    def compare(self, reader, stream, expected, rows):
+        for name, value in expected.items():
+            column = reader.column(stream, name)
+            values = set(column)
+            if len(column) != rows or values != {value}:
+                raise AssertionError(
+                    "{} column {} has {} rows of {}, expected {} rows of {}"
+                    .format(stream, name, len(column), sorted(values), rows,
+                            value))
+            del column
+
+    def write(self, subblock):
+        pass
+
+    def interaction(self, info):
+        pass
+
+    def track(self, pre, post):
+        pass
+
+
+interface.patch(ColumnRoundTripOverride)
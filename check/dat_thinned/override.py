@@ -0,0 +1,83 @@
+"""Check: a thinned DAT file read by coast_dat.
+
+The file of write_dat.py reaches write() subblock by subblock with the
+thinned layout, every shower begins and ends once and the particle lines
+arrive unchanged.
+"""
+import os
+import struct
+
+import interface
+
+
+PARTICLE_SUBBLOCKS = 50
+LINES = 39
+
+
+class DatThinnedOverride(interface.Override):
+
+    def __init__(self):
+        self.begins = []
+        self.ends = []
+        self.particles = {}
+        self.weights = 0.0
+        self.current = None
+
+    def init(self):
+        pass
+
+    def close(self):
+        showers = list(range(1, int(os.environ["COAST_CHECK_SHOWERS"]) + 1))
+        if self.begins != showers or self.ends != showers:
+            raise AssertionError(
+                "shower_begin for {} and shower_end for {}, expected {}"
+                .format(self.begins, self.ends, showers))
+        expected = dict.fromkeys(showers, PARTICLE_SUBBLOCKS)
+        if self.particles != expected:
+            raise AssertionError("particle subblocks per shower {}, "
+                                 "expected {}".format(self.particles,
+                                                      expected))
+        weights = 2.5 * LINES * PARTICLE_SUBBLOCKS * len(showers)
+        if self.weights != weights:
+            raise AssertionError("sum of weights {}, expected {}"
+                                 .format(self.weights, weights))
+
+    def shower_begin(self, header):
+        self.begins.append(header.eventNumber)
+        self.current = header.eventNumber
+        self.particles[self.current] = 0
+
+    def shower_end(self, trailer):
+        self.ends.append(trailer.eventNumber)
+        self.current = None
+
+    def write(self, subblock):
+        if len(subblock) != LINES * 8 * 4:
+            raise AssertionError("subblock of {} bytes, expected the "
+                                 "thinned layout".format(len(subblock)))
+        values = struct.unpack("{}f".format(LINES * 8), subblock)
+        if self.current is None or values[0] != 5001:
+            return
+
+        number = self.particles[self.current]
+        for line in range(LINES):
+            description, x, y, weight = (values[line * 8],
+                                         values[line * 8 + 4],
+                                         values[line * 8 + 5],
+                                         values[line * 8 + 7])
+            if (description, x, y) != (5001, line, number):
+                raise AssertionError(
+                    "line {} of particle subblock {} of shower {} has "
+                    "description, x and y {}".format(
+                        line, number, self.current, (description, x, y)))
+            self.weights += weight
+        self.particles[self.current] = number + 1
+
+    def interaction(self, info):
+        pass
+
+    def track(self, pre, post):
+        pass
+
+
+interface.patch(DatThinnedOverride)
@@ -0,0 +1,64 @@
+"""Write the thinned particle output of a synthetic run for coast_dat.
+
+Every shower holds 50 particle subblocks of 39 muons with the thinning
+weight 2.5, the line number as x and the subblock number as y. The
+subblocks are written in records of 21 with Fortran record markers, as by
+a gfortran build of CORSIKA.
+
+Usage: python3 write_dat.py DAT SHOWERS
+"""
+import struct
+import sys
+
+
+ENTRIES = 8
+LINES = 39
+RECORD_SUBBLOCKS = 21
+PARTICLE_SUBBLOCKS = 50
+
+RUN_HEADER = 211285.28125
+EVENT_HEADER = 217433.078125
+EVENT_END = 3397.391845703125
+RUN_END = 3301.33251953125
+
+
+def subblock(values):
+    return struct.pack("{}f".format(LINES * ENTRIES), *values)
+
+
+def marker(type, number):
+    values = [0.0] * (LINES * ENTRIES)
+    values[0:2] = [type, number]
+    return subblock(values)
+
+
+def particles(number):
+    values = [0.0] * (LINES * ENTRIES)
+    for line in range(LINES):
+        values[line * ENTRIES] = 5001.0
+        values[line * ENTRIES + 4] = line
+        values[line * ENTRIES + 5] = number
+        values[line * ENTRIES + 7] = 2.5
+    return subblock(values)
+
+
+def main(path, showers):
+    subblocks = [marker(RUN_HEADER, 1)]
+    for shower in range(1, showers + 1):
+        subblocks.append(marker(EVENT_HEADER, shower))
+        subblocks.extend(particles(number)
+                         for number in range(PARTICLE_SUBBLOCKS))
+        subblocks.append(marker(EVENT_END, shower))
+    subblocks.append(marker(RUN_END, 1))
+    while len(subblocks) % RECORD_SUBBLOCKS:
+        subblocks.append(subblock([0.0] * (LINES * ENTRIES)))
+
+    with open(path, "wb") as dat:
+        for first in range(0, len(subblocks), RECORD_SUBBLOCKS):
+            record = b"".join(subblocks[first:first + RECORD_SUBBLOCKS])
+            length = struct.pack("I", len(record))
+            dat.write(length + record + length)
+
+
+if __name__ == "__main__":
+    main(sys.argv[1], int(sys.argv[2]))
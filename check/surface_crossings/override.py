@@ -0,0 +1,89 @@
+"""Check: crossings of the straight tracks with native surfaces.
+
+Every track of the synthetic run goes straight down from z = 1e6 to
+z = 9e5. It crosses a plane a quarter down its length and a sphere at
+0.4 and 0.6 of its length, but misses a disc beside it and a plane below
+it. Depth, time and energy at the crossings follow from these fractions.
+"""
+import os
+
+import interface
+
+
+TRACKS = 1000
+
+# (z, depth, time, energy) of pre and post
+PRE = (1e6, 10.0, 0.0, 1e3)
+POST = (0.9e6, 20.0, 3.3e-3, 9e2)
+
+
+def close(value, expected):
+    return abs(value - expected) <= 1e-9 * max(abs(expected), 1e-3)
+
+
+class SurfaceCrossingsOverride(interface.Override):
+
+    def __init__(self):
+        self.crossed = 0
+        self.showers = 0
+        self.expected = []
+
+    def init(self):
+        plane = interface.addPlane((0, 0, 0.975e6), (0, 0, 1))
+        sphere = interface.addSphere((0, 0, 0.95e6), 1e4)
+        interface.addPlane((5, 5, 0.92e6), (0, 0, 1), 1)
+        interface.addPlane((0, 0, 0.5e6), (0, 0, 1))
+        for surface, fraction in ((plane, 0.25), (sphere, 0.4),
+                                  (sphere, 0.6)):
+            self.expected.append((surface, tuple(
+                pre + fraction * (post - pre)
+                for pre, post in zip(PRE, POST))))
+        interface.disableTrack()
+
+    def close(self):
+        showers = int(os.environ["COAST_CHECK_SHOWERS"])
+        if self.showers != showers:
+            raise AssertionError("{} showers checked, expected {}"
+                                 .format(self.showers, showers))
+
+    def crossings(self, crossings):
+        for i in range(len(crossings)):
+            surface, values = self.expected[self.crossed % 3]
+            found = (crossings.z[i], crossings.atmosphericDepth[i],
+                     crossings.time[i], crossings.energy[i])
+            if crossings.surfaceID[i] != surface or not all(
+                    close(value, reference)
+                    for value, reference in zip(found, values)):
+                raise AssertionError(
+                    "crossing {} with surface {} at z, depth, time and "
+                    "energy {}, expected surface {} at {}".format(
+                        self.crossed, crossings.surfaceID[i], found, surface,
+                        values))
+            if (crossings.particleID[i] != 5 or crossings.weight[i] != 1
+                    or crossings.uz[i] != -1):
+                raise AssertionError("crossing {} has particle {}, weight "
+                                     "{} and uz {}".format(
+                                         self.crossed,
+                                         crossings.particleID[i],
+                                         crossings.weight[i],
+                                         crossings.uz[i]))
+            self.crossed += 1
+
+    def shower_end(self, trailer):
+        self.showers += 1
+        if self.crossed != 3 * TRACKS * self.showers:
+            raise AssertionError("{} crossings until shower {}, expected {}"
+                                 .format(self.crossed, trailer.eventNumber,
+                                         3 * TRACKS * self.showers))
+
+    def write(self, subblock):
+        pass
+
+    def interaction(self, info):
+        pass
+
+    def track(self, pre, post):
+        pass
+
+
+interface.patch(SurfaceCrossingsOverride)
@@ -0,0 +1,85 @@
+"""Check: path lengths of the straight tracks in native voxel grids.
+
+Every track of the synthetic run goes straight down from z = 1e6 to
+z = 9e5 and loses an energy of 100, so that it crosses the middle of four
+voxels of 5e4 along z with half its length and energy loss in each. The
+cylindrical grid puts the track at an azimuth of -3/4 pi, which has to be
+wrapped into its (0, 2 pi) axis.
+"""
+import math
+import os
+
+import interface
+
+
+TRACKS = 1000
+HEIGHTS = (0.85e6, 1.05e6, 4)
+
+
+def close(value, expected):
+    return abs(value - expected) <= 1e-9 * abs(expected)
+
+
+class VoxelPathsOverride(interface.Override):
+
+    def __init__(self):
+        self.grids = {
+            "cartesian": (interface.VoxelGrid(
+                "cartesian", [(-1, 1, 1), (-1, 1, 1), HEIGHTS],
+                species=[5, 6]), (0, 0)),
+            "cylindrical": (interface.VoxelGrid(
+                "cylindrical", [(0, 10, 1), (0, 2 * math.pi, 4), HEIGHTS],
+                core=(1, 1, 0), direction=(0, 0)), (0, 2))
+        }
+        self.showers = 0
+
+    def init(self):
+        interface.disableTrack()
+
+    def close(self):
+        showers = int(os.environ["COAST_CHECK_SHOWERS"])
+        if self.showers != showers:
+            raise AssertionError("{} showers checked, expected {}"
+                                 .format(self.showers, showers))
+
+    def shower_end(self, trailer):
+        for name, (grid, (first, second)) in self.grids.items():
+            contents = grid.contents()
+            index = [tuple(int(contents.index[axis][voxel])
+                           for axis in range(3))
+                     for voxel in range(len(contents.pathLength))]
+            expected = [(first, second, 1), (first, second, 2)]
+            if index != expected:
+                raise AssertionError("{} grid touched voxels {}, expected {}"
+                                     .format(name, index, expected))
+
+            for voxel in range(2):
+                values = (contents.pathLength[voxel],
+                          contents.energyDeposit[voxel],
+                          contents.count[voxel])
+                references = (5e4, 50.0, 1.0)
+                if not all(close(value, TRACKS * reference)
+                           for value, reference in zip(values, references)):
+                    raise AssertionError(
+                        "{} grid voxel {} has path length, energy deposit "
+                        "and count {} in shower {}".format(
+                            name, index[voxel], values,
+                            trailer.eventNumber))
+            if contents.segments != TRACKS:
+                raise AssertionError("{} grid has {} segments, expected {}"
+                                     .format(name, contents.segments, TRACKS))
+            del contents
+            grid.reset()
+        self.showers += 1
+
+    def write(self, subblock):
+        pass
+
+    def interaction(self, info):
+        pass
+
+    def track(self, pre, post):
+        pass
+
+
+interface.patch(VoxelPathsOverride)
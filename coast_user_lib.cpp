@@ -101,6 +101,24 @@ extern "C" void track_([[maybe_unused]] const crs::CParticle & pre,
 }
 
 
+/** Get the COAST calls the interface currently processes.
+ *
+ * Not called by CORSIKA. coast_consumer announces the result to CORSIKA,
+ * which then skips calls that no consumer processes:
+ * - bit 0: wrida_(...)
+ * - bit 1: interaction_(...)
+ * - bit 2: track_(...)
+ */
+extern "C" unsigned int capturemask_() {
+#ifdef USE_PYTHON_INTERFACE
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    return pythonInterface->getRequiredCalls();
+#else
+    return 0;
+#endif
+}
+
+
 // for special use only but should be defined because it is delcared in CORSIKA.F
 extern "C" void tabularizedatmosphere_(
         [[maybe_unused]] const int & nPoints,
@@ -0,0 +1,228 @@
+#include "ArrowBatch.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+namespace {
+
+// data buffer of empty columns, Arrow requires non-NULL buffers
+alignas(64) const std::int64_t EMPTY_BUFFER[1] = {0};
+
+using BatchPointer = std::shared_ptr<const ArrowBatch>;
+
+/** Private data of an exported column. */
+struct ColumnData {
+    BatchPointer batch;
+    const void * buffers[2];
+};
+
+/** Private data of an exported struct schema. */
+struct SchemaData {
+    BatchPointer batch;
+    std::vector<ArrowSchema> children;
+    std::vector<ArrowSchema *> pointers;
+};
+
+/** Private data of an exported struct array. */
+struct ArrayData {
+    BatchPointer batch;
+    std::vector<ArrowArray> children;
+    std::vector<ArrowArray *> pointers;
+    const void * buffers[1];
+};
+
+
+// release callbacks; children are released separately as consumers may
+// move them out of their parent
+
+void releaseColumnSchema(ArrowSchema * schema) {
+    delete static_cast<BatchPointer *>(schema->private_data);
+    schema->release = NULL;
+}
+
+void releaseSchema(ArrowSchema * schema) {
+    auto * data = static_cast<SchemaData *>(schema->private_data);
+    for (ArrowSchema & child : data->children) {
+        if (child.release != NULL) {
+            child.release(&child);
+        }
+    }
+    delete data;
+    schema->release = NULL;
+}
+
+void releaseColumnArray(ArrowArray * array) {
+    delete static_cast<ColumnData *>(array->private_data);
+    array->release = NULL;
+}
+
+void releaseArray(ArrowArray * array) {
+    auto * data = static_cast<ArrayData *>(array->private_data);
+    for (ArrowArray & child : data->children) {
+        if (child.release != NULL) {
+            child.release(&child);
+        }
+    }
+    delete data;
+    array->release = NULL;
+}
+
+}
+
+
+std::size_t ArrowBatch::Column::getSize() const {
+    switch (type) {
+        case Type::FLOAT64:
+            return float64.size();
+        case Type::FLOAT32:
+            return float32.size();
+        default:
+            return int32.size();
+    }
+}
+
+
+const void * ArrowBatch::Column::getData() const {
+    const void * data = NULL;
+    switch (type) {
+        case Type::FLOAT64:
+            data = float64.data();
+            break;
+        case Type::FLOAT32:
+            data = float32.data();
+            break;
+        default:
+            data = int32.data();
+            break;
+    }
+
+    return data == NULL ? EMPTY_BUFFER : data;
+}
+
+
+const char * ArrowBatch::Column::getFormat() const {
+    switch (type) {
+        case Type::FLOAT64:
+            return "g";
+        case Type::FLOAT32:
+            return "f";
+        default:
+            return "i";
+    }
+}
+
+
+std::size_t ArrowBatch::addColumn(const std::string & name, Type type) {
+    mColumns.push_back({name, type, {}, {}, {}});
+    return mColumns.size() - 1;
+}
+
+
+ArrowBatch::Column & ArrowBatch::getColumn(std::size_t index) {
+    return mColumns.at(index);
+}
+
+
+const std::vector<ArrowBatch::Column> & ArrowBatch::getColumns() const {
+    return mColumns;
+}
+
+
+std::size_t ArrowBatch::getSize() const {
+    return mColumns.empty() ? 0 : mColumns.front().getSize();
+}
+
+
+void ArrowBatch::reserve(std::size_t rows) {
+    for (Column & column : mColumns) {
+        switch (column.type) {
+            case Type::FLOAT64:
+                column.float64.reserve(rows);
+                break;
+            case Type::FLOAT32:
+                column.float32.reserve(rows);
+                break;
+            default:
+                column.int32.reserve(rows);
+                break;
+        }
+    }
+}
+
+
+void ArrowBatch::exportBatch(const std::shared_ptr<const ArrowBatch> & batch,
+                             ArrowSchema * schema, ArrowArray * array) {
+    const std::vector<Column> & columns = batch->getColumns();
+    const std::int64_t length = batch->getSize();
+    for (const Column & column : columns) {
+        if (static_cast<std::int64_t>(column.getSize()) != length) {
+            throw std::logic_error("columns of arrow batches need equal "
+                                   "length");
+        }
+    }
+
+    const std::int64_t count = columns.size();
+    auto schemaData = std::make_unique<SchemaData>();
+    auto arrayData = std::make_unique<ArrayData>();
+    schemaData->batch = batch;
+    schemaData->children.resize(count);
+    arrayData->batch = batch;
+    arrayData->children.resize(count);
+    arrayData->buffers[0] = NULL;
+
+    for (std::int64_t i = 0; i < count; ++i) {
+        const Column & column = columns[i];
+
+        ArrowSchema & childSchema = schemaData->children[i];
+        childSchema.format = column.getFormat();
+        childSchema.name = column.name.c_str();
+        childSchema.metadata = NULL;
+        childSchema.flags = 0;
+        childSchema.n_children = 0;
+        childSchema.children = NULL;
+        childSchema.dictionary = NULL;
+        childSchema.release = releaseColumnSchema;
+        childSchema.private_data = new BatchPointer(batch);
+        schemaData->pointers.push_back(&childSchema);
+
+        auto * columnData = new ColumnData{batch, {NULL, column.getData()}};
+        ArrowArray & childArray = arrayData->children[i];
+        childArray.length = length;
+        childArray.null_count = 0;
+        childArray.offset = 0;
+        childArray.n_buffers = 2;
+        childArray.n_children = 0;
+        childArray.buffers = columnData->buffers;
+        childArray.children = NULL;
+        childArray.dictionary = NULL;
+        childArray.release = releaseColumnArray;
+        childArray.private_data = columnData;
+        arrayData->pointers.push_back(&childArray);
+    }
+
+    schema->format = "+s";
+    schema->name = "";
+    schema->metadata = NULL;
+    schema->flags = 0;
+    schema->n_children = count;
+    schema->children = schemaData->pointers.data();
+    schema->dictionary = NULL;
+    schema->release = releaseSchema;
+    schema->private_data = schemaData.release();
+
+    array->length = length;
+    array->null_count = 0;
+    array->offset = 0;
+    array->n_buffers = 1;
+    array->n_children = count;
+    array->buffers = arrayData->buffers;
+    array->children = arrayData->pointers.data();
+    array->dictionary = NULL;
+    array->release = releaseArray;
+    array->private_data = arrayData.release();
+}
@@ -0,0 +1,132 @@
+/** \file
+ * Record columns in Arrow layout and their export via the Arrow C data
+ * interface.
+ */
+#ifndef __ARROWBATCH_H__
+#define __ARROWBATCH_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+// structures of the Arrow C data interface, see
+// https://arrow.apache.org/docs/format/CDataInterface.html
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+    const char * format;
+    const char * name;
+    const char * metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema ** children;
+    struct ArrowSchema * dictionary;
+    void (*release)(struct ArrowSchema *);
+    void * private_data;
+};
+
+struct ArrowArray {
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void ** buffers;
+    struct ArrowArray ** children;
+    struct ArrowArray * dictionary;
+    void (*release)(struct ArrowArray *);
+    void * private_data;
+};
+
+#endif
+
+
+/** Columns of equal length without nulls that can be exported as Arrow
+ * record batch.
+ *
+ * The export is a struct array with one child per column whose data
+ * buffer points directly into the column, i.e. consumers like
+ * pyarrow.record_batch() do not copy. The exported structures share the
+ * ownership of the batch, which therefore has to be held by a
+ * std::shared_ptr and must not change any more.
+ */
+class ArrowBatch {
+
+    // interface types
+    public:
+        /** Arrow data type of a column. */
+        enum class Type {
+            FLOAT64,  /**< Format "g". */
+            FLOAT32,  /**< Format "f". */
+            INT32     /**< Format "i". */
+        };
+
+        /** Column of a batch; only the vector of its type is used. */
+        struct Column {
+            std::string name;
+            Type type;
+            std::vector<double> float64;
+            std::vector<float> float32;
+            std::vector<std::int32_t> int32;
+
+            /** Get the number of values. */
+            std::size_t getSize() const;
+
+            /** Get the values, never NULL. */
+            const void * getData() const;
+
+            /** Get the Arrow format string of the type. */
+            const char * getFormat() const;
+        };
+
+
+    // members
+    private:
+        std::vector<Column> mColumns;
+
+
+    // public functions
+    public:
+        /** Add an empty column.
+         *
+         * @return Index of the column.
+         */
+        std::size_t addColumn(const std::string & name, Type type);
+
+        /** Get a column to append values. */
+        Column & getColumn(std::size_t index);
+
+        /** Get all columns. */
+        const std::vector<Column> & getColumns() const;
+
+        /** Get the number of rows, i.e. the size of the first column. */
+        std::size_t getSize() const;
+
+        /** Reserve memory for rows in all columns. */
+        void reserve(std::size_t rows);
+
+        /** Export a batch as Arrow struct array.
+         *
+         * Both structures keep the batch alive until their release callback
+         * is called. Throws a std::logic_error if the columns differ in
+         * length.
+         *
+         * @param batch Batch to export.
+         * @param schema Uninitialized schema that receives the columns.
+         * @param array Uninitialized array that receives the data.
+         */
+        static void exportBatch(const std::shared_ptr<const ArrowBatch> & batch,
+                                ArrowSchema * schema, ArrowArray * array);
+
+};
+
+
+#endif
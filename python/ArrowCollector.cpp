@@ -0,0 +1,160 @@
+#include "ArrowCollector.h"
+
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+namespace {
+
+using Type = ArrowBatch::Type;
+
+// initial rows of a batch
+constexpr std::size_t INITIAL_ROWS = 4096;
+
+}
+
+
+ArrowCollector::ArrowCollector(RecordFilter::RecordType source,
+                               const std::vector<int> & species,
+                               const std::vector<int> & levels)
+    : mSource(source)
+{
+    if (source != RecordFilter::RecordType::PARTICLE &&
+        (!species.empty() || !levels.empty())) {
+        throw std::invalid_argument("species and observation levels can "
+                                    "only be selected for particles");
+    }
+
+    mDecoder.setSpecies(species);
+    mDecoder.setObservationLevels(levels);
+    mBatch = createBatch();
+}
+
+
+RecordFilter::RecordType ArrowCollector::getSource() const {
+    return mSource;
+}
+
+
+void ArrowCollector::add(const crs::CParticle & pre,
+                         const crs::CParticle & post) {
+    ArrowBatch & batch = *mBatch;
+    std::size_t column = 0;
+    for (const crs::CParticle * particle : {&pre, &post}) {
+        batch.getColumn(column++).float64.push_back(particle->time);
+        batch.getColumn(column++).float64.push_back(particle->x);
+        batch.getColumn(column++).float64.push_back(particle->y);
+        batch.getColumn(column++).float64.push_back(particle->z);
+        batch.getColumn(column++).float64.push_back(particle->depth);
+        batch.getColumn(column++).float64.push_back(particle->energy);
+        batch.getColumn(column++).float64.push_back(particle->weight);
+        batch.getColumn(column++).int32.push_back(particle->particleId);
+        batch.getColumn(column++).int32.push_back(
+                particle->hadronicGeneration);
+    }
+}
+
+
+void ArrowCollector::add(const crs::CInteraction & info) {
+    ArrowBatch & batch = *mBatch;
+    batch.getColumn(0).float64.push_back(info.x);
+    batch.getColumn(1).float64.push_back(info.y);
+    batch.getColumn(2).float64.push_back(info.z);
+    batch.getColumn(3).float64.push_back(info.etot);
+    batch.getColumn(4).float64.push_back(info.sigma);
+    batch.getColumn(5).float64.push_back(info.kela);
+    batch.getColumn(6).int32.push_back(info.projId);
+    batch.getColumn(7).int32.push_back(info.targetId);
+}
+
+
+void ArrowCollector::add(const CREAL * DataSubBlock, int entries) {
+    const std::size_t size = mDecoder.decode(DataSubBlock, entries);
+    if (size == 0) {
+        mDecoder.clear();
+        return;
+    }
+
+    // the decoder appends branch free, the batch receives the accepted
+    // particles in one go per column
+    const ParticleDecoder::Columns & decoded = mDecoder.getColumns();
+    auto append = [size](auto & column, const auto & values) {
+        column.insert(column.end(), values.begin(), values.begin() + size);
+    };
+
+    ArrowBatch & batch = *mBatch;
+    append(batch.getColumn(0).int32, decoded.particleId);
+    append(batch.getColumn(1).int32, decoded.hadronicGeneration);
+    append(batch.getColumn(2).int32, decoded.observationLevel);
+    append(batch.getColumn(3).float32, decoded.px);
+    append(batch.getColumn(4).float32, decoded.py);
+    append(batch.getColumn(5).float32, decoded.pz);
+    append(batch.getColumn(6).float32, decoded.x);
+    append(batch.getColumn(7).float32, decoded.y);
+    append(batch.getColumn(8).float32, decoded.time);
+    append(batch.getColumn(9).float32, decoded.weight);
+    mDecoder.clear();
+}
+
+
+std::size_t ArrowCollector::getSize() const {
+    return mBatch->getSize();
+}
+
+
+std::shared_ptr<const ArrowBatch> ArrowCollector::take() {
+    std::shared_ptr<const ArrowBatch> batch = mBatch;
+    mBatch = createBatch();
+    return batch;
+}
+
+
+std::shared_ptr<ArrowBatch> ArrowCollector::createBatch() const {
+    auto batch = std::make_shared<ArrowBatch>();
+
+    switch (mSource) {
+        case RecordFilter::RecordType::TRACK:
+            for (const std::string prefix : {"pre.", "post."}) {
+                batch->addColumn(prefix + "time", Type::FLOAT64);
+                batch->addColumn(prefix + "x", Type::FLOAT64);
+                batch->addColumn(prefix + "y", Type::FLOAT64);
+                batch->addColumn(prefix + "z", Type::FLOAT64);
+                batch->addColumn(prefix + "depth", Type::FLOAT64);
+                batch->addColumn(prefix + "energy", Type::FLOAT64);
+                batch->addColumn(prefix + "weight", Type::FLOAT64);
+                batch->addColumn(prefix + "particleID", Type::INT32);
+                batch->addColumn(prefix + "hadronicGeneration", Type::INT32);
+            }
+            break;
+
+        case RecordFilter::RecordType::INTERACTION:
+            batch->addColumn("x", Type::FLOAT64);
+            batch->addColumn("y", Type::FLOAT64);
+            batch->addColumn("z", Type::FLOAT64);
+            batch->addColumn("labEnergy", Type::FLOAT64);
+            batch->addColumn("crossSection", Type::FLOAT64);
+            batch->addColumn("elasticity", Type::FLOAT64);
+            batch->addColumn("projectileID", Type::INT32);
+            batch->addColumn("targetID", Type::INT32);
+            break;
+
+        case RecordFilter::RecordType::PARTICLE:
+            batch->addColumn("particleID", Type::INT32);
+            batch->addColumn("hadronicGeneration", Type::INT32);
+            batch->addColumn("observationLevel", Type::INT32);
+            batch->addColumn("px", Type::FLOAT32);
+            batch->addColumn("py", Type::FLOAT32);
+            batch->addColumn("pz", Type::FLOAT32);
+            batch->addColumn("x", Type::FLOAT32);
+            batch->addColumn("y", Type::FLOAT32);
+            batch->addColumn("time", Type::FLOAT32);
+            batch->addColumn("weight", Type::FLOAT32);
+            break;
+    }
+
+    batch->reserve(INITIAL_ROWS);
+    return batch;
+}
@@ -0,0 +1,83 @@
+/** \file
+ * Collection of records into Arrow batches.
+ */
+#ifndef __ARROWCOLLECTOR_H__
+#define __ARROWCOLLECTOR_H__
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <crs/CorsikaTypes.h>
+#include <crs/CInteraction.h>
+#include <crs/CParticle.h>
+
+#include "ArrowBatch.h"
+#include "ParticleDecoder.h"
+#include "RecordFilter.h"
+
+
+/** Appends tracks, interactions or decoded particles to the columns of an
+ * ArrowBatch, which is handed over by take().
+ *
+ * The columns and their names are those of the ColumnWriter for tracks
+ * (pre.time, ..., post.hadronicGeneration) and interactions (x, ...,
+ * targetID) and those of write_particles() for particles (particleID, ...,
+ * weight, 32 bit floats as in the CORSIKA subblocks).
+ */
+class ArrowCollector {
+
+    // members
+    private:
+        RecordFilter::RecordType mSource;
+        std::shared_ptr<ArrowBatch> mBatch;
+        ParticleDecoder mDecoder;
+
+
+    // public functions
+    public:
+        /** Create a collector.
+         *
+         * Throws a std::invalid_argument for species or levels outside the
+         * ranges of the ParticleDecoder or if they are given for other
+         * sources than particles.
+         *
+         * @param source Records to collect.
+         * @param species Collected particle IDs; empty = all particles.
+         * @param levels Collected observation levels; empty = all levels.
+         */
+        ArrowCollector(RecordFilter::RecordType source,
+                       const std::vector<int> & species = {},
+                       const std::vector<int> & levels = {});
+
+        /** Get the collected records. */
+        RecordFilter::RecordType getSource() const;
+
+        /** Append a track segment. */
+        void add(const crs::CParticle & pre, const crs::CParticle & post);
+
+        /** Append an interaction. */
+        void add(const crs::CInteraction & info);
+
+        /** Append the particles of a subblock.
+         *
+         * @param DataSubBlock 39 particle lines.
+         * @param entries Entries per line (8 thinned, 7 not thinned).
+         */
+        void add(const CREAL * DataSubBlock, int entries);
+
+        /** Get the number of collected records. */
+        std::size_t getSize() const;
+
+        /** Hand over the collected records and start an empty batch. */
+        std::shared_ptr<const ArrowBatch> take();
+
+
+    // private functions
+    private:
+        std::shared_ptr<ArrowBatch> createBatch() const;
+
+};
+
+
+#endif
@@ -0,0 +1,250 @@
+#include "BlockWriter.h"
+
+#include <zlib.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+
+namespace {
+
+const char FILE_MAGIC[8] = {'C', 'O', 'A', 'S', 'T', 'B', 'L', 'K'};
+const char INDEX_MAGIC[8] = {'C', 'O', 'A', 'S', 'T', 'I', 'D', 'X'};
+constexpr std::uint32_t FILE_VERSION = 1;
+
+static_assert(sizeof(CREAL) == 4, "subblocks are stored as float32");
+
+}
+
+
+BlockWriter::BlockWriter(const std::string & path, int entries, int level,
+                         std::size_t blockSubBlocks)
+    : mPath(path),
+      mEntries(entries),
+      mBlockSubBlocks(blockSubBlocks),
+      mLevel(level)
+{
+    if (entries != 7 && entries != 8) {
+        throw std::invalid_argument("particle lines have 7 or 8 entries");
+    }
+    if (level < 0 || level > 9) {
+        throw std::invalid_argument("compression level has to be in [0, 9]");
+    }
+    if (blockSubBlocks == 0) {
+        throw std::invalid_argument("number of subblocks per block has to "
+                                    "be > 0");
+    }
+
+    mFile = std::fopen(path.c_str(), "wb");
+    if (mFile == NULL) {
+        throw std::runtime_error("cannot create block file " + path);
+    }
+    std::setvbuf(mFile, NULL, _IOFBF, 1 << 20);
+
+    writeBytes(FILE_MAGIC, sizeof(FILE_MAGIC));
+    writeValue<std::uint32_t>(FILE_VERSION);
+    writeValue<std::uint32_t>(entries);
+
+    mCurrent.data.reserve(mBlockSubBlocks * 39 * mEntries);
+    mCompressor = std::thread(&BlockWriter::compress, this);
+}
+
+
+BlockWriter::~BlockWriter() {
+    if (mFile == NULL) {
+        return;
+    }
+
+    try {
+        close();
+    }
+    catch (const std::exception &) {
+        if (mFile != NULL) {
+            std::fclose(mFile);
+            mFile = NULL;
+        }
+    }
+}
+
+
+const std::string & BlockWriter::getPath() const {
+    return mPath;
+}
+
+std::size_t BlockWriter::getBlockSubBlocks() const {
+    return mBlockSubBlocks;
+}
+
+
+void BlockWriter::write(const CREAL * DataSubBlock) {
+    const ShowerBoundary::BlockType type =
+        ShowerBoundary::getBlockType(DataSubBlock);
+    if (type == ShowerBoundary::BlockType::EVENT_HEADER) {
+        mShower = static_cast<std::uint64_t>(DataSubBlock[1]);
+    }
+
+    if (mCurrent.subBlocks > 0 &&
+        (mCurrent.shower != mShower || mCurrent.type != type ||
+         mCurrent.subBlocks >= mBlockSubBlocks)) {
+        submit();
+    }
+
+    if (mCurrent.subBlocks == 0) {
+        mCurrent.shower = mShower;
+        mCurrent.type = type;
+        mCurrent.first = mSubBlocks;
+    }
+
+    mCurrent.data.insert(mCurrent.data.end(), DataSubBlock,
+                         DataSubBlock + 39 * mEntries);
+    ++mCurrent.subBlocks;
+    ++mSubBlocks;
+
+    if (type == ShowerBoundary::BlockType::EVENT_END) {
+        mShower = 0;
+    }
+}
+
+
+void BlockWriter::close() {
+    if (mFile == NULL) {
+        return;
+    }
+
+    std::exception_ptr error;
+    try {
+        if (mCurrent.subBlocks > 0) {
+            submit();
+        }
+    }
+    catch (const std::exception &) {
+        error = std::current_exception();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mCondition.notify_all();
+    if (mCompressor.joinable()) {
+        mCompressor.join();
+    }
+
+    // the compression thread is done, the file belongs to this thread
+    if (!error) {
+        error = mError;
+    }
+    if (error) {
+        std::fclose(mFile);
+        mFile = NULL;
+        std::rethrow_exception(error);
+    }
+
+    const std::uint64_t footerOffset = mOffset;
+    writeValue<std::uint64_t>(mIndex.size());
+    for (const IndexEntry & entry : mIndex) {
+        writeValue<std::uint64_t>(entry.shower);
+        writeValue<std::uint32_t>(entry.type);
+        writeValue<std::uint32_t>(entry.subBlocks);
+        writeValue<std::uint64_t>(entry.first);
+        writeValue<std::uint64_t>(entry.offset);
+        writeValue<std::uint64_t>(entry.size);
+    }
+
+    writeValue<std::uint64_t>(footerOffset);
+    writeBytes(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+
+    const int status = std::fclose(mFile);
+    mFile = NULL;
+    if (status != 0) {
+        throw std::runtime_error("cannot close block file " + mPath);
+    }
+}
+
+
+void BlockWriter::submit() {
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCondition.wait(lock, [this] {
+        return mPending.size() < MAX_PENDING_BLOCKS || mError;
+    });
+    if (mError) {
+        std::rethrow_exception(mError);
+    }
+
+    mPending.push_back(std::move(mCurrent));
+    lock.unlock();
+    mCondition.notify_all();
+
+    mCurrent = Block();
+    mCurrent.data.reserve(mBlockSubBlocks * 39 * mEntries);
+}
+
+
+void BlockWriter::compress() {
+    for (;;) {
+        Block block;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCondition.wait(lock, [this] {
+                return !mPending.empty() || mStopping;
+            });
+            if (mPending.empty()) {
+                return;
+            }
+            block = std::move(mPending.front());
+            mPending.pop_front();
+        }
+        mCondition.notify_all();
+
+        try {
+            writeBlock(block);
+        }
+        catch (const std::exception &) {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mError = std::current_exception();
+            mPending.clear();
+            mCondition.notify_all();
+            return;
+        }
+    }
+}
+
+
+void BlockWriter::writeBlock(const Block & block) {
+    const uLong bytes = block.data.size() * sizeof(CREAL);
+    uLongf size = compressBound(bytes);
+    mCompressed.resize(size);
+    const int status = compress2(
+            mCompressed.data(), &size,
+            reinterpret_cast<const Bytef *>(block.data.data()), bytes,
+            mLevel);
+    if (status != Z_OK) {
+        throw std::runtime_error("cannot compress block of " + mPath + ": " +
+                                 zError(status));
+    }
+
+    mIndex.push_back({block.shower, static_cast<std::uint32_t>(block.type),
+                      block.subBlocks, block.first, mOffset, size});
+    writeBytes(mCompressed.data(), size);
+}
+
+
+void BlockWriter::writeBytes(const void * data, std::size_t size) {
+    if (std::fwrite(data, 1, size, mFile) != size) {
+        throw std::runtime_error("cannot write to block file " + mPath);
+    }
+
+    mOffset += size;
+}
+
+
+template <typename T>
+void BlockWriter::writeValue(T value) {
+    writeBytes(&value, sizeof(T));
+}
@@ -0,0 +1,164 @@
+/** \file
+ * Native sink that compresses the CORSIKA particle output into a block
+ * indexed file.
+ */
+#ifndef __BLOCKWRITER_H__
+#define __BLOCKWRITER_H__
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <crs/CorsikaTypes.h>
+
+#include "ShowerBoundary.h"
+
+
+/** Writes the subblocks of COAST wrida_(...) zlib compressed into a file
+ * with an index of blocks.
+ *
+ * Consecutive subblocks of the same shower and type (see
+ * ShowerBoundary::BlockType) are grouped into blocks of at most
+ * getBlockSubBlocks() subblocks. Every block is compressed and written by
+ * a background thread, such that CORSIKA only copies the subblocks. The
+ * shower of a subblock is the event number of the preceding event header
+ * up to the event end; run headers and ends have shower 0. close()
+ * appends an index of all blocks, which allows to decompress only the
+ * particles of a single shower.
+ *
+ * File layout (native byte order):
+ * - header: "COASTBLK", uint32 version, uint32 entries per particle line
+ * - blocks: zlib streams of subblocks * 39 * entries float32 values
+ * - footer: uint64 block count, per block: uint64 shower, uint32 type,
+ *   uint32 subblocks, uint64 first subblock (position in the output),
+ *   uint64 offset, uint64 compressed size
+ * - trailer: uint64 footer offset, "COASTIDX"
+ *
+ * The python reader is interface.BlockReader.
+ */
+class BlockWriter {
+
+    // interface types
+    public:
+        /** Default number of subblocks per block. */
+        static constexpr std::size_t DEFAULT_BLOCK_SUBBLOCKS = 1024;
+
+        /** Default zlib compression level. */
+        static constexpr int DEFAULT_LEVEL = 6;
+
+        /** Blocks that wait for compression before CORSIKA waits. */
+        static constexpr std::size_t MAX_PENDING_BLOCKS = 4;
+
+
+    // internal types
+    private:
+        struct Block {
+            std::uint64_t shower = 0;
+            ShowerBoundary::BlockType type =
+                ShowerBoundary::BlockType::PARTICLES;
+            std::uint32_t subBlocks = 0;
+            std::uint64_t first = 0;
+            std::vector<CREAL> data;
+        };
+
+        struct IndexEntry {
+            std::uint64_t shower;
+            std::uint32_t type;
+            std::uint32_t subBlocks;
+            std::uint64_t first;
+            std::uint64_t offset;
+            std::uint64_t size;
+        };
+
+
+    // members
+    private:
+        std::string mPath;
+        int mEntries;
+        std::size_t mBlockSubBlocks;
+        int mLevel;
+
+        // CORSIKA thread
+        std::uint64_t mShower = 0;
+        std::uint64_t mSubBlocks = 0;
+        Block mCurrent;
+
+        // shared with the compression thread
+        std::mutex mMutex;
+        std::condition_variable mCondition;
+        std::deque<Block> mPending;
+        bool mStopping = false;
+        std::exception_ptr mError;
+        std::thread mCompressor;
+
+        // compression thread
+        std::FILE * mFile = NULL;
+        std::uint64_t mOffset = 0;
+        std::vector<unsigned char> mCompressed;
+        std::vector<IndexEntry> mIndex;
+
+
+    // public functions
+    public:
+        /** Create the file, write its header and start the compression
+         * thread.
+         *
+         * Throws a std::runtime_error if the file cannot be created and a
+         * std::invalid_argument for entries other than 7 or 8, a level
+         * outside [0, 9] or 0 subblocks per block.
+         *
+         * @param path Path of the output file.
+         * @param entries Entries per particle line (8 thinned, 7 not
+         * thinned).
+         * @param level zlib compression level.
+         * @param blockSubBlocks Maximum number of subblocks per block.
+         */
+        BlockWriter(const std::string & path, int entries,
+                    int level = DEFAULT_LEVEL,
+                    std::size_t blockSubBlocks = DEFAULT_BLOCK_SUBBLOCKS);
+        BlockWriter(const BlockWriter &) = delete;
+        BlockWriter & operator=(const BlockWriter &) = delete;
+
+        /** Close the file if close() was not called; errors are ignored. */
+        ~BlockWriter();
+
+        /** Get the path of the output file. */
+        const std::string & getPath() const;
+
+        /** Get the maximum number of subblocks per block. */
+        std::size_t getBlockSubBlocks() const;
+
+        /** Append a subblock.
+         *
+         * Waits if MAX_PENDING_BLOCKS blocks wait for compression. Throws a
+         * std::runtime_error if the compression thread failed.
+         */
+        void write(const CREAL * DataSubBlock);
+
+        /** Compress and write all pending subblocks, the index and close the
+         * file.
+         *
+         * Throws a std::runtime_error on compression or write errors.
+         */
+        void close();
+
+
+    // private functions
+    private:
+        void submit();
+        void compress();
+        void writeBlock(const Block & block);
+        void writeBytes(const void * data, std::size_t size);
+        template <typename T> void writeValue(T value);
+
+};
+
+
+#endif
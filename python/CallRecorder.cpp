@@ -0,0 +1,134 @@
+#include "CallRecorder.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+
+CallRecorder::CallRecorder(const std::string & path)
+    : mPath(path)
+{
+    mFile = std::fopen(path.c_str(), "wb");
+    if (mFile == NULL) {
+        throw std::runtime_error("cannot create call log " + path);
+    }
+    std::setvbuf(mFile, NULL, _IOFBF, 1 << 20);
+
+    const FileHeader header = getFileHeader();
+    std::fwrite(&header, sizeof(header), 1, mFile);
+}
+
+
+CallRecorder::~CallRecorder() {
+    if (mFile != NULL) {
+        std::fclose(mFile);
+    }
+}
+
+
+const std::string & CallRecorder::getPath() const {
+    return mPath;
+}
+
+
+void CallRecorder::recordInit(const CorsikaConfig & config) {
+    mSubBlockSize = getSubBlockSize(config);
+    const std::string payload = getInitPayload(config);
+
+    mStart = std::chrono::steady_clock::now();
+    writeRecord(Call::INIT, payload.data(), payload.size());
+}
+
+
+void CallRecorder::recordWrite(const CREAL * DataSubBlock) {
+    writeRecord(Call::WRITE, DataSubBlock, mSubBlockSize);
+}
+
+
+void CallRecorder::recordInteraction(const crs::CInteraction & info) {
+    writeRecord(Call::INTERACTION, &info, sizeof(info));
+}
+
+
+void CallRecorder::recordTrack(const crs::CParticle & pre,
+                               const crs::CParticle & post) {
+    writeRecord(Call::TRACK, &pre, sizeof(pre), &post, sizeof(post));
+}
+
+
+std::string CallRecorder::getInitPayload(const CorsikaConfig & config) {
+    using CorsikaOption = CorsikaConfig::CorsikaOption;
+
+    auto flag = [](CorsikaOption option, Option bit) -> std::uint32_t {
+        return option == CorsikaOption::TRUE ? static_cast<std::uint32_t>(bit)
+                                             : 0;
+    };
+    const std::uint32_t options =
+        flag(config.getThinning(), THINNING) |
+        flag(config.getCurved(), CURVED) |
+        flag(config.getSlant(), SLANT) |
+        flag(config.getStackinput(), STACKINPUT) |
+        flag(config.getPreshower(), PRESHOWER);
+
+    const std::string filename = config.getFilename();
+    std::string payload(2 * sizeof(std::uint32_t), '\0');
+    const std::uint32_t length = filename.size();
+    std::memcpy(&payload[0], &options, sizeof(options));
+    std::memcpy(&payload[sizeof(options)], &length, sizeof(length));
+    payload += filename;
+    return payload;
+}
+
+
+std::uint32_t CallRecorder::getSubBlockSize(const CorsikaConfig & config) {
+    switch (config.getThinning()) {
+        case CorsikaConfig::CorsikaOption::TRUE:
+            return 39 * 8 * sizeof(CREAL);
+        case CorsikaConfig::CorsikaOption::FALSE:
+            return 39 * 7 * sizeof(CREAL);
+        default:
+            throw std::invalid_argument("corsika option thinning not set");
+    }
+}
+
+
+void CallRecorder::close() {
+    if (mFile == NULL) {
+        return;
+    }
+
+    writeRecord(Call::CLOSE, nullptr, 0);
+
+    const bool failed = std::ferror(mFile) != 0;
+    const bool closeFailed = std::fclose(mFile) != 0;
+    mFile = NULL;
+    if (failed || closeFailed) {
+        throw std::runtime_error("cannot write call log " + mPath);
+    }
+}
+
+
+void CallRecorder::writeRecord(Call call, const void * first,
+                               std::uint32_t firstSize, const void * second,
+                               std::uint32_t secondSize) {
+    static const char padding[8] = {};
+
+    const std::uint32_t size = firstSize + secondSize;
+    const CallHeader header = {
+        call, size, static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - mStart).count())
+    };
+
+    std::fwrite(&header, sizeof(header), 1, mFile);
+    if (firstSize > 0) {
+        std::fwrite(first, 1, firstSize, mFile);
+    }
+    if (secondSize > 0) {
+        std::fwrite(second, 1, secondSize, mFile);
+    }
+    std::fwrite(padding, 1, getPaddedSize(size) - size, mFile);
+}
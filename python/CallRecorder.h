@@ -0,0 +1,161 @@
+/** \file
+ * Binary log of the COAST calls that allows to replay a CORSIKA run without
+ * CORSIKA.
+ */
+#ifndef __CALLRECORDER_H__
+#define __CALLRECORDER_H__
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include <crs/CorsikaTypes.h>
+#include <crs/CInteraction.h>
+#include <crs/CParticle.h>
+
+#include "CorsikaConfig.h"
+
+
+/** Records every COAST call with its arguments into a file.
+ *
+ * File layout (native byte order, records 8 byte aligned):
+ * - header: "COASTREC", uint32 version, uint16 sizeof(crs::CParticle),
+ *   uint16 sizeof(crs::CInteraction)
+ * - records: CallHeader followed by the payload, padded to 8 bytes
+ *   - INIT: uint32 options (bit 0 thinning, 1 curved, 2 slant, 3 stackinput,
+ *     4 preshower), uint32 filename length, filename
+ *   - WRITE: 39 * entries CREAL (entries 8 if thinning else 7)
+ *   - INTERACTION: crs::CInteraction
+ *   - TRACK: crs::CParticle pre, crs::CParticle post
+ *   - CLOSE: no payload
+ *
+ * The log is replayed with the coast_replay driver (make replay).
+ */
+class CallRecorder {
+
+    // interface types
+    public:
+        /** Recorded COAST function. */
+        enum class Call : std::uint32_t {
+            INIT = 1,     /**< inida_(...) */
+            WRITE,        /**< wrida_(...) */
+            INTERACTION,  /**< interaction_(...) */
+            TRACK,        /**< track_(...) */
+            CLOSE         /**< cloda_() */
+        };
+
+        /** Bits of the INIT options. */
+        enum Option : std::uint32_t {
+            THINNING = 1u << 0,
+            CURVED = 1u << 1,
+            SLANT = 1u << 2,
+            STACKINPUT = 1u << 3,
+            PRESHOWER = 1u << 4
+        };
+
+        /** Header of every record. */
+        struct CallHeader {
+            Call call;
+            std::uint32_t size;  /**< Payload size without padding. */
+            std::uint64_t time;  /**< Nanoseconds since the INIT call. */
+        };
+
+        /** Header of the file. */
+        struct FileHeader {
+            char magic[8];
+            std::uint32_t version;
+            std::uint16_t particleSize;
+            std::uint16_t interactionSize;
+        };
+
+        /** Current file version. */
+        static constexpr std::uint32_t VERSION = 1;
+
+        /** Get the file header of this build; inline such that readers
+         * only need this header. */
+        static FileHeader getFileHeader() {
+            FileHeader header;
+            std::memcpy(header.magic, "COASTREC", sizeof(header.magic));
+            header.version = VERSION;
+            header.particleSize = sizeof(crs::CParticle);
+            header.interactionSize = sizeof(crs::CInteraction);
+            return header;
+        }
+
+        /** Get the payload size including padding. */
+        static constexpr std::uint64_t getPaddedSize(std::uint64_t size) {
+            return (size + 7) & ~std::uint64_t(7);
+        }
+
+        /** Get the INIT payload of a configuration.
+         *
+         * Throws a std::invalid_argument if thinning is unknown.
+         */
+        static std::string getInitPayload(const CorsikaConfig & config);
+
+        /** Get the WRITE payload size of a configuration.
+         *
+         * Throws a std::invalid_argument if thinning is unknown.
+         */
+        static std::uint32_t getSubBlockSize(const CorsikaConfig & config);
+
+
+    // members
+    private:
+        std::string mPath;
+        std::FILE * mFile = NULL;
+        std::chrono::steady_clock::time_point mStart;
+        std::uint32_t mSubBlockSize = 0;
+
+
+    // public functions
+    public:
+        /** Create the log file and write its header.
+         *
+         * Throws a std::runtime_error if the file cannot be created.
+         */
+        explicit CallRecorder(const std::string & path);
+        CallRecorder(const CallRecorder &) = delete;
+        CallRecorder & operator=(const CallRecorder &) = delete;
+
+        /** Close the file if close() was not called; errors are ignored. */
+        ~CallRecorder();
+
+        /** Get the path of the log file. */
+        const std::string & getPath() const;
+
+        /** Record inida_(...) and start the clock.
+         *
+         * Throws a std::invalid_argument if thinning is unknown.
+         */
+        void recordInit(const CorsikaConfig & config);
+
+        /** Record wrida_(...). */
+        void recordWrite(const CREAL * DataSubBlock);
+
+        /** Record interaction_(...). */
+        void recordInteraction(const crs::CInteraction & info);
+
+        /** Record track_(...). */
+        void recordTrack(const crs::CParticle & pre,
+                         const crs::CParticle & post);
+
+        /** Record cloda_() and close the file.
+         *
+         * Throws a std::runtime_error on write errors.
+         */
+        void close();
+
+
+    // private functions
+    private:
+        void writeRecord(Call call, const void * first, std::uint32_t firstSize,
+                         const void * second = nullptr,
+                         std::uint32_t secondSize = 0);
+
+};
+
+
+#endif
@@ -0,0 +1,98 @@
+/** \file
+ * C ABI of native plugins that receive the COAST calls next to python.
+ *
+ * A plugin is a shared library that exports
+ *
+ *     extern "C" const CoastPlugin * coast_plugin();
+ *
+ * and is listed in CORSIKA_PYTHON_PLUGINS or loaded with
+ * interface.loadPlugin(path) in override.py. Only this header is needed to
+ * build a plugin, e.g.
+ *
+ *     g++ -shared -fPIC -I$COAST_DIR/include -I$COAST_USER_LIB/python \
+ *         -o muons.so muons.cpp
+ */
+#ifndef __COASTPLUGIN_H__
+#define __COASTPLUGIN_H__
+
+#include <cstddef>
+#include <cstdint>
+
+#include <crs/CorsikaTypes.h>
+#include <crs/CInteraction.h>
+#include <crs/CParticle.h>
+
+
+/** ABI version of CoastPlugin; plugins of other versions are rejected. */
+#define COAST_PLUGIN_ABI_VERSION 1
+
+/** Name of the function that returns the plugin table. */
+#define COAST_PLUGIN_ENTRY "coast_plugin"
+
+
+extern "C" {
+
+/** CORSIKA options of inida_(...); 1 = set, 0 = not set, -1 = unknown. */
+struct CoastPluginConfig {
+    const char * filename;  /**< CORSIKA output file. */
+    int thinning;
+    int curved;
+    int slant;
+    int stackinput;
+    int preshower;
+};
+
+/** Callbacks of a plugin; mirrors interface.Override and
+ * interface.BatchOverride.
+ *
+ * Every callback returns 0 on success, any other value aborts the run.
+ * Callbacks that are NULL are not called and COAST calls that no plugin or
+ * python override needs are not requested from CORSIKA. All callbacks are
+ * called on the CORSIKA thread with the records of all COAST calls, i.e.
+ * before the capture flags, sampling and filters of python apply, and the
+ * pointers are only valid during the call.
+ */
+struct CoastPlugin {
+    /** Has to be COAST_PLUGIN_ABI_VERSION. */
+    std::uint32_t abiVersion;
+
+    /** Name in error messages. */
+    const char * name;
+
+    /** Called once after loading; state is passed to all other callbacks. */
+    int (*init)(const CoastPluginConfig * config, void ** state);
+
+    /** Called after the last call, pending batches are delivered before. */
+    int (*close)(void * state);
+
+    /** Raw CORSIKA subblock of 39 lines with entries (8 thinned, 7 not
+     * thinned, 0 unknown) values. */
+    int (*write)(void * state, const CREAL * DataSubBlock, int entries);
+
+    /** Single interaction; unused if interactionBatch is set. */
+    int (*interaction)(void * state, const crs::CInteraction * info);
+
+    /** Single track; unused if trackBatch is set. */
+    int (*track)(void * state, const crs::CParticle * pre,
+                 const crs::CParticle * post);
+
+    /** Up to batchSize interactions in order. */
+    int (*interactionBatch)(void * state, const crs::CInteraction * infos,
+                            std::size_t count);
+
+    /** Up to batchSize tracks in order; pre[i] and post[i] form a track. */
+    int (*trackBatch)(void * state, const crs::CParticle * pre,
+                      const crs::CParticle * post, std::size_t count);
+
+    /** Records per batch call; 0 = 4096. Batches are delivered when full,
+     * before the event end subblock is written and before close. */
+    std::size_t batchSize;
+};
+
+/** Type of the exported coast_plugin() function. */
+typedef const CoastPlugin * (*CoastPluginEntry)();
+
+}
+
+
+#endif
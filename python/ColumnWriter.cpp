@@ -0,0 +1,282 @@
+#include "ColumnWriter.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace {
+
+const char FILE_MAGIC[8] = {'C', 'O', 'A', 'S', 'T', 'C', 'O', 'L'};
+const char INDEX_MAGIC[8] = {'C', 'O', 'A', 'S', 'T', 'I', 'D', 'X'};
+constexpr std::uint32_t FILE_VERSION = 1;
+
+// "EVTH" interpreted as CORSIKA single precision float
+constexpr float EVENT_HEADER = 217433.078125f;
+
+// column types and names in the order they are written
+using ColumnList = std::vector<std::pair<char, std::string>>;
+
+ColumnList createTrackColumns() {
+    const ColumnList particle = {
+        {'d', "time"}, {'d', "x"}, {'d', "y"}, {'d', "z"}, {'d', "depth"},
+        {'d', "energy"}, {'d', "weight"}, {'i', "particleID"},
+        {'i', "hadronicGeneration"}
+    };
+
+    ColumnList columns;
+    for (const std::string prefix : {"pre.", "post."}) {
+        for (const auto & [type, name] : particle) {
+            columns.emplace_back(type, prefix + name);
+        }
+    }
+
+    return columns;
+}
+
+const ColumnList trackColumns = createTrackColumns();
+
+const ColumnList interactionColumns = {
+    {'d', "x"}, {'d', "y"}, {'d', "z"}, {'d', "labEnergy"},
+    {'d', "crossSection"}, {'d', "elasticity"}, {'i', "projectileID"},
+    {'i', "targetID"}
+};
+
+}
+
+
+ColumnWriter::ColumnWriter(const std::string & path, std::size_t chunkRows)
+    : mPath(path), mChunkRows(chunkRows)
+{
+    if (chunkRows == 0) {
+        throw std::invalid_argument("number of rows per chunk has to be > 0");
+    }
+
+    mFile = std::fopen(path.c_str(), "wb");
+    if (mFile == NULL) {
+        throw std::runtime_error("cannot create column file " + path);
+    }
+    std::setvbuf(mFile, NULL, _IOFBF, 1 << 20);
+
+    writeBytes(FILE_MAGIC, sizeof(FILE_MAGIC));
+    writeValue<std::uint32_t>(FILE_VERSION);
+    writeValue<std::uint32_t>(0);
+}
+
+
+ColumnWriter::~ColumnWriter() {
+    if (mFile == NULL) {
+        return;
+    }
+
+    try {
+        close();
+    }
+    catch (const std::exception &) {
+        if (mFile != NULL) {
+            std::fclose(mFile);
+            mFile = NULL;
+        }
+    }
+}
+
+
+const std::string & ColumnWriter::getPath() const {
+    return mPath;
+}
+
+std::size_t ColumnWriter::getChunkRows() const {
+    return mChunkRows;
+}
+
+
+void ColumnWriter::beginShower(std::uint64_t shower) {
+    flushAll();
+    mShower = shower;
+}
+
+
+void ColumnWriter::write(const CREAL * DataSubBlock) {
+    if (static_cast<float>(DataSubBlock[0]) == EVENT_HEADER) {
+        beginShower(static_cast<std::uint64_t>(DataSubBlock[1]));
+    }
+}
+
+
+void ColumnWriter::addTrack(const crs::CParticle & pre,
+                            const crs::CParticle & post) {
+    // consecutive tracks mostly belong to the same species
+    if (mLastTracks == NULL || mLastTrackSpecies != pre.particleId) {
+        auto it = mTracks.find(pre.particleId);
+        if (it == mTracks.end()) {
+            it = mTracks.emplace(pre.particleId, TrackBatch()).first;
+            it->second.setCapacity(mChunkRows);
+        }
+        mLastTrackSpecies = pre.particleId;
+        mLastTracks = &it->second;
+    }
+
+    mLastTracks->push(pre, post);
+    if (mLastTracks->isFull()) {
+        flushTracks(mLastTrackSpecies, *mLastTracks);
+    }
+}
+
+
+void ColumnWriter::addInteraction(const crs::CInteraction & info) {
+    auto it = mInteractions.find(info.projId);
+    if (it == mInteractions.end()) {
+        it = mInteractions.emplace(info.projId, InteractionBatch()).first;
+        it->second.setCapacity(mChunkRows);
+    }
+
+    it->second.push(info);
+    if (it->second.isFull()) {
+        flushInteractions(it->first, it->second);
+    }
+}
+
+
+void ColumnWriter::close() {
+    if (mFile == NULL) {
+        return;
+    }
+
+    flushAll();
+
+    const std::uint64_t footerOffset = mOffset;
+    const std::pair<std::string, const ColumnList &> streams[] = {
+        {"track", trackColumns},
+        {"interaction", interactionColumns}
+    };
+
+    writeValue<std::uint32_t>(2);
+    for (const auto & [name, columns] : streams) {
+        writeString(name);
+        writeValue<std::uint32_t>(columns.size());
+        for (const auto & [type, column] : columns) {
+            writeValue<char>(type);
+            writeString(column);
+        }
+    }
+
+    writeValue<std::uint64_t>(mChunks.size());
+    for (const auto & chunk : mChunks) {
+        writeValue<std::uint32_t>(static_cast<std::uint32_t>(chunk.stream));
+        writeValue<std::int32_t>(chunk.species);
+        writeValue<std::uint64_t>(chunk.shower);
+        writeValue<std::uint64_t>(chunk.offset);
+        writeValue<std::uint64_t>(chunk.rows);
+    }
+
+    writeValue<std::uint64_t>(footerOffset);
+    writeBytes(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+
+    const int status = std::fclose(mFile);
+    mFile = NULL;
+    if (status != 0) {
+        throw std::runtime_error("cannot close column file " + mPath);
+    }
+}
+
+
+void ColumnWriter::flushTracks(int species, TrackBatch & batch) {
+    const std::size_t rows = batch.getSize();
+    if (rows == 0) {
+        return;
+    }
+
+    mChunks.push_back({Stream::TRACK, species, mShower, mOffset, rows});
+    for (const auto * columns : {&batch.getPre(), &batch.getPost()}) {
+        writeColumn(columns->time, rows);
+        writeColumn(columns->x, rows);
+        writeColumn(columns->y, rows);
+        writeColumn(columns->z, rows);
+        writeColumn(columns->depth, rows);
+        writeColumn(columns->energy, rows);
+        writeColumn(columns->weight, rows);
+        writeColumn(columns->particleId, rows);
+        writeColumn(columns->hadronicGeneration, rows);
+    }
+
+    batch.clear();
+}
+
+
+void ColumnWriter::flushInteractions(int species, InteractionBatch & batch) {
+    const std::size_t rows = batch.getSize();
+    if (rows == 0) {
+        return;
+    }
+
+    mChunks.push_back({Stream::INTERACTION, species, mShower, mOffset, rows});
+    const auto & columns = batch.getColumns();
+    writeColumn(columns.x, rows);
+    writeColumn(columns.y, rows);
+    writeColumn(columns.z, rows);
+    writeColumn(columns.etot, rows);
+    writeColumn(columns.sigma, rows);
+    writeColumn(columns.kela, rows);
+    writeColumn(columns.projId, rows);
+    writeColumn(columns.targetId, rows);
+
+    batch.clear();
+}
+
+
+void ColumnWriter::flushAll() {
+    for (auto & [species, batch] : mTracks) {
+        flushTracks(species, batch);
+    }
+
+    for (auto & [species, batch] : mInteractions) {
+        flushInteractions(species, batch);
+    }
+}
+
+
+template <typename T>
+void ColumnWriter::writeColumn(const std::vector<T> & column,
+                               std::size_t rows) {
+    static_assert(sizeof(T) == 8 || sizeof(T) == 4,
+                  "columns are float64 or int32");
+
+    writeBytes(column.data(), rows * sizeof(T));
+
+    // keep every column 8 byte aligned
+    const std::size_t padding = (8 - (rows * sizeof(T)) % 8) % 8;
+    if (padding > 0) {
+        const char zeros[8] = {};
+        writeBytes(zeros, padding);
+    }
+}
+
+
+void ColumnWriter::writeBytes(const void * data, std::size_t size) {
+    if (mFile == NULL) {
+        throw std::logic_error("column file " + mPath + " is closed");
+    }
+
+    if (std::fwrite(data, 1, size, mFile) != size) {
+        throw std::runtime_error("cannot write to column file " + mPath);
+    }
+
+    mOffset += size;
+}
+
+
+void ColumnWriter::writeString(const std::string & value) {
+    writeValue<std::uint32_t>(value.size());
+    writeBytes(value.data(), value.size());
+}
+
+
+template <typename T>
+void ColumnWriter::writeValue(T value) {
+    writeBytes(&value, sizeof(T));
+}
@@ -0,0 +1,139 @@
+/** \file
+ * Native sink that streams COAST track and interaction records into a
+ * chunked columnar file.
+ */
+#ifndef __COLUMNWRITER_H__
+#define __COLUMNWRITER_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <crs/CorsikaTypes.h>
+#include <crs/CInteraction.h>
+#include <crs/CParticle.h>
+
+#include "TrackBatch.h"
+#include "InteractionBatch.h"
+
+
+/** Writes track and interaction records into a columnar file.
+ *
+ * Records are collected per stream (tracks or interactions), shower and
+ * particle species (pre particle ID or projectile ID) and written as chunks
+ * of at most getChunkRows() rows, in which every column is stored
+ * contiguously. close() appends an index of all chunks.
+ *
+ * File layout (native byte order, columns 8 byte aligned):
+ * - header: "COASTCOL", uint32 version, uint32 reserved
+ * - chunks: per column rows * (float64 | int32) values, padded to 8 bytes
+ * - footer: per stream: uint32 name length, name, uint32 column count, per
+ *   column: char type ('d' or 'i'), uint32 name length, name;
+ *   uint64 chunk count, per chunk: uint32 stream, int32 species,
+ *   uint64 shower, uint64 offset, uint64 rows
+ * - trailer: uint64 footer offset, "COASTIDX"
+ *
+ * The python reader is interface.ColumnReader.
+ */
+class ColumnWriter {
+
+    // interface types
+    public:
+        /** Stream of a chunk. */
+        enum class Stream : std::uint32_t {
+            TRACK,       /**< Pairs of crs::CParticle. */
+            INTERACTION  /**< crs::CInteraction. */
+        };
+
+        /** Default number of rows per chunk. */
+        static constexpr std::size_t DEFAULT_CHUNK_ROWS = 4096;
+
+
+    // internal types
+    private:
+        struct Chunk {
+            Stream stream;
+            std::int32_t species;
+            std::uint64_t shower;
+            std::uint64_t offset;
+            std::uint64_t rows;
+        };
+
+
+    // members
+    private:
+        std::string mPath;
+        std::FILE * mFile = NULL;
+        std::uint64_t mOffset = 0;
+        std::size_t mChunkRows;
+        std::uint64_t mShower = 0;
+        std::map<int, TrackBatch> mTracks;
+        int mLastTrackSpecies = 0;
+        TrackBatch * mLastTracks = NULL;
+        std::map<int, InteractionBatch> mInteractions;
+        std::vector<Chunk> mChunks;
+
+
+    // public functions
+    public:
+        /** Create the file and write its header.
+         *
+         * Throws a std::runtime_error if the file cannot be created and a
+         * std::invalid_argument if chunkRows is 0.
+         *
+         * @param path Path of the output file.
+         * @param chunkRows Maximum number of rows per chunk.
+         */
+        ColumnWriter(const std::string & path,
+                     std::size_t chunkRows = DEFAULT_CHUNK_ROWS);
+        ColumnWriter(const ColumnWriter &) = delete;
+        ColumnWriter & operator=(const ColumnWriter &) = delete;
+
+        /** Close the file if close() was not called; errors are ignored. */
+        ~ColumnWriter();
+
+        /** Get the path of the output file. */
+        const std::string & getPath() const;
+
+        /** Get the maximum number of rows per chunk. */
+        std::size_t getChunkRows() const;
+
+        /** Start a new shower; pending records of the previous shower are
+         * written. */
+        void beginShower(std::uint64_t shower);
+
+        /** Start a new shower if the subblock is an event header (EVTH),
+         * using the event number of the header. */
+        void write(const CREAL * DataSubBlock);
+
+        /** Append a track. */
+        void addTrack(const crs::CParticle & pre, const crs::CParticle & post);
+
+        /** Append an interaction. */
+        void addInteraction(const crs::CInteraction & info);
+
+        /** Write all pending records, the index and close the file.
+         *
+         * Throws a std::runtime_error on write errors.
+         */
+        void close();
+
+
+    // private functions
+    private:
+        void flushTracks(int species, TrackBatch & batch);
+        void flushInteractions(int species, InteractionBatch & batch);
+        void flushAll();
+        template <typename T>
+        void writeColumn(const std::vector<T> & column, std::size_t rows);
+        void writeBytes(const void * data, std::size_t size);
+        void writeString(const std::string & value);
+        template <typename T> void writeValue(T value);
+
+};
+
+
+#endif
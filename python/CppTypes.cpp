@@ -0,0 +1,373 @@
+#include "CppTypes.h"
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <structmember.h>
+
+#include <cstddef>
+
+
+// object layouts
+
+struct ParticleObject {
+    PyObject_HEAD
+    double time;
+    double x;
+    double y;
+    double z;
+    double depth;
+    double energy;
+    double weight;
+    int particleId;
+    int hadronicGeneration;
+    PyObject * position;
+};
+
+struct InteractionObject {
+    PyObject_HEAD
+    double x;
+    double y;
+    double z;
+    double etot;
+    double sigma;
+    double kela;
+    int projId;
+    int targetId;
+    PyObject * position;
+};
+
+
+static PyTypeObject * ParticleType = NULL;
+static PyTypeObject * InteractionType = NULL;
+
+
+// position handling shared by both types
+
+static PyObject * getPosition(PyObject ** position,
+                              double x, double y, double z) {
+    if (*position == NULL) {
+        *position = Py_BuildValue("[ddd]", x, y, z);
+        if (*position == NULL) {
+            return NULL;
+        }
+    }
+
+    Py_INCREF(*position);
+    return *position;
+}
+
+static int setPosition(PyObject ** position, double * x, double * y,
+                       double * z, PyObject * value) {
+    if (value == NULL) {
+        PyErr_SetString(PyExc_AttributeError, "cannot delete position");
+        return -1;
+    }
+
+    // store numbers only such that no reference cycles can be created
+    PyObject * list = PySequence_List(value);
+    if (list == NULL) {
+        return -1;
+    }
+
+    if (PyList_GET_SIZE(list) != 3) {
+        Py_DECREF(list);
+        PyErr_SetString(PyExc_ValueError, "position needs x, y, z values");
+        return -1;
+    }
+
+    double values[3];
+    for (Py_ssize_t i = 0; i < 3; ++i) {
+        values[i] = PyFloat_AsDouble(PyList_GET_ITEM(list, i));
+        if (values[i] == -1.0 && PyErr_Occurred() != NULL) {
+            Py_DECREF(list);
+            return -1;
+        }
+    }
+    Py_DECREF(list);
+
+    *x = values[0];
+    *y = values[1];
+    *z = values[2];
+    Py_CLEAR(*position);
+    return 0;
+}
+
+
+// Particle
+
+static void Particle_dealloc(ParticleObject * self) {
+    // instances of heap types own a reference to their type
+    PyTypeObject * type = Py_TYPE(self);
+    Py_XDECREF(self->position);
+    type->tp_free((PyObject *) self);
+    Py_DECREF(type);
+}
+
+static int Particle_init(ParticleObject * self, PyObject * args,
+                         PyObject * kwds) {
+    static const char * kwlist[] = {
+        "t", "x", "y", "z", "depth", "energy", "weight", "ID", "hadgen",
+        NULL
+    };
+
+    if (!PyArg_ParseTupleAndKeywords(
+                args, kwds, "dddddddii", const_cast<char **>(kwlist),
+                &self->time, &self->x, &self->y, &self->z, &self->depth,
+                &self->energy, &self->weight, &self->particleId,
+                &self->hadronicGeneration)) {
+        return -1;
+    }
+
+    Py_CLEAR(self->position);
+    return 0;
+}
+
+static PyObject * Particle_getPosition(ParticleObject * self,
+                                       [[maybe_unused]] void * closure) {
+    return getPosition(&self->position, self->x, self->y, self->z);
+}
+
+static int Particle_setPosition(ParticleObject * self, PyObject * value,
+                                [[maybe_unused]] void * closure) {
+    return setPosition(&self->position, &self->x, &self->y, &self->z,
+                       value);
+}
+
+static PyMemberDef Particle_members[] = {
+    {
+        "time", T_DOUBLE, offsetof(ParticleObject, time), 0,
+        "Time of the CORSIKA particle event in seconds."
+    },
+    {
+        "atmosphericDepth", T_DOUBLE, offsetof(ParticleObject, depth), 0,
+        "Travel depth in g/cm^2 for the particle."
+    },
+    {
+        "energy", T_DOUBLE, offsetof(ParticleObject, energy), 0,
+        "Current total energy of the particle."
+    },
+    {
+        "weight", T_DOUBLE, offsetof(ParticleObject, weight), 0,
+        "Thinning weight of the particle."
+    },
+    {
+        "particleID", T_INT, offsetof(ParticleObject, particleId), 0,
+        "Particle type as integer ID in CORSIKA convention."
+    },
+    {
+        "hadronicGeneration", T_INT,
+        offsetof(ParticleObject, hadronicGeneration), 0,
+        "Hadronic generation counter of the particle."
+    },
+
+    {NULL, 0, 0, 0, NULL}
+};
+
+static PyGetSetDef Particle_getset[] = {
+    {
+        "position",
+        (getter) Particle_getPosition,
+        (setter) Particle_setPosition,
+        "x, y, z values of the particle position in meters.",
+        NULL
+    },
+
+    {NULL, NULL, NULL, NULL, NULL}
+};
+
+
+PyObject * createParticle(const crs::CParticle & particle) {
+    ParticleObject * self = PyObject_New(ParticleObject, ParticleType);
+    if (self == NULL) {
+        return NULL;
+    }
+
+    self->time = particle.time;
+    self->x = particle.x;
+    self->y = particle.y;
+    self->z = particle.z;
+    self->depth = particle.depth;
+    self->energy = particle.energy;
+    self->weight = particle.weight;
+    self->particleId = particle.particleId;
+    self->hadronicGeneration = particle.hadronicGeneration;
+    self->position = NULL;
+
+    return (PyObject *) self;
+}
+
+
+// Interaction
+
+static void Interaction_dealloc(InteractionObject * self) {
+    // instances of heap types own a reference to their type
+    PyTypeObject * type = Py_TYPE(self);
+    Py_XDECREF(self->position);
+    type->tp_free((PyObject *) self);
+    Py_DECREF(type);
+}
+
+static int Interaction_init(InteractionObject * self, PyObject * args,
+                            PyObject * kwds) {
+    static const char * kwlist[] = {
+        "x", "y", "z", "etot", "sigma", "kela", "pID", "tID", NULL
+    };
+
+    if (!PyArg_ParseTupleAndKeywords(
+                args, kwds, "ddddddii", const_cast<char **>(kwlist),
+                &self->x, &self->y, &self->z, &self->etot, &self->sigma,
+                &self->kela, &self->projId, &self->targetId)) {
+        return -1;
+    }
+
+    Py_CLEAR(self->position);
+    return 0;
+}
+
+static PyObject * Interaction_getPosition(InteractionObject * self,
+                                          [[maybe_unused]] void * closure) {
+    return getPosition(&self->position, self->x, self->y, self->z);
+}
+
+static int Interaction_setPosition(InteractionObject * self, PyObject * value,
+                                   [[maybe_unused]] void * closure) {
+    return setPosition(&self->position, &self->x, &self->y, &self->z,
+                       value);
+}
+
+static PyMemberDef Interaction_members[] = {
+    {
+        "labEnergy", T_DOUBLE, offsetof(InteractionObject, etot), 0,
+        "Total energy in the laboritory frame."
+    },
+    {
+        "crossSection", T_DOUBLE, offsetof(InteractionObject, sigma), 0,
+        "Cross section of the particle interaction."
+    },
+    {
+        "elasticity", T_DOUBLE, offsetof(InteractionObject, kela), 0,
+        "Elasticity of the interaction."
+    },
+    {
+        "projectileID", T_INT, offsetof(InteractionObject, projId), 0,
+        "Numeric CORSIKA ID of the incident particle."
+    },
+    {
+        "targetID", T_INT, offsetof(InteractionObject, targetId), 0,
+        "Numeric CORSIKA ID of the target particle."
+    },
+
+    {NULL, 0, 0, 0, NULL}
+};
+
+static PyGetSetDef Interaction_getset[] = {
+    {
+        "position",
+        (getter) Interaction_getPosition,
+        (setter) Interaction_setPosition,
+        "x, y, z values of the interaction position in meters.",
+        NULL
+    },
+
+    {NULL, NULL, NULL, NULL, NULL}
+};
+
+
+PyObject * createInteraction(const crs::CInteraction & info) {
+    InteractionObject * self = PyObject_New(InteractionObject,
+                                            InteractionType);
+    if (self == NULL) {
+        return NULL;
+    }
+
+    self->x = info.x;
+    self->y = info.y;
+    self->z = info.z;
+    self->etot = info.etot;
+    self->sigma = info.sigma;
+    self->kela = info.kela;
+    self->projId = info.projId;
+    self->targetId = info.targetId;
+    self->position = NULL;
+
+    return (PyObject *) self;
+}
+
+
+// type registration
+
+static PyType_Slot Particle_slots[] = {
+    {Py_tp_doc, (void *) "Python wrapper for the CParticle class in COAST."},
+    {Py_tp_new, (void *) PyType_GenericNew},
+    {Py_tp_init, (void *) Particle_init},
+    {Py_tp_dealloc, (void *) Particle_dealloc},
+    {Py_tp_members, (void *) Particle_members},
+    {Py_tp_getset, (void *) Particle_getset},
+
+    {0, NULL}
+};
+
+static PyType_Spec Particle_spec = {
+    "cppwrapper_emb.Particle",
+    sizeof(ParticleObject),
+    0,
+    Py_TPFLAGS_DEFAULT,
+    Particle_slots
+};
+
+static PyType_Slot Interaction_slots[] = {
+    {Py_tp_doc,
+     (void *) "Python wrapper for the CInteraction class in COAST."},
+    {Py_tp_new, (void *) PyType_GenericNew},
+    {Py_tp_init, (void *) Interaction_init},
+    {Py_tp_dealloc, (void *) Interaction_dealloc},
+    {Py_tp_members, (void *) Interaction_members},
+    {Py_tp_getset, (void *) Interaction_getset},
+
+    {0, NULL}
+};
+
+static PyType_Spec Interaction_spec = {
+    "cppwrapper_emb.Interaction",
+    sizeof(InteractionObject),
+    0,
+    Py_TPFLAGS_DEFAULT,
+    Interaction_slots
+};
+
+
+static int addCppType(PyObject * module, const char * name,
+                      PyType_Spec * spec, PyTypeObject ** type) {
+    Py_CLEAR(*type);
+    *type = (PyTypeObject *) PyType_FromSpec(spec);
+    if (*type == NULL) {
+        return -1;
+    }
+
+    // the module gets its own reference, the static pointer keeps ours
+    Py_INCREF(*type);
+    if (PyModule_AddObject(module, name, (PyObject *) *type) < 0) {
+        Py_DECREF(*type);
+        return -1;
+    }
+
+    return 0;
+}
+
+int addCppTypes(PyObject * module) {
+    if (addCppType(module, "Particle", &Particle_spec, &ParticleType) < 0) {
+        return -1;
+    }
+
+    if (addCppType(module, "Interaction", &Interaction_spec,
+                   &InteractionType) < 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
+void releaseCppTypes() {
+    Py_CLEAR(ParticleType);
+    Py_CLEAR(InteractionType);
+}
@@ -0,0 +1,52 @@
+/** \file
+ * Python types implemented in C++ that are exported by the cppwrapper_emb
+ * module.
+ *
+ * The types Particle and Interaction mirror the python classes in
+ * particle.py and interaction.py with the same attribute names, but store
+ * their values in fixed slots and create the position list only on first
+ * access.
+ */
+#ifndef __CPPTYPES_H__
+#define __CPPTYPES_H__
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <crs/CInteraction.h>
+#include <crs/CParticle.h>
+
+
+/** Prepare the Particle and Interaction types and add them to a module.
+ *
+ * @param module Python module that exports the types.
+ *
+ * @return 0 on success, -1 with a python exception set on failure.
+ */
+int addCppTypes(PyObject * module);
+
+/** Release the Particle and Interaction types.
+ *
+ * Has to be called before Py_Finalize(), such that a later interpreter of
+ * the same process prepares new types in addCppTypes(...).
+ */
+void releaseCppTypes();
+
+/** Create a python Particle from COAST particle information.
+ *
+ * Requires a previous call to addCppTypes(...).
+ *
+ * @return New reference or NULL with a python exception set.
+ */
+PyObject * createParticle(const crs::CParticle & particle);
+
+/** Create a python Interaction from COAST interaction information.
+ *
+ * Requires a previous call to addCppTypes(...).
+ *
+ * @return New reference or NULL with a python exception set.
+ */
+PyObject * createInteraction(const crs::CInteraction & info);
+
+
+#endif
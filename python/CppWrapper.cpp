@@ -3,6 +3,16 @@
 #define PY_SSIZE_T_CLEAN
 #include <Python.h>
 
+#include <array>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "CppTypes.h"
+
 
 static PyObject * disableWrite(PyObject * self, PyObject * args);
 static PyObject * enableWrite(PyObject * self, PyObject * args);
@@ -10,6 +20,50 @@ static PyObject * disableInteraction(PyObject * self, PyObject * args);
 static PyObject * enableInteraction(PyObject * self, PyObject * args);
 static PyObject * disableTrack(PyObject * self, PyObject * args);
 static PyObject * enableTrack(PyObject * self, PyObject * args);
+static PyObject * setTrackFilter(PyObject * self, PyObject * args);
+static PyObject * addTrackColumn(PyObject * self, PyObject * args);
+static PyObject * clearTrackFilter(PyObject * self, PyObject * args);
+static PyObject * setInteractionFilter(PyObject * self, PyObject * args);
+static PyObject * addInteractionColumn(PyObject * self, PyObject * args);
+static PyObject * clearInteractionFilter(PyObject * self, PyObject * args);
+static PyObject * setTrackSampling(PyObject * self, PyObject * args);
+static PyObject * clearTrackSampling(PyObject * self, PyObject * args);
+static PyObject * setInteractionSampling(PyObject * self, PyObject * args);
+static PyObject * clearInteractionSampling(PyObject * self, PyObject * args);
+static PyObject * setSamplingSeed(PyObject * self, PyObject * args);
+static PyObject * setAsyncMode(PyObject * self, PyObject * args);
+static PyObject * getAsyncDropped(PyObject * self, PyObject * args);
+static PyObject * setColumnWriter(PyObject * self, PyObject * args);
+static PyObject * getColumnWriterPath(PyObject * self, PyObject * args);
+static PyObject * setBlockWriter(PyObject * self, PyObject * args);
+static PyObject * getBlockWriterPath(PyObject * self, PyObject * args);
+static PyObject * addHistogram(PyObject * self, PyObject * args);
+static PyObject * getHistogram(PyObject * self, PyObject * args);
+static PyObject * resetHistogram(PyObject * self, PyObject * args);
+static PyObject * stats(PyObject * self, PyObject * args);
+static PyObject * setStatsFile(PyObject * self, PyObject * args);
+static PyObject * setTrace(PyObject * self, PyObject * args);
+static PyObject * traceBegin(PyObject * self, PyObject * args);
+static PyObject * traceEnd(PyObject * self, PyObject * args);
+static PyObject * setBatchSize(PyObject * self, PyObject * args);
+static PyObject * getBatchSize(PyObject * self, PyObject * args);
+static PyObject * updateCallbacks(PyObject * self, PyObject * args);
+static PyObject * setWriteBlockCount(PyObject * self, PyObject * args);
+static PyObject * getWriteBlockCount(PyObject * self, PyObject * args);
+static PyObject * setParticleFilter(PyObject * self, PyObject * args);
+static PyObject * addVoxelGrid(PyObject * self, PyObject * args);
+static PyObject * getVoxelGrid(PyObject * self, PyObject * args);
+static PyObject * resetVoxelGrid(PyObject * self, PyObject * args);
+static PyObject * addPlane(PyObject * self, PyObject * args);
+static PyObject * addSphere(PyObject * self, PyObject * args);
+static PyObject * clearSurfaces(PyObject * self, PyObject * args);
+static PyObject * addObserverArray(PyObject * self, PyObject * args);
+static PyObject * getObserverTraces(PyObject * self, PyObject * args);
+static PyObject * resetObserverArray(PyObject * self, PyObject * args);
+static PyObject * addArrowCollector(PyObject * self, PyObject * args);
+static PyObject * takeArrowRecords(PyObject * self, PyObject * args);
+static PyObject * exportArrowRecords(PyObject * self, PyObject * args);
+static PyObject * loadPlugin(PyObject * self, PyObject * args);
 
 
 static PyMethodDef cppwrapper_emb_methods[] = {
@@ -49,6 +103,273 @@ static PyMethodDef cppwrapper_emb_methods[] = {
         METH_VARARGS,
         "Enable COAST calls to python track()."
     },
+    {
+        "setTrackFilter",
+        setTrackFilter,
+        METH_VARARGS,
+        "Only deliver tracks that pass the given expression."
+    },
+    {
+        "addTrackColumn",
+        addTrackColumn,
+        METH_VARARGS,
+        "Deliver tracks with an additional natively computed column."
+    },
+    {
+        "clearTrackFilter",
+        clearTrackFilter,
+        METH_VARARGS,
+        "Remove the track filter and all derived track columns."
+    },
+    {
+        "setInteractionFilter",
+        setInteractionFilter,
+        METH_VARARGS,
+        "Only deliver interactions that pass the given expression."
+    },
+    {
+        "addInteractionColumn",
+        addInteractionColumn,
+        METH_VARARGS,
+        "Deliver interactions with an additional natively computed column."
+    },
+    {
+        "clearInteractionFilter",
+        clearInteractionFilter,
+        METH_VARARGS,
+        "Remove the interaction filter and all derived interaction columns."
+    },
+    {
+        "setTrackSampling",
+        setTrackSampling,
+        METH_VARARGS,
+        "Deliver only a weighted sample of tracks."
+    },
+    {
+        "clearTrackSampling",
+        clearTrackSampling,
+        METH_VARARGS,
+        "Remove all track sampling rules."
+    },
+    {
+        "setInteractionSampling",
+        setInteractionSampling,
+        METH_VARARGS,
+        "Deliver only a sample of interactions."
+    },
+    {
+        "clearInteractionSampling",
+        clearInteractionSampling,
+        METH_VARARGS,
+        "Remove all interaction sampling rules."
+    },
+    {
+        "setSamplingSeed",
+        setSamplingSeed,
+        METH_VARARGS,
+        "Set the seed of track and interaction sampling."
+    },
+    {
+        "setAsyncMode",
+        setAsyncMode,
+        METH_VARARGS,
+        "Deliver COAST calls to python in a separate thread."
+    },
+    {
+        "getAsyncDropped",
+        getAsyncDropped,
+        METH_VARARGS,
+        "Get the number of records dropped in asynchronous mode per type."
+    },
+    {
+        "setColumnWriter",
+        setColumnWriter,
+        METH_VARARGS,
+        "Stream all tracks and interactions into a columnar file."
+    },
+    {
+        "getColumnWriterPath",
+        getColumnWriterPath,
+        METH_VARARGS,
+        "Get the path of the columnar file (empty = not writing)."
+    },
+    {
+        "setBlockWriter",
+        setBlockWriter,
+        METH_VARARGS,
+        "Compress all subblocks of write() into a block indexed file."
+    },
+    {
+        "getBlockWriterPath",
+        getBlockWriterPath,
+        METH_VARARGS,
+        "Get the path of the block file (empty = not writing)."
+    },
+    {
+        "addHistogram",
+        addHistogram,
+        METH_VARARGS,
+        "Add a natively filled histogram of tracks, interactions or "
+        "particles."
+    },
+    {
+        "getHistogram",
+        getHistogram,
+        METH_VARARGS,
+        "Get memoryviews on the contents and bin edges of a histogram."
+    },
+    {
+        "resetHistogram",
+        resetHistogram,
+        METH_VARARGS,
+        "Set the contents of a histogram to zero."
+    },
+    {
+        "stats",
+        stats,
+        METH_VARARGS,
+        "Get call counters and python latency histograms per callback."
+    },
+    {
+        "setStatsFile",
+        setStatsFile,
+        METH_VARARGS,
+        "Write the call counters to a JSON file at cloda_ (empty = no file)."
+    },
+    {
+        "setTrace",
+        setTrace,
+        METH_VARARGS,
+        "Record a timeline of the interface in Chrome trace-event format."
+    },
+    {
+        "traceBegin",
+        traceBegin,
+        METH_VARARGS,
+        "Begin a user span in the timeline."
+    },
+    {
+        "traceEnd",
+        traceEnd,
+        METH_VARARGS,
+        "End the innermost user span in the timeline."
+    },
+    {
+        "setBatchSize",
+        setBatchSize,
+        METH_VARARGS,
+        "Deliver track() and interaction() calls in batches of given size."
+    },
+    {
+        "getBatchSize",
+        getBatchSize,
+        METH_VARARGS,
+        "Get the number of entries per batch (0 = no batching)."
+    },
+    {
+        "_updateCallbacks",
+        updateCallbacks,
+        METH_VARARGS,
+        "Resolve the python callables that are called by COAST."
+    },
+    {
+        "setWriteBlockCount",
+        setWriteBlockCount,
+        METH_VARARGS,
+        "Deliver given number of subblocks per write() call as memoryview "
+        "(0 = bytes)."
+    },
+    {
+        "getWriteBlockCount",
+        getWriteBlockCount,
+        METH_VARARGS,
+        "Get the number of subblocks per write() call (0 = bytes)."
+    },
+    {
+        "setParticleFilter",
+        setParticleFilter,
+        METH_VARARGS,
+        "Only deliver particles of given IDs and observation levels to "
+        "write_particles() (empty = all)."
+    },
+    {
+        "addVoxelGrid",
+        addVoxelGrid,
+        METH_VARARGS,
+        "Add a voxel grid that accumulates the energy deposit of tracks."
+    },
+    {
+        "getVoxelGrid",
+        getVoxelGrid,
+        METH_VARARGS,
+        "Get the touched voxels of a voxel grid."
+    },
+    {
+        "resetVoxelGrid",
+        resetVoxelGrid,
+        METH_VARARGS,
+        "Remove all deposits of a voxel grid."
+    },
+    {
+        "addPlane",
+        addPlane,
+        METH_VARARGS,
+        "Add a plane or disc whose crossings are delivered to crossings()."
+    },
+    {
+        "addSphere",
+        addSphere,
+        METH_VARARGS,
+        "Add a sphere whose crossings are delivered to crossings()."
+    },
+    {
+        "clearSurfaces",
+        clearSurfaces,
+        METH_VARARGS,
+        "Deliver the pending crossings and remove all surfaces."
+    },
+    {
+        "addObserverArray",
+        addObserverArray,
+        METH_VARARGS,
+        "Add observers that accumulate the radio emission of tracks."
+    },
+    {
+        "getObserverTraces",
+        getObserverTraces,
+        METH_VARARGS,
+        "Get the traces of an observer array."
+    },
+    {
+        "resetObserverArray",
+        resetObserverArray,
+        METH_VARARGS,
+        "Set the traces of an observer array to zero."
+    },
+    {
+        "addArrowCollector",
+        addArrowCollector,
+        METH_VARARGS,
+        "Add a collector that appends records to Arrow columns."
+    },
+    {
+        "takeArrowRecords",
+        takeArrowRecords,
+        METH_VARARGS,
+        "Hand over the collected records of a collector."
+    },
+    {
+        "exportArrowRecords",
+        exportArrowRecords,
+        METH_VARARGS,
+        "Export records as arrow_schema and arrow_array capsules."
+    },
+    {
+        "loadPlugin",
+        loadPlugin,
+        METH_VARARGS,
+        "Load a native plugin that receives the COAST calls."
+    },
 
     {NULL, NULL, 0, NULL}
 };
@@ -63,7 +384,29 @@ static PyModuleDef cppwrapper_emb_module = {
 };
 
 PyMODINIT_FUNC PyInit_cppwrapper_emb(void) {
-    return PyModule_Create(&cppwrapper_emb_module);
+    PyObject * module = PyModule_Create(&cppwrapper_emb_module);
+    if (module == NULL) {
+        return NULL;
+    }
+
+    if (addCppTypes(module) < 0) {
+        Py_DECREF(module);
+        return NULL;
+    }
+
+    return module;
+}
+
+
+// error handling
+
+static void setPythonError(const std::exception & e) {
+    if (dynamic_cast<const std::invalid_argument *>(&e) != nullptr) {
+        PyErr_SetString(PyExc_ValueError, e.what());
+    }
+    else {
+        PyErr_SetString(PyExc_RuntimeError, e.what());
+    }
 }
 
 
@@ -125,3 +468,1199 @@ static PyObject * enableTrack([[maybe_unused]] PyObject * self,
     return Py_None;
 }
 
+
+
+static PyObject * setTrackFilter([[maybe_unused]] PyObject * self,
+                                 PyObject * args) {
+    const char * source = NULL;
+    if (!PyArg_ParseTuple(args, "s", &source)) {
+        return NULL;
+    }
+
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    try {
+        pythonInterface->setTrackFilter(source);
+    }
+    catch (const std::exception & e) {
+        setPythonError(e);
+        return NULL;
+    }
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+static PyObject * addTrackColumn([[maybe_unused]] PyObject * self,
+                                 PyObject * args) {
+    const char * name = NULL;
+    const char * source = NULL;
+    if (!PyArg_ParseTuple(args, "ss", &name, &source)) {
+        return NULL;
+    }
+
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    try {
+        pythonInterface->addTrackColumn(name, source);
+    }
+    catch (const std::exception & e) {
+        setPythonError(e);
+        return NULL;
+    }
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+static PyObject * clearTrackFilter([[maybe_unused]] PyObject * self,
+                                   [[maybe_unused]] PyObject * args) {
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    try {
+        pythonInterface->clearTrackFilter();
+    }
+    catch (const std::exception & e) {
+        setPythonError(e);
+        return NULL;
+    }
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+
+static PyObject * setInteractionFilter([[maybe_unused]] PyObject * self,
+                                       PyObject * args) {
+    const char * source = NULL;
+    if (!PyArg_ParseTuple(args, "s", &source)) {
+        return NULL;
+    }
+
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    try {
+        pythonInterface->setInteractionFilter(source);
+    }
+    catch (const std::exception & e) {
+        setPythonError(e);
+        return NULL;
+    }
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+static PyObject * addInteractionColumn([[maybe_unused]] PyObject * self,
+                                       PyObject * args) {
+    const char * name = NULL;
+    const char * source = NULL;
+    if (!PyArg_ParseTuple(args, "ss", &name, &source)) {
+        return NULL;
+    }
+
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    try {
+        pythonInterface->addInteractionColumn(name, source);
+    }
+    catch (const std::exception & e) {
+        setPythonError(e);
+        return NULL;
+    }
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+static PyObject * clearInteractionFilter([[maybe_unused]] PyObject * self,
+                                         [[maybe_unused]] PyObject * args) {
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    try {
+        pythonInterface->clearInteractionFilter();
+    }
+    catch (const std::exception & e) {
+        setPythonError(e);
+        return NULL;
+    }
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+
+static PyObject * setTrackSampling([[maybe_unused]] PyObject * self,
+                                       PyObject * args) {
+    const char * mode = NULL;
+    double value = 1.0;
+    int particleId = RecordSampler::DEFAULT_SPECIES;
+    double exponent = 1.0;
+    if (!PyArg_ParseTuple(args, "s|did", &mode, &value, &particleId,
+                          &exponent)) {
+        return NULL;
+    }
+
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    try {
+        pythonInterface->setTrackSampling(
+                particleId, RecordSampler::createRule(mode, value, exponent));
+    }
+    catch (const std::exception & e) {
+        setPythonError(e);
+        return NULL;
+    }
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+static PyObject * clearTrackSampling([[maybe_unused]] PyObject * self,
+                                         [[maybe_unused]] PyObject * args) {
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    pythonInterface->clearTrackSampling();
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+
+static PyObject * setInteractionSampling([[maybe_unused]] PyObject * self,
+                                             PyObject * args) {
+    const char * mode = NULL;
+    double value = 1.0;
+    int particleId = RecordSampler::DEFAULT_SPECIES;
+    double exponent = 1.0;
+    if (!PyArg_ParseTuple(args, "s|did", &mode, &value, &particleId,
+                          &exponent)) {
+        return NULL;
+    }
+
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    try {
+        pythonInterface->setInteractionSampling(
+                particleId, RecordSampler::createRule(mode, value, exponent));
+    }
+    catch (const std::exception & e) {
+        setPythonError(e);
+        return NULL;
+    }
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+static PyObject * clearInteractionSampling([[maybe_unused]] PyObject * self,
+                                               [[maybe_unused]] PyObject * args) {
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    pythonInterface->clearInteractionSampling();
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+
+static PyObject * setSamplingSeed([[maybe_unused]] PyObject * self,
+                                  PyObject * args) {
+    unsigned long long seed = 0;
+    if (!PyArg_ParseTuple(args, "K", &seed)) {
+        return NULL;
+    }
+
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    pythonInterface->setSamplingSeed(seed);
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+
+static PyObject * setAsyncMode([[maybe_unused]] PyObject * self,
+                               PyObject * args) {
+    Py_ssize_t capacity = 0;
+    const char * policy = "block";
+    if (!PyArg_ParseTuple(args, "n|s", &capacity, &policy)) {
+        return NULL;
+    }
+
+    if (capacity < 0) {
+        PyErr_SetString(PyExc_ValueError, "capacity has to be >= 0");
+        return NULL;
+    }
+
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    try {
+        pythonInterface->setAsyncMode(capacity,
+                                      RecordQueue::getPolicy(policy));
+    }
+    catch (const std::exception & e) {
+        setPythonError(e);
+        return NULL;
+    }
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+static PyObject * getAsyncDropped([[maybe_unused]] PyObject * self,
+                                  [[maybe_unused]] PyObject * args) {
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    using RecordType = RecordQueue::RecordType;
+    return Py_BuildValue(
+            "{sKsKsK}",
+            "write", static_cast<unsigned long long>(
+                pythonInterface->getAsyncDropped(RecordType::WRITE)),
+            "interaction", static_cast<unsigned long long>(
+                pythonInterface->getAsyncDropped(RecordType::INTERACTION)),
+            "track", static_cast<unsigned long long>(
+                pythonInterface->getAsyncDropped(RecordType::TRACK)));
+}
+
+
+static PyObject * setColumnWriter([[maybe_unused]] PyObject * self,
+                                  PyObject * args) {
+    const char * path = NULL;
+    Py_ssize_t chunkRows = ColumnWriter::DEFAULT_CHUNK_ROWS;
+    if (!PyArg_ParseTuple(args, "s|n", &path, &chunkRows)) {
+        return NULL;
+    }
+
+    if (chunkRows <= 0) {
+        PyErr_SetString(PyExc_ValueError, "chunk rows have to be > 0");
+        return NULL;
+    }
+
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    try {
+        pythonInterface->setColumnWriter(path, chunkRows);
+    }
+    catch (const std::exception & e) {
+        setPythonError(e);
+        return NULL;
+    }
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+static PyObject * getColumnWriterPath([[maybe_unused]] PyObject * self,
+                                      [[maybe_unused]] PyObject * args) {
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    const std::string path = pythonInterface->getColumnWriterPath();
+    return PyUnicode_FromStringAndSize(path.c_str(), path.size());
+}
+
+
+static PyObject * setBlockWriter([[maybe_unused]] PyObject * self,
+                                 PyObject * args) {
+    const char * path = NULL;
+    int level = BlockWriter::DEFAULT_LEVEL;
+    Py_ssize_t blockSubBlocks = BlockWriter::DEFAULT_BLOCK_SUBBLOCKS;
+    if (!PyArg_ParseTuple(args, "s|in", &path, &level, &blockSubBlocks)) {
+        return NULL;
+    }
+
+    if (blockSubBlocks <= 0) {
+        PyErr_SetString(PyExc_ValueError,
+                        "subblocks per block have to be > 0");
+        return NULL;
+    }
+
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    try {
+        pythonInterface->setBlockWriter(path, level, blockSubBlocks);
+    }
+    catch (const std::exception & e) {
+        setPythonError(e);
+        return NULL;
+    }
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+static PyObject * getBlockWriterPath([[maybe_unused]] PyObject * self,
+                                     [[maybe_unused]] PyObject * args) {
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    const std::string path = pythonInterface->getBlockWriterPath();
+    return PyUnicode_FromStringAndSize(path.c_str(), path.size());
+}
+
+
+static bool parseHistogramAxis(PyObject * item, Histogram::Axis & axis) {
+    const char * expression = NULL;
+    const char * binning = NULL;
+    Py_ssize_t bins = 0;
+    PyObject * edges = NULL;
+
+    if (!PyTuple_Check(item)) {
+        PyErr_SetString(PyExc_TypeError, "histogram axes have to be tuples");
+        return false;
+    }
+
+    if (PyTuple_GET_SIZE(item) == 2) {
+        if (!PyArg_ParseTuple(item, "sO", &expression, &edges)) {
+            return false;
+        }
+
+        PyObject * sequence = PySequence_Fast(edges,
+                                              "bin edges have to be a "
+                                              "sequence");
+        if (sequence == NULL) {
+            return false;
+        }
+
+        const Py_ssize_t size = PySequence_Fast_GET_SIZE(sequence);
+        for (Py_ssize_t i = 0; i < size; ++i) {
+            const double edge = PyFloat_AsDouble(
+                    PySequence_Fast_GET_ITEM(sequence, i));
+            if (edge == -1.0 && PyErr_Occurred() != NULL) {
+                Py_DECREF(sequence);
+                return false;
+            }
+            axis.edges.push_back(edge);
+        }
+        Py_DECREF(sequence);
+
+        axis.expression = expression;
+        axis.binning = Histogram::Binning::VARIABLE;
+        return true;
+    }
+
+    if (!PyArg_ParseTuple(item, "ssndd", &expression, &binning, &bins,
+                          &axis.lower, &axis.upper)) {
+        return false;
+    }
+
+    const std::string name = binning;
+    if (name == "fixed") {
+        axis.binning = Histogram::Binning::FIXED;
+    }
+    else if (name == "log") {
+        axis.binning = Histogram::Binning::LOG;
+    }
+    else {
+        PyErr_SetString(PyExc_ValueError,
+                        "binning has to be 'fixed' or 'log'");
+        return false;
+    }
+
+    if (bins <= 0) {
+        PyErr_SetString(PyExc_ValueError, "number of bins has to be > 0");
+        return false;
+    }
+
+    axis.expression = expression;
+    axis.bins = bins;
+    return true;
+}
+
+
+static PyObject * addHistogram([[maybe_unused]] PyObject * self,
+                               PyObject * args) {
+    const char * source = NULL;
+    PyObject * axes = NULL;
+    const char * weight = "";
+    const char * filter = "";
+    if (!PyArg_ParseTuple(args, "sO|ss", &source, &axes, &weight, &filter)) {
+        return NULL;
+    }
+
+    using RecordType = RecordFilter::RecordType;
+    RecordType type;
+    const std::string name = source;
+    if (name == "track") {
+        type = RecordType::TRACK;
+    }
+    else if (name == "interaction") {
+        type = RecordType::INTERACTION;
+    }
+    else if (name == "particle") {
+        type = RecordType::PARTICLE;
+    }
+    else {
+        PyErr_SetString(PyExc_ValueError, "histogram source has to be "
+                        "'track', 'interaction' or 'particle'");
+        return NULL;
+    }
+
+    PyObject * sequence = PySequence_Fast(axes, "axes have to be a sequence");
+    if (sequence == NULL) {
+        return NULL;
+    }
+
+    std::vector<Histogram::Axis> definitions(
+            PySequence_Fast_GET_SIZE(sequence));
+    for (std::size_t i = 0; i < definitions.size(); ++i) {
+        if (!parseHistogramAxis(PySequence_Fast_GET_ITEM(sequence, i),
+                                definitions[i])) {
+            Py_DECREF(sequence);
+            return NULL;
+        }
+    }
+    Py_DECREF(sequence);
+
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    try {
+        return PyLong_FromSize_t(pythonInterface->addHistogram(
+                    type, definitions, weight, filter));
+    }
+    catch (const std::exception & e) {
+        setPythonError(e);
+        return NULL;
+    }
+}
+
+static PyObject * getHistogram([[maybe_unused]] PyObject * self,
+                               PyObject * args) {
+    Py_ssize_t id = 0;
+    if (!PyArg_ParseTuple(args, "n", &id)) {
+        return NULL;
+    }
+
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    if (id < 0 ||
+        static_cast<std::size_t>(id) >= pythonInterface->getHistogramCount()) {
+        PyErr_SetString(PyExc_ValueError, "unknown histogram id");
+        return NULL;
+    }
+
+    try {
+        return pythonInterface->getHistogramContents(id);
+    }
+    catch (const std::exception & e) {
+        setPythonError(e);
+        return NULL;
+    }
+}
+
+static PyObject * resetHistogram([[maybe_unused]] PyObject * self,
+                                 PyObject * args) {
+    Py_ssize_t id = 0;
+    if (!PyArg_ParseTuple(args, "n", &id)) {
+        return NULL;
+    }
+
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    if (id < 0 ||
+        static_cast<std::size_t>(id) >= pythonInterface->getHistogramCount()) {
+        PyErr_SetString(PyExc_ValueError, "unknown histogram id");
+        return NULL;
+    }
+
+    try {
+        pythonInterface->resetHistogram(id);
+    }
+    catch (const std::exception & e) {
+        setPythonError(e);
+        return NULL;
+    }
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+
+static PyObject * stats([[maybe_unused]] PyObject * self,
+                        [[maybe_unused]] PyObject * args) {
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    const InterfaceStats & interfaceStats = pythonInterface->getStats();
+
+    PyObject * result = PyDict_New();
+    if (result == NULL) {
+        return NULL;
+    }
+
+    for (std::size_t i = 0; i < InterfaceStats::CALLBACKS; ++i) {
+        const auto callback = static_cast<InterfaceStats::Callback>(i);
+        const InterfaceStats::Snapshot snapshot =
+            interfaceStats.getSnapshot(callback);
+
+        PyObject * latency = PyTuple_New(InterfaceStats::LATENCY_BUCKETS);
+        for (std::size_t bucket = 0; latency != NULL &&
+             bucket < InterfaceStats::LATENCY_BUCKETS; ++bucket) {
+            PyTuple_SET_ITEM(latency, bucket, PyLong_FromUnsignedLongLong(
+                        snapshot.latency[bucket]));
+        }
+
+        PyObject * entry = Py_BuildValue(
+                "{sKsKsKsKsKsKsN}",
+                "calls", static_cast<unsigned long long>(snapshot.calls),
+                "captured", static_cast<unsigned long long>(snapshot.captured),
+                "skipped", static_cast<unsigned long long>(
+                    snapshot.calls - snapshot.captured),
+                "bytes", static_cast<unsigned long long>(snapshot.bytes),
+                "python_calls", static_cast<unsigned long long>(
+                    snapshot.pythonCalls),
+                "python_ns", static_cast<unsigned long long>(
+                    snapshot.pythonNanoseconds),
+                "latency_ns_log2", latency);
+        if (entry == NULL ||
+            PyDict_SetItemString(result, InterfaceStats::getName(callback),
+                                 entry) < 0) {
+            Py_XDECREF(entry);
+            Py_DECREF(result);
+            return NULL;
+        }
+        Py_DECREF(entry);
+    }
+
+    if (PyDict_SetItemString(result, "enabled", InterfaceStats::ENABLED
+                             ? Py_True : Py_False) < 0) {
+        Py_DECREF(result);
+        return NULL;
+    }
+
+    return result;
+}
+
+static PyObject * setStatsFile([[maybe_unused]] PyObject * self,
+                               PyObject * args) {
+    const char * path = NULL;
+    if (!PyArg_ParseTuple(args, "s", &path)) {
+        return NULL;
+    }
+
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    pythonInterface->setStatsFile(path);
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+
+static PyObject * setTrace([[maybe_unused]] PyObject * self,
+                           PyObject * args) {
+    const char * path = NULL;
+    unsigned long long sampleEvery = 1;
+    if (!PyArg_ParseTuple(args, "s|K", &path, &sampleEvery)) {
+        return NULL;
+    }
+
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    try {
+        pythonInterface->setTrace(path, sampleEvery);
+    }
+    catch (const std::exception & e) {
+        setPythonError(e);
+        return NULL;
+    }
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+static PyObject * traceBegin([[maybe_unused]] PyObject * self,
+                             PyObject * args) {
+    const char * name = NULL;
+    if (!PyArg_ParseTuple(args, "s", &name)) {
+        return NULL;
+    }
+
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    pythonInterface->beginTraceSpan(name);
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+static PyObject * traceEnd([[maybe_unused]] PyObject * self,
+                           [[maybe_unused]] PyObject * args) {
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    pythonInterface->endTraceSpan();
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+
+static PyObject * setBatchSize([[maybe_unused]] PyObject * self,
+                               PyObject * args) {
+    Py_ssize_t size = 0;
+    if (!PyArg_ParseTuple(args, "n", &size)) {
+        return NULL;
+    }
+
+    if (size < 0) {
+        PyErr_SetString(PyExc_ValueError, "batch size must not be negative");
+        return NULL;
+    }
+
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    try {
+        pythonInterface->setBatchSize(size);
+    }
+    catch (const std::exception & e) {
+        setPythonError(e);
+        return NULL;
+    }
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+static PyObject * getBatchSize([[maybe_unused]] PyObject * self,
+                               [[maybe_unused]] PyObject * args) {
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    return PyLong_FromSize_t(pythonInterface->getBatchSize());
+}
+
+
+static PyObject * updateCallbacks([[maybe_unused]] PyObject * self,
+                                  [[maybe_unused]] PyObject * args) {
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    try {
+        pythonInterface->updateCallbacks();
+    }
+    catch (const std::exception & e) {
+        setPythonError(e);
+        return NULL;
+    }
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+
+static PyObject * setWriteBlockCount([[maybe_unused]] PyObject * self,
+                                     PyObject * args) {
+    Py_ssize_t count = 0;
+    if (!PyArg_ParseTuple(args, "n", &count)) {
+        return NULL;
+    }
+
+    if (count < 0) {
+        PyErr_SetString(PyExc_ValueError,
+                        "write block count must not be negative");
+        return NULL;
+    }
+
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    try {
+        pythonInterface->setWriteBlockCount(count);
+    }
+    catch (const std::exception & e) {
+        setPythonError(e);
+        return NULL;
+    }
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+static PyObject * getWriteBlockCount([[maybe_unused]] PyObject * self,
+                                     [[maybe_unused]] PyObject * args) {
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    return PyLong_FromSize_t(pythonInterface->getWriteBlockCount());
+}
+
+
+static bool parseIntegers(PyObject * object, const char * message,
+                          std::vector<int> & values) {
+    PyObject * sequence = PySequence_Fast(object, message);
+    if (sequence == NULL) {
+        return false;
+    }
+
+    const Py_ssize_t size = PySequence_Fast_GET_SIZE(sequence);
+    for (Py_ssize_t i = 0; i < size; ++i) {
+        const long value = PyLong_AsLong(
+                PySequence_Fast_GET_ITEM(sequence, i));
+        if (value == -1 && PyErr_Occurred() != NULL) {
+            Py_DECREF(sequence);
+            return false;
+        }
+        values.push_back(static_cast<int>(value));
+    }
+    Py_DECREF(sequence);
+    return true;
+}
+
+
+static PyObject * setParticleFilter([[maybe_unused]] PyObject * self,
+                                    PyObject * args) {
+    PyObject * speciesObject = NULL;
+    PyObject * levelsObject = NULL;
+    if (!PyArg_ParseTuple(args, "|OO", &speciesObject, &levelsObject)) {
+        return NULL;
+    }
+
+    std::vector<int> species;
+    std::vector<int> levels;
+    if ((speciesObject != NULL &&
+         !parseIntegers(speciesObject, "species have to be a sequence",
+                        species)) ||
+        (levelsObject != NULL &&
+         !parseIntegers(levelsObject, "levels have to be a sequence",
+                        levels))) {
+        return NULL;
+    }
+
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    try {
+        pythonInterface->setParticleFilter(species, levels);
+    }
+    catch (const std::exception & e) {
+        setPythonError(e);
+        return NULL;
+    }
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+
+static PyObject * addVoxelGrid([[maybe_unused]] PyObject * self,
+                               PyObject * args) {
+    const char * geometry = NULL;
+    PyObject * axes = NULL;
+    PyObject * species = NULL;
+    std::array<double, 3> core = {0, 0, 0};
+    PyObject * direction = Py_None;
+    if (!PyArg_ParseTuple(args, "sO|O(ddd)O", &geometry, &axes, &species,
+                          &core[0], &core[1], &core[2], &direction)) {
+        return NULL;
+    }
+
+    const std::string name = geometry;
+    VoxelGrid::Geometry type;
+    if (name == "cartesian") {
+        type = VoxelGrid::Geometry::CARTESIAN;
+    }
+    else if (name == "cylindrical") {
+        type = VoxelGrid::Geometry::CYLINDRICAL;
+    }
+    else {
+        PyErr_SetString(PyExc_ValueError, "voxel geometry has to be "
+                        "'cartesian' or 'cylindrical'");
+        return NULL;
+    }
+
+    PyObject * sequence = PySequence_Fast(axes, "axes have to be a sequence");
+    if (sequence == NULL) {
+        return NULL;
+    }
+    if (PySequence_Fast_GET_SIZE(sequence) != 3) {
+        Py_DECREF(sequence);
+        PyErr_SetString(PyExc_ValueError, "voxel grids need three axes");
+        return NULL;
+    }
+
+    std::array<VoxelGrid::Axis, 3> definitions;
+    for (std::size_t i = 0; i < 3; ++i) {
+        Py_ssize_t bins = 0;
+        if (!PyArg_ParseTuple(PySequence_Fast_GET_ITEM(sequence, i),
+                              "ddn;voxel axes have to be (lower, upper, "
+                              "bins)", &definitions[i].lower,
+                              &definitions[i].upper, &bins)) {
+            Py_DECREF(sequence);
+            return NULL;
+        }
+        if (bins <= 0) {
+            Py_DECREF(sequence);
+            PyErr_SetString(PyExc_ValueError, "number of bins has to be > 0");
+            return NULL;
+        }
+        definitions[i].bins = bins;
+    }
+    Py_DECREF(sequence);
+
+    std::vector<int> ids;
+    if (species != NULL &&
+        !parseIntegers(species, "species have to be a sequence", ids)) {
+        return NULL;
+    }
+
+    double zenith = 0;
+    double azimuth = 0;
+    if (direction != Py_None &&
+        !PyArg_ParseTuple(direction, "dd;direction has to be (zenith, "
+                          "azimuth)", &zenith, &azimuth)) {
+        return NULL;
+    }
+
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    try {
+        const std::size_t id =
+            pythonInterface->addVoxelGrid(type, definitions, ids, core);
+        if (direction != Py_None) {
+            pythonInterface->getVoxelGrid(id).setDirection(zenith, azimuth);
+        }
+        return PyLong_FromSize_t(id);
+    }
+    catch (const std::exception & e) {
+        setPythonError(e);
+        return NULL;
+    }
+}
+
+static PyObject * getVoxelGrid([[maybe_unused]] PyObject * self,
+                               PyObject * args) {
+    Py_ssize_t id = 0;
+    if (!PyArg_ParseTuple(args, "n", &id)) {
+        return NULL;
+    }
+
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    if (id < 0 ||
+        static_cast<std::size_t>(id) >= pythonInterface->getVoxelGridCount()) {
+        PyErr_SetString(PyExc_ValueError, "unknown voxel grid id");
+        return NULL;
+    }
+
+    try {
+        return pythonInterface->getVoxelGridContents(id);
+    }
+    catch (const std::exception & e) {
+        setPythonError(e);
+        return NULL;
+    }
+}
+
+static PyObject * resetVoxelGrid([[maybe_unused]] PyObject * self,
+                                 PyObject * args) {
+    Py_ssize_t id = 0;
+    if (!PyArg_ParseTuple(args, "n", &id)) {
+        return NULL;
+    }
+
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    if (id < 0 ||
+        static_cast<std::size_t>(id) >= pythonInterface->getVoxelGridCount()) {
+        PyErr_SetString(PyExc_ValueError, "unknown voxel grid id");
+        return NULL;
+    }
+
+    pythonInterface->getVoxelGrid(id).reset();
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+
+static PyObject * addPlane([[maybe_unused]] PyObject * self,
+                           PyObject * args) {
+    std::array<double, 3> point;
+    std::array<double, 3> normal;
+    double radius = 0;
+    if (!PyArg_ParseTuple(args, "(ddd)(ddd)|d", &point[0], &point[1],
+                          &point[2], &normal[0], &normal[1], &normal[2],
+                          &radius)) {
+        return NULL;
+    }
+
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    try {
+        return PyLong_FromLong(
+                pythonInterface->addPlane(point, normal, radius));
+    }
+    catch (const std::exception & e) {
+        setPythonError(e);
+        return NULL;
+    }
+}
+
+static PyObject * addSphere([[maybe_unused]] PyObject * self,
+                            PyObject * args) {
+    std::array<double, 3> center;
+    double radius = 0;
+    if (!PyArg_ParseTuple(args, "(ddd)d", &center[0], &center[1],
+                          &center[2], &radius)) {
+        return NULL;
+    }
+
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    try {
+        return PyLong_FromLong(pythonInterface->addSphere(center, radius));
+    }
+    catch (const std::exception & e) {
+        setPythonError(e);
+        return NULL;
+    }
+}
+
+static PyObject * clearSurfaces([[maybe_unused]] PyObject * self,
+                                [[maybe_unused]] PyObject * args) {
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    try {
+        pythonInterface->clearSurfaces();
+    }
+    catch (const std::exception & e) {
+        setPythonError(e);
+        return NULL;
+    }
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+
+static PyObject * addObserverArray([[maybe_unused]] PyObject * self,
+                                   PyObject * args) {
+    PyObject * positions = NULL;
+    ObserverArray::Binning binning;
+    Py_ssize_t bins = 0;
+    PyObject * offsets = Py_None;
+    ObserverArray::Atmosphere atmosphere;
+    if (!PyArg_ParseTuple(args, "O(ddn)|Oddd", &positions, &binning.start,
+                          &binning.width, &bins, &offsets,
+                          &atmosphere.refractivity, &atmosphere.scaleHeight,
+                          &atmosphere.speedOfLight)) {
+        return NULL;
+    }
+    if (bins <= 0) {
+        PyErr_SetString(PyExc_ValueError, "number of bins has to be > 0");
+        return NULL;
+    }
+    binning.bins = bins;
+
+    PyObject * sequence = PySequence_Fast(positions,
+                                          "positions have to be a sequence");
+    if (sequence == NULL) {
+        return NULL;
+    }
+    std::vector<std::array<double, 3>> observers(
+            PySequence_Fast_GET_SIZE(sequence));
+    for (std::size_t k = 0; k < observers.size(); ++k) {
+        if (!PyArg_ParseTuple(PySequence_Fast_GET_ITEM(sequence, k),
+                              "ddd;positions have to be (x, y, z)",
+                              &observers[k][0], &observers[k][1],
+                              &observers[k][2])) {
+            Py_DECREF(sequence);
+            return NULL;
+        }
+    }
+    Py_DECREF(sequence);
+
+    std::vector<double> times;
+    if (offsets != Py_None) {
+        sequence = PySequence_Fast(offsets, "offsets have to be a sequence");
+        if (sequence == NULL) {
+            return NULL;
+        }
+        for (Py_ssize_t k = 0; k < PySequence_Fast_GET_SIZE(sequence); ++k) {
+            const double value = PyFloat_AsDouble(
+                    PySequence_Fast_GET_ITEM(sequence, k));
+            if (value == -1.0 && PyErr_Occurred() != NULL) {
+                Py_DECREF(sequence);
+                return NULL;
+            }
+            times.push_back(value);
+        }
+        Py_DECREF(sequence);
+    }
+
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    try {
+        return PyLong_FromSize_t(pythonInterface->addObserverArray(
+                observers, times, binning, atmosphere));
+    }
+    catch (const std::exception & e) {
+        setPythonError(e);
+        return NULL;
+    }
+}
+
+static PyObject * getObserverTraces([[maybe_unused]] PyObject * self,
+                                    PyObject * args) {
+    Py_ssize_t id = 0;
+    if (!PyArg_ParseTuple(args, "n", &id)) {
+        return NULL;
+    }
+
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    if (id < 0 || static_cast<std::size_t>(id) >=
+            pythonInterface->getObserverArrayCount()) {
+        PyErr_SetString(PyExc_ValueError, "unknown observer array id");
+        return NULL;
+    }
+
+    try {
+        return pythonInterface->getObserverTraces(id);
+    }
+    catch (const std::exception & e) {
+        setPythonError(e);
+        return NULL;
+    }
+}
+
+static PyObject * resetObserverArray([[maybe_unused]] PyObject * self,
+                                     PyObject * args) {
+    Py_ssize_t id = 0;
+    if (!PyArg_ParseTuple(args, "n", &id)) {
+        return NULL;
+    }
+
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    if (id < 0 || static_cast<std::size_t>(id) >=
+            pythonInterface->getObserverArrayCount()) {
+        PyErr_SetString(PyExc_ValueError, "unknown observer array id");
+        return NULL;
+    }
+
+    pythonInterface->getObserverArray(id).reset();
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+
+// capsule names; the Arrow ones are required by the PyCapsule interface
+static const char * ARROW_BATCH_CAPSULE = "cppwrapper_emb.ArrowBatch";
+static const char * ARROW_SCHEMA_CAPSULE = "arrow_schema";
+static const char * ARROW_ARRAY_CAPSULE = "arrow_array";
+
+static void deleteArrowBatchCapsule(PyObject * capsule) {
+    delete static_cast<std::shared_ptr<const ArrowBatch> *>(
+            PyCapsule_GetPointer(capsule, ARROW_BATCH_CAPSULE));
+}
+
+static void deleteArrowSchemaCapsule(PyObject * capsule) {
+    auto * schema = static_cast<ArrowSchema *>(
+            PyCapsule_GetPointer(capsule, ARROW_SCHEMA_CAPSULE));
+    // consumers that imported the schema have released it already
+    if (schema->release != NULL) {
+        schema->release(schema);
+    }
+    delete schema;
+}
+
+static void deleteArrowArrayCapsule(PyObject * capsule) {
+    auto * array = static_cast<ArrowArray *>(
+            PyCapsule_GetPointer(capsule, ARROW_ARRAY_CAPSULE));
+    if (array->release != NULL) {
+        array->release(array);
+    }
+    delete array;
+}
+
+
+static PyObject * addArrowCollector([[maybe_unused]] PyObject * self,
+                                    PyObject * args) {
+    const char * source = NULL;
+    PyObject * speciesObject = Py_None;
+    PyObject * levelsObject = Py_None;
+    if (!PyArg_ParseTuple(args, "s|OO", &source, &speciesObject,
+                          &levelsObject)) {
+        return NULL;
+    }
+
+    using RecordType = RecordFilter::RecordType;
+    RecordType type;
+    const std::string name = source;
+    if (name == "track") {
+        type = RecordType::TRACK;
+    }
+    else if (name == "interaction") {
+        type = RecordType::INTERACTION;
+    }
+    else if (name == "particle") {
+        type = RecordType::PARTICLE;
+    }
+    else {
+        PyErr_SetString(PyExc_ValueError, "collector source has to be "
+                        "'track', 'interaction' or 'particle'");
+        return NULL;
+    }
+
+    std::vector<int> species;
+    std::vector<int> levels;
+    if ((speciesObject != Py_None &&
+         !parseIntegers(speciesObject, "species have to be a sequence",
+                        species)) ||
+        (levelsObject != Py_None &&
+         !parseIntegers(levelsObject, "levels have to be a sequence",
+                        levels))) {
+        return NULL;
+    }
+
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    try {
+        return PyLong_FromSize_t(
+                pythonInterface->addArrowCollector(type, species, levels));
+    }
+    catch (const std::exception & e) {
+        setPythonError(e);
+        return NULL;
+    }
+}
+
+static PyObject * takeArrowRecords([[maybe_unused]] PyObject * self,
+                                   PyObject * args) {
+    Py_ssize_t id = 0;
+    if (!PyArg_ParseTuple(args, "n", &id)) {
+        return NULL;
+    }
+
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    if (id < 0 || static_cast<std::size_t>(id) >=
+            pythonInterface->getArrowCollectorCount()) {
+        PyErr_SetString(PyExc_ValueError, "unknown arrow collector id");
+        return NULL;
+    }
+
+    auto * batch = new std::shared_ptr<const ArrowBatch>(
+            pythonInterface->getArrowCollector(id).take());
+    const std::size_t size = (*batch)->getSize();
+    PyObject * handle = PyCapsule_New(batch, ARROW_BATCH_CAPSULE,
+                                      deleteArrowBatchCapsule);
+    if (handle == NULL) {
+        delete batch;
+        return NULL;
+    }
+
+    return Py_BuildValue("(Nn)", handle, static_cast<Py_ssize_t>(size));
+}
+
+static PyObject * exportArrowRecords([[maybe_unused]] PyObject * self,
+                                     PyObject * args) {
+    PyObject * handle = NULL;
+    if (!PyArg_ParseTuple(args, "O", &handle)) {
+        return NULL;
+    }
+
+    auto * batch = static_cast<std::shared_ptr<const ArrowBatch> *>(
+            PyCapsule_GetPointer(handle, ARROW_BATCH_CAPSULE));
+    if (batch == NULL) {
+        return NULL;
+    }
+
+    // the capsules own the structures; the structures share the batch
+    auto * schema = new ArrowSchema();
+    auto * array = new ArrowArray();
+    schema->release = NULL;
+    array->release = NULL;
+    PyObject * schemaCapsule = PyCapsule_New(schema, ARROW_SCHEMA_CAPSULE,
+                                             deleteArrowSchemaCapsule);
+    if (schemaCapsule == NULL) {
+        delete schema;
+        delete array;
+        return NULL;
+    }
+    PyObject * arrayCapsule = PyCapsule_New(array, ARROW_ARRAY_CAPSULE,
+                                            deleteArrowArrayCapsule);
+    if (arrayCapsule == NULL) {
+        Py_DECREF(schemaCapsule);
+        delete array;
+        return NULL;
+    }
+
+    try {
+        ArrowBatch::exportBatch(*batch, schema, array);
+    }
+    catch (const std::exception & e) {
+        Py_DECREF(schemaCapsule);
+        Py_DECREF(arrayCapsule);
+        setPythonError(e);
+        return NULL;
+    }
+
+    return Py_BuildValue("(NN)", schemaCapsule, arrayCapsule);
+}
+
+
+static PyObject * loadPlugin([[maybe_unused]] PyObject * self,
+                             PyObject * args) {
+    const char * path = NULL;
+    if (!PyArg_ParseTuple(args, "s", &path)) {
+        return NULL;
+    }
+
+    PythonInterface * pythonInterface = PythonInterface::instance();
+    try {
+        pythonInterface->loadPlugin(path);
+    }
+    catch (const std::exception & e) {
+        setPythonError(e);
+        return NULL;
+    }
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
@@ -0,0 +1,698 @@
+#include "Expression.h"
+
+#include <cctype>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+// builtin functions and constants
+
+namespace {
+
+enum Function : std::uint32_t {
+    SQRT, ABS, EXP, LOG, LOG10, SIN, COS, TAN, ASIN, ACOS, ATAN, MASS,
+    ATAN2, POW, HYPOT, MIN, MAX
+};
+
+const std::map<std::string, Function> functions1 = {
+    {"sqrt", SQRT}, {"abs", ABS}, {"exp", EXP}, {"log", LOG},
+    {"log10", LOG10}, {"sin", SIN}, {"cos", COS}, {"tan", TAN},
+    {"asin", ASIN}, {"acos", ACOS}, {"atan", ATAN}, {"mass", MASS}
+};
+
+const std::map<std::string, Function> functions2 = {
+    {"atan2", ATAN2}, {"pow", POW}, {"hypot", HYPOT}, {"min", MIN},
+    {"max", MAX}
+};
+
+const std::map<std::string, double> constants = {
+    {"True", 1.0}, {"False", 0.0}, {"pi", M_PI},
+    {"MeV", 1e-3}, {"GeV", 1.0}, {"TeV", 1e3}, {"PeV", 1e6}, {"EeV", 1e9}
+};
+
+
+/** Rest mass in GeV of a CORSIKA particle ID. */
+double particleMass(double id) {
+    constexpr double electron = 0.51099895e-3;
+    constexpr double muon = 0.1056583755;
+    constexpr double proton = 0.93827208816;
+    constexpr double neutron = 0.93956542052;
+
+    const int code = static_cast<int>(id);
+    switch (code) {
+        case 1: return 0.0;
+        case 2: case 3: return electron;
+        case 5: case 6: return muon;
+        case 7: return 0.1349768;
+        case 8: case 9: return 0.13957039;
+        case 10: case 16: return 0.497611;
+        case 11: case 12: return 0.493677;
+        case 13: case 25: return neutron;
+        case 14: case 15: return proton;
+        case 17: return 0.547862;
+        case 18: case 26: return 1.115683;
+        case 19: case 27: return 1.18937;
+        case 20: case 28: return 1.192642;
+        case 21: case 29: return 1.197449;
+        case 22: case 30: return 1.31486;
+        case 23: case 31: return 1.32171;
+        case 24: case 32: return 1.67245;
+        case 66: case 67: case 68: case 69: return 0.0;
+        case 75: case 76: case 95: case 96: return muon;
+        default: break;
+    }
+
+    // nuclei are coded as A * 100 + Z, binding energy is neglected
+    const int A = code / 100;
+    const int Z = code % 100;
+    if (A >= 2 && Z >= 0 && Z <= A) {
+        return Z * proton + (A - Z) * neutron;
+    }
+
+    return std::numeric_limits<double>::quiet_NaN();
+}
+
+}
+
+
+// parser
+
+/** Recursive descent parser that emits bytecode into an Expression. */
+class Expression::Parser {
+
+    private:
+        enum class Token { NUMBER, NAME, OPERATOR, END };
+
+        const std::string & mSource;
+        const std::map<std::string, std::size_t> & mVariables;
+        Expression & mExpression;
+        std::size_t mPosition = 0;
+        std::size_t mDepth = 0;
+
+        Token mToken = Token::END;
+        std::string mText;
+        double mNumber = 0.0;
+        std::size_t mTokenStart = 0;
+
+    public:
+        Parser(const std::string & source,
+               const std::map<std::string, std::size_t> & variables,
+               Expression & expression)
+            : mSource(source)
+            , mVariables(variables)
+            , mExpression(expression)
+        {
+            // nothing
+        }
+
+        void parse() {
+            next();
+            if (mToken == Token::END) {
+                fail("empty expression");
+            }
+
+            parseOr();
+            if (mToken != Token::END) {
+                fail("unexpected '" + mText + "'");
+            }
+        }
+
+    private:
+        [[noreturn]] void fail(const std::string & message) const {
+            throw std::invalid_argument(
+                    message + " at position " + std::to_string(mTokenStart) +
+                    " in expression '" + mSource + "'");
+        }
+
+        bool isOperator(const char * text) const {
+            return mToken == Token::OPERATOR && mText == text;
+        }
+
+        bool isKeyword(const char * text) const {
+            return mToken == Token::NAME && mText == text;
+        }
+
+        void expect(const char * text) {
+            if (!isOperator(text)) {
+                fail(std::string("expected '") + text + "'");
+            }
+            next();
+        }
+
+        void next() {
+            while (mPosition < mSource.size() &&
+                   std::isspace(static_cast<unsigned char>(
+                           mSource[mPosition]))) {
+                ++mPosition;
+            }
+
+            mTokenStart = mPosition;
+            if (mPosition >= mSource.size()) {
+                mToken = Token::END;
+                mText = "end of expression";
+                return;
+            }
+
+            const char * begin = mSource.c_str() + mPosition;
+            const unsigned char c = *begin;
+
+            if (std::isdigit(c) || (c == '.' && std::isdigit(
+                    static_cast<unsigned char>(begin[1])))) {
+                char * end = nullptr;
+                mNumber = std::strtod(begin, &end);
+                mPosition += end - begin;
+                mText = std::string(begin, static_cast<const char *>(end));
+                mToken = Token::NUMBER;
+                return;
+            }
+
+            if (std::isalpha(c) || c == '_') {
+                std::size_t end = mPosition;
+                while (end < mSource.size() &&
+                       (std::isalnum(static_cast<unsigned char>(
+                               mSource[end])) ||
+                        mSource[end] == '_' || mSource[end] == '.')) {
+                    ++end;
+                }
+                mText = mSource.substr(mPosition, end - mPosition);
+                mPosition = end;
+                mToken = Token::NAME;
+                return;
+            }
+
+            static const char * twoChar[] = {"**", "<=", ">=", "==", "!="};
+            for (const char * op : twoChar) {
+                if (mSource.compare(mPosition, 2, op) == 0) {
+                    mText = op;
+                    mPosition += 2;
+                    mToken = Token::OPERATOR;
+                    return;
+                }
+            }
+
+            if (std::string("+-*/%<>(),").find(c) != std::string::npos) {
+                mText = std::string(1, c);
+                mPosition += 1;
+                mToken = Token::OPERATOR;
+                return;
+            }
+
+            mText = std::string(1, c);
+            fail("invalid character '" + mText + "'");
+        }
+
+        void emit(OpCode op, std::uint32_t arg = 0, std::uint32_t count = 0) {
+            mExpression.mCode.push_back({op, arg, count});
+
+            switch (op) {
+                case OpCode::CONSTANT:
+                case OpCode::VARIABLE:
+                    ++mDepth;
+                    break;
+
+                case OpCode::NEGATE:
+                case OpCode::NOT:
+                case OpCode::IN:
+                case OpCode::FUNCTION1:
+                    break;
+
+                default:
+                    --mDepth;
+                    break;
+            }
+
+            if (mDepth > mExpression.mStackDepth) {
+                mExpression.mStackDepth = mDepth;
+            }
+        }
+
+        void emitConstant(double value) {
+            mExpression.mConstants.push_back(value);
+            emit(OpCode::CONSTANT, mExpression.mConstants.size() - 1);
+        }
+
+        void parseOr() {
+            parseAnd();
+            while (isKeyword("or")) {
+                next();
+                parseAnd();
+                emit(OpCode::OR);
+            }
+        }
+
+        void parseAnd() {
+            parseNot();
+            while (isKeyword("and")) {
+                next();
+                parseNot();
+                emit(OpCode::AND);
+            }
+        }
+
+        void parseNot() {
+            if (isKeyword("not")) {
+                next();
+                parseNot();
+                emit(OpCode::NOT);
+                return;
+            }
+
+            parseComparison();
+        }
+
+        bool parseComparisonOperator(OpCode & op) {
+            static const std::map<std::string, OpCode> comparisons = {
+                {"<", OpCode::LESS}, {"<=", OpCode::LESS_EQUAL},
+                {">", OpCode::GREATER}, {">=", OpCode::GREATER_EQUAL},
+                {"==", OpCode::EQUAL}, {"!=", OpCode::NOT_EQUAL}
+            };
+
+            if (mToken != Token::OPERATOR) {
+                return false;
+            }
+
+            auto it = comparisons.find(mText);
+            if (it == comparisons.end()) {
+                return false;
+            }
+
+            op = it->second;
+            return true;
+        }
+
+        void parseComparison() {
+            parseSum();
+
+            OpCode op;
+            if (parseComparisonOperator(op)) {
+                next();
+                parseSum();
+                emit(op);
+            }
+            else if (isKeyword("in")) {
+                next();
+                parseMembers();
+            }
+            else if (isKeyword("not")) {
+                next();
+                if (!isKeyword("in")) {
+                    fail("expected 'in'");
+                }
+                next();
+                parseMembers();
+                emit(OpCode::NOT);
+            }
+            else {
+                return;
+            }
+
+            if (parseComparisonOperator(op) || isKeyword("in")) {
+                fail("chained comparisons are not supported");
+            }
+        }
+
+        void parseMembers() {
+            expect("(");
+
+            std::size_t offset = mExpression.mConstants.size();
+            while (!isOperator(")")) {
+                mExpression.mConstants.push_back(parseConstant());
+                if (!isOperator(",")) {
+                    break;
+                }
+                next();
+            }
+            expect(")");
+
+            std::size_t count = mExpression.mConstants.size() - offset;
+            if (count == 0) {
+                fail("empty member list");
+            }
+            emit(OpCode::IN, offset, count);
+        }
+
+        double parseConstant() {
+            double sign = 1.0;
+            while (isOperator("-") || isOperator("+")) {
+                if (isOperator("-")) {
+                    sign = -sign;
+                }
+                next();
+            }
+
+            double value = 0.0;
+            if (mToken == Token::NUMBER) {
+                value = mNumber;
+            }
+            else if (mToken == Token::NAME && constants.count(mText) > 0) {
+                value = constants.at(mText);
+            }
+            else {
+                fail("members of 'in' have to be constants");
+            }
+            next();
+
+            return sign * value;
+        }
+
+        void parseSum() {
+            parseProduct();
+            while (isOperator("+") || isOperator("-")) {
+                OpCode op = isOperator("+") ? OpCode::ADD : OpCode::SUBTRACT;
+                next();
+                parseProduct();
+                emit(op);
+            }
+        }
+
+        void parseProduct() {
+            parseUnary();
+            while (isOperator("*") || isOperator("/") || isOperator("%")) {
+                OpCode op = OpCode::MODULO;
+                if (isOperator("*")) {
+                    op = OpCode::MULTIPLY;
+                }
+                else if (isOperator("/")) {
+                    op = OpCode::DIVIDE;
+                }
+                next();
+                parseUnary();
+                emit(op);
+            }
+        }
+
+        void parseUnary() {
+            if (isOperator("-")) {
+                next();
+                parseUnary();
+                emit(OpCode::NEGATE);
+                return;
+            }
+
+            if (isOperator("+")) {
+                next();
+                parseUnary();
+                return;
+            }
+
+            parsePower();
+        }
+
+        void parsePower() {
+            parseAtom();
+            if (isOperator("**")) {
+                next();
+                parseUnary();
+                emit(OpCode::POWER);
+            }
+        }
+
+        void parseAtom() {
+            if (mToken == Token::NUMBER) {
+                emitConstant(mNumber);
+                next();
+                return;
+            }
+
+            if (isOperator("(")) {
+                next();
+                parseOr();
+                expect(")");
+                return;
+            }
+
+            if (mToken != Token::NAME) {
+                fail("unexpected '" + mText + "'");
+            }
+
+            std::string name = mText;
+            next();
+
+            if (isOperator("(")) {
+                parseCall(name);
+                return;
+            }
+
+            auto variable = mVariables.find(name);
+            if (variable != mVariables.end()) {
+                emit(OpCode::VARIABLE, variable->second);
+                return;
+            }
+
+            auto constant = constants.find(name);
+            if (constant != constants.end()) {
+                emitConstant(constant->second);
+                return;
+            }
+
+            fail("unknown name '" + name + "'");
+        }
+
+        void parseCall(const std::string & name) {
+            auto function1 = functions1.find(name);
+            auto function2 = functions2.find(name);
+            if (function1 == functions1.end() &&
+                function2 == functions2.end()) {
+                fail("unknown function '" + name + "'");
+            }
+
+            expect("(");
+            parseOr();
+            if (function2 != functions2.end()) {
+                expect(",");
+                parseOr();
+                expect(")");
+                emit(OpCode::FUNCTION2, function2->second);
+                return;
+            }
+            expect(")");
+            emit(OpCode::FUNCTION1, function1->second);
+        }
+
+};
+
+
+// expression
+
+Expression::Expression(const std::string & source,
+                       const std::map<std::string, std::size_t> & variables)
+    : mSource(source)
+{
+    Parser parser(source, variables, *this);
+    parser.parse();
+    mStack.resize(mStackDepth * BLOCK);
+}
+
+
+const std::string & Expression::getSource() const {
+    return mSource;
+}
+
+
+bool Expression::isEmpty() const {
+    return mCode.empty();
+}
+
+
+void Expression::evaluate(const double * const * columns, std::size_t n,
+                          double * result) const {
+    // stack level k holds the values of all records at mStack[k * BLOCK],
+    // a and b are the two topmost levels and next the first free level
+    double * stack = mStack.data();
+    double * next = stack;
+
+    for (const Instruction & ins : mCode) {
+        const std::size_t depth = (next - stack) / BLOCK;
+        double * b = depth >= 1 ? next - BLOCK : next;
+        double * a = depth >= 2 ? next - 2 * BLOCK : next;
+
+        switch (ins.op) {
+            case OpCode::CONSTANT: {
+                const double value = mConstants[ins.arg];
+                for (std::size_t i = 0; i < n; ++i) {
+                    next[i] = value;
+                }
+                next += BLOCK;
+                break;
+            }
+
+            case OpCode::VARIABLE: {
+                const double * column = columns[ins.arg];
+                for (std::size_t i = 0; i < n; ++i) {
+                    next[i] = column[i];
+                }
+                next += BLOCK;
+                break;
+            }
+
+            case OpCode::NEGATE:
+                for (std::size_t i = 0; i < n; ++i) {
+                    b[i] = -b[i];
+                }
+                break;
+
+            case OpCode::NOT:
+                for (std::size_t i = 0; i < n; ++i) {
+                    b[i] = b[i] == 0.0;
+                }
+                break;
+
+            case OpCode::ADD:
+                for (std::size_t i = 0; i < n; ++i) {
+                    a[i] += b[i];
+                }
+                next = b;
+                break;
+
+            case OpCode::SUBTRACT:
+                for (std::size_t i = 0; i < n; ++i) {
+                    a[i] -= b[i];
+                }
+                next = b;
+                break;
+
+            case OpCode::MULTIPLY:
+                for (std::size_t i = 0; i < n; ++i) {
+                    a[i] *= b[i];
+                }
+                next = b;
+                break;
+
+            case OpCode::DIVIDE:
+                for (std::size_t i = 0; i < n; ++i) {
+                    a[i] /= b[i];
+                }
+                next = b;
+                break;
+
+            case OpCode::MODULO:
+                // python semantics: the result has the sign of the divisor
+                for (std::size_t i = 0; i < n; ++i) {
+                    double r = std::fmod(a[i], b[i]);
+                    a[i] = (r != 0.0 && ((r < 0.0) != (b[i] < 0.0)))
+                         ? r + b[i] : r;
+                }
+                next = b;
+                break;
+
+            case OpCode::POWER:
+                for (std::size_t i = 0; i < n; ++i) {
+                    a[i] = std::pow(a[i], b[i]);
+                }
+                next = b;
+                break;
+
+            case OpCode::LESS:
+                for (std::size_t i = 0; i < n; ++i) {
+                    a[i] = a[i] < b[i];
+                }
+                next = b;
+                break;
+
+            case OpCode::LESS_EQUAL:
+                for (std::size_t i = 0; i < n; ++i) {
+                    a[i] = a[i] <= b[i];
+                }
+                next = b;
+                break;
+
+            case OpCode::GREATER:
+                for (std::size_t i = 0; i < n; ++i) {
+                    a[i] = a[i] > b[i];
+                }
+                next = b;
+                break;
+
+            case OpCode::GREATER_EQUAL:
+                for (std::size_t i = 0; i < n; ++i) {
+                    a[i] = a[i] >= b[i];
+                }
+                next = b;
+                break;
+
+            case OpCode::EQUAL:
+                for (std::size_t i = 0; i < n; ++i) {
+                    a[i] = a[i] == b[i];
+                }
+                next = b;
+                break;
+
+            case OpCode::NOT_EQUAL:
+                for (std::size_t i = 0; i < n; ++i) {
+                    a[i] = a[i] != b[i];
+                }
+                next = b;
+                break;
+
+            case OpCode::AND:
+                for (std::size_t i = 0; i < n; ++i) {
+                    a[i] = (a[i] != 0.0) & (b[i] != 0.0);
+                }
+                next = b;
+                break;
+
+            case OpCode::OR:
+                for (std::size_t i = 0; i < n; ++i) {
+                    a[i] = (a[i] != 0.0) | (b[i] != 0.0);
+                }
+                next = b;
+                break;
+
+            case OpCode::IN: {
+                const double * members = mConstants.data() + ins.arg;
+                for (std::size_t i = 0; i < n; ++i) {
+                    bool found = false;
+                    for (std::uint32_t k = 0; k < ins.count; ++k) {
+                        found |= b[i] == members[k];
+                    }
+                    b[i] = found;
+                }
+                break;
+            }
+
+            case OpCode::FUNCTION1:
+                for (std::size_t i = 0; i < n; ++i) {
+                    switch (ins.arg) {
+                        case SQRT: b[i] = std::sqrt(b[i]); break;
+                        case ABS: b[i] = std::fabs(b[i]); break;
+                        case EXP: b[i] = std::exp(b[i]); break;
+                        case LOG: b[i] = std::log(b[i]); break;
+                        case LOG10: b[i] = std::log10(b[i]); break;
+                        case SIN: b[i] = std::sin(b[i]); break;
+                        case COS: b[i] = std::cos(b[i]); break;
+                        case TAN: b[i] = std::tan(b[i]); break;
+                        case ASIN: b[i] = std::asin(b[i]); break;
+                        case ACOS: b[i] = std::acos(b[i]); break;
+                        case ATAN: b[i] = std::atan(b[i]); break;
+                        case MASS: b[i] = particleMass(b[i]); break;
+                        default: break;
+                    }
+                }
+                break;
+
+            case OpCode::FUNCTION2:
+                for (std::size_t i = 0; i < n; ++i) {
+                    switch (ins.arg) {
+                        case ATAN2: a[i] = std::atan2(a[i], b[i]); break;
+                        case POW: a[i] = std::pow(a[i], b[i]); break;
+                        case HYPOT: a[i] = std::hypot(a[i], b[i]); break;
+                        case MIN: a[i] = std::fmin(a[i], b[i]); break;
+                        case MAX: a[i] = std::fmax(a[i], b[i]); break;
+                        default: break;
+                    }
+                }
+                next = b;
+                break;
+        }
+    }
+
+    for (std::size_t i = 0; i < n; ++i) {
+        result[i] = stack[i];
+    }
+}
@@ -0,0 +1,107 @@
+/** \file
+ * Compiler and evaluator for arithmetic and logical expressions on numeric
+ * record variables.
+ */
+#ifndef __EXPRESSION_H__
+#define __EXPRESSION_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+
+/** Arithmetic and logical expression compiled into stack bytecode.
+ *
+ * The syntax follows python expressions:
+ * - numbers, True, False and the constants pi, MeV, GeV, TeV, PeV, EeV
+ *   (energies in GeV)
+ * - variables that are given during compilation, e.g. energy or
+ *   post.energy
+ * - arithmetic: +, -, *, /, %, ** and unary -
+ * - comparisons: <, <=, >, >=, ==, != (not chained) and x in (1, 2, ...)
+ *   or x not in (...) with constant members
+ * - logic: and, or, not (both operands are always evaluated)
+ * - functions: sqrt, abs, exp, log, log10, sin, cos, tan, asin, acos, atan,
+ *   atan2, pow, hypot, min, max and mass(particleID), which returns the rest
+ *   mass in GeV of a CORSIKA particle ID or nan for unknown IDs.
+ *
+ * Logical results are 1.0 (true) or 0.0 (false); every non-zero value is
+ * considered true. Evaluation is done on blocks of up to BLOCK records at
+ * once such that every instruction runs as a tight loop over the block.
+ */
+class Expression {
+
+    // interface types
+    public:
+        /** Maximum number of records per call to evaluate(...). */
+        static constexpr std::size_t BLOCK = 64;
+
+
+    // internal types
+    private:
+        enum class OpCode : std::uint8_t {
+            CONSTANT, VARIABLE,
+            NEGATE, NOT,
+            ADD, SUBTRACT, MULTIPLY, DIVIDE, MODULO, POWER,
+            LESS, LESS_EQUAL, GREATER, GREATER_EQUAL, EQUAL, NOT_EQUAL,
+            AND, OR, IN,
+            FUNCTION1, FUNCTION2
+        };
+
+        struct Instruction {
+            OpCode op;
+            std::uint32_t arg;
+            std::uint32_t count;
+        };
+
+        class Parser;
+
+
+    // members
+    private:
+        std::string mSource;
+        std::vector<Instruction> mCode;
+        std::vector<double> mConstants;
+        std::size_t mStackDepth = 0;
+        mutable std::vector<double> mStack;
+
+
+    // public functions
+    public:
+        /** Construct an empty expression. */
+        Expression() = default;
+
+        /** Compile an expression.
+         *
+         * Throws a std::invalid_argument with a description of the first
+         * syntax error.
+         *
+         * @param source Expression in python syntax.
+         * @param variables Map of variable names to their index in the
+         * columns given to evaluate(...).
+         */
+        Expression(const std::string & source,
+                   const std::map<std::string, std::size_t> & variables);
+
+        /** Get the source of the compiled expression. */
+        const std::string & getSource() const;
+
+        /** Indicate if no expression is compiled. */
+        bool isEmpty() const;
+
+        /** Evaluate the expression for a block of records.
+         *
+         * @param columns Pointer per variable index to the values of the n
+         * records.
+         * @param n Number of records, at most BLOCK.
+         * @param result Output for the n results.
+         */
+        void evaluate(const double * const * columns, std::size_t n,
+                      double * result) const;
+
+};
+
+
+#endif
@@ -0,0 +1,208 @@
+#include "Histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+Histogram::Histogram(const std::vector<Axis> & axes,
+                     const std::string & weight, const std::string & filter,
+                     const std::map<std::string, std::size_t> & variables)
+    : mAxes(axes)
+{
+    if (axes.empty() || axes.size() > MAX_AXES) {
+        throw std::invalid_argument("histograms have 1 to 3 axes");
+    }
+
+    std::size_t size = 1;
+    for (auto & axis : mAxes) {
+        setupAxis(axis);
+        mAxisExpressions.emplace_back(axis.expression, variables);
+        mShape.push_back(axis.bins + 2);
+        size *= axis.bins + 2;
+    }
+
+    if (!weight.empty()) {
+        mWeight = Expression(weight, variables);
+    }
+    if (!filter.empty()) {
+        mFilter = Expression(filter, variables);
+    }
+
+    mStrides.resize(mShape.size());
+    std::size_t stride = 1;
+    for (std::size_t i = mShape.size(); i-- > 0;) {
+        mStrides[i] = stride;
+        stride *= mShape[i];
+    }
+
+    mSumW.assign(size, 0.0);
+    mSumW2.assign(size, 0.0);
+    mValues.resize(Expression::BLOCK);
+    mWeights.resize(Expression::BLOCK);
+    mAccepted.resize(Expression::BLOCK);
+    mIndices.resize(Expression::BLOCK);
+}
+
+
+void Histogram::setupAxis(Axis & axis) {
+    if (axis.binning == Binning::VARIABLE) {
+        if (axis.edges.size() < 2) {
+            throw std::invalid_argument("variable binning requires at least "
+                                        "two edges");
+        }
+        for (std::size_t i = 1; i < axis.edges.size(); ++i) {
+            if (!(axis.edges[i] > axis.edges[i - 1])) {
+                throw std::invalid_argument("bin edges have to be strictly "
+                                            "increasing");
+            }
+        }
+
+        axis.bins = axis.edges.size() - 1;
+        axis.lower = axis.edges.front();
+        axis.upper = axis.edges.back();
+        return;
+    }
+
+    if (axis.bins == 0 || !(axis.upper > axis.lower) ||
+        !std::isfinite(axis.lower) || !std::isfinite(axis.upper)) {
+        throw std::invalid_argument("binning requires bins > 0 and a finite "
+                                    "range with lower < upper");
+    }
+
+    if (axis.binning == Binning::LOG && !(axis.lower > 0.0)) {
+        throw std::invalid_argument("log binning requires lower > 0");
+    }
+
+    axis.edges.resize(axis.bins + 1);
+    for (std::size_t i = 0; i <= axis.bins; ++i) {
+        const double fraction = static_cast<double>(i) / axis.bins;
+        axis.edges[i] = axis.binning == Binning::LOG
+            ? axis.lower * std::pow(axis.upper / axis.lower, fraction)
+            : axis.lower + (axis.upper - axis.lower) * fraction;
+    }
+}
+
+
+void Histogram::fill(const double * const * columns, std::size_t n) {
+    if (mFilter.isEmpty()) {
+        std::fill_n(mAccepted.begin(), n, 1.0);
+    }
+    else {
+        mFilter.evaluate(columns, n, mAccepted.data());
+    }
+
+    if (mWeight.isEmpty()) {
+        std::fill_n(mWeights.begin(), n, 1.0);
+    }
+    else {
+        mWeight.evaluate(columns, n, mWeights.data());
+    }
+
+    std::fill_n(mIndices.begin(), n, 0);
+    for (std::size_t axis = 0; axis < mAxes.size(); ++axis) {
+        mAxisExpressions[axis].evaluate(columns, n, mValues.data());
+        addBinIndices(axis, n);
+    }
+
+    for (std::size_t i = 0; i < n; ++i) {
+        if (mAccepted[i] == 0.0) {
+            continue;
+        }
+
+        const double w = mWeights[i];
+        mSumW[mIndices[i]] += w;
+        mSumW2[mIndices[i]] += w * w;
+        ++mEntries;
+    }
+}
+
+
+void Histogram::addBinIndices(std::size_t axis, std::size_t n) {
+    const Axis & definition = mAxes[axis];
+    const std::size_t stride = mStrides[axis];
+    const double bins = static_cast<double>(definition.bins);
+    double * values = mValues.data();
+    double * accepted = mAccepted.data();
+    std::size_t * indices = mIndices.data();
+
+    for (std::size_t i = 0; i < n; ++i) {
+        if (std::isnan(values[i])) {
+            accepted[i] = 0.0;
+            values[i] = 0.0;
+        }
+    }
+
+    if (definition.binning == Binning::VARIABLE) {
+        const auto & edges = definition.edges;
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::size_t bin = std::upper_bound(
+                    edges.begin(), edges.end(), values[i]) - edges.begin();
+            indices[i] += stride * bin;
+        }
+        return;
+    }
+
+    // branch-free position in units of bins; the loop vectorizes for fixed
+    // binning
+    double offset = definition.lower;
+    double scale = bins / (definition.upper - definition.lower);
+    if (definition.binning == Binning::LOG) {
+        offset = std::log(definition.lower);
+        scale = bins / (std::log(definition.upper) - offset);
+        for (std::size_t i = 0; i < n; ++i) {
+            values[i] = values[i] > 0.0 ? std::log(values[i]) : -HUGE_VAL;
+        }
+    }
+
+    for (std::size_t i = 0; i < n; ++i) {
+        // clamp to [-1, bins] before the conversion to avoid overflow
+        double position = (values[i] - offset) * scale;
+        position = position < -1.0 ? -1.0 : position;
+        position = position > bins ? bins : position;
+        const std::size_t bin =
+            static_cast<std::size_t>(std::floor(position) + 1.0);
+        indices[i] += stride * bin;
+    }
+}
+
+
+void Histogram::reset() {
+    std::fill(mSumW.begin(), mSumW.end(), 0.0);
+    std::fill(mSumW2.begin(), mSumW2.end(), 0.0);
+    mEntries = 0;
+}
+
+
+const std::vector<Histogram::Axis> & Histogram::getAxes() const {
+    return mAxes;
+}
+
+const std::string & Histogram::getWeight() const {
+    return mWeight.getSource();
+}
+
+const std::string & Histogram::getFilter() const {
+    return mFilter.getSource();
+}
+
+const std::vector<std::size_t> & Histogram::getShape() const {
+    return mShape;
+}
+
+const std::vector<double> & Histogram::getSumW() const {
+    return mSumW;
+}
+
+const std::vector<double> & Histogram::getSumW2() const {
+    return mSumW2;
+}
+
+std::uint64_t Histogram::getEntries() const {
+    return mEntries;
+}
@@ -0,0 +1,125 @@
+/** \file
+ * Weighted histograms of up to three dimensions that are filled natively
+ * from blocks of record variables.
+ */
+#ifndef __HISTOGRAM_H__
+#define __HISTOGRAM_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Expression.h"
+
+
+/** Histogram whose axis values, weight and selection are expressions of
+ * record variables (see Expression and RecordFilter).
+ *
+ * Every axis has an underflow bin (index 0) and an overflow bin (index
+ * bins + 1). Contents are stored in C order with the first axis varying
+ * slowest, as sum of weights and sum of squared weights. Records with a nan
+ * axis value are not filled.
+ */
+class Histogram {
+
+    // interface types
+    public:
+        /** Bin edge layout of an axis. */
+        enum class Binning {
+            FIXED,   /**< Equal width bins between lower and upper. */
+            LOG,     /**< Equal width bins in log(x) between lower and upper. */
+            VARIABLE /**< Arbitrary increasing edges. */
+        };
+
+        /** Definition of an axis. */
+        struct Axis {
+            std::string expression;
+            Binning binning = Binning::FIXED;
+            std::size_t bins = 1;
+            double lower = 0.0;
+            double upper = 1.0;
+            std::vector<double> edges;
+        };
+
+        /** Maximum number of axes. */
+        static constexpr std::size_t MAX_AXES = 3;
+
+
+    // members
+    private:
+        std::vector<Axis> mAxes;
+        std::vector<Expression> mAxisExpressions;
+        Expression mWeight;
+        Expression mFilter;
+        std::vector<std::size_t> mShape;
+        std::vector<std::size_t> mStrides;
+        std::vector<double> mSumW;
+        std::vector<double> mSumW2;
+        std::uint64_t mEntries = 0;
+
+        std::vector<double> mValues;
+        std::vector<double> mWeights;
+        std::vector<double> mAccepted;
+        std::vector<std::size_t> mIndices;
+
+
+    // public functions
+    public:
+        /** Compile the expressions and allocate the contents.
+         *
+         * Throws a std::invalid_argument for invalid binning or
+         * expressions. For FIXED and LOG axes the edges are computed, for
+         * VARIABLE axes bins and the range follow from the edges.
+         *
+         * @param axes One to three axis definitions.
+         * @param weight Weight expression; empty = 1.
+         * @param filter Selection expression; empty = all records.
+         * @param variables Variable names of the records.
+         */
+        Histogram(const std::vector<Axis> & axes, const std::string & weight,
+                  const std::string & filter,
+                  const std::map<std::string, std::size_t> & variables);
+
+        /** Fill a block of records.
+         *
+         * @param columns Variable columns of the block.
+         * @param n Number of records, at most Expression::BLOCK.
+         */
+        void fill(const double * const * columns, std::size_t n);
+
+        /** Set all contents to zero. */
+        void reset();
+
+        /** Get the axis definitions including the edges. */
+        const std::vector<Axis> & getAxes() const;
+
+        /** Get the weight expression; empty = 1. */
+        const std::string & getWeight() const;
+
+        /** Get the selection expression; empty = all records. */
+        const std::string & getFilter() const;
+
+        /** Get the number of bins including under- and overflow per axis. */
+        const std::vector<std::size_t> & getShape() const;
+
+        /** Get the sum of weights per bin. */
+        const std::vector<double> & getSumW() const;
+
+        /** Get the sum of squared weights per bin. */
+        const std::vector<double> & getSumW2() const;
+
+        /** Get the number of filled records. */
+        std::uint64_t getEntries() const;
+
+
+    // private functions
+    private:
+        static void setupAxis(Axis & axis);
+        void addBinIndices(std::size_t axis, std::size_t n);
+
+};
+
+
+#endif
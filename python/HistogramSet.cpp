@@ -0,0 +1,67 @@
+#include "HistogramSet.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ParticleDecoder.h"
+
+
+HistogramSet::HistogramSet(RecordFilter::RecordType type)
+    : mRecords(type)
+{}
+
+
+std::size_t HistogramSet::add(const std::vector<Histogram::Axis> & axes,
+                              const std::string & weight,
+                              const std::string & filter) {
+    flush();
+    mHistograms.push_back(std::make_unique<Histogram>(
+            axes, weight, filter, mRecords.getVariableNames()));
+    mActive.store(true, std::memory_order_relaxed);
+    return mHistograms.size() - 1;
+}
+
+
+std::size_t HistogramSet::getSize() const {
+    return mHistograms.size();
+}
+
+
+Histogram & HistogramSet::get(std::size_t index) {
+    return *mHistograms.at(index);
+}
+
+
+void HistogramSet::fill(const CREAL * DataSubBlock, int entries) {
+    if (!ParticleDecoder::isParticleSubBlock(DataSubBlock)) {
+        return;
+    }
+
+    for (int i = 0; i < 39; ++i) {
+        const CREAL * line = DataSubBlock + i * entries;
+        if (line[0] == 0) {
+            continue;
+        }
+
+        mRecords.load(mPending, line, entries);
+        if (++mPending == Expression::BLOCK) {
+            flush();
+        }
+    }
+}
+
+
+void HistogramSet::flush() {
+    if (mPending == 0) {
+        return;
+    }
+
+    const double * const * columns = mRecords.getColumns();
+    for (auto & histogram : mHistograms) {
+        histogram->fill(columns, mPending);
+    }
+    mPending = 0;
+}
+
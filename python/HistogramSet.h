@@ -0,0 +1,99 @@
+/** \file
+ * Collection of native histograms that are filled from one kind of COAST
+ * record.
+ */
+#ifndef __HISTOGRAMSET_H__
+#define __HISTOGRAMSET_H__
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <crs/CorsikaTypes.h>
+#include <crs/CInteraction.h>
+#include <crs/CParticle.h>
+
+#include "Histogram.h"
+#include "RecordFilter.h"
+
+
+/** Histograms of track, interaction or subblock particle records.
+ *
+ * Records are collected in blocks of Expression::BLOCK rows and every
+ * histogram is filled once per block. Call flush() before reading contents.
+ * Histograms are never removed such that their contents stay at a fixed
+ * memory location.
+ */
+class HistogramSet {
+
+    // members
+    private:
+        RecordFilter mRecords;
+        std::vector<std::unique_ptr<Histogram>> mHistograms;
+        std::size_t mPending = 0;
+        std::atomic<bool> mActive{false};
+
+
+    // public functions
+    public:
+        /** Construct an empty set for the given record type. */
+        explicit HistogramSet(RecordFilter::RecordType type);
+
+        /** Add a histogram.
+         *
+         * Throws a std::invalid_argument for invalid binning or
+         * expressions (see Histogram).
+         *
+         * @return Index of the histogram in the set.
+         */
+        std::size_t add(const std::vector<Histogram::Axis> & axes,
+                        const std::string & weight,
+                        const std::string & filter);
+
+        /** Get the number of histograms. */
+        std::size_t getSize() const;
+
+        /** Get a histogram; pending records are not filled yet. */
+        Histogram & get(std::size_t index);
+
+        /** Indicate if at least one histogram exists; may be called from
+         * any thread. */
+        bool isActive() const {
+            return mActive.load(std::memory_order_relaxed);
+        }
+
+        /** Fill a track. */
+        void fill(const crs::CParticle & pre, const crs::CParticle & post) {
+            mRecords.load(mPending, pre, post);
+            if (++mPending == Expression::BLOCK) {
+                flush();
+            }
+        }
+
+        /** Fill an interaction. */
+        void fill(const crs::CInteraction & info) {
+            mRecords.load(mPending, info);
+            if (++mPending == Expression::BLOCK) {
+                flush();
+            }
+        }
+
+        /** Fill all particles of a CORSIKA subblock.
+         *
+         * Header and trailer subblocks (RUNH, EVTH, LONG, EVTE, RUNE) and
+         * empty particle lines are skipped.
+         *
+         * @param DataSubBlock 39 particle lines.
+         * @param entries Entries per line (8 thinned, 7 not thinned).
+         */
+        void fill(const CREAL * DataSubBlock, int entries);
+
+        /** Fill all pending records into the histograms. */
+        void flush();
+
+};
+
+
+#endif
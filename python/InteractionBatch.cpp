@@ -0,0 +1,91 @@
+#include "InteractionBatch.h"
+
+#include <cstddef>
+#include <vector>
+
+
+void InteractionBatch::InteractionColumns::resize(std::size_t size) {
+    x.resize(size);
+    y.resize(size);
+    z.resize(size);
+    etot.resize(size);
+    sigma.resize(size);
+    kela.resize(size);
+    projId.resize(size);
+    targetId.resize(size);
+}
+
+void InteractionBatch::InteractionColumns::set(
+        std::size_t index, const crs::CInteraction & info) {
+    x[index] = info.x;
+    y[index] = info.y;
+    z[index] = info.z;
+    etot[index] = info.etot;
+    sigma[index] = info.sigma;
+    kela[index] = info.kela;
+    projId[index] = info.projId;
+    targetId[index] = info.targetId;
+}
+
+
+void InteractionBatch::setCapacity(std::size_t capacity) {
+    mColumns.resize(capacity);
+    mDerived.resize(mDerivedCount * capacity);
+    mSize = 0;
+}
+
+std::size_t InteractionBatch::getCapacity() const {
+    return mColumns.x.size();
+}
+
+std::size_t InteractionBatch::getSize() const {
+    return mSize;
+}
+
+bool InteractionBatch::isEmpty() const {
+    return mSize == 0;
+}
+
+bool InteractionBatch::isFull() const {
+    return mSize >= getCapacity();
+}
+
+
+void InteractionBatch::push(const crs::CInteraction & info) {
+    mColumns.set(mSize, info);
+    ++mSize;
+}
+
+void InteractionBatch::push(const crs::CInteraction & info,
+                            const double * derived) {
+    const std::size_t capacity = getCapacity();
+    for (std::size_t k = 0; k < mDerivedCount; ++k) {
+        mDerived[k * capacity + mSize] = derived[k];
+    }
+    push(info);
+}
+
+void InteractionBatch::clear() {
+    mSize = 0;
+}
+
+
+void InteractionBatch::setDerivedCount(std::size_t count) {
+    mDerivedCount = count;
+    mDerived.resize(mDerivedCount * getCapacity());
+    mSize = 0;
+}
+
+std::size_t InteractionBatch::getDerivedCount() const {
+    return mDerivedCount;
+}
+
+const double * InteractionBatch::getDerived(std::size_t column) const {
+    return mDerived.data() + column * getCapacity();
+}
+
+
+const InteractionBatch::InteractionColumns &
+InteractionBatch::getColumns() const {
+    return mColumns;
+}
@@ -0,0 +1,110 @@
+/** \file
+ * Column buffers that collect COAST interaction_(...) calls for batched
+ * delivery.
+ */
+#ifndef __INTERACTIONBATCH_H__
+#define __INTERACTIONBATCH_H__
+
+#include <cstddef>
+#include <vector>
+
+#include <crs/CInteraction.h>
+
+
+/** Preallocated structure-of-arrays storage for particle interactions.
+ *
+ * Every member of crs::CInteraction is stored in its own column. Column memory
+ * is only allocated in setCapacity(...) such that pointers to the column data
+ * stay valid until the capacity changes.
+ */
+class InteractionBatch {
+
+    // interface types
+    public:
+        /** One column per crs::CInteraction member. */
+        struct InteractionColumns {
+            std::vector<double> x;
+            std::vector<double> y;
+            std::vector<double> z;
+            std::vector<double> etot;
+            std::vector<double> sigma;
+            std::vector<double> kela;
+            std::vector<int> projId;
+            std::vector<int> targetId;
+
+            /** Resize all columns to the given number of entries. */
+            void resize(std::size_t size);
+
+            /** Store an interaction at the given row. */
+            void set(std::size_t index, const crs::CInteraction & info);
+        };
+
+
+    // members
+    private:
+        std::size_t mSize = 0;
+        std::size_t mDerivedCount = 0;
+        std::vector<double> mDerived;
+        InteractionColumns mColumns;
+
+
+    // public functions
+    public:
+        /** Set the number of interactions that fit into the batch.
+         *
+         * Discards all stored interactions.
+         */
+        void setCapacity(std::size_t capacity);
+
+        /** Get the number of interactions that fit into the batch. */
+        std::size_t getCapacity() const;
+
+        /** Get the number of currently stored interactions. */
+        std::size_t getSize() const;
+
+        /** Indicate if no interaction is stored. */
+        bool isEmpty() const;
+
+        /** Indicate if no further interaction fits into the batch. */
+        bool isFull() const;
+
+        /** Append an interaction.
+         *
+         * The caller has to make sure that the batch is not full.
+         *
+         * @param info COAST interaction information.
+         */
+        void push(const crs::CInteraction & info);
+
+        /** Append an interaction together with its derived values.
+         *
+         * The caller has to make sure that the batch is not full.
+         *
+         * @param info COAST interaction information.
+         * @param derived getDerivedCount() values of derived columns.
+         */
+        void push(const crs::CInteraction & info, const double * derived);
+
+        /** Discard all stored interactions but keep the allocated memory. */
+        void clear();
+
+        /** Set the number of derived columns that are stored in addition to
+         * the COAST information.
+         *
+         * Discards all stored interactions.
+         */
+        void setDerivedCount(std::size_t count);
+
+        /** Get the number of derived columns. */
+        std::size_t getDerivedCount() const;
+
+        /** Get the values of a derived column. */
+        const double * getDerived(std::size_t column) const;
+
+        /** Get the interaction columns. */
+        const InteractionColumns & getColumns() const;
+
+};
+
+
+#endif
@@ -0,0 +1,95 @@
+#include "InterfaceStats.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+
+const char * InterfaceStats::getName(Callback callback) {
+    switch (callback) {
+        case Callback::INIT:
+            return "init";
+        case Callback::WRITE:
+            return "write";
+        case Callback::INTERACTION:
+            return "interaction";
+        case Callback::TRACK:
+            return "track";
+        case Callback::CLOSE:
+            return "close";
+        case Callback::SHOWER_BEGIN:
+            return "shower_begin";
+        case Callback::SHOWER_END:
+            return "shower_end";
+        case Callback::PARTICLES:
+            return "write_particles";
+        case Callback::CROSSINGS:
+            return "crossings";
+    }
+
+    return "unknown";
+}
+
+
+InterfaceStats::Snapshot InterfaceStats::getSnapshot(
+        Callback callback) const {
+    const Counters & counters = mCounters[static_cast<std::size_t>(callback)];
+
+    Snapshot snapshot;
+    snapshot.calls = counters.calls.load(std::memory_order_relaxed);
+    snapshot.captured = counters.captured.load(std::memory_order_relaxed);
+    snapshot.bytes = counters.bytes.load(std::memory_order_relaxed);
+    snapshot.pythonCalls =
+        counters.pythonCalls.load(std::memory_order_relaxed);
+    snapshot.pythonNanoseconds =
+        counters.pythonNanoseconds.load(std::memory_order_relaxed);
+    for (std::size_t i = 0; i < LATENCY_BUCKETS; ++i) {
+        snapshot.latency[i] =
+            counters.latency[i].load(std::memory_order_relaxed);
+    }
+
+    return snapshot;
+}
+
+
+void InterfaceStats::writeSummary(const std::string & path) const {
+    std::FILE * file = std::fopen(path.c_str(), "w");
+    if (file == NULL) {
+        throw std::runtime_error("cannot create stats file " + path);
+    }
+
+    std::fprintf(file, "{\n");
+    for (std::size_t i = 0; i < CALLBACKS; ++i) {
+        const Callback callback = static_cast<Callback>(i);
+        const Snapshot snapshot = getSnapshot(callback);
+
+        std::fprintf(file,
+                     "  \"%s\": {\"calls\": %llu, \"captured\": %llu, "
+                     "\"skipped\": %llu, \"bytes\": %llu, "
+                     "\"python_calls\": %llu, \"python_ns\": %llu, "
+                     "\"latency_ns_log2\": [",
+                     getName(callback),
+                     static_cast<unsigned long long>(snapshot.calls),
+                     static_cast<unsigned long long>(snapshot.captured),
+                     static_cast<unsigned long long>(
+                         snapshot.calls - snapshot.captured),
+                     static_cast<unsigned long long>(snapshot.bytes),
+                     static_cast<unsigned long long>(snapshot.pythonCalls),
+                     static_cast<unsigned long long>(
+                         snapshot.pythonNanoseconds));
+        for (std::size_t bucket = 0; bucket < LATENCY_BUCKETS; ++bucket) {
+            std::fprintf(file, bucket == 0 ? "%llu" : ", %llu",
+                         static_cast<unsigned long long>(
+                             snapshot.latency[bucket]));
+        }
+        std::fprintf(file, "]}%s\n", i + 1 < CALLBACKS ? "," : "");
+    }
+    std::fprintf(file, "}\n");
+
+    const bool failed = std::ferror(file) != 0;
+    if (std::fclose(file) != 0 || failed) {
+        throw std::runtime_error("cannot write stats file " + path);
+    }
+}
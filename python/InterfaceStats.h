@@ -0,0 +1,158 @@
+/** \file
+ * Counters and latency histograms of the COAST callbacks.
+ */
+#ifndef __INTERFACESTATS_H__
+#define __INTERFACESTATS_H__
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+
+/** Low-overhead instrumentation of the interface.
+ *
+ * Counts calls, captured calls and record bytes per callback and collects
+ * the time spent in python calls in histograms with logarithmic buckets.
+ * Every counter has a single writing thread (the CORSIKA thread for call
+ * counts, the thread that calls python for latencies and the counts of
+ * showers, particles and crossings) and can be read from any thread.
+ *
+ * Compiled with USE_INTERFACE_STATS; otherwise ENABLED is false and all
+ * recording functions are empty.
+ */
+class InterfaceStats {
+
+    // interface types
+    public:
+        /** Instrumented COAST callback. */
+        enum class Callback {
+            INIT,         /**< inida_(...) */
+            WRITE,        /**< wrida_(...) */
+            INTERACTION,  /**< interaction_(...) */
+            TRACK,        /**< track_(...) */
+            CLOSE,        /**< cloda_() */
+            SHOWER_BEGIN, /**< EVTH subblock, shower_begin(...) */
+            SHOWER_END,   /**< EVTE subblock, shower_end(...) */
+            PARTICLES,    /**< decoded particles, write_particles(...) */
+            CROSSINGS     /**< surface crossings, crossings(...) */
+        };
+
+        /** Number of callbacks. */
+        static constexpr std::size_t CALLBACKS = 9;
+
+        /** Number of latency buckets; bucket i counts python calls that took
+         * [2^i, 2^(i+1)) ns, the last bucket all longer calls. */
+        static constexpr std::size_t LATENCY_BUCKETS = 32;
+
+#ifdef USE_INTERFACE_STATS
+        static constexpr bool ENABLED = true;
+#else
+        static constexpr bool ENABLED = false;
+#endif
+
+        /** Copy of the counters of a callback. */
+        struct Snapshot {
+            std::uint64_t calls = 0;
+            std::uint64_t captured = 0;
+            std::uint64_t bytes = 0;
+            std::uint64_t pythonCalls = 0;
+            std::uint64_t pythonNanoseconds = 0;
+            std::array<std::uint64_t, LATENCY_BUCKETS> latency = {};
+        };
+
+
+    // internal types
+    private:
+        using Counter = std::atomic<std::uint64_t>;
+
+        struct Counters {
+            Counter calls{0};
+            Counter captured{0};
+            Counter bytes{0};
+            Counter pythonCalls{0};
+            Counter pythonNanoseconds{0};
+            std::array<Counter, LATENCY_BUCKETS> latency{};
+        };
+
+
+    // members
+    private:
+        std::array<Counters, CALLBACKS> mCounters;
+
+
+    // public functions
+    public:
+        /** Get the name of a callback. */
+        static const char * getName(Callback callback);
+
+        /** Get a monotonic timestamp in ns; 0 if disabled. */
+        static std::uint64_t now() {
+            if constexpr (!ENABLED) {
+                return 0;
+            }
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch())
+                .count();
+        }
+
+        /** Count a COAST call.
+         *
+         * @param callback Called function.
+         * @param captured Indicates if the call is passed on to python.
+         * @param bytes Size of the record.
+         */
+        void count(Callback callback, bool captured, std::size_t bytes) {
+            if constexpr (ENABLED) {
+                Counters & counters = get(callback);
+                increment(counters.calls, 1);
+                increment(counters.captured, captured);
+                increment(counters.bytes, bytes);
+            }
+        }
+
+        /** Record the duration of a python call that started at start
+         * (see now()). */
+        void addLatency(Callback callback, std::uint64_t start) {
+            if constexpr (ENABLED) {
+                const std::uint64_t duration = now() - start;
+                Counters & counters = get(callback);
+                increment(counters.pythonCalls, 1);
+                increment(counters.pythonNanoseconds, duration);
+                increment(counters.latency[getBucket(duration)], 1);
+            }
+        }
+
+        /** Copy the counters of a callback. */
+        Snapshot getSnapshot(Callback callback) const;
+
+        /** Write all counters as JSON object into a file.
+         *
+         * Throws a std::runtime_error if the file cannot be written.
+         */
+        void writeSummary(const std::string & path) const;
+
+
+    // private functions
+    private:
+        Counters & get(Callback callback) {
+            return mCounters[static_cast<std::size_t>(callback)];
+        }
+
+        static void increment(Counter & counter, std::uint64_t value) {
+            // single writer, so no read-modify-write instruction is needed
+            counter.store(counter.load(std::memory_order_relaxed) + value,
+                          std::memory_order_relaxed);
+        }
+
+        static std::size_t getBucket(std::uint64_t duration) {
+            const std::size_t bucket = 63 - __builtin_clzll(duration | 1);
+            return bucket < LATENCY_BUCKETS ? bucket : LATENCY_BUCKETS - 1;
+        }
+
+};
+
+
+#endif
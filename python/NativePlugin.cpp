@@ -0,0 +1,198 @@
+#include "NativePlugin.h"
+
+#include <dlfcn.h>
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+#include "ShowerBoundary.h"
+
+
+namespace {
+
+int toPluginOption(CorsikaConfig::CorsikaOption option) {
+    switch (option) {
+        case CorsikaConfig::CorsikaOption::TRUE:
+            return 1;
+        case CorsikaConfig::CorsikaOption::FALSE:
+            return 0;
+        default:
+            return -1;
+    }
+}
+
+}
+
+
+NativePlugin::NativePlugin(const std::string & path)
+    : mPath(path)
+{
+    mHandle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (mHandle == NULL) {
+        throw std::runtime_error(std::string("cannot load plugin ") +
+                                 dlerror());
+    }
+
+    auto entry = reinterpret_cast<CoastPluginEntry>(
+            dlsym(mHandle, COAST_PLUGIN_ENTRY));
+    if (entry == NULL || (mPlugin = entry()) == NULL) {
+        dlclose(mHandle);
+        throw std::runtime_error("plugin " + path + " does not export " +
+                                 COAST_PLUGIN_ENTRY + "()");
+    }
+
+    if (mPlugin->abiVersion != COAST_PLUGIN_ABI_VERSION) {
+        dlclose(mHandle);
+        throw std::runtime_error(
+                "plugin " + path + " has ABI version " +
+                std::to_string(mPlugin->abiVersion) + " instead of " +
+                std::to_string(COAST_PLUGIN_ABI_VERSION));
+    }
+
+    if (mPlugin->batchSize > 0) {
+        mBatchSize = mPlugin->batchSize;
+    }
+    if (mPlugin->trackBatch != NULL) {
+        mPre.reserve(mBatchSize);
+        mPost.reserve(mBatchSize);
+    }
+    if (mPlugin->interactionBatch != NULL) {
+        mInteractions.reserve(mBatchSize);
+    }
+}
+
+
+NativePlugin::~NativePlugin() {
+    // errors cannot be reported any more
+    if (mInitialized && mPlugin->close != NULL) {
+        mPlugin->close(mState);
+    }
+    dlclose(mHandle);
+}
+
+
+const std::string & NativePlugin::getPath() const {
+    return mPath;
+}
+
+
+std::string NativePlugin::getName() const {
+    return mPlugin->name != NULL ? mPlugin->name : mPath;
+}
+
+
+bool NativePlugin::needsWrite() const {
+    // batches are delivered before the end of every shower
+    return mPlugin->write != NULL || mPlugin->trackBatch != NULL ||
+           mPlugin->interactionBatch != NULL;
+}
+
+
+bool NativePlugin::needsInteraction() const {
+    return mPlugin->interaction != NULL ||
+           mPlugin->interactionBatch != NULL;
+}
+
+
+bool NativePlugin::needsTrack() const {
+    return mPlugin->track != NULL || mPlugin->trackBatch != NULL;
+}
+
+
+void NativePlugin::init(const CorsikaConfig & config) {
+    const std::string filename = config.getFilename();
+    const CoastPluginConfig pluginConfig = {
+        filename.c_str(),
+        toPluginOption(config.getThinning()),
+        toPluginOption(config.getCurved()),
+        toPluginOption(config.getSlant()),
+        toPluginOption(config.getStackinput()),
+        toPluginOption(config.getPreshower())
+    };
+
+    if (mPlugin->init != NULL) {
+        check(mPlugin->init(&pluginConfig, &mState), "init");
+    }
+    mInitialized = true;
+}
+
+
+void NativePlugin::close() {
+    if (!mInitialized) {
+        return;
+    }
+
+    flush();
+    mInitialized = false;
+    if (mPlugin->close != NULL) {
+        check(mPlugin->close(mState), "close");
+    }
+}
+
+
+void NativePlugin::write(const CREAL * DataSubBlock, int entries) {
+    if (ShowerBoundary::getBlockType(DataSubBlock) ==
+            ShowerBoundary::BlockType::EVENT_END) {
+        flush();
+    }
+
+    if (mPlugin->write != NULL) {
+        check(mPlugin->write(mState, DataSubBlock, entries), "write");
+    }
+}
+
+
+void NativePlugin::interaction(const crs::CInteraction & info) {
+    if (mPlugin->interactionBatch != NULL) {
+        mInteractions.push_back(info);
+        if (mInteractions.size() >= mBatchSize) {
+            flush();
+        }
+    }
+    else if (mPlugin->interaction != NULL) {
+        check(mPlugin->interaction(mState, &info), "interaction");
+    }
+}
+
+
+void NativePlugin::track(const crs::CParticle & pre,
+                         const crs::CParticle & post) {
+    if (mPlugin->trackBatch != NULL) {
+        mPre.push_back(pre);
+        mPost.push_back(post);
+        if (mPre.size() >= mBatchSize) {
+            flush();
+        }
+    }
+    else if (mPlugin->track != NULL) {
+        check(mPlugin->track(mState, &pre, &post), "track");
+    }
+}
+
+
+void NativePlugin::flush() {
+    if (!mPre.empty()) {
+        const int status = mPlugin->trackBatch(mState, mPre.data(),
+                                               mPost.data(), mPre.size());
+        mPre.clear();
+        mPost.clear();
+        check(status, "trackBatch");
+    }
+
+    if (!mInteractions.empty()) {
+        const int status = mPlugin->interactionBatch(
+                mState, mInteractions.data(), mInteractions.size());
+        mInteractions.clear();
+        check(status, "interactionBatch");
+    }
+}
+
+
+void NativePlugin::check(int status, const char * callback) const {
+    if (status != 0) {
+        throw std::runtime_error("error " + std::to_string(status) +
+                                 " in plugin call to " + getName() + "::" +
+                                 callback + "()");
+    }
+}
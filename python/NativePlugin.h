@@ -0,0 +1,104 @@
+/** \file
+ * Native plugin loaded with dlopen.
+ */
+#ifndef __NATIVEPLUGIN_H__
+#define __NATIVEPLUGIN_H__
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <crs/CorsikaTypes.h>
+#include <crs/CInteraction.h>
+#include <crs/CParticle.h>
+
+#include "CoastPlugin.h"
+#include "CorsikaConfig.h"
+
+
+/** Shared library that implements the CoastPlugin ABI.
+ *
+ * Forwards the COAST calls to the callbacks of the plugin and collects
+ * tracks and interactions for its batch callbacks. Errors of the plugin
+ * are thrown as std::runtime_error.
+ */
+class NativePlugin {
+
+    // interface types
+    public:
+        /** Records per batch call if the plugin does not set batchSize. */
+        static constexpr std::size_t DEFAULT_BATCH_SIZE = 4096;
+
+
+    // members
+    private:
+        std::string mPath;
+        void * mHandle = NULL;
+        const CoastPlugin * mPlugin = NULL;
+        void * mState = NULL;
+        bool mInitialized = false;
+
+        std::size_t mBatchSize = DEFAULT_BATCH_SIZE;
+        std::vector<crs::CParticle> mPre;
+        std::vector<crs::CParticle> mPost;
+        std::vector<crs::CInteraction> mInteractions;
+
+
+    // public functions
+    public:
+        /** Load a plugin.
+         *
+         * Throws a std::runtime_error if the library cannot be loaded, does
+         * not export coast_plugin() or has another ABI version.
+         */
+        explicit NativePlugin(const std::string & path);
+
+        /** Close the plugin if this was not done and unload it. */
+        ~NativePlugin();
+
+        NativePlugin(const NativePlugin &) = delete;
+        NativePlugin & operator=(const NativePlugin &) = delete;
+
+        /** Get the path of the library. */
+        const std::string & getPath() const;
+
+        /** Get the name of the plugin, the path if it has none. */
+        std::string getName() const;
+
+        /** Indicate if the plugin needs write(...) calls. */
+        bool needsWrite() const;
+
+        /** Indicate if the plugin needs interaction(...) calls. */
+        bool needsInteraction() const;
+
+        /** Indicate if the plugin needs track(...) calls. */
+        bool needsTrack() const;
+
+        /** Call init of the plugin. */
+        void init(const CorsikaConfig & config);
+
+        /** Deliver pending batches and call close of the plugin. */
+        void close();
+
+        /** Forward a subblock; pending batches are delivered before event
+         * end subblocks. */
+        void write(const CREAL * DataSubBlock, int entries);
+
+        /** Forward or collect an interaction. */
+        void interaction(const crs::CInteraction & info);
+
+        /** Forward or collect a track. */
+        void track(const crs::CParticle & pre, const crs::CParticle & post);
+
+        /** Deliver pending batches. */
+        void flush();
+
+
+    // private functions
+    private:
+        void check(int status, const char * callback) const;
+
+};
+
+
+#endif
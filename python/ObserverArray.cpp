@@ -0,0 +1,243 @@
+#include "ObserverArray.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+
+namespace {
+
+/** Charge number of a CORSIKA particle ID, 0 for neutral or unknown IDs. */
+int particleCharge(int code) {
+    switch (code) {
+        case 2: case 5: case 8: case 11: case 14: case 19: case 27:
+        case 31: case 32: case 75: case 95:
+            return 1;
+        case 3: case 6: case 9: case 12: case 15: case 21: case 23:
+        case 24: case 29: case 76: case 96:
+            return -1;
+        default:
+            break;
+    }
+
+    // nuclei are coded as A * 100 + Z
+    const int A = code / 100;
+    const int Z = code % 100;
+    if (A >= 2 && Z <= A) {
+        return Z;
+    }
+
+    return 0;
+}
+
+}
+
+
+ObserverArray::ObserverArray(
+        const std::vector<std::array<double, 3>> & positions,
+        const std::vector<double> & offsets, const Binning & binning,
+        const Atmosphere & atmosphere)
+    : mBinning(binning),
+      mAtmosphere(atmosphere),
+      mObservers(positions.size()),
+      mCharges(MAX_PARTICLE_ID)
+{
+    if (mObservers == 0) {
+        throw std::invalid_argument("observer arrays need observers");
+    }
+    if (!offsets.empty() && offsets.size() != mObservers) {
+        throw std::invalid_argument("observer arrays need one time offset "
+                                    "per observer");
+    }
+    if (binning.bins == 0 || !(binning.width > 0)) {
+        throw std::invalid_argument("traces need bins > 0 and width > 0");
+    }
+    if (!(atmosphere.refractivity >= 0) || !(atmosphere.scaleHeight > 0) ||
+        !(atmosphere.speedOfLight > 0)) {
+        throw std::invalid_argument("the atmosphere needs refractivity >= 0, "
+                                    "scale height > 0 and speed of light "
+                                    "> 0");
+    }
+
+    for (std::size_t k = 0; k < mObservers; ++k) {
+        mX.push_back(positions[k][0]);
+        mY.push_back(positions[k][1]);
+        mZ.push_back(positions[k][2]);
+        mOffset.push_back(offsets.empty() ? 0.0 : offsets[k]);
+        mDensity.push_back(
+                std::exp(-positions[k][2] / atmosphere.scaleHeight));
+    }
+
+    mStartTime.resize(mObservers);
+    mEndTime.resize(mObservers);
+    mAreaX.resize(mObservers);
+    mAreaY.resize(mObservers);
+    mAreaZ.resize(mObservers);
+
+    for (int code = 0; code < MAX_PARTICLE_ID; ++code) {
+        mCharges[code] = particleCharge(code);
+    }
+    mPotential.assign(mObservers * 3 * binning.bins, 0.0);
+}
+
+
+void ObserverArray::add(const crs::CParticle & pre,
+                        const crs::CParticle & post) {
+    const int charge = pre.particleId >= 0 &&
+                       pre.particleId < MAX_PARTICLE_ID
+                     ? mCharges[pre.particleId] : 0;
+    const double dx = post.x - pre.x;
+    const double dy = post.y - pre.y;
+    const double dz = post.z - pre.z;
+    if (charge == 0 || (dx == 0 && dy == 0 && dz == 0)) {
+        return;
+    }
+    ++mSegments;
+
+    const double c = mAtmosphere.speedOfLight;
+    const double refractivity = mAtmosphere.refractivity;
+    const double scaleHeight = mAtmosphere.scaleHeight;
+    const double flat = 1e-6 * scaleHeight;
+    const double preDensity = std::exp(-pre.z / scaleHeight);
+    const double postDensity = std::exp(-post.z / scaleHeight);
+    const double scale = charge * pre.weight / c;
+    const double centerX = pre.x + 0.5 * dx;
+    const double centerY = pre.y + 0.5 * dy;
+    const double centerZ = pre.z + 0.5 * dz;
+
+    const double * x = mX.data();
+    const double * y = mY.data();
+    const double * z = mZ.data();
+    const double * offset = mOffset.data();
+    const double * density = mDensity.data();
+    double * startTime = mStartTime.data();
+    double * endTime = mEndTime.data();
+    double * areaX = mAreaX.data();
+    double * areaY = mAreaY.data();
+    double * areaZ = mAreaZ.data();
+
+    // branch-free over the observers, such that the loop vectorizes
+    for (std::size_t k = 0; k < mObservers; ++k) {
+        const double preRx = x[k] - pre.x;
+        const double preRy = y[k] - pre.y;
+        const double preRz = z[k] - pre.z;
+        const double postRx = x[k] - post.x;
+        const double postRy = y[k] - post.y;
+        const double postRz = z[k] - post.z;
+        const double preR = std::sqrt(preRx * preRx + preRy * preRy +
+                                      preRz * preRz);
+        const double postR = std::sqrt(postRx * postRx + postRy * postRy +
+                                       postRz * postRz);
+
+        // mean refractive index of the exponential atmosphere along the
+        // line of sight
+        const double preN = 1.0 + refractivity *
+            (std::abs(preRz) > flat
+                 ? scaleHeight * (preDensity - density[k]) / preRz
+                 : preDensity);
+        const double postN = 1.0 + refractivity *
+            (std::abs(postRz) > flat
+                 ? scaleHeight * (postDensity - density[k]) / postRz
+                 : postDensity);
+
+        startTime[k] = pre.time + preN * preR / c - offset[k];
+        endTime[k] = post.time + postN * postR / c - offset[k];
+
+        const double rx = x[k] - centerX;
+        const double ry = y[k] - centerY;
+        const double rz = z[k] - centerZ;
+        const double r2 = rx * rx + ry * ry + rz * rz;
+        const double projection =
+            r2 > 0 ? (rx * dx + ry * dy + rz * dz) / r2 : 0.0;
+        const double factor = r2 > 0 ? scale / std::sqrt(r2) : 0.0;
+        areaX[k] = factor * (dx - projection * rx);
+        areaY[k] = factor * (dy - projection * ry);
+        areaZ[k] = factor * (dz - projection * rz);
+    }
+
+    for (std::size_t k = 0; k < mObservers; ++k) {
+        addBox(k, startTime[k], endTime[k], areaX[k], areaY[k], areaZ[k]);
+    }
+}
+
+
+void ObserverArray::addBox(std::size_t observer, double start, double end,
+                           double areaX, double areaY, double areaZ) {
+    // box in units of bins, reversed inside the Cherenkov cone
+    double lower = (std::min(start, end) - mBinning.start) / mBinning.width;
+    double upper = (std::max(start, end) - mBinning.start) / mBinning.width;
+    const double bins = static_cast<double>(mBinning.bins);
+    if (!(upper >= 0) || !(lower < bins)) {
+        return;
+    }
+
+    double * trace = mPotential.data() + observer * 3 * mBinning.bins;
+    const double length = upper - lower;
+    const double norm = 1.0 / mBinning.width;
+
+    if (length < 1e-9) {
+        // all signal arrives at once
+        const std::size_t bin = static_cast<std::size_t>(lower);
+        trace[bin] += areaX * norm;
+        trace[mBinning.bins + bin] += areaY * norm;
+        trace[2 * mBinning.bins + bin] += areaZ * norm;
+        return;
+    }
+
+    const std::size_t first = static_cast<std::size_t>(std::max(lower, 0.0));
+    const std::size_t last = static_cast<std::size_t>(
+            std::min(upper, bins - 1.0));
+    for (std::size_t bin = first; bin <= last; ++bin) {
+        const double overlap = std::min(upper, bin + 1.0) -
+                               std::max(lower, static_cast<double>(bin));
+        const double fraction = overlap / length * norm;
+        trace[bin] += areaX * fraction;
+        trace[mBinning.bins + bin] += areaY * fraction;
+        trace[2 * mBinning.bins + bin] += areaZ * fraction;
+    }
+}
+
+
+const std::vector<double> & ObserverArray::getVectorPotential() const {
+    return mPotential;
+}
+
+
+const std::vector<double> & ObserverArray::getElectricField() {
+    // E = -dA/dt with zero potential before the first bin
+    mField.resize(mPotential.size());
+    const std::size_t bins = mBinning.bins;
+    for (std::size_t trace = 0; trace < mObservers * 3; ++trace) {
+        const double * potential = mPotential.data() + trace * bins;
+        double * field = mField.data() + trace * bins;
+        double previous = 0.0;
+        for (std::size_t bin = 0; bin < bins; ++bin) {
+            field[bin] = -(potential[bin] - previous) / mBinning.width;
+            previous = potential[bin];
+        }
+    }
+    return mField;
+}
+
+
+std::size_t ObserverArray::getObserverCount() const {
+    return mObservers;
+}
+
+const ObserverArray::Binning & ObserverArray::getBinning() const {
+    return mBinning;
+}
+
+std::uint64_t ObserverArray::getSegments() const {
+    return mSegments;
+}
+
+
+void ObserverArray::reset() {
+    std::fill(mPotential.begin(), mPotential.end(), 0.0);
+    mSegments = 0;
+}
@@ -0,0 +1,137 @@
+/** \file
+ * Radio emission of track segments at an array of observers.
+ */
+#ifndef __OBSERVERARRAY_H__
+#define __OBSERVERARRAY_H__
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <crs/CParticle.h>
+
+#include "ParticleId.h"
+
+
+/** Accumulates time-binned traces of the radio emission of charged track
+ * segments at many observers.
+ *
+ * Every segment contributes to the vector potential at every observer as
+ * in the ZHS formalism: a box between the arrival times of the signal
+ * emitted at pre and at post with the area
+ *
+ *     q * weight * (d - (r * d) r) / (c R),
+ *
+ * where d is the segment, r the unit vector and R the distance from its
+ * center to the observer and q the charge number of the particle. Signals
+ * propagate with c / n_eff, the mean refractive index of an exponential
+ * atmosphere n(h) = 1 + refractivity * exp(-h / scaleHeight) along the
+ * line of sight. The electric field is the negative time derivative of the
+ * vector potential, which equals the endpoint formalism for segments that
+ * are short compared to R but stays finite at the Cherenkov angle.
+ * Multiply both by e / (4 pi epsilon_0 c) to get SI units.
+ *
+ * Observer positions, distances and arrival times are kept and computed
+ * as structure of arrays, such that the loop over the observers of a
+ * segment vectorizes.
+ */
+class ObserverArray {
+
+    // interface types
+    public:
+        /** Equal width time bins of every trace. */
+        struct Binning {
+            double start = 0.0;   /**< Begin of the first bin relative to
+                                       the time offset of the observer. */
+            double width = 1.0;
+            std::size_t bins = 1;
+        };
+
+        /** Signal propagation in the atmosphere, by default in CORSIKA
+         * units (cm, ns). */
+        struct Atmosphere {
+            double refractivity = 2.92e-4;  /**< n - 1 at height 0. */
+            double scaleHeight = 8.0e5;     /**< In units of the track
+                                                 positions. */
+            double speedOfLight = 29.9792458;  /**< In units of the track
+                                                    positions per time. */
+        };
+
+
+    // members
+    private:
+        Binning mBinning;
+        Atmosphere mAtmosphere;
+        std::size_t mObservers;
+
+        // observers, structure of arrays
+        std::vector<double> mX;
+        std::vector<double> mY;
+        std::vector<double> mZ;
+        std::vector<double> mOffset;
+        std::vector<double> mDensity;    // exp(-z / scaleHeight)
+
+        // per segment and observer
+        std::vector<double> mStartTime;
+        std::vector<double> mEndTime;
+        std::vector<double> mAreaX;
+        std::vector<double> mAreaY;
+        std::vector<double> mAreaZ;
+
+        std::vector<int> mCharges;
+        std::vector<double> mPotential;  // observer x component x bin
+        std::vector<double> mField;
+        std::uint64_t mSegments = 0;
+
+
+    // public functions
+    public:
+        /** Define the observers.
+         *
+         * Throws a std::invalid_argument for no observers, a mismatch of
+         * positions and offsets or invalid binning and atmosphere.
+         *
+         * @param positions x, y, z of every observer; z is the height.
+         * @param offsets Time offset of the trace of every observer;
+         * empty = 0.
+         * @param binning Time bins of every trace.
+         * @param atmosphere Refractive index and speed of light.
+         */
+        ObserverArray(const std::vector<std::array<double, 3>> & positions,
+                      const std::vector<double> & offsets,
+                      const Binning & binning, const Atmosphere & atmosphere);
+
+        /** Add the emission of a track segment; segments of neutral
+         * particles or without length are ignored. */
+        void add(const crs::CParticle & pre, const crs::CParticle & post);
+
+        /** Get the vector potential of shape observers x 3 x bins. */
+        const std::vector<double> & getVectorPotential() const;
+
+        /** Compute the electric field of shape observers x 3 x bins; valid
+         * until the next call. */
+        const std::vector<double> & getElectricField();
+
+        /** Get the number of observers. */
+        std::size_t getObserverCount() const;
+
+        /** Get the time binning. */
+        const Binning & getBinning() const;
+
+        /** Get the number of added charged segments. */
+        std::uint64_t getSegments() const;
+
+        /** Set the traces to zero. */
+        void reset();
+
+
+    // private functions
+    private:
+        void addBox(std::size_t observer, double start, double end,
+                    double areaX, double areaY, double areaZ);
+
+};
+
+
+#endif
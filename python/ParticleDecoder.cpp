@@ -0,0 +1,174 @@
+#include "ParticleDecoder.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "ShowerBoundary.h"
+
+
+namespace {
+
+constexpr int LINES = 39;
+
+// IDs of lines that carry additional information instead of a particle
+constexpr int INFORMATION_IDS[] = {75, 76, 85, 86};
+
+}
+
+
+ParticleDecoder::ParticleDecoder() {
+    setSpecies({});
+    setObservationLevels({});
+}
+
+
+bool ParticleDecoder::isParticleSubBlock(const CREAL * DataSubBlock) {
+    return ShowerBoundary::getBlockType(DataSubBlock) ==
+           ShowerBoundary::BlockType::PARTICLES;
+}
+
+
+void ParticleDecoder::setSpecies(const std::vector<int> & species) {
+    for (const int id : species) {
+        if (id < 1 || id >= MAX_PARTICLE_ID) {
+            throw std::invalid_argument("particle IDs have to be in [1, " +
+                                        std::to_string(MAX_PARTICLE_ID) +
+                                        ")");
+        }
+    }
+
+    mAcceptedSpecies.assign(MAX_PARTICLE_ID, species.empty() ? 1 : 0);
+    for (const int id : species) {
+        mAcceptedSpecies[id] = 1;
+    }
+    if (species.empty()) {
+        mAcceptedSpecies[0] = 0;
+        for (const int id : INFORMATION_IDS) {
+            mAcceptedSpecies[id] = 0;
+        }
+    }
+    mSpecies = species;
+}
+
+const std::vector<int> & ParticleDecoder::getSpecies() const {
+    return mSpecies;
+}
+
+
+void ParticleDecoder::setObservationLevels(const std::vector<int> & levels) {
+    std::uint32_t accepted = levels.empty() ? ~std::uint32_t(0) : 0;
+    for (const int level : levels) {
+        if (level < 0 || level > 9) {
+            throw std::invalid_argument("observation levels have to be in "
+                                        "[0, 9]");
+        }
+        accepted |= std::uint32_t(1) << level;
+    }
+
+    mAcceptedLevels = accepted;
+    mLevels = levels;
+}
+
+const std::vector<int> & ParticleDecoder::getObservationLevels() const {
+    return mLevels;
+}
+
+
+std::size_t ParticleDecoder::decode(const CREAL * DataSubBlock,
+                                    int entries) {
+    if (!isParticleSubBlock(DataSubBlock)) {
+        return 0;
+    }
+
+    // the fixed layouts let the compiler vectorize the strided loads
+    return entries > 7 ? decodeLines<8>(DataSubBlock)
+                       : decodeLines<7>(DataSubBlock);
+}
+
+
+template <int Entries>
+std::size_t ParticleDecoder::decodeLines(const CREAL * DataSubBlock) {
+    int id[LINES];
+    int hadronicGeneration[LINES];
+    int level[LINES];
+    int keep[LINES];
+
+    for (int i = 0; i < LINES; ++i) {
+        const float value = DataSubBlock[i * Entries];
+        // descriptions are below 2^24 and exact in single precision
+        const int description = value > 0.0f && value < 16777216.0f
+                              ? static_cast<int>(value) : 0;
+        id[i] = description / 1000;
+        const int rest = description - id[i] * 1000;
+        hadronicGeneration[i] = rest / 10;
+        level[i] = rest - hadronicGeneration[i] * 10;
+    }
+
+    const unsigned char * species = mAcceptedSpecies.data();
+    for (int i = 0; i < LINES; ++i) {
+        const int known = id[i] < MAX_PARTICLE_ID;
+        keep[i] = known & species[known ? id[i] : 0] &
+                  static_cast<int>((mAcceptedLevels >> level[i]) & 1u);
+    }
+
+    // every line is written, kept lines advance the position
+    reserve(mSize + LINES);
+    Columns & c = mColumns;
+    std::size_t n = mSize;
+    for (int i = 0; i < LINES; ++i) {
+        const CREAL * line = DataSubBlock + i * Entries;
+        c.particleId[n] = id[i];
+        c.hadronicGeneration[n] = hadronicGeneration[i];
+        c.observationLevel[n] = level[i];
+        c.px[n] = line[1];
+        c.py[n] = line[2];
+        c.pz[n] = line[3];
+        c.x[n] = line[4];
+        c.y[n] = line[5];
+        c.time[n] = line[6];
+        c.weight[n] = Entries > 7 ? line[7] : 1.0f;
+        n += keep[i];
+    }
+
+    const std::size_t added = n - mSize;
+    mSize = n;
+    return added;
+}
+
+
+void ParticleDecoder::reserve(std::size_t size) {
+    if (size <= mColumns.particleId.size()) {
+        return;
+    }
+
+    const std::size_t capacity =
+        std::max(size, 2 * mColumns.particleId.size());
+    mColumns.particleId.resize(capacity);
+    mColumns.hadronicGeneration.resize(capacity);
+    mColumns.observationLevel.resize(capacity);
+    mColumns.px.resize(capacity);
+    mColumns.py.resize(capacity);
+    mColumns.pz.resize(capacity);
+    mColumns.x.resize(capacity);
+    mColumns.y.resize(capacity);
+    mColumns.time.resize(capacity);
+    mColumns.weight.resize(capacity);
+}
+
+
+std::size_t ParticleDecoder::getSize() const {
+    return mSize;
+}
+
+const ParticleDecoder::Columns & ParticleDecoder::getColumns() const {
+    return mColumns;
+}
+
+
+void ParticleDecoder::clear() {
+    mSize = 0;
+}
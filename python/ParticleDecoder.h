@@ -0,0 +1,123 @@
+/** \file
+ * Decoding of CORSIKA particle subblocks into typed columns.
+ */
+#ifndef __PARTICLEDECODER_H__
+#define __PARTICLEDECODER_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <crs/CorsikaTypes.h>
+
+#include "ParticleId.h"
+
+
+/** Decodes the 39 particle lines of CORSIKA subblocks into structure of
+ * arrays columns.
+ *
+ * Empty lines (description 0), lines without a particle (negative
+ * descriptions of the EHISTORY mother and grandmother lines, muon
+ * additional information 75, 76, 85 and 86) and header and trailer
+ * subblocks are dropped. Lines can be restricted to species and
+ * observation levels. The description of a line is
+ * particle ID * 1000 + hadronic generation * 10 + observation level.
+ *
+ * Decoding is branch free: the descriptions are first unpacked into fixed
+ * size arrays, which the compiler vectorizes for the line layout given at
+ * compile time, and all lines are then appended with a position that only
+ * advances for accepted lines.
+ */
+class ParticleDecoder {
+
+    // interface types
+    public:
+        /** Decoded particles, all columns have getSize() entries. */
+        struct Columns {
+            std::vector<int> particleId;
+            std::vector<int> hadronicGeneration;
+            std::vector<int> observationLevel;
+            std::vector<float> px;
+            std::vector<float> py;
+            std::vector<float> pz;
+            std::vector<float> x;
+            std::vector<float> y;
+            std::vector<float> time;
+            std::vector<float> weight;  /**< 1 if not thinned. */
+        };
+
+
+    // members
+    private:
+        Columns mColumns;
+        std::size_t mSize = 0;
+        std::vector<unsigned char> mAcceptedSpecies;
+        std::uint32_t mAcceptedLevels = ~std::uint32_t(0);
+        std::vector<int> mSpecies;
+        std::vector<int> mLevels;
+
+
+    // public functions
+    public:
+        /** Construct a decoder that accepts all particles. */
+        ParticleDecoder();
+
+        /** Indicate if a subblock holds particles, i.e. is not a RUNH, EVTH,
+         * LONG, EVTE or RUNE subblock. */
+        static bool isParticleSubBlock(const CREAL * DataSubBlock);
+
+        /** Restrict decoding to particle species.
+         *
+         * Throws a std::invalid_argument for IDs outside
+         * [1, MAX_PARTICLE_ID).
+         *
+         * @param species Accepted particle IDs; empty = all particles.
+         */
+        void setSpecies(const std::vector<int> & species);
+
+        /** Get the accepted particle IDs; empty = all particles. */
+        const std::vector<int> & getSpecies() const;
+
+        /** Restrict decoding to observation levels.
+         *
+         * Throws a std::invalid_argument for levels outside [0, 9].
+         *
+         * @param levels Accepted observation levels of the description;
+         * empty = all levels.
+         */
+        void setObservationLevels(const std::vector<int> & levels);
+
+        /** Get the accepted observation levels; empty = all levels. */
+        const std::vector<int> & getObservationLevels() const;
+
+        /** Append the particles of a subblock.
+         *
+         * Header and trailer subblocks are ignored.
+         *
+         * @param DataSubBlock 39 particle lines.
+         * @param entries Entries per line (8 thinned, 7 not thinned).
+         * @return Number of appended particles.
+         */
+        std::size_t decode(const CREAL * DataSubBlock, int entries);
+
+        /** Get the number of decoded particles. */
+        std::size_t getSize() const;
+
+        /** Get the decoded columns; only the first getSize() entries are
+         * valid. */
+        const Columns & getColumns() const;
+
+        /** Remove all decoded particles. */
+        void clear();
+
+
+    // private functions
+    private:
+        template <int Entries>
+        std::size_t decodeLines(const CREAL * DataSubBlock);
+        void reserve(std::size_t size);
+
+};
+
+
+#endif
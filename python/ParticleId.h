@@ -0,0 +1,13 @@
+/** \file
+ * Range of the CORSIKA particle IDs handled by the native tables.
+ */
+#ifndef __PARTICLEID_H__
+#define __PARTICLEID_H__
+
+
+/** Particle IDs below this value index the per-species tables of the
+ * decoder, samplers and sinks; nuclei are coded as A * 100 + Z. */
+constexpr int MAX_PARTICLE_ID = 10000;
+
+
+#endif
@@ -3,181 +3,1807 @@
 #define PY_SSIZE_T_CLEAN
 #include <Python.h>
 
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
 #include <cstddef>
 #include <cstdlib>
 #include <cstdio>
 #include "stdfilesystem.h"
-#include <mutex>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "CorsikaConfig.h"
+#include "CppWrapper.h"
+#include "CppTypes.h"
+
+
+// the vectorcall API is underscore prefixed in python 3.8
+#if PY_VERSION_HEX < 0x03090000
+    #define PyObject_Vectorcall _PyObject_Vectorcall
+#endif
+
+
+// interface callbacks
+
+void PythonInterface::init(const CorsikaConfig & config) {
+    setCorsikaConfig(config);
+    setupSharedRing();
+    if (mSharedRing) {
+        // the override, recording and tracing run in the consumer processes
+        return;
+    }
+
+    setupTracer();
+    if (mTracer) {
+        mTracer->begin(InterfaceStats::getName(InterfaceStats::Callback::INIT));
+    }
+    setupCallRecorder();
+    mStats.count(InterfaceStats::Callback::INIT, true, 0);
+    setupPlugins();
+
+    if (!mPlugins.empty() && findOverrideDirectory().empty()) {
+        // the plugins run without python, which only receives calls that
+        // are captured
+        mCaptureMask.store(0);
+        updateActiveCalls();
+        setupColumnWriter();
+        setupBlockWriter();
+        setupStats();
+        if (mTracer) {
+            mTracer->end();
+        }
+        return;
+    }
+
+    PyImport_AppendInittab("cppwrapper_emb", &PyInit_cppwrapper_emb);
+    Py_Initialize();
+    mPythonRunning = true;
+    setupPackagesSearchPath();
+    importInterface();
+    setupColumnWriter();
+    setupBlockWriter();
+    setupStats();
+    setupOverrideSearchPath();
+    runOverride();
+    updateCallbacks();
+    callPythonInit();
+    if (mTracer) {
+        mTracer->end();
+    }
+    startAsync();
+}
+
+
+void PythonInterface::close() {
+    if (mSharedRing) {
+        mSharedRing->close();
+        mSharedRing.reset();
+        waitForConsumerProcesses();
+        return;
+    }
+
+    mStats.count(InterfaceStats::Callback::CLOSE, true, 0);
+    if (mTracer) {
+        mTracer->begin(
+                InterfaceStats::getName(InterfaceStats::Callback::CLOSE));
+    }
+    closeCallRecorder();
+    closePlugins();
+    if (!mPythonRunning) {
+        setColumnWriter("", 0);
+        setBlockWriter("", 0, 0);
+        if (mTracer) {
+            mTracer->end();
+        }
+        writeStats();
+        closeTracer();
+        return;
+    }
+
+    stopAsync();
+    setColumnWriter("", 0);
+    setBlockWriter("", 0, 0);
+    flushHistograms();
+    flushWriteStaging();
+    flushParticles();
+    flushCrossings();
+    drainTrack();
+    drainInteraction();
+    callPythonClose();
+    if (mTracer) {
+        mTracer->end();
+    }
+    releaseCppTypes();
+    Py_Finalize();
+    mPythonRunning = false;
+    writeStats();
+    closeTracer();
+}
+
+
+void PythonInterface::write(const CREAL * DataSubBlock) {
+    if ((mActiveCalls.load(std::memory_order_relaxed) & CAPTURE_WRITE) == 0) {
+        mStats.count(InterfaceStats::Callback::WRITE, false,
+                     39 * mSubBlockEntries * sizeof(CREAL));
+        return;
+    }
+
+    if (mSharedRing) {
+        mSharedRing->publishWrite(DataSubBlock);
+        return;
+    }
+
+    if (mCallRecorder) {
+        mCallRecorder->recordWrite(DataSubBlock);
+    }
+
+    if (mColumnWriter) {
+        mColumnWriter->write(DataSubBlock);
+    }
+
+    if (mBlockWriter) {
+        mBlockWriter->write(DataSubBlock);
+    }
+
+    for (const std::unique_ptr<NativePlugin> & plugin : mPlugins) {
+        plugin->write(DataSubBlock, mSubBlockEntries);
+    }
+
+    const bool capture =
+        (mCaptureMask.load(std::memory_order_relaxed) & CAPTURE_WRITE) != 0;
+    mStats.count(InterfaceStats::Callback::WRITE, capture,
+                 39 * mSubBlockEntries * sizeof(CREAL));
+
+    // histograms are filled and showers are tracked by the thread that
+    // holds the GIL
+    if (mAsyncRunning.load(std::memory_order_relaxed)) {
+        if (capture || mParticleHistograms.isActive() ||
+            isCollecting(RecordFilter::RecordType::PARTICLE) ||
+            !ParticleDecoder::isParticleSubBlock(DataSubBlock)) {
+            if (mAsyncWriteSize == 0) {
+                writeUnknown(DataSubBlock);
+            }
+            enqueue(RecordQueue::RecordType::WRITE, capture, DataSubBlock,
+                    mAsyncWriteSize);
+        }
+        return;
+    }
+
+    deliverWrite(DataSubBlock, capture);
+}
+
+
+void PythonInterface::interaction(const crs::CInteraction & info) {
+    if ((mActiveCalls.load(std::memory_order_relaxed) &
+         CAPTURE_INTERACTION) == 0) {
+        mStats.count(InterfaceStats::Callback::INTERACTION, false,
+                     sizeof(info));
+        return;
+    }
+
+    if (mSharedRing) {
+        mSharedRing->publishInteraction(info);
+        return;
+    }
+
+    if (mCallRecorder) {
+        mCallRecorder->recordInteraction(info);
+    }
+
+    if (mColumnWriter) {
+        mColumnWriter->addInteraction(info);
+    }
+
+    for (const std::unique_ptr<NativePlugin> & plugin : mPlugins) {
+        plugin->interaction(info);
+    }
+
+    const bool capture = (mCaptureMask.load(std::memory_order_relaxed) &
+                          CAPTURE_INTERACTION) != 0;
+    mStats.count(InterfaceStats::Callback::INTERACTION, capture,
+                 sizeof(info));
+
+    if (mAsyncRunning.load(std::memory_order_relaxed)) {
+        if (capture || isFillingInteractions()) {
+            enqueue(RecordQueue::RecordType::INTERACTION, capture, &info,
+                    sizeof(info));
+        }
+        return;
+    }
+
+    fillInteractions(info);
+
+    if (capture) {
+        dispatch(InterfaceStats::Callback::INTERACTION,
+                 mCallbackTable.interaction, info);
+    }
+}
+
+
+void PythonInterface::track(const crs::CParticle & pre,
+                            const crs::CParticle & post) {
+    if ((mActiveCalls.load(std::memory_order_relaxed) & CAPTURE_TRACK) == 0) {
+        mStats.count(InterfaceStats::Callback::TRACK, false,
+                     sizeof(pre) + sizeof(post));
+        return;
+    }
+
+    if (mSharedRing) {
+        mSharedRing->publishTrack(pre, post);
+        return;
+    }
+
+    if (mCallRecorder) {
+        mCallRecorder->recordTrack(pre, post);
+    }
+
+    if (mColumnWriter) {
+        mColumnWriter->addTrack(pre, post);
+    }
+
+    for (const std::unique_ptr<NativePlugin> & plugin : mPlugins) {
+        plugin->track(pre, post);
+    }
+
+    const bool capture =
+        (mCaptureMask.load(std::memory_order_relaxed) & CAPTURE_TRACK) != 0;
+    mStats.count(InterfaceStats::Callback::TRACK, capture,
+                 sizeof(pre) + sizeof(post));
+
+    if (mAsyncRunning.load(std::memory_order_relaxed)) {
+        if (capture || isFillingTracks()) {
+            enqueue(RecordQueue::RecordType::TRACK, capture, &pre,
+                    sizeof(pre), &post, sizeof(post));
+        }
+        return;
+    }
+
+    fillTracks(pre, post);
+
+    if (capture) {
+        dispatch(InterfaceStats::Callback::TRACK, mCallbackTable.track, pre,
+                 post);
+    }
+}
+
+
+template <typename Handler, typename... Args>
+void PythonInterface::dispatch(InterfaceStats::Callback callback,
+                               Handler handler, const Args &... args) {
+    if (!mTracer || !mTracer->sample(static_cast<std::size_t>(callback))) {
+        (this->*handler)(args...);
+        return;
+    }
+
+    Tracer::Span span(*mTracer, InterfaceStats::getName(callback));
+    (this->*handler)(args...);
+}
+
+
+// asynchronous mode
+
+void PythonInterface::startAsync() {
+    if (mAsyncCapacity == 0) {
+        return;
+    }
+
+    mAsyncQueue = std::make_unique<RecordQueue>(mAsyncCapacity,
+                                                mAsyncPolicy);
+    mAsyncWriteSize = 39 * mSubBlockEntries * sizeof(CREAL);
+    mAsyncError = nullptr;
+
+    // the consumer thread takes over the GIL
+    mAsyncMainState = PyEval_SaveThread();
+    mAsyncConsumer = std::thread(&PythonInterface::consumeAsync, this);
+    mAsyncRunning.store(true);
+}
+
+
+void PythonInterface::stopAsync() {
+    if (!mAsyncRunning.load()) {
+        return;
+    }
+
+    mAsyncRunning.store(false);
+    mAsyncQueue->close();
+    mAsyncConsumer.join();
+    PyEval_RestoreThread(mAsyncMainState);
+    mAsyncMainState = NULL;
+
+    if (mAsyncError) {
+        std::exception_ptr error = mAsyncError;
+        mAsyncError = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+
+void PythonInterface::consumeAsync() {
+    PyGILState_STATE state = PyGILState_Ensure();
+    if (mTracer) {
+        mTracer->setThreadName("python consumer");
+    }
+
+    try {
+        for (;;) {
+            const RecordQueue::Record * record = mAsyncQueue->front();
+            if (record != nullptr) {
+                dispatchRecord(*record);
+                mAsyncQueue->pop();
+                continue;
+            }
+
+            bool available = false;
+            Py_BEGIN_ALLOW_THREADS
+            available = mAsyncQueue->wait();
+            Py_END_ALLOW_THREADS
+            if (!available) {
+                break;
+            }
+        }
+    }
+    catch (...) {
+        mAsyncError = std::current_exception();
+        mAsyncQueue->fail();
+    }
+
+    PyGILState_Release(state);
+}
+
+
+void PythonInterface::dispatchRecord(const RecordQueue::Record & record) {
+    // records may only be queued for the native sinks; python receives them
+    // if they were captured when CORSIKA pushed them
+    const bool capture = record.flags != 0;
+
+    switch (record.type) {
+        case RecordQueue::RecordType::WRITE: {
+            auto * DataSubBlock = static_cast<const CREAL *>(record.getData());
+            deliverWrite(DataSubBlock, capture);
+            break;
+        }
+
+        case RecordQueue::RecordType::INTERACTION: {
+            crs::CInteraction info;
+            std::memcpy(&info, record.getData(), sizeof(info));
+            fillInteractions(info);
+            if (capture) {
+                dispatch(InterfaceStats::Callback::INTERACTION,
+                         mCallbackTable.interaction, info);
+            }
+            break;
+        }
+
+        case RecordQueue::RecordType::TRACK: {
+            crs::CParticle pre;
+            crs::CParticle post;
+            auto * data = static_cast<const unsigned char *>(record.getData());
+            std::memcpy(&pre, data, sizeof(pre));
+            std::memcpy(&post, data + sizeof(pre), sizeof(post));
+            fillTracks(pre, post);
+            if (capture) {
+                dispatch(InterfaceStats::Callback::TRACK, mCallbackTable.track,
+                         pre, post);
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+
+void PythonInterface::enqueue(RecordQueue::RecordType type, bool capture,
+                              const void * first, std::size_t firstSize,
+                              const void * second, std::size_t secondSize) {
+    // the consumer thread begins and ends the showers, so their boundaries
+    // are never dropped
+    const bool pushed =
+        (type == RecordQueue::RecordType::WRITE &&
+         ShowerBoundary::isBoundary(static_cast<const CREAL *>(first))) ?
+            mAsyncQueue->pushRequired(type, capture, first, firstSize) :
+            mAsyncQueue->push(type, capture, first, firstSize, second,
+                              secondSize);
+    if (pushed || !mAsyncQueue->isFailed()) {
+        return;
+    }
+
+    // joins the consumer and rethrows its error
+    stopAsync();
+}
+
+
+// callback handlers
+
+void PythonInterface::installCallbacks() {
+    CallbackTable table;
+
+    switch (mCorsikaConfig.getThinning()) {
+        case CorsikaConfig::CorsikaOption::TRUE:
+            mSubBlockEntries = 8;
+            table.write = selectWriteHandler<8>();
+            break;
+
+        case CorsikaConfig::CorsikaOption::FALSE:
+            mSubBlockEntries = 7;
+            table.write = selectWriteHandler<7>();
+            break;
+
+        default:
+            mSubBlockEntries = 0;
+            table.write = &PythonInterface::writeUnknown;
+            break;
+    }
+
+    const bool interactionFilter = mInteractionFilter.isActive();
+    const bool trackFilter = mTrackFilter.isActive();
+    if (mBatchSize > 0) {
+        table.interaction = interactionFilter
+                          ? &PythonInterface::interactionFilteredBatched
+                          : &PythonInterface::interactionBatched;
+        table.track = trackFilter
+                    ? &PythonInterface::trackFilteredBatched
+                    : &PythonInterface::trackBatched;
+    }
+    else {
+        table.interaction = interactionFilter
+                          ? &PythonInterface::interactionFiltered
+                          : &PythonInterface::interactionDirect;
+        table.track = trackFilter
+                    ? &PythonInterface::trackFiltered
+                    : &PythonInterface::trackDirect;
+    }
+
+    // sampling runs before the selected handlers
+    if (mInteractionSampler.isActive()) {
+        table.sampledInteraction = table.interaction;
+        table.interaction = &PythonInterface::interactionSampled;
+    }
+    else {
+        mInteractionSamplingWeight = 1.0;
+    }
+
+    if (mTrackSampler.isActive()) {
+        table.sampledTrack = table.track;
+        table.track = &PythonInterface::trackSampled;
+    }
+
+    mCallbackTable = table;
+}
+
+
+template <int Entries>
+PythonInterface::WriteHandler PythonInterface::selectWriteHandler() const {
+    if (mPython_callback_write_particles != NULL) {
+        return &PythonInterface::writeParticles<Entries>;
+    }
+
+    if (mWriteBlockCount == 0) {
+        return &PythonInterface::writeBytes<Entries>;
+    }
+
+    if (mWriteBlockCount == 1) {
+        return &PythonInterface::writeView<Entries>;
+    }
+
+    return &PythonInterface::writeStaged<Entries>;
+}
+
+
+template <int Entries>
+void PythonInterface::writeBytes(const CREAL * DataSubBlock) {
+    constexpr Py_ssize_t blocklen = 39 * Entries * 4;
+    callPythonWrite(PyBytes_FromStringAndSize(
+            (const char *) DataSubBlock, blocklen));
+}
+
+
+template <int Entries>
+void PythonInterface::writeView(const CREAL * DataSubBlock) {
+    mDeliveringViews = true;
+    callPythonWrite(lendView(getMemoryView(DataSubBlock, 39, Entries)));
+}
+
+
+template <int Entries>
+void PythonInterface::writeStaged(const CREAL * DataSubBlock) {
+    constexpr std::size_t blocklen = 39 * Entries;
+    std::copy(DataSubBlock, DataSubBlock + blocklen,
+              mWriteStaging.data() + mWriteStagingBlocks * blocklen);
+    ++mWriteStagingBlocks;
+    if (mWriteStagingBlocks >= mWriteBlockCount) {
+        flushWriteStaging();
+    }
+}
+
+
+template <int Entries>
+void PythonInterface::writeParticles(const CREAL * DataSubBlock) {
+    mParticleDecoder.decode(DataSubBlock, Entries);
+    if (++mParticleBlocks >= std::max<std::size_t>(mWriteBlockCount, 1)) {
+        flushParticles();
+    }
+}
+
+
+void PythonInterface::writeUnknown(
+        [[maybe_unused]] const CREAL * DataSubBlock) {
+    throw std::runtime_error("corsika option thinning not set");
+}
+
+
+void PythonInterface::deliverWrite(const CREAL * DataSubBlock,
+                                   bool capture) {
+    if (mParticleHistograms.isActive()) {
+        fillParticleHistograms(DataSubBlock);
+    }
+    if (isCollecting(RecordFilter::RecordType::PARTICLE)) {
+        collectParticles(DataSubBlock);
+    }
+
+    const ShowerBoundary::BlockType type =
+        mShowerBoundary.process(DataSubBlock);
+    if (type == ShowerBoundary::BlockType::EVENT_HEADER) {
+        beginShower();
+    }
+
+    if (capture) {
+        dispatch(InterfaceStats::Callback::WRITE, mCallbackTable.write,
+                 DataSubBlock);
+    }
+
+    if (type == ShowerBoundary::BlockType::EVENT_END) {
+        endShower();
+    }
+}
+
+
+void PythonInterface::beginShower() {
+    const ShowerBoundary::Header & header = mShowerBoundary.getHeader();
+    for (const std::unique_ptr<VoxelGrid> & grid : mVoxelGrids) {
+        grid->beginShower(header.zenith, header.azimuth);
+    }
+
+    const bool capture = mPython_callback_shower_begin != NULL;
+    mStats.count(InterfaceStats::Callback::SHOWER_BEGIN, capture, 0);
+    if (capture) {
+        dispatch(InterfaceStats::Callback::SHOWER_BEGIN,
+                 &PythonInterface::callPythonShowerBegin);
+    }
+}
+
+
+void PythonInterface::callPythonShowerBegin() {
+    const ShowerBoundary::Header & header = mShowerBoundary.getHeader();
+    PyObject * seeds = PyTuple_New(header.seeds.size());
+    for (std::size_t i = 0; i < header.seeds.size(); ++i) {
+        PyTuple_SET_ITEM(seeds, i, Py_BuildValue(
+                "(iL)", header.seeds[i].seed,
+                static_cast<long long>(header.seeds[i].calls)));
+    }
+    PyObject * levels = PyTuple_New(header.observationLevels.size());
+    for (std::size_t i = 0; i < header.observationLevels.size(); ++i) {
+        PyTuple_SET_ITEM(levels, i,
+                         PyFloat_FromDouble(header.observationLevels[i]));
+    }
+
+    PyObject * args[14] = {
+        NULL,
+        PyLong_FromLong(header.runNumber),
+        PyLong_FromLong(header.eventNumber),
+        PyLong_FromLong(header.particleId),
+        PyFloat_FromDouble(header.energy),
+        PyFloat_FromDouble(header.startingAltitude),
+        PyFloat_FromDouble(header.firstInteractionHeight),
+        PyFloat_FromDouble(header.px),
+        PyFloat_FromDouble(header.py),
+        PyFloat_FromDouble(header.pz),
+        PyFloat_FromDouble(header.zenith),
+        PyFloat_FromDouble(header.azimuth),
+        seeds,
+        levels
+    };
+    callPython(mPython_callback_shower_begin, args, 13,
+               InterfaceStats::Callback::SHOWER_BEGIN);
+}
+
+
+void PythonInterface::endShower() {
+    const bool capture = mPython_callback_shower_end != NULL;
+    mStats.count(InterfaceStats::Callback::SHOWER_END, capture, 0);
+    if (!capture) {
+        return;
+    }
+
+    // the override receives everything of the shower before its end
+    flushWriteStaging();
+    flushParticles();
+    flushCrossings();
+    drainTrack();
+    drainInteraction();
+
+    dispatch(InterfaceStats::Callback::SHOWER_END,
+             &PythonInterface::callPythonShowerEnd);
+}
+
+
+void PythonInterface::callPythonShowerEnd() {
+    const ShowerBoundary::Trailer & trailer = mShowerBoundary.getTrailer();
+    PyObject * args[8] = {
+        NULL,
+        PyLong_FromLong(trailer.runNumber),
+        PyLong_FromLong(trailer.eventNumber),
+        PyFloat_FromDouble(trailer.photons),
+        PyFloat_FromDouble(trailer.electrons),
+        PyFloat_FromDouble(trailer.hadrons),
+        PyFloat_FromDouble(trailer.muons),
+        PyFloat_FromDouble(trailer.particles)
+    };
+    callPython(mPython_callback_shower_end, args, 7,
+               InterfaceStats::Callback::SHOWER_END);
+}
+
+
+void PythonInterface::interactionDirect(const crs::CInteraction & info) {
+    PyObject * args[2] = {NULL, createInteraction(info)};
+    callPython(mPython_callback_interaction, args, 1,
+               InterfaceStats::Callback::INTERACTION);
+}
+
+
+void PythonInterface::interactionBatched(const crs::CInteraction & info) {
+    mInteractionBatch.push(info);
+    if (mInteractionBatch.isFull()) {
+        flushInteractionBatch();
+    }
+}
+
+
+void PythonInterface::trackDirect(const crs::CParticle & pre,
+                                  const crs::CParticle & post) {
+    PyObject * args[3] = {NULL, createParticle(pre), createParticle(post)};
+    callPython(mPython_callback_track, args, 2,
+               InterfaceStats::Callback::TRACK);
+}
+
+
+void PythonInterface::trackBatched(const crs::CParticle & pre,
+                                   const crs::CParticle & post) {
+    mTrackBatch.push(pre, post);
+    if (mTrackBatch.isFull()) {
+        flushTrackBatch();
+    }
+}
+
+
+void PythonInterface::interactionFiltered(const crs::CInteraction & info) {
+    mInteractionFilter.load(0, info, mInteractionSamplingWeight);
+    mInteractionFilter.evaluate(1);
+    if (!mInteractionFilter.isAccepted(0)) {
+        return;
+    }
+
+    const auto & names = mInteractionFilter.getColumnNames();
+    if (names.empty()) {
+        interactionDirect(info);
+        return;
+    }
+
+    PyObject * args[3] = {
+        NULL, createInteraction(info),
+        getDerivedValues(names, mInteractionFilter.getDerived(0))
+    };
+    callPython(mPython_callback_interaction, args, 2,
+               InterfaceStats::Callback::INTERACTION);
+}
+
+
+void PythonInterface::interactionFilteredBatched(
+        const crs::CInteraction & info) {
+    mInteractionPending[mInteractionPendingSize] = info;
+    mInteractionFilter.load(mInteractionPendingSize, info,
+                            mInteractionSamplingWeight);
+    ++mInteractionPendingSize;
+    if (mInteractionPendingSize >= Expression::BLOCK) {
+        processInteractionPending();
+    }
+}
+
+
+void PythonInterface::trackFiltered(const crs::CParticle & pre,
+                                    const crs::CParticle & post) {
+    mTrackFilter.load(0, pre, post);
+    mTrackFilter.evaluate(1);
+    if (!mTrackFilter.isAccepted(0)) {
+        return;
+    }
+
+    const auto & names = mTrackFilter.getColumnNames();
+    if (names.empty()) {
+        trackDirect(pre, post);
+        return;
+    }
+
+    PyObject * args[4] = {
+        NULL, createParticle(pre), createParticle(post),
+        getDerivedValues(names, mTrackFilter.getDerived(0))
+    };
+    callPython(mPython_callback_track, args, 3,
+               InterfaceStats::Callback::TRACK);
+}
+
+
+void PythonInterface::trackFilteredBatched(const crs::CParticle & pre,
+                                           const crs::CParticle & post) {
+    mTrackPendingPre[mTrackPendingSize] = pre;
+    mTrackPendingPost[mTrackPendingSize] = post;
+    mTrackFilter.load(mTrackPendingSize, pre, post);
+    ++mTrackPendingSize;
+    if (mTrackPendingSize >= Expression::BLOCK) {
+        processTrackPending();
+    }
+}
+
+
+void PythonInterface::interactionSampled(const crs::CInteraction & info) {
+    const double weight = mInteractionSampler.sample(info.projId, info.etot);
+    if (weight == 0.0) {
+        return;
+    }
+
+    mInteractionSamplingWeight = weight;
+    (this->*mCallbackTable.sampledInteraction)(info);
+}
+
+
+void PythonInterface::trackSampled(const crs::CParticle & pre,
+                                   const crs::CParticle & post) {
+    const double weight = mTrackSampler.sample(pre.particleId, pre.energy);
+    if (weight == 0.0) {
+        return;
+    }
+
+    if (weight == 1.0) {
+        (this->*mCallbackTable.sampledTrack)(pre, post);
+        return;
+    }
+
+    crs::CParticle sampledPre = pre;
+    crs::CParticle sampledPost = post;
+    sampledPre.weight *= weight;
+    sampledPost.weight *= weight;
+    (this->*mCallbackTable.sampledTrack)(sampledPre, sampledPost);
+}
+
+
+void PythonInterface::processTrackPending() {
+    const std::size_t size = mTrackPendingSize;
+    mTrackPendingSize = 0;
+    if (size == 0) {
+        return;
+    }
+
+    mTrackFilter.evaluate(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        if (!mTrackFilter.isAccepted(i)) {
+            continue;
+        }
+
+        mTrackBatch.push(mTrackPendingPre[i], mTrackPendingPost[i],
+                         mTrackFilter.getDerived(i));
+        if (mTrackBatch.isFull()) {
+            flushTrackBatch();
+        }
+    }
+}
+
+
+void PythonInterface::processInteractionPending() {
+    const std::size_t size = mInteractionPendingSize;
+    mInteractionPendingSize = 0;
+    if (size == 0) {
+        return;
+    }
+
+    mInteractionFilter.evaluate(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        if (!mInteractionFilter.isAccepted(i)) {
+            continue;
+        }
+
+        mInteractionBatch.push(mInteractionPending[i],
+                               mInteractionFilter.getDerived(i));
+        if (mInteractionBatch.isFull()) {
+            flushInteractionBatch();
+        }
+    }
+}
+
+
+void PythonInterface::drainTrack() {
+    processTrackPending();
+    flushTrackBatch();
+}
+
+
+void PythonInterface::drainInteraction() {
+    processInteractionPending();
+    flushInteractionBatch();
+}
+
+
+// singleton setup
+
+PythonInterface * PythonInterface::_instance = nullptr;
+
+PythonInterface * PythonInterface::instance() {
+    static CGuard g;
+    if (_instance == nullptr) {
+        _instance = new PythonInterface();
+    }
+
+    return _instance;
+}
+
+
+// member functions
+
+void PythonInterface::setCapture(unsigned int flag, bool val) {
+    if (val) {
+        mCaptureMask.fetch_or(flag, std::memory_order_relaxed);
+    }
+    else {
+        mCaptureMask.fetch_and(~flag, std::memory_order_relaxed);
+    }
+    updateActiveCalls();
+}
+
+
+void PythonInterface::updateActiveCalls() {
+    // called whenever python or a native sink starts or stops receiving
+    // calls; the shared ring decides on its own what it publishes
+    unsigned int active = getRequiredCalls();
+    if (mSharedRing) {
+        active = CAPTURE_WRITE | CAPTURE_INTERACTION | CAPTURE_TRACK;
+    }
+
+    // the subblocks mark the showers
+    if (!mVoxelGrids.empty() || mPython_callback_shower_begin != NULL ||
+        mPython_callback_shower_end != NULL) {
+        active |= CAPTURE_WRITE;
+    }
+    mActiveCalls.store(active, std::memory_order_relaxed);
+}
+
+bool PythonInterface::isCapturing(unsigned int flag) const {
+    return (mCaptureMask.load(std::memory_order_relaxed) & flag) != 0;
+}
+
+
+void PythonInterface::captureWrite(bool val) {
+    setCapture(CAPTURE_WRITE, val);
+}
+
+bool PythonInterface::isCapturingWrite() const {
+    return isCapturing(CAPTURE_WRITE);
+}
+
+
+void PythonInterface::captureInteraction(bool val) {
+    setCapture(CAPTURE_INTERACTION, val);
+}
+
+bool PythonInterface::isCapturingInteraction() const {
+    return isCapturing(CAPTURE_INTERACTION);
+}
+
+
+void PythonInterface::captureTrack(bool val) {
+    setCapture(CAPTURE_TRACK, val);
+}
+
+bool PythonInterface::isCapturingTrack() const {
+    return isCapturing(CAPTURE_TRACK);
+}
+
+
+unsigned int PythonInterface::getRequiredCalls() const {
+    if (mCallRecorder) {
+        return CAPTURE_WRITE | CAPTURE_INTERACTION | CAPTURE_TRACK;
+    }
+
+    unsigned int required = mCaptureMask.load(std::memory_order_relaxed);
+    if (mColumnWriter || mBlockWriter || mParticleHistograms.isActive() ||
+        isCollecting(RecordFilter::RecordType::PARTICLE)) {
+        required |= CAPTURE_WRITE;
+    }
+    if (isFillingInteractions()) {
+        required |= CAPTURE_INTERACTION;
+    }
+    if (isFillingTracks()) {
+        required |= CAPTURE_TRACK;
+    }
+    for (const std::unique_ptr<NativePlugin> & plugin : mPlugins) {
+        if (plugin->needsWrite()) {
+            required |= CAPTURE_WRITE;
+        }
+        if (plugin->needsInteraction()) {
+            required |= CAPTURE_INTERACTION;
+        }
+        if (plugin->needsTrack()) {
+            required |= CAPTURE_TRACK;
+        }
+    }
+    return required;
+}
+
+
+void PythonInterface::setCorsikaConfig(const CorsikaConfig & config) {
+    mCorsikaConfig = config;
+    installCallbacks();
+}
+
+const CorsikaConfig & PythonInterface::getCorsikaConfig() const {
+    return mCorsikaConfig;
+}
+
+
+void PythonInterface::setBatchSize(std::size_t size) {
+    checkNotDelivering();
+    drainTrack();
+    drainInteraction();
+
+    mTrackBatch.setCapacity(size);
+    mInteractionBatch.setCapacity(size);
+    mBatchSize = size;
+    installCallbacks();
+}
+
+std::size_t PythonInterface::getBatchSize() const {
+    return mBatchSize;
+}
+
+
+void PythonInterface::setWriteBlockCount(std::size_t count) {
+    checkNotDelivering();
+    flushWriteStaging();
+    flushParticles();
+
+    // staging memory for the largest (thinned) subblock layout
+    mWriteStaging.assign(count > 1 ? count * 39 * 8 : 0, 0);
+    mWriteBlockCount = count;
+    installCallbacks();
+}
+
+std::size_t PythonInterface::getWriteBlockCount() const {
+    return mWriteBlockCount;
+}
+
+
+void PythonInterface::setParticleFilter(const std::vector<int> & species,
+                                        const std::vector<int> & levels) {
+    ParticleDecoder decoder;
+    decoder.setSpecies(species);
+    decoder.setObservationLevels(levels);
+
+    checkNotDelivering();
+    flushParticles();
+    mParticleDecoder = std::move(decoder);
+}
+
+
+void PythonInterface::setTrackFilter(const std::string & source) {
+    checkNotDelivering();
+    drainTrack();
+
+    mTrackFilter.setFilter(source);
+    installCallbacks();
+}
+
+
+void PythonInterface::addTrackColumn(const std::string & name,
+                                     const std::string & source) {
+    checkNotDelivering();
+    drainTrack();
+
+    mTrackFilter.addColumn(name, source);
+    mTrackBatch.setDerivedCount(mTrackFilter.getColumnNames().size());
+    installCallbacks();
+}
+
+
+void PythonInterface::clearTrackFilter() {
+    checkNotDelivering();
+    drainTrack();
+
+    mTrackFilter.clear();
+    mTrackBatch.setDerivedCount(0);
+    installCallbacks();
+}
+
+
+void PythonInterface::setInteractionFilter(const std::string & source) {
+    checkNotDelivering();
+    drainInteraction();
+
+    mInteractionFilter.setFilter(source);
+    installCallbacks();
+}
+
+
+void PythonInterface::addInteractionColumn(const std::string & name,
+                                           const std::string & source) {
+    checkNotDelivering();
+    drainInteraction();
+
+    mInteractionFilter.addColumn(name, source);
+    mInteractionBatch.setDerivedCount(
+            mInteractionFilter.getColumnNames().size());
+    installCallbacks();
+}
+
+
+void PythonInterface::clearInteractionFilter() {
+    checkNotDelivering();
+    drainInteraction();
+
+    mInteractionFilter.clear();
+    mInteractionBatch.setDerivedCount(0);
+    installCallbacks();
+}
+
+
+void PythonInterface::setTrackSampling(int particleId,
+                                       const RecordSampler::Rule & rule) {
+    mTrackSampler.setRule(particleId, rule);
+    installCallbacks();
+}
+
+
+void PythonInterface::clearTrackSampling() {
+    mTrackSampler.clear();
+    installCallbacks();
+}
+
+
+void PythonInterface::setInteractionSampling(
+        int particleId, const RecordSampler::Rule & rule) {
+    mInteractionSampler.setRule(particleId, rule);
+    installCallbacks();
+}
+
+
+void PythonInterface::clearInteractionSampling() {
+    mInteractionSampler.clear();
+    installCallbacks();
+}
+
+
+void PythonInterface::setAsyncMode(std::size_t capacity,
+                                   RecordQueue::Policy policy) {
+    if (mAsyncRunning.load()) {
+        throw std::logic_error("asynchronous mode cannot be changed while "
+                               "the consumer thread is running");
+    }
+
+    mAsyncCapacity = capacity;
+    mAsyncPolicy = policy;
+}
+
+std::size_t PythonInterface::getAsyncCapacity() const {
+    return mAsyncCapacity;
+}
+
+
+std::uint64_t PythonInterface::getAsyncDropped(
+        RecordQueue::RecordType type) const {
+    if (!mAsyncQueue) {
+        return 0;
+    }
+
+    return mAsyncQueue->getDropped(type);
+}
+
+
+void PythonInterface::setColumnWriter(const std::string & path,
+                                      std::size_t chunkRows) {
+    // the writer is used by the CORSIKA thread
+    if (mAsyncRunning.load()) {
+        throw std::logic_error("column writer cannot be changed while the "
+                               "consumer thread is running");
+    }
+
+    if (mColumnWriter) {
+        std::unique_ptr<ColumnWriter> writer = std::move(mColumnWriter);
+        writer->close();
+    }
+
+    if (!path.empty()) {
+        mColumnWriter = std::make_unique<ColumnWriter>(path, chunkRows);
+    }
+    updateActiveCalls();
+}
+
+std::string PythonInterface::getColumnWriterPath() const {
+    return mColumnWriter ? mColumnWriter->getPath() : std::string();
+}
+
+
+void PythonInterface::setupColumnWriter() {
+    const char * envval = std::getenv(mColumnWriterVariable.c_str());
+    if (envval != NULL && envval[0] != '\0') {
+        setColumnWriter(envval, ColumnWriter::DEFAULT_CHUNK_ROWS);
+    }
+}
+
+
+void PythonInterface::setBlockWriter(const std::string & path, int level,
+                                     std::size_t blockSubBlocks) {
+    // the writer is used by the CORSIKA thread
+    if (mAsyncRunning.load()) {
+        throw std::logic_error("block writer cannot be changed while the "
+                               "consumer thread is running");
+    }
+
+    if (mBlockWriter) {
+        std::unique_ptr<BlockWriter> writer = std::move(mBlockWriter);
+        writer->close();
+    }
+
+    if (!path.empty()) {
+        if (mSubBlockEntries == 0) {
+            throw std::runtime_error("corsika option thinning not set");
+        }
+        mBlockWriter = std::make_unique<BlockWriter>(
+                path, mSubBlockEntries, level, blockSubBlocks);
+    }
+    updateActiveCalls();
+}
+
+std::string PythonInterface::getBlockWriterPath() const {
+    return mBlockWriter ? mBlockWriter->getPath() : std::string();
+}
+
+
+void PythonInterface::setupBlockWriter() {
+    const char * envval = std::getenv(mBlockWriterVariable.c_str());
+    if (envval != NULL && envval[0] != '\0') {
+        setBlockWriter(envval, BlockWriter::DEFAULT_LEVEL,
+                       BlockWriter::DEFAULT_BLOCK_SUBBLOCKS);
+    }
+}
+
+
+void PythonInterface::setupCallRecorder() {
+    const char * envval = std::getenv(mCallRecorderVariable.c_str());
+    if (envval == NULL || envval[0] == '\0') {
+        return;
+    }
+
+    mCallRecorder = std::make_unique<CallRecorder>(envval);
+    mCallRecorder->recordInit(mCorsikaConfig);
+    updateActiveCalls();
+}
+
+
+void PythonInterface::closeCallRecorder() {
+    if (mCallRecorder) {
+        std::unique_ptr<CallRecorder> recorder = std::move(mCallRecorder);
+        recorder->close();
+    }
+    updateActiveCalls();
+}
+
+
+void PythonInterface::setupSharedRing() {
+    const char * name = std::getenv(mSharedRingVariable.c_str());
+    const char * directories = std::getenv(mInterfacesVariable.c_str());
+    const bool fanOut = directories != NULL && directories[0] != '\0';
+    if (!fanOut && (name == NULL || name[0] == '\0')) {
+        return;
+    }
+
+    std::uint64_t capacity = SharedRing::DEFAULT_CAPACITY;
+    const char * size = std::getenv(mSharedRingSizeVariable.c_str());
+    if (size != NULL && size[0] != '\0') {
+        capacity = std::strtoull(size, NULL, 10);
+    }
+
+    std::uint32_t consumers = 1;
+    const char * count = std::getenv(mSharedRingConsumersVariable.c_str());
+    if (count != NULL && count[0] != '\0') {
+        consumers = std::strtoul(count, NULL, 10);
+    }
+
+    const std::string ringName = name != NULL && name[0] != '\0'
+        ? std::string(name)
+        : "/coast-" + std::to_string(getpid());
+    mSharedRing = SharedRing::create(ringName, capacity);
+    if (fanOut) {
+        spawnConsumers(directories);
+        consumers = mConsumerProcesses.size();
+    }
+    mSharedRing->start(consumers, mConsumerProcesses);
+    mSharedRing->publishInit(mCorsikaConfig);
+}
+
+
+void PythonInterface::spawnConsumers(const std::string & directories) {
+    const filesystem::path consumer = getCoastPath() / mConsumerName;
+    const filesystem::path library = getCoastPath() / mLibraryName;
+    if (!filesystem::exists(consumer)) {
+        throw std::runtime_error("cannot find " + consumer.string() +
+                                 ", build it with make consumer");
+    }
+
+    // every consumer runs one override directory, native plugins only run
+    // in the first one
+    std::vector<std::string> environment;
+    std::string plugins;
+    for (char ** variable = environ; *variable != NULL; ++variable) {
+        const std::string entry = *variable;
+        const std::string key = entry.substr(0, entry.find('='));
+        if (key == mPluginsVariable) {
+            plugins = entry;
+        }
+        else if (key != mInterfaceVariable && key != mInterfacesVariable &&
+            key != mSharedRingVariable) {
+            environment.push_back(entry);
+        }
+    }
+    environment.emplace_back();
+
+    std::size_t begin = 0;
+    while (begin <= directories.size()) {
+        std::size_t end = directories.find(':', begin);
+        if (end == std::string::npos) {
+            end = directories.size();
+        }
+        const std::string directory = directories.substr(begin, end - begin);
+        begin = end + 1;
+        if (directory.empty()) {
+            continue;
+        }
+
+        environment.back() = mInterfaceVariable + "=" + directory;
+        std::vector<char *> envp;
+        for (std::string & entry : environment) {
+            envp.push_back(&entry[0]);
+        }
+        if (mConsumerProcesses.empty() && !plugins.empty()) {
+            envp.push_back(&plugins[0]);
+        }
+        envp.push_back(NULL);
+
+        std::string program = consumer.string();
+        std::string ringName = mSharedRing->getName();
+        std::string libraryPath = library.string();
+        char * argv[] = {&program[0], &ringName[0], &libraryPath[0], NULL};
+
+        pid_t pid = 0;
+        const int error = posix_spawn(&pid, program.c_str(), NULL, NULL,
+                                      argv, envp.data());
+        if (error != 0) {
+            throw std::runtime_error("cannot start " + program + ": " +
+                                     std::strerror(error));
+        }
+        mConsumerProcesses.push_back(pid);
+    }
+
+    if (mConsumerProcesses.empty()) {
+        throw std::invalid_argument(mInterfacesVariable +
+                                    " lists no override directory");
+    }
+}
+
+
+void PythonInterface::waitForConsumerProcesses() {
+    // CORSIKA ends after all analyses are written
+    const std::size_t processes = mConsumerProcesses.size();
+    std::size_t failed = 0;
+    for (const int pid : mConsumerProcesses) {
+        int status = 0;
+        if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status) ||
+            WEXITSTATUS(status) != 0) {
+            ++failed;
+        }
+    }
+    mConsumerProcesses.clear();
+
+    if (failed > 0) {
+        throw std::runtime_error(std::to_string(failed) + " of " +
+                                 std::to_string(processes) +
+                                 " override consumer processes failed");
+    }
+}
+
+
+const InterfaceStats & PythonInterface::getStats() const {
+    return mStats;
+}
+
+
+void PythonInterface::setStatsFile(const std::string & path) {
+    mStatsPath = path;
+}
+
+const std::string & PythonInterface::getStatsFile() const {
+    return mStatsPath;
+}
+
+
+void PythonInterface::setupStats() {
+    const char * envval = std::getenv(mStatsVariable.c_str());
+    if (envval != NULL) {
+        setStatsFile(envval);
+    }
+}
+
+
+void PythonInterface::writeStats() const {
+    if (!mStatsPath.empty()) {
+        mStats.writeSummary(mStatsPath);
+    }
+}
+
+
+void PythonInterface::setTrace(const std::string & path,
+                               std::uint64_t sampleEvery) {
+    // the tracer samples on the CORSIKA and the consumer thread
+    if (mAsyncRunning.load()) {
+        throw std::logic_error("trace cannot be changed while the consumer "
+                               "thread is running");
+    }
+
+    std::unique_ptr<Tracer> tracer;
+    if (!path.empty()) {
+        tracer = std::make_unique<Tracer>(path, sampleEvery);
+        tracer->setThreadName("corsika");
+    }
+
+    if (mTracer) {
+        mTracer->write();
+        mRetiredTracers.push_back(std::move(mTracer));
+    }
+    mTracer = std::move(tracer);
+}
+
+std::string PythonInterface::getTracePath() const {
+    return mTracer ? mTracer->getPath() : std::string();
+}
+
+
+void PythonInterface::beginTraceSpan(const std::string & name) {
+    if (mTracer) {
+        mTracer->begin(name);
+    }
+}
+
+void PythonInterface::endTraceSpan() {
+    if (mTracer) {
+        mTracer->end();
+    }
+}
 
-#include "CorsikaConfig.h"
-#include "CppWrapper.h"
 
+void PythonInterface::setupTracer() {
+    const char * envval = std::getenv(mTraceVariable.c_str());
+    if (envval == NULL || envval[0] == '\0') {
+        return;
+    }
 
-// interface callbacks
+    std::uint64_t sampleEvery = 1;
+    const char * sample = std::getenv(mTraceSampleVariable.c_str());
+    if (sample != NULL && sample[0] != '\0') {
+        sampleEvery = std::strtoull(sample, NULL, 10);
+    }
 
-void PythonInterface::init(const CorsikaConfig & config) {
-    setCorsikaConfig(config);
+    setTrace(envval, sampleEvery);
+}
 
-    PyImport_AppendInittab("cppwrapper_emb", &PyInit_cppwrapper_emb);
-    Py_Initialize();
-    setupPackagesSearchPath();
-    importInterface();
-    setupOverrideSearchPath();
-    runOverride();
-    callPythonInit();
+
+void PythonInterface::closeTracer() {
+    setTrace("", 1);
+    mRetiredTracers.clear();
 }
 
 
-void PythonInterface::close() {
-    callPythonClose();
-    Py_Finalize();
+std::size_t PythonInterface::addHistogram(
+        RecordFilter::RecordType source,
+        const std::vector<Histogram::Axis> & axes, const std::string & weight,
+        const std::string & filter) {
+    HistogramSet * set = &mTrackHistograms;
+    if (source == RecordFilter::RecordType::INTERACTION) {
+        set = &mInteractionHistograms;
+    }
+    else if (source == RecordFilter::RecordType::PARTICLE) {
+        set = &mParticleHistograms;
+    }
+
+    mHistograms.push_back({set, set->add(axes, weight, filter)});
+    updateActiveCalls();
+    return mHistograms.size() - 1;
 }
 
 
-void PythonInterface::write([[maybe_unused]] const CREAL * DataSubBlock) {
-    if (!isCapturingWrite()) {
-        return;
+const Histogram & PythonInterface::getHistogram(std::size_t id) {
+    const HistogramEntry & entry = mHistograms.at(id);
+    entry.set->flush();
+    return entry.set->get(entry.index);
+}
+
+
+PyObject * PythonInterface::getHistogramContents(std::size_t id) {
+    const Histogram & histogram = getHistogram(id);
+    const std::vector<Histogram::Axis> & axes = histogram.getAxes();
+    const std::vector<Py_ssize_t> shape(histogram.getShape().begin(),
+                                        histogram.getShape().end());
+
+    PyObject * edges = PyTuple_New(axes.size());
+    for (std::size_t i = 0; i < axes.size(); ++i) {
+        PyTuple_SET_ITEM(edges, i, getMemoryView(axes[i].edges.data(),
+                                                 axes[i].edges.size()));
     }
 
-    CorsikaConfig::CorsikaOption thinning = getCorsikaConfig().getThinning();
-    int blocklen = 0;
-    switch (thinning) {
-        case CorsikaConfig::CorsikaOption::TRUE:
-            blocklen = 39 * 8 * 4;
-            break;
+    return Py_BuildValue(
+            "(NNNK)",
+            getMemoryView(histogram.getSumW().data(), shape),
+            getMemoryView(histogram.getSumW2().data(), shape),
+            edges,
+            static_cast<unsigned long long>(histogram.getEntries()));
+}
 
-        case CorsikaConfig::CorsikaOption::FALSE:
-            blocklen = 39 * 7 * 4;
-            break;
 
-        case CorsikaConfig::CorsikaOption::UNKNOWN:
-            throw std::runtime_error("corsika option thinning not set");
-            break;
+void PythonInterface::resetHistogram(std::size_t id) {
+    const HistogramEntry & entry = mHistograms.at(id);
+    entry.set->flush();
+    entry.set->get(entry.index).reset();
+}
 
-        default:
-            throw std::domain_error("in write(): unknown corsika option value");
-            break;
+
+std::size_t PythonInterface::getHistogramCount() const {
+    return mHistograms.size();
+}
+
+
+std::size_t PythonInterface::addVoxelGrid(
+        VoxelGrid::Geometry geometry,
+        const std::array<VoxelGrid::Axis, 3> & axes,
+        const std::vector<int> & species,
+        const std::array<double, 3> & core) {
+    // the CORSIKA thread checks the grids for every track
+    if (mAsyncRunning.load()) {
+        throw std::logic_error("voxel grids cannot be added while the "
+                               "consumer thread is running");
     }
 
-    PyObject * result = PyObject_CallMethod(
-            mPython_class_cppaccess, mCppAccessWriteName.c_str(),
-            "y#", (const char *) DataSubBlock, blocklen);
+    mVoxelGrids.push_back(
+        std::make_unique<VoxelGrid>(geometry, axes, species, core));
+    updateActiveCalls();
+    return mVoxelGrids.size() - 1;
+}
+
 
-    if (result == NULL) {
-        PyErr_Print();
-        throw std::runtime_error("error in python call to write()");
+VoxelGrid & PythonInterface::getVoxelGrid(std::size_t id) {
+    return *mVoxelGrids.at(id);
+}
+
+
+std::size_t PythonInterface::getVoxelGridCount() const {
+    return mVoxelGrids.size();
+}
+
+
+PyObject * PythonInterface::getVoxelGridContents(std::size_t id) {
+    VoxelGrid & grid = getVoxelGrid(id);
+    const VoxelGrid::Contents & contents = grid.collect();
+    const Py_ssize_t size = contents.count.size();
+
+    PyObject * edges = PyTuple_New(3);
+    for (std::size_t i = 0; i < 3; ++i) {
+        const std::vector<double> & axis = grid.getEdges(i);
+        PyTuple_SET_ITEM(edges, i, getMemoryView(axis.data(), axis.size()));
     }
 
-    Py_DECREF(result);
+    return Py_BuildValue(
+            "(NNNNNNNNK)",
+            getMemoryView(contents.index[0].data(), size),
+            getMemoryView(contents.index[1].data(), size),
+            getMemoryView(contents.index[2].data(), size),
+            getMemoryView(contents.pathLength.data(), size),
+            getMemoryView(contents.energyDeposit.data(), size),
+            getMemoryView(contents.count.data(), size),
+            getMemoryView(contents.speciesCount.data(), size,
+                          grid.getSpecies().size()),
+            edges,
+            static_cast<unsigned long long>(grid.getSegments()));
 }
 
 
-void PythonInterface::interaction(const crs::CInteraction & info) {
-    if (!isCapturingInteraction()) {
-        return;
+std::size_t PythonInterface::addObserverArray(
+        const std::vector<std::array<double, 3>> & positions,
+        const std::vector<double> & offsets,
+        const ObserverArray::Binning & binning,
+        const ObserverArray::Atmosphere & atmosphere) {
+    // the CORSIKA thread checks the observer arrays for every track
+    if (mAsyncRunning.load()) {
+        throw std::logic_error("observer arrays cannot be added while the "
+                               "consumer thread is running");
     }
 
-    PyObject * result = PyObject_CallMethod(
-            mPython_class_cppaccess, mCppAccessInteractionName.c_str(),
-            "d d d d d d i i",
-            info.x, info.y, info.z, info.etot, info.sigma, info.kela,
-            info.projId, info.targetId);
+    mObserverArrays.push_back(std::make_unique<ObserverArray>(
+            positions, offsets, binning, atmosphere));
+    updateActiveCalls();
+    return mObserverArrays.size() - 1;
+}
 
-    if (result == NULL) {
-        PyErr_Print();
-        throw std::runtime_error("error in python call to interaction()");
+
+ObserverArray & PythonInterface::getObserverArray(std::size_t id) {
+    return *mObserverArrays.at(id);
+}
+
+
+std::size_t PythonInterface::getObserverArrayCount() const {
+    return mObserverArrays.size();
+}
+
+
+PyObject * PythonInterface::getObserverTraces(std::size_t id) {
+    ObserverArray & observers = getObserverArray(id);
+    const ObserverArray::Binning & binning = observers.getBinning();
+    const std::vector<Py_ssize_t> shape = {
+        static_cast<Py_ssize_t>(observers.getObserverCount()), 3,
+        static_cast<Py_ssize_t>(binning.bins)
+    };
+
+    return Py_BuildValue(
+            "(NNddK)",
+            getMemoryView(observers.getVectorPotential().data(), shape),
+            getMemoryView(observers.getElectricField().data(), shape),
+            binning.start, binning.width,
+            static_cast<unsigned long long>(observers.getSegments()));
+}
+
+
+std::size_t PythonInterface::addArrowCollector(
+        RecordFilter::RecordType source, const std::vector<int> & species,
+        const std::vector<int> & levels) {
+    // the CORSIKA thread checks the collectors for every record
+    if (mAsyncRunning.load()) {
+        throw std::logic_error("Arrow collectors cannot be added while the "
+                               "consumer thread is running");
     }
 
-    Py_DECREF(result);
+    mArrowCollectors.push_back(
+        std::make_unique<ArrowCollector>(source, species, levels));
+    updateActiveCalls();
+    return mArrowCollectors.size() - 1;
 }
 
 
-void PythonInterface::track(const crs::CParticle & pre,
-                            const crs::CParticle & post) {
-    if (!isCapturingTrack()) {
+ArrowCollector & PythonInterface::getArrowCollector(std::size_t id) {
+    return *mArrowCollectors.at(id);
+}
+
+
+std::size_t PythonInterface::getArrowCollectorCount() const {
+    return mArrowCollectors.size();
+}
+
+
+void PythonInterface::loadPlugin(const std::string & path) {
+    // the CORSIKA thread calls the plugins
+    if (mAsyncRunning.load()) {
+        throw std::logic_error("plugins cannot be loaded while the consumer "
+                               "thread is running");
+    }
+
+    auto plugin = std::make_unique<NativePlugin>(path);
+    plugin->init(mCorsikaConfig);
+    mPlugins.push_back(std::move(plugin));
+    updateActiveCalls();
+}
+
+
+std::size_t PythonInterface::getPluginCount() const {
+    return mPlugins.size();
+}
+
+
+void PythonInterface::setupPlugins() {
+    const char * envval = std::getenv(mPluginsVariable.c_str());
+    if (envval == NULL) {
         return;
     }
 
-    PyObject * result = PyObject_CallMethod(
-            mPython_class_cppaccess, mCppAccessTrackName.c_str(),
-            "d d d d d d d i i"
-            "d d d d d d d i i",
-            pre.time,  pre.x,  pre.y,  pre.z,  pre.depth,  pre.energy,
-            pre.weight,  pre.particleId,  pre.hadronicGeneration,
+    const std::string paths = envval;
+    std::size_t begin = 0;
+    while (begin <= paths.size()) {
+        std::size_t end = paths.find(':', begin);
+        if (end == std::string::npos) {
+            end = paths.size();
+        }
+        if (end > begin) {
+            loadPlugin(paths.substr(begin, end - begin));
+        }
+        begin = end + 1;
+    }
+}
 
-            post.time, post.x, post.y, post.z, post.depth, post.energy,
-            post.weight, post.particleId, post.hadronicGeneration);
 
-    if (result == NULL) {
-        PyErr_Print();
-        throw std::runtime_error("error in python call to track()");
+void PythonInterface::closePlugins() {
+    for (const std::unique_ptr<NativePlugin> & plugin : mPlugins) {
+        plugin->close();
     }
+    mPlugins.clear();
+    updateActiveCalls();
+}
 
-    Py_DECREF(result);
+
+bool PythonInterface::isCollecting(RecordFilter::RecordType source) const {
+    for (const std::unique_ptr<ArrowCollector> & collector :
+            mArrowCollectors) {
+        if (collector->getSource() == source) {
+            return true;
+        }
+    }
+    return false;
 }
 
 
-// singleton setup
+void PythonInterface::collectParticles(const CREAL * DataSubBlock) {
+    if (mSubBlockEntries == 0) {
+        writeUnknown(DataSubBlock);
+    }
 
-PythonInterface * PythonInterface::_instance = nullptr;
+    for (const std::unique_ptr<ArrowCollector> & collector :
+            mArrowCollectors) {
+        if (collector->getSource() == RecordFilter::RecordType::PARTICLE) {
+            collector->add(DataSubBlock, mSubBlockEntries);
+        }
+    }
+}
 
-PythonInterface * PythonInterface::instance() {
-    static CGuard g;
-    if (_instance == nullptr) {
-        _instance = new PythonInterface();
+
+bool PythonInterface::isFillingInteractions() const {
+    return mInteractionHistograms.isActive() ||
+           isCollecting(RecordFilter::RecordType::INTERACTION);
+}
+
+
+void PythonInterface::fillInteractions(const crs::CInteraction & info) {
+    if (mInteractionHistograms.isActive()) {
+        mInteractionHistograms.fill(info);
     }
+    for (const std::unique_ptr<ArrowCollector> & collector :
+            mArrowCollectors) {
+        if (collector->getSource() ==
+                RecordFilter::RecordType::INTERACTION) {
+            collector->add(info);
+        }
+    }
+}
 
-    return _instance;
+
+bool PythonInterface::isFillingTracks() const {
+    return mTrackHistograms.isActive() || !mVoxelGrids.empty() ||
+           mSurfaceDetector.isActive() || !mObserverArrays.empty() ||
+           isCollecting(RecordFilter::RecordType::TRACK);
 }
 
 
-// member functions
+void PythonInterface::fillTracks(const crs::CParticle & pre,
+                                 const crs::CParticle & post) {
+    if (mTrackHistograms.isActive()) {
+        mTrackHistograms.fill(pre, post);
+    }
+    for (const std::unique_ptr<VoxelGrid> & grid : mVoxelGrids) {
+        grid->deposit(pre, post);
+    }
+    detectCrossings(pre, post);
+    for (const std::unique_ptr<ObserverArray> & observers :
+            mObserverArrays) {
+        observers->add(pre, post);
+    }
+    for (const std::unique_ptr<ArrowCollector> & collector :
+            mArrowCollectors) {
+        if (collector->getSource() == RecordFilter::RecordType::TRACK) {
+            collector->add(pre, post);
+        }
+    }
+}
 
-void PythonInterface::captureWrite(bool val) {
-    std::scoped_lock<std::mutex> lock(mCaptureWrite_mutex);
-    mCaptureWrite = val;
+
+int PythonInterface::addPlane(const std::array<double, 3> & point,
+                              const std::array<double, 3> & normal,
+                              double radius) {
+    checkSurfacesNotRunning();
+    const int id = mSurfaceDetector.addPlane(point, normal, radius);
+    updateActiveCalls();
+    return id;
 }
 
-bool PythonInterface::isCapturingWrite() const {
-    // don't lock just wait for unlock
-    std::unique_lock<std::mutex> lock(mCaptureWrite_mutex);
-    lock.unlock();
-    return mCaptureWrite;
+
+int PythonInterface::addSphere(const std::array<double, 3> & center,
+                               double radius) {
+    checkSurfacesNotRunning();
+    const int id = mSurfaceDetector.addSphere(center, radius);
+    updateActiveCalls();
+    return id;
 }
 
 
-void PythonInterface::captureInteraction(bool val) {
-    std::scoped_lock<std::mutex> lock(mCaptureInteraction_mutex);
-    mCaptureInteraction = val;
+void PythonInterface::clearSurfaces() {
+    checkNotDelivering();
+    checkSurfacesNotRunning();
+    flushCrossings();
+    mSurfaceDetector.clear();
+    updateActiveCalls();
 }
 
-bool PythonInterface::isCapturingInteraction() const {
-    // don't lock just wait for unlock
-    std::unique_lock<std::mutex> lock(mCaptureInteraction_mutex);
-    lock.unlock();
-    return mCaptureInteraction;
+
+void PythonInterface::checkSurfacesNotRunning() const {
+    // the CORSIKA thread checks the surfaces for every track
+    if (mAsyncRunning.load()) {
+        throw std::logic_error("surfaces cannot be changed while the "
+                               "consumer thread is running");
+    }
 }
 
 
-void PythonInterface::captureTrack(bool val) {
-    std::scoped_lock<std::mutex> lock(mCaptureTrack_mutex);
-    mCaptureTrack = val;
+void PythonInterface::detectCrossings(const crs::CParticle & pre,
+                                      const crs::CParticle & post) {
+    // crossings are only collected for an override that receives them
+    if (!mSurfaceDetector.isActive() || mPython_callback_crossings == NULL) {
+        return;
+    }
+
+    mSurfaceDetector.detect(pre, post);
+    if (mSurfaceDetector.isFull()) {
+        flushCrossings();
+    }
 }
 
-bool PythonInterface::isCapturingTrack() const {
-    // don't lock just wait for unlock
-    std::unique_lock<std::mutex> lock(mCaptureTrack_mutex);
-    lock.unlock();
-    return mCaptureTrack;
+
+void PythonInterface::fillParticleHistograms(const CREAL * DataSubBlock) {
+    if (mSubBlockEntries == 0) {
+        writeUnknown(DataSubBlock);
+    }
+
+    mParticleHistograms.fill(DataSubBlock, mSubBlockEntries);
 }
 
 
-void PythonInterface::setCorsikaConfig(const CorsikaConfig & config) {
-    mCorsikaConfig = config;
+void PythonInterface::flushHistograms() {
+    mTrackHistograms.flush();
+    mInteractionHistograms.flush();
+    mParticleHistograms.flush();
 }
 
-CorsikaConfig PythonInterface::getCorsikaConfig() const {
-    return mCorsikaConfig;
+
+void PythonInterface::setSamplingSeed(std::uint64_t seed) {
+    // independent sequences for tracks and interactions
+    mTrackSampler.setSeed(seed);
+    mInteractionSampler.setSeed(seed ^ 0x5DEECE66Dull);
+}
+
+
+void PythonInterface::checkNotDelivering() const {
+    // python holds views on C++ buffers during delivery
+    if (mDeliveringViews) {
+        throw std::logic_error(
+                "cannot change the interface configuration from within "
+                "a call that receives memoryviews");
+    }
 }
 
 
@@ -187,30 +1813,37 @@ void PythonInterface::setupPackagesSearchPath() const {
 }
 
 
-void PythonInterface::setupOverrideSearchPath() {
-    if (!mOverridePath.empty()) {
-        return;
-    }
-
-    const char * envval = std::getenv("CORSIKA_PYTHON_INTERFACE");
+filesystem::path PythonInterface::findOverrideDirectory() const {
+    const char * envval = std::getenv(mInterfaceVariable.c_str());
     if (envval != NULL) {
         filesystem::path pythonPath(envval);
-        mOverridePath = pythonPath / mOverrideName;
-        if (filesystem::exists(mOverridePath)) {
-            addPythonSearchPath(pythonPath);
-            return;
+        if (filesystem::exists(pythonPath / mOverrideName)) {
+            return pythonPath;
         }
     }
 
     auto coastPath = getCoastPath();
-    mOverridePath = coastPath / mOverrideName;
-    if (filesystem::exists(mOverridePath)) {
-        addPythonSearchPath(coastPath);
+    if (filesystem::exists(coastPath / mOverrideName)) {
+        return coastPath;
+    }
+
+    return filesystem::path();
+}
+
+
+void PythonInterface::setupOverrideSearchPath() {
+    if (!mOverridePath.empty()) {
         return;
     }
 
-    throw std::runtime_error(
-            std::string("cannot find python file ") + mOverrideName);
+    const filesystem::path directory = findOverrideDirectory();
+    if (directory.empty()) {
+        throw std::runtime_error(
+                std::string("cannot find python file ") + mOverrideName);
+    }
+
+    mOverridePath = directory / mOverrideName;
+    addPythonSearchPath(directory);
 }
 
 
@@ -240,30 +1873,373 @@ void PythonInterface::runOverride() const {
 }
 
 
-void PythonInterface::callPythonInit() const {
-    PyObject * result = PyObject_CallMethod(
-            mPython_class_cppaccess, mCppAccessInitName.c_str(), NULL);
-
-    if (result == NULL) {
+void PythonInterface::updateCallbacks() {
+    PyObject * callbacks = PyObject_CallMethod(
+            mPython_class_cppaccess, mCppAccessCallbacksName.c_str(), NULL);
+
+    PyObject * init = NULL;
+    PyObject * close = NULL;
+    PyObject * write = NULL;
+    PyObject * interaction = NULL;
+    PyObject * track = NULL;
+    PyObject * writeParticles = NULL;
+    PyObject * showerBegin = NULL;
+    PyObject * showerEnd = NULL;
+    PyObject * crossings = NULL;
+    PyObject * trackBatch = NULL;
+    PyObject * interactionBatch = NULL;
+    if (callbacks == NULL || !PyArg_ParseTuple(
+                callbacks, "OOOOOOOOOOO;python callbacks",
+                &init, &close, &write, &interaction, &track,
+                &writeParticles, &showerBegin, &showerEnd, &crossings,
+                &trackBatch, &interactionBatch)) {
+        Py_XDECREF(callbacks);
         PyErr_Print();
-        throw std::runtime_error("error in python call to init()");
+        throw std::runtime_error("cannot resolve python callbacks");
     }
 
-    Py_DECREF(result);
+    releaseCallbacks();
+    Py_INCREF(init);
+    Py_INCREF(close);
+    Py_INCREF(write);
+    Py_INCREF(interaction);
+    Py_INCREF(track);
+    Py_INCREF(trackBatch);
+    Py_INCREF(interactionBatch);
+    mPython_callback_init = init;
+    mPython_callback_close = close;
+    mPython_callback_write = write;
+    mPython_callback_interaction = interaction;
+    mPython_callback_track = track;
+    mPython_callback_track_batch = trackBatch;
+    mPython_callback_interaction_batch = interactionBatch;
+    if (writeParticles != Py_None) {
+        Py_INCREF(writeParticles);
+        mPython_callback_write_particles = writeParticles;
+    }
+    else {
+        // pending particles are not wanted by the new interface
+        mParticleDecoder.clear();
+        mParticleBlocks = 0;
+    }
+    if (showerBegin != Py_None) {
+        Py_INCREF(showerBegin);
+        mPython_callback_shower_begin = showerBegin;
+    }
+    if (showerEnd != Py_None) {
+        Py_INCREF(showerEnd);
+        mPython_callback_shower_end = showerEnd;
+    }
+    if (crossings != Py_None) {
+        Py_INCREF(crossings);
+        mPython_callback_crossings = crossings;
+    }
+    else {
+        mSurfaceDetector.clearCrossings();
+    }
+
+    Py_DECREF(callbacks);
+    installCallbacks();
+    updateActiveCalls();
+}
+
+
+void PythonInterface::releaseCallbacks() {
+    Py_CLEAR(mPython_callback_init);
+    Py_CLEAR(mPython_callback_close);
+    Py_CLEAR(mPython_callback_write);
+    Py_CLEAR(mPython_callback_interaction);
+    Py_CLEAR(mPython_callback_track);
+    Py_CLEAR(mPython_callback_write_particles);
+    Py_CLEAR(mPython_callback_shower_begin);
+    Py_CLEAR(mPython_callback_shower_end);
+    Py_CLEAR(mPython_callback_crossings);
+    Py_CLEAR(mPython_callback_track_batch);
+    Py_CLEAR(mPython_callback_interaction_batch);
 }
 
 
-void PythonInterface::callPythonClose() const {
-    PyObject * result = PyObject_CallMethod(
-            mPython_class_cppaccess, mCppAccessCloseName.c_str(), NULL);
+void PythonInterface::callPython(PyObject * callable, PyObject ** args,
+                                 std::size_t nargs,
+                                 InterfaceStats::Callback callback) {
+    // args[0] is reserved such that bound methods can prepend self without
+    // copying the arguments; args[1..nargs] are stolen references
+    bool valid = true;
+    for (std::size_t i = 1; i <= nargs; ++i) {
+        valid = valid && args[i] != NULL;
+    }
+
+    // python may patch the interface and release the callable during the call
+    PyObject * result = NULL;
+    if (valid) {
+        const std::uint64_t start = InterfaceStats::now();
+        Py_INCREF(callable);
+        result = PyObject_Vectorcall(
+                callable, args + 1, nargs | PY_VECTORCALL_ARGUMENTS_OFFSET,
+                NULL);
+        Py_DECREF(callable);
+        mStats.addLatency(callback, start);
+    }
+
+    for (std::size_t i = 1; i <= nargs; ++i) {
+        Py_XDECREF(args[i]);
+    }
 
     if (result == NULL) {
         PyErr_Print();
-        throw std::runtime_error("error in python call to close()");
+    }
+
+    // views on C++ buffers are released after the call, such that later
+    // access raises a ValueError instead of reading reused memory
+    const bool released = releaseLentViews();
+
+    if (result == NULL) {
+        throw std::runtime_error(std::string("error in python call to ") +
+                                 InterfaceStats::getName(callback) + "()");
     }
 
     Py_DECREF(result);
+
+    if (!released) {
+        throw std::runtime_error(
+                std::string("python keeps buffers of the views passed to ") +
+                InterfaceStats::getName(callback) + "(), copy the data "
+                "instead");
+    }
+}
+
+
+PyObject * PythonInterface::lendView(PyObject * view) {
+    Py_INCREF(view);
+    mLentViews.push_back(view);
+    return view;
+}
+
+
+bool PythonInterface::releaseLentViews() {
+    bool released = true;
+    for (PyObject * view : mLentViews) {
+        // fails while python holds a buffer of the view, e.g. a numpy array
+        PyObject * result = PyObject_CallMethod(view, "release", NULL);
+        if (result == NULL) {
+            PyErr_Clear();
+            released = false;
+        }
+        Py_XDECREF(result);
+        Py_DECREF(view);
+    }
+    mLentViews.clear();
+    return released;
+}
+
+
+void PythonInterface::callPythonInit() {
+    PyObject * args[1] = {NULL};
+    callPython(mPython_callback_init, args, 0,
+               InterfaceStats::Callback::INIT);
+}
+
+
+void PythonInterface::callPythonClose() {
+    PyObject * args[1] = {NULL};
+    callPython(mPython_callback_close, args, 0,
+               InterfaceStats::Callback::CLOSE);
+
+    releaseCallbacks();
     Py_XDECREF(mPython_module_interface);
     Py_XDECREF(mPython_class_cppaccess);
 }
 
+
+
+void PythonInterface::callPythonWrite(PyObject * subblock) {
+    PyObject * args[2] = {NULL, subblock};
+    callPython(mPython_callback_write, args, 1,
+               InterfaceStats::Callback::WRITE);
+    mDeliveringViews = false;
+}
+
+
+void PythonInterface::flushWriteStaging() {
+    if (mWriteStagingBlocks == 0) {
+        return;
+    }
+
+    Py_ssize_t rows = mWriteStagingBlocks * 39;
+    mWriteStagingBlocks = 0;
+    mDeliveringViews = true;
+    callPythonWrite(lendView(
+            getMemoryView(mWriteStaging.data(), rows, mSubBlockEntries)));
+}
+
+
+void PythonInterface::flushParticles() {
+    mParticleBlocks = 0;
+    const Py_ssize_t size = mParticleDecoder.getSize();
+    if (size == 0) {
+        return;
+    }
+
+    const ParticleDecoder::Columns & c = mParticleDecoder.getColumns();
+    mDeliveringViews = true;
+    PyObject * args[11] = {
+        NULL,
+        lendView(getMemoryView(c.particleId.data(), size)),
+        lendView(getMemoryView(c.hadronicGeneration.data(), size)),
+        lendView(getMemoryView(c.observationLevel.data(), size)),
+        lendView(getMemoryView(c.px.data(), size)),
+        lendView(getMemoryView(c.py.data(), size)),
+        lendView(getMemoryView(c.pz.data(), size)),
+        lendView(getMemoryView(c.x.data(), size)),
+        lendView(getMemoryView(c.y.data(), size)),
+        lendView(getMemoryView(c.time.data(), size)),
+        lendView(getMemoryView(c.weight.data(), size))
+    };
+    mParticleDecoder.clear();
+    mStats.count(InterfaceStats::Callback::PARTICLES, true, 0);
+    callPython(mPython_callback_write_particles, args, 10,
+               InterfaceStats::Callback::PARTICLES);
+    mDeliveringViews = false;
+}
+
+
+void PythonInterface::flushCrossings() {
+    const Py_ssize_t size = mSurfaceDetector.getSize();
+    if (size == 0) {
+        return;
+    }
+
+    const SurfaceDetector::Crossings & c = mSurfaceDetector.getCrossings();
+    mDeliveringViews = true;
+    PyObject * args[13] = {
+        NULL,
+        lendView(getMemoryView(c.surfaceId.data(), size)),
+        lendView(getMemoryView(c.particleId.data(), size)),
+        lendView(getMemoryView(c.x.data(), size)),
+        lendView(getMemoryView(c.y.data(), size)),
+        lendView(getMemoryView(c.z.data(), size)),
+        lendView(getMemoryView(c.depth.data(), size)),
+        lendView(getMemoryView(c.time.data(), size)),
+        lendView(getMemoryView(c.energy.data(), size)),
+        lendView(getMemoryView(c.weight.data(), size)),
+        lendView(getMemoryView(c.ux.data(), size)),
+        lendView(getMemoryView(c.uy.data(), size)),
+        lendView(getMemoryView(c.uz.data(), size))
+    };
+    mSurfaceDetector.clearCrossings();
+    mStats.count(InterfaceStats::Callback::CROSSINGS, true, 0);
+    callPython(mPython_callback_crossings, args, 12,
+               InterfaceStats::Callback::CROSSINGS);
+    mDeliveringViews = false;
+}
+
+
+void PythonInterface::flushTrackBatch() {
+    if (mTrackBatch.isEmpty()) {
+        return;
+    }
+
+    Py_ssize_t size = mTrackBatch.getSize();
+    mTrackBatch.clear();
+    mDeliveringViews = true;
+    PyObject * args[4] = {
+        NULL,
+        getParticleColumns(mTrackBatch.getPre(), size),
+        getParticleColumns(mTrackBatch.getPost(), size),
+        getDerivedColumns(mTrackFilter.getColumnNames(), mTrackBatch, size)
+    };
+    callPython(mPython_callback_track_batch, args, 3,
+               InterfaceStats::Callback::TRACK);
+    mDeliveringViews = false;
+}
+
+
+void PythonInterface::flushInteractionBatch() {
+    if (mInteractionBatch.isEmpty()) {
+        return;
+    }
+
+    Py_ssize_t size = mInteractionBatch.getSize();
+    mInteractionBatch.clear();
+    mDeliveringViews = true;
+
+    const auto & columns = mInteractionBatch.getColumns();
+    PyObject * args[10] = {
+        NULL,
+        lendView(getMemoryView(columns.x.data(), size)),
+        lendView(getMemoryView(columns.y.data(), size)),
+        lendView(getMemoryView(columns.z.data(), size)),
+        lendView(getMemoryView(columns.etot.data(), size)),
+        lendView(getMemoryView(columns.sigma.data(), size)),
+        lendView(getMemoryView(columns.kela.data(), size)),
+        lendView(getMemoryView(columns.projId.data(), size)),
+        lendView(getMemoryView(columns.targetId.data(), size)),
+        getDerivedColumns(mInteractionFilter.getColumnNames(),
+                          mInteractionBatch, size)
+    };
+    callPython(mPython_callback_interaction_batch, args, 9,
+               InterfaceStats::Callback::INTERACTION);
+    mDeliveringViews = false;
+}
+
+
+PyObject * PythonInterface::getDerivedValues(
+        const std::vector<std::string> & names, const double * values) const {
+    PyObject * derived = PyDict_New();
+    if (derived == NULL) {
+        return NULL;
+    }
+
+    for (std::size_t k = 0; k < names.size(); ++k) {
+        PyObject * value = PyFloat_FromDouble(values[k]);
+        if (value == NULL ||
+            PyDict_SetItemString(derived, names[k].c_str(), value) < 0) {
+            Py_XDECREF(value);
+            Py_DECREF(derived);
+            return NULL;
+        }
+        Py_DECREF(value);
+    }
+
+    return derived;
+}
+
+
+template <typename Batch>
+PyObject * PythonInterface::getDerivedColumns(
+        const std::vector<std::string> & names, const Batch & batch,
+        Py_ssize_t size) {
+    PyObject * derived = PyDict_New();
+    if (derived == NULL) {
+        return NULL;
+    }
+
+    for (std::size_t k = 0; k < batch.getDerivedCount(); ++k) {
+        PyObject * column =
+            lendView(getMemoryView(batch.getDerived(k), size));
+        if (PyDict_SetItemString(derived, names[k].c_str(), column) < 0) {
+            Py_DECREF(column);
+            Py_DECREF(derived);
+            return NULL;
+        }
+        Py_DECREF(column);
+    }
+
+    return derived;
+}
+
+
+PyObject * PythonInterface::getParticleColumns(
+        const TrackBatch::ParticleColumns & columns, Py_ssize_t size) {
+    return Py_BuildValue(
+            "(NNNNNNNNN)",
+            lendView(getMemoryView(columns.time.data(), size)),
+            lendView(getMemoryView(columns.x.data(), size)),
+            lendView(getMemoryView(columns.y.data(), size)),
+            lendView(getMemoryView(columns.z.data(), size)),
+            lendView(getMemoryView(columns.depth.data(), size)),
+            lendView(getMemoryView(columns.energy.data(), size)),
+            lendView(getMemoryView(columns.weight.data(), size)),
+            lendView(getMemoryView(columns.particleId.data(), size)),
+            lendView(getMemoryView(columns.hadronicGeneration.data(), size)));
+}
@@ -7,9 +7,15 @@
 #define PY_SSIZE_T_CLEAN
 #include <Python.h>
 
+#include <array>
 #include <cstddef>
+#include <cstdint>
 #include <string>
-#include <mutex>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <vector>
 #include "stdfilesystem.h"
 
 #include <crs/CorsikaTypes.h>
@@ -18,9 +24,36 @@
 
 #include "PythonWrapper.h"
 #include "CorsikaConfig.h"
+#include "TrackBatch.h"
+#include "InteractionBatch.h"
+#include "RecordFilter.h"
+#include "RecordSampler.h"
+#include "RecordQueue.h"
+#include "ColumnWriter.h"
+#include "BlockWriter.h"
+#include "Histogram.h"
+#include "HistogramSet.h"
+#include "ParticleDecoder.h"
+#include "ShowerBoundary.h"
+#include "VoxelGrid.h"
+#include "SurfaceDetector.h"
+#include "ObserverArray.h"
+#include "ArrowCollector.h"
+#include "NativePlugin.h"
+#include "CallRecorder.h"
+#include "SharedRing.h"
+#include "InterfaceStats.h"
+#include "Tracer.h"
 
 
-/** Singelton class that handles the Python-COAST interface. */
+/** Singelton class that handles the Python-COAST interface.
+ *
+ * Every COAST call reaches the native sinks, i.e. plugins, writers,
+ * histograms, voxel grids, surfaces, observer arrays and Arrow collectors,
+ * before capture flags, sampling and filters select what python receives.
+ * Plugins and writers run on the CORSIKA thread, in asynchronous mode the
+ * consumer thread fills the other sinks.
+ */
 class PythonInterface : private PythonWrapper {
     
     // singleton handling
@@ -46,24 +79,141 @@ class PythonInterface : private PythonWrapper {
     private:
         CorsikaConfig mCorsikaConfig;
 
-        mutable std::mutex mCaptureWrite_mutex;
-        bool mCaptureWrite = true;
-        mutable std::mutex mCaptureInteraction_mutex;
-        bool mCaptureInteraction = true;
-        mutable std::mutex mCaptureTrack_mutex;
-        bool mCaptureTrack = true;
+        // hot path dispatch, installed whenever the configuration changes
+        using WriteHandler = void (PythonInterface::*)(const CREAL *);
+        using InteractionHandler =
+            void (PythonInterface::*)(const crs::CInteraction &);
+        using TrackHandler = void (PythonInterface::*)(
+                const crs::CParticle &, const crs::CParticle &);
+
+        struct CallbackTable {
+            WriteHandler write = &PythonInterface::writeUnknown;
+            InteractionHandler interaction =
+                &PythonInterface::interactionDirect;
+            TrackHandler track = &PythonInterface::trackDirect;
+            InteractionHandler sampledInteraction =
+                &PythonInterface::interactionDirect;
+            TrackHandler sampledTrack = &PythonInterface::trackDirect;
+        };
+
+        CallbackTable mCallbackTable;
+
+        static constexpr unsigned int CAPTURE_WRITE = 1u << 0;
+        static constexpr unsigned int CAPTURE_INTERACTION = 1u << 1;
+        static constexpr unsigned int CAPTURE_TRACK = 1u << 2;
+        std::atomic<unsigned int> mCaptureMask{
+            CAPTURE_WRITE | CAPTURE_INTERACTION | CAPTURE_TRACK};
+        // calls that python or a native sink receives, a single load decides
+        // if a COAST call returns immediately (see updateActiveCalls())
+        std::atomic<unsigned int> mActiveCalls{
+            CAPTURE_WRITE | CAPTURE_INTERACTION | CAPTURE_TRACK};
+
+        std::size_t mBatchSize = 0;
+        bool mDeliveringViews = false;
+        std::vector<PyObject *> mLentViews;
+
+        RecordFilter mTrackFilter{RecordFilter::RecordType::TRACK};
+        RecordFilter mInteractionFilter{
+            RecordFilter::RecordType::INTERACTION};
+        std::vector<crs::CParticle> mTrackPendingPre =
+            std::vector<crs::CParticle>(Expression::BLOCK);
+        std::vector<crs::CParticle> mTrackPendingPost =
+            std::vector<crs::CParticle>(Expression::BLOCK);
+        std::size_t mTrackPendingSize = 0;
+        std::vector<crs::CInteraction> mInteractionPending =
+            std::vector<crs::CInteraction>(Expression::BLOCK);
+        std::size_t mInteractionPendingSize = 0;
+
+        RecordSampler mTrackSampler;
+        RecordSampler mInteractionSampler;
+        double mInteractionSamplingWeight = 1.0;
+
+        std::size_t mAsyncCapacity = 0;
+        RecordQueue::Policy mAsyncPolicy = RecordQueue::Policy::BLOCK;
+        std::unique_ptr<RecordQueue> mAsyncQueue;
+        std::atomic<bool> mAsyncRunning{false};
+        std::size_t mAsyncWriteSize = 0;
+        std::thread mAsyncConsumer;
+        PyThreadState * mAsyncMainState = NULL;
+        std::exception_ptr mAsyncError;
+
+        std::unique_ptr<ColumnWriter> mColumnWriter;
+        std::unique_ptr<BlockWriter> mBlockWriter;
+
+        struct HistogramEntry {
+            HistogramSet * set;
+            std::size_t index;
+        };
+
+        HistogramSet mTrackHistograms{RecordFilter::RecordType::TRACK};
+        HistogramSet mInteractionHistograms{
+            RecordFilter::RecordType::INTERACTION};
+        HistogramSet mParticleHistograms{RecordFilter::RecordType::PARTICLE};
+        std::vector<HistogramEntry> mHistograms;
+        std::vector<std::unique_ptr<VoxelGrid>> mVoxelGrids;
+        SurfaceDetector mSurfaceDetector;
+        std::vector<std::unique_ptr<ObserverArray>> mObserverArrays;
+        std::vector<std::unique_ptr<ArrowCollector>> mArrowCollectors;
+
+        std::vector<std::unique_ptr<NativePlugin>> mPlugins;
+        bool mPythonRunning = false;
+
+        std::unique_ptr<CallRecorder> mCallRecorder;
+        std::unique_ptr<SharedRing> mSharedRing;
+        std::vector<int> mConsumerProcesses;
+
+        InterfaceStats mStats;
+        std::string mStatsPath;
+
+        // replaced tracers stay alive, spans of python callbacks may still
+        // refer to them
+        std::unique_ptr<Tracer> mTracer;
+        std::vector<std::unique_ptr<Tracer>> mRetiredTracers;
+
+        int mSubBlockEntries = 0;
+        std::size_t mWriteBlockCount = 0;
+        std::vector<CREAL> mWriteStaging;
+        std::size_t mWriteStagingBlocks = 0;
+        ParticleDecoder mParticleDecoder;
+        std::size_t mParticleBlocks = 0;
+        ShowerBoundary mShowerBoundary;
+        TrackBatch mTrackBatch;
+        InteractionBatch mInteractionBatch;
 
         const std::string mInterfaceName = "interface";
         PyObject * mPython_module_interface = NULL;
         const std::string mCppAccessName = "instance";
         PyObject * mPython_class_cppaccess = NULL;
-        const std::string mCppAccessInitName = "_init";
-        const std::string mCppAccessCloseName = "_close";
-        const std::string mCppAccessWriteName = "_write";
-        const std::string mCppAccessInteractionName = "_interaction";
-        const std::string mCppAccessTrackName = "_track";
+        const std::string mCppAccessCallbacksName = "_callbacks";
+
+        PyObject * mPython_callback_init = NULL;
+        PyObject * mPython_callback_close = NULL;
+        PyObject * mPython_callback_write = NULL;
+        PyObject * mPython_callback_interaction = NULL;
+        PyObject * mPython_callback_track = NULL;
+        PyObject * mPython_callback_write_particles = NULL;
+        PyObject * mPython_callback_shower_begin = NULL;
+        PyObject * mPython_callback_shower_end = NULL;
+        PyObject * mPython_callback_crossings = NULL;
+        PyObject * mPython_callback_track_batch = NULL;
+        PyObject * mPython_callback_interaction_batch = NULL;
 
         const std::string mOverrideName = "override.py";
+        const std::string mInterfaceVariable = "CORSIKA_PYTHON_INTERFACE";
+        const std::string mInterfacesVariable = "CORSIKA_PYTHON_INTERFACES";
+        const std::string mConsumerName = "coast_consumer";
+        const std::string mLibraryName = "libCOAST.so";
+        const std::string mColumnWriterVariable = "CORSIKA_PYTHON_COLUMNS";
+        const std::string mBlockWriterVariable = "CORSIKA_PYTHON_BLOCKS";
+        const std::string mCallRecorderVariable = "CORSIKA_PYTHON_RECORD";
+        const std::string mStatsVariable = "CORSIKA_PYTHON_STATS";
+        const std::string mSharedRingVariable = "CORSIKA_PYTHON_SHM";
+        const std::string mSharedRingSizeVariable = "CORSIKA_PYTHON_SHM_SIZE";
+        const std::string mSharedRingConsumersVariable =
+            "CORSIKA_PYTHON_SHM_CONSUMERS";
+        const std::string mTraceVariable = "CORSIKA_PYTHON_TRACE";
+        const std::string mTraceSampleVariable = "CORSIKA_PYTHON_TRACE_SAMPLE";
+        const std::string mPluginsVariable = "CORSIKA_PYTHON_PLUGINS";
         filesystem::path mOverridePath;
 
 
@@ -73,7 +223,23 @@ class PythonInterface : private PythonWrapper {
 
         /** Initialize the interface.
          *
-         * Gets called by the COAST function inida_(...).
+         * Gets called by the COAST function inida_(...). If the environment
+         * variable CORSIKA_PYTHON_RECORD is set, all COAST calls are
+         * recorded into that file for offline replay (see CallRecorder).
+         *
+         * If CORSIKA_PYTHON_SHM is set, python is not started in this
+         * process. All COAST calls are published into a shared-memory ring
+         * of that name instead (see SharedRing), whose consumer processes
+         * (coast_consumer) run the override. CORSIKA_PYTHON_SHM_SIZE sets the
+         * ring size in bytes and CORSIKA_PYTHON_SHM_CONSUMERS the number of
+         * consumers to wait for (default 1). The other environment
+         * variables then apply to the consumers.
+         *
+         * If CORSIKA_PYTHON_INTERFACES is set to a ':' separated list of
+         * override directories, one coast_consumer process per directory
+         * is started on such a ring (named CORSIKA_PYTHON_SHM or after the
+         * process id), such that the overrides run in parallel, each with
+         * its own interpreter and capture flags. close() waits for them.
          *
          * @param config CorsikaConfig information.
          */
@@ -157,18 +323,557 @@ class PythonInterface : private PythonWrapper {
          */
         bool isCapturingTrack() const;
 
+        /** Get the COAST calls the interface currently processes.
+         *
+         * Calls are processed if they are captured, filled into
+         * histograms, written to columns or recorded. Consumers of a
+         * shared-memory ring announce them, such that CORSIKA only
+         * publishes calls that are processed (see SharedRing).
+         *
+         * @return Combination of write (bit 0), interaction (bit 1) and
+         * track (bit 2).
+         */
+        unsigned int getRequiredCalls() const;
+
+        /** Resolve the python callables for init(), close(), write(),
+         * interaction(), track(), write_particles(), shower_begin(),
+         * shower_end(), crossings() and the batch deliveries.
+         *
+         * The callables are requested once from the python CppAccess
+         * instance and afterwards called directly through the vectorcall
+         * protocol. Gets called during init(...) and whenever python patches
+         * the interface.
+         */
+        void updateCallbacks();
+
         /** Return CorsikaConfig information */
-        CorsikaConfig getCorsikaConfig() const;
+        const CorsikaConfig & getCorsikaConfig() const;
+
+        /** Set the number of entries that are collected before they are
+         * handed over to python.
+         *
+         * With a batch size > 0, COAST track_(...) and interaction_(...)
+         * calls are stored in column buffers and delivered to the python
+         * methods _track_batch(...) and _interaction_batch(...) whenever a
+         * buffer is full and at cloda_(...). Pending entries are delivered
+         * before the batch size changes. Throws a std::logic_error if called
+         * while a batch is delivered.
+         *
+         * @param size Number of entries per batch; 0 = no batching.
+         */
+        void setBatchSize(std::size_t size);
+
+        /** Get the number of entries that are collected before they are
+         * handed over to python; 0 = no batching. */
+        std::size_t getBatchSize() const;
+
+        /** Set how CORSIKA subblocks are handed over to python write().
+         *
+         * - 0: every subblock is copied into a python bytes object.
+         * - 1: every subblock is passed as read-only float memoryview of
+         *   shape (39, entries) on the CORSIKA buffer without copying.
+         * - K > 1: K subblocks are collected in a reused staging buffer and
+         *   passed as read-only memoryview of shape (K * 39, entries).
+         *   Pending subblocks are delivered at cloda_(...) or before the
+         *   count changes.
+         *
+         * Views are released after the python call, later access raises a
+         * ValueError. Throws a std::logic_error if called while subblocks
+         * are delivered.
+         *
+         * @param count Number of subblocks per python call; 0 = bytes.
+         */
+        void setWriteBlockCount(std::size_t count);
+
+        /** Get the number of subblocks per python write() call; 0 = bytes. */
+        std::size_t getWriteBlockCount() const;
+
+        /** Restrict the particles delivered to python write_particles().
+         *
+         * If the override defines write_particles(...), it replaces
+         * write(...): subblocks are decoded natively (see ParticleDecoder)
+         * and the particles of max(1, getWriteBlockCount()) subblocks are
+         * delivered as columns. Pending particles are delivered before the
+         * filter changes. Throws a std::invalid_argument for invalid IDs or
+         * levels and a std::logic_error if called while particles are
+         * delivered.
+         *
+         * @param species Accepted particle IDs; empty = all particles.
+         * @param levels Accepted observation levels; empty = all levels.
+         */
+        void setParticleFilter(const std::vector<int> & species,
+                               const std::vector<int> & levels);
+
+        /** Only deliver tracks to python that pass a filter expression.
+         *
+         * The expression is compiled once and evaluated natively for every
+         * captured track (see RecordFilter for the available variables).
+         * Pending tracks are delivered before the filter changes. Throws a
+         * std::invalid_argument if the expression cannot be compiled.
+         *
+         * @param source Expression in python syntax; empty = accept all.
+         */
+        void setTrackFilter(const std::string & source);
+
+        /** Add a natively computed column to the delivered tracks.
+         *
+         * Derived values are passed as additional dict argument to python
+         * track() or track_batch(). Pending tracks are delivered before the
+         * columns change. Throws a std::invalid_argument if the expression
+         * cannot be compiled or the name is already used.
+         *
+         * @param name Key of the derived value.
+         * @param source Expression in python syntax.
+         */
+        void addTrackColumn(const std::string & name,
+                            const std::string & source);
+
+        /** Remove the track filter and all derived track columns. */
+        void clearTrackFilter();
+
+        /** Only deliver interactions to python that pass a filter
+         * expression.
+         *
+         * See setTrackFilter(...).
+         *
+         * @param source Expression in python syntax; empty = accept all.
+         */
+        void setInteractionFilter(const std::string & source);
+
+        /** Add a natively computed column to the delivered interactions.
+         *
+         * See addTrackColumn(...).
+         *
+         * @param name Key of the derived value.
+         * @param source Expression in python syntax.
+         */
+        void addInteractionColumn(const std::string & name,
+                                  const std::string & source);
+
+        /** Remove the interaction filter and all derived interaction
+         * columns. */
+        void clearInteractionFilter();
+
+        /** Set the track sampling rule of a particle species.
+         *
+         * Sampling is decided on the particle ID and energy of the pre
+         * particle before any filter. The weight factor of a delivered
+         * track is multiplied into the weight of pre and post. Throws a
+         * std::invalid_argument if the rule is invalid.
+         *
+         * @param particleId CORSIKA particle ID or
+         * RecordSampler::DEFAULT_SPECIES for all species without own rule.
+         * @param rule Sampling rule.
+         */
+        void setTrackSampling(int particleId,
+                              const RecordSampler::Rule & rule);
+
+        /** Remove all track sampling rules. */
+        void clearTrackSampling();
+
+        /** Set the interaction sampling rule of a projectile species.
+         *
+         * Sampling is decided on the projectile ID and the lab energy.
+         * Interactions carry no weight, so the weight factor is available as
+         * variable samplingWeight of the interaction filter and derived
+         * columns. See setTrackSampling(...).
+         *
+         * @param particleId CORSIKA particle ID or
+         * RecordSampler::DEFAULT_SPECIES for all species without own rule.
+         * @param rule Sampling rule.
+         */
+        void setInteractionSampling(int particleId,
+                                    const RecordSampler::Rule & rule);
+
+        /** Remove all interaction sampling rules. */
+        void clearInteractionSampling();
+
+        /** Set the seed of the track and interaction sampling and restart
+         * their random sequences and counters. */
+        void setSamplingSeed(std::uint64_t seed);
+
+        /** Decouple CORSIKA from python.
+         *
+         * With a capacity > 0, COAST wrida_(...), interaction_(...) and
+         * track_(...) calls only copy their records into a RecordQueue once
+         * python init() returned. A consumer thread holds the GIL and
+         * delivers the records to python exactly as in synchronous mode,
+         * including sampling, filters and batching. Records reach python if
+         * they were captured when CORSIKA made the call. The queue is
+         * drained at cloda_(...) before python close() is called. Errors of
+         * the consumer are rethrown in the next COAST call.
+         *
+         * Throws a std::logic_error if called while the consumer is running.
+         *
+         * @param capacity Queue size in bytes; 0 = synchronous calls.
+         * @param policy Behaviour when the queue is full.
+         */
+        void setAsyncMode(std::size_t capacity, RecordQueue::Policy policy);
+
+        /** Get the queue size in bytes of asynchronous mode; 0 =
+         * synchronous calls. */
+        std::size_t getAsyncCapacity() const;
+
+        /** Get the number of records of a type that were dropped because
+         * the queue was full. */
+        std::uint64_t getAsyncDropped(RecordQueue::RecordType type) const;
+
+        /** Stream all COAST track_(...) and interaction_(...) records into
+         * a columnar file (see ColumnWriter).
+         *
+         * A previously opened file is completed first. The file is
+         * completed at cloda_(...) before python close() is called. Also
+         * enabled by the environment variable CORSIKA_PYTHON_COLUMNS.
+         * Throws a std::logic_error if called in asynchronous mode after
+         * init().
+         *
+         * @param path Output file; empty = stop writing.
+         * @param chunkRows Maximum number of rows per chunk.
+         */
+        void setColumnWriter(const std::string & path,
+                             std::size_t chunkRows);
+
+        /** Get the path of the columnar file; empty = not writing. */
+        std::string getColumnWriterPath() const;
+
+        /** Compress all COAST wrida_(...) subblocks into a block indexed
+         * file (see BlockWriter).
+         *
+         * Subblocks are compressed by a background thread. A previously
+         * opened file is completed first. The file is completed at
+         * cloda_(...) before python close() is called. Also enabled by the
+         * environment variable CORSIKA_PYTHON_BLOCKS. Throws a
+         * std::logic_error if called in asynchronous mode after init(), a
+         * std::runtime_error if the thinning option is unknown and a
+         * std::invalid_argument for an invalid level or block size.
+         *
+         * @param path Output file; empty = stop writing.
+         * @param level zlib compression level in [0, 9].
+         * @param blockSubBlocks Maximum number of subblocks per block.
+         */
+        void setBlockWriter(const std::string & path, int level,
+                            std::size_t blockSubBlocks);
+
+        /** Get the path of the block file; empty = not writing. */
+        std::string getBlockWriterPath() const;
+
+        /** Add a natively filled histogram (see Histogram).
+         *
+         * Track and interaction histograms are filled with every COAST
+         * track_(...) or interaction_(...) record, particle histograms with
+         * every particle line of the wrida_(...) subblocks. Throws a
+         * std::invalid_argument for invalid axes or expressions.
+         *
+         * @param source TRACK, INTERACTION or PARTICLE records.
+         * @param axes One to three axis definitions.
+         * @param weight Weight expression; empty = 1.
+         * @param filter Selection expression; empty = all records.
+         * @return Histogram ID.
+         */
+        std::size_t addHistogram(RecordFilter::RecordType source,
+                                 const std::vector<Histogram::Axis> & axes,
+                                 const std::string & weight,
+                                 const std::string & filter);
+
+        /** Get a histogram after filling all pending records.
+         *
+         * Histograms are never removed, such that their contents can be
+         * viewed until the interface is closed. Throws a std::out_of_range
+         * for unknown IDs.
+         */
+        const Histogram & getHistogram(std::size_t id);
+
+        /** Get the contents of a histogram as python objects after filling
+         * all pending records.
+         *
+         * @return Tuple of read-only memoryviews on sum of weights and sum
+         * of squared weights (shape including flow bins), a tuple of
+         * memoryviews on the bin edges per axis and the number of entries.
+         */
+        PyObject * getHistogramContents(std::size_t id);
+
+        /** Set the contents of a histogram to zero. */
+        void resetHistogram(std::size_t id);
+
+        /** Get the number of histograms. */
+        std::size_t getHistogramCount() const;
+
+        /** Add a voxel grid that accumulates the energy deposit of every
+         * COAST track_(...) segment (see VoxelGrid).
+         *
+         * Cylindrical grids without a fixed direction follow the primary of
+         * every shower. Throws a std::invalid_argument for invalid axes or
+         * particle IDs and a std::logic_error while the consumer thread is
+         * running.
+         *
+         * @return Voxel grid ID.
+         */
+        std::size_t addVoxelGrid(VoxelGrid::Geometry geometry,
+                                 const std::array<VoxelGrid::Axis, 3> & axes,
+                                 const std::vector<int> & species,
+                                 const std::array<double, 3> & core);
+
+        /** Get a voxel grid; throws a std::out_of_range for unknown IDs. */
+        VoxelGrid & getVoxelGrid(std::size_t id);
+
+        /** Get the number of voxel grids. */
+        std::size_t getVoxelGridCount() const;
+
+        /** Get the touched voxels of a grid as python objects.
+         *
+         * @return Tuple of read-only memoryviews on the three bin indices,
+         * path length, energy deposit, count and the species counts (shape
+         * voxels x species), a tuple of memoryviews on the bin edges per
+         * axis and the number of segments. The views are valid until the
+         * next call for the grid.
+         */
+        PyObject * getVoxelGridContents(std::size_t id);
+
+        /** Add a plane or disc to the surfaces that every COAST track_(...)
+         * segment is intersected with (see SurfaceDetector).
+         *
+         * If the override defines crossings(...), the interpolated
+         * crossings are delivered as columns whenever
+         * SurfaceDetector::DEFAULT_CAPACITY crossings are collected, before
+         * shower_end() and at cloda_(...). Throws a std::invalid_argument
+         * for a zero normal or a negative radius and a std::logic_error
+         * while the consumer thread is running.
+         *
+         * @param point Point on the plane, the center of a disc.
+         * @param normal Normal of the plane.
+         * @param radius Radius of a disc; 0 = unbounded plane.
+         * @return Surface ID.
+         */
+        int addPlane(const std::array<double, 3> & point,
+                     const std::array<double, 3> & normal, double radius);
+
+        /** Add a sphere to the surfaces, see addPlane(...).
+         *
+         * Throws a std::invalid_argument for radius <= 0.
+         *
+         * @return Surface ID.
+         */
+        int addSphere(const std::array<double, 3> & center, double radius);
+
+        /** Deliver the pending crossings and remove all surfaces. Throws a
+         * std::logic_error if called while crossings are delivered or the
+         * consumer thread is running. */
+        void clearSurfaces();
+
+        /** Add an array of observers that accumulates the radio emission
+         * of every COAST track_(...) segment (see ObserverArray).
+         *
+         * Throws a std::invalid_argument for invalid observers, binning or
+         * atmosphere and a std::logic_error while the consumer thread is
+         * running.
+         *
+         * @return Observer array ID.
+         */
+        std::size_t addObserverArray(
+                const std::vector<std::array<double, 3>> & positions,
+                const std::vector<double> & offsets,
+                const ObserverArray::Binning & binning,
+                const ObserverArray::Atmosphere & atmosphere);
+
+        /** Get an observer array; throws a std::out_of_range for unknown
+         * IDs. */
+        ObserverArray & getObserverArray(std::size_t id);
+
+        /** Get the number of observer arrays. */
+        std::size_t getObserverArrayCount() const;
+
+        /** Get the traces of an observer array as python objects.
+         *
+         * @return Tuple of read-only memoryviews on the vector potential
+         * and the electric field (shape observers x 3 x bins), start and
+         * width of the time bins and the number of segments. The views are
+         * valid until the next call for the array.
+         */
+        PyObject * getObserverTraces(std::size_t id);
+
+        /** Add a collector that appends tracks, interactions or the
+         * particles of COAST write(...) to Arrow batches (see
+         * ArrowCollector).
+         *
+         * Throws a std::invalid_argument for invalid species or levels and
+         * a std::logic_error while the consumer thread is running.
+         *
+         * @return Collector ID.
+         */
+        std::size_t addArrowCollector(RecordFilter::RecordType source,
+                                      const std::vector<int> & species,
+                                      const std::vector<int> & levels);
+
+        /** Get a collector; throws a std::out_of_range for unknown IDs. */
+        ArrowCollector & getArrowCollector(std::size_t id);
+
+        /** Get the number of collectors. */
+        std::size_t getArrowCollectorCount() const;
+
+        /** Load a native plugin (see CoastPlugin.h) and call its init.
+         *
+         * Plugins receive all COAST calls before the python override.
+         * Plugins listed in the environment variable
+         * CORSIKA_PYTHON_PLUGINS (separated by ':') are loaded before
+         * override.py runs; without an override.py python is then not
+         * started at all. Throws a std::runtime_error if the plugin cannot
+         * be loaded or fails and a std::logic_error while the consumer
+         * thread is running.
+         *
+         * @param path Shared library of the plugin.
+         */
+        void loadPlugin(const std::string & path);
+
+        /** Get the number of loaded plugins. */
+        std::size_t getPluginCount() const;
+
+        /** Get the call counters and python latencies (see InterfaceStats).
+         *
+         * Calls are counted in the order of COAST, python latencies when
+         * python returns. Empty unless compiled with USE_INTERFACE_STATS.
+         */
+        const InterfaceStats & getStats() const;
+
+        /** Write the counters as JSON to a file at cloda_(...) after python
+         * close() returned.
+         *
+         * Initialized from the environment variable CORSIKA_PYTHON_STATS.
+         *
+         * @param path Output file; empty = no summary.
+         */
+        void setStatsFile(const std::string & path);
+
+        /** Get the path of the summary file; empty = no summary. */
+        const std::string & getStatsFile() const;
+
+        /** Record a timeline of the interface in Chrome trace-event format
+         * (see Tracer).
+         *
+         * Spans of init(), close() and every sampleEvery-th write(),
+         * interaction() and track() call are recorded together with user
+         * spans. The file is written at cloda_(...) or when the trace is
+         * replaced. Initialized from the environment variables
+         * CORSIKA_PYTHON_TRACE and CORSIKA_PYTHON_TRACE_SAMPLE. Throws a
+         * std::logic_error while the consumer thread is running and a
+         * std::invalid_argument if sampleEvery is 0.
+         *
+         * @param path Output file; empty = stop tracing.
+         * @param sampleEvery Record every n-th call of a callback.
+         */
+        void setTrace(const std::string & path, std::uint64_t sampleEvery);
+
+        /** Get the path of the trace file; empty = not tracing. */
+        std::string getTracePath() const;
+
+        /** Begin a user span in the timeline of the calling thread; ignored
+         * if not tracing. */
+        void beginTraceSpan(const std::string & name);
+
+        /** End the innermost user span of the calling thread; ignored if
+         * not tracing. */
+        void endTraceSpan();
 
 
     private:
         void setCorsikaConfig(const CorsikaConfig & config);
+        void installCallbacks();
+        template <int Entries> WriteHandler selectWriteHandler() const;
+        template <int Entries> void writeBytes(const CREAL * DataSubBlock);
+        template <int Entries> void writeView(const CREAL * DataSubBlock);
+        template <int Entries> void writeStaged(const CREAL * DataSubBlock);
+        template <int Entries>
+        void writeParticles(const CREAL * DataSubBlock);
+        void writeUnknown(const CREAL * DataSubBlock);
+        void deliverWrite(const CREAL * DataSubBlock, bool capture);
+        void beginShower();
+        void endShower();
+        void interactionDirect(const crs::CInteraction & info);
+        void interactionBatched(const crs::CInteraction & info);
+        void trackDirect(const crs::CParticle & pre,
+                         const crs::CParticle & post);
+        void trackBatched(const crs::CParticle & pre,
+                          const crs::CParticle & post);
+        void interactionFiltered(const crs::CInteraction & info);
+        void interactionFilteredBatched(const crs::CInteraction & info);
+        void trackFiltered(const crs::CParticle & pre,
+                           const crs::CParticle & post);
+        void trackFilteredBatched(const crs::CParticle & pre,
+                                  const crs::CParticle & post);
+        void interactionSampled(const crs::CInteraction & info);
+        void trackSampled(const crs::CParticle & pre,
+                          const crs::CParticle & post);
+        void setupColumnWriter();
+        void setupBlockWriter();
+        void setupCallRecorder();
+        void closeCallRecorder();
+        void setupSharedRing();
+        void spawnConsumers(const std::string & directories);
+        void waitForConsumerProcesses();
+        void setupStats();
+        void setupTracer();
+        void closeTracer();
+        template <typename Handler, typename... Args>
+        void dispatch(InterfaceStats::Callback callback, Handler handler,
+                      const Args &... args);
+        void writeStats() const;
+        void fillParticleHistograms(const CREAL * DataSubBlock);
+        void flushHistograms();
+        bool isCollecting(RecordFilter::RecordType source) const;
+        void collectParticles(const CREAL * DataSubBlock);
+        bool isFillingInteractions() const;
+        void fillInteractions(const crs::CInteraction & info);
+        bool isFillingTracks() const;
+        void fillTracks(const crs::CParticle & pre,
+                        const crs::CParticle & post);
+        void detectCrossings(const crs::CParticle & pre,
+                             const crs::CParticle & post);
+        void checkSurfacesNotRunning() const;
+        void startAsync();
+        void stopAsync();
+        void consumeAsync();
+        void dispatchRecord(const RecordQueue::Record & record);
+        void enqueue(RecordQueue::RecordType type, bool capture,
+                     const void * first, std::size_t firstSize,
+                     const void * second = nullptr,
+                     std::size_t secondSize = 0);
+        void processTrackPending();
+        void processInteractionPending();
+        void drainTrack();
+        void drainInteraction();
+        void checkNotDelivering() const;
+        PyObject * getDerivedValues(const std::vector<std::string> & names,
+                                    const double * values) const;
+        template <typename Batch>
+        PyObject * getDerivedColumns(const std::vector<std::string> & names,
+                                     const Batch & batch, Py_ssize_t size);
+        void setCapture(unsigned int flag, bool val);
+        void updateActiveCalls();
+        bool isCapturing(unsigned int flag) const;
         void setupPackagesSearchPath() const;
+        void setupPlugins();
+        void closePlugins();
+        filesystem::path findOverrideDirectory() const;
         void setupOverrideSearchPath();
         void importInterface();
         void runOverride() const;
-        void callPythonInit() const;
-        void callPythonClose() const;
+        void callPythonInit();
+        void callPythonClose();
+        void releaseCallbacks();
+        void callPython(PyObject * callable, PyObject ** args,
+                        std::size_t nargs, InterfaceStats::Callback callback);
+        PyObject * lendView(PyObject * view);
+        bool releaseLentViews();
+        void callPythonWrite(PyObject * subblock);
+        void callPythonShowerBegin();
+        void callPythonShowerEnd();
+        void flushWriteStaging();
+        void flushParticles();
+        void flushCrossings();
+        void flushTrackBatch();
+        void flushInteractionBatch();
+        PyObject * getParticleColumns(
+                const TrackBatch::ParticleColumns & columns,
+                Py_ssize_t size);
 
 };
 
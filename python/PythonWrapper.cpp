@@ -3,6 +3,8 @@
 #define PY_SSIZE_T_CLEAN
 #include <Python.h>
 
+#include <vector>
+
 
 filesystem::path PythonWrapper::getCoastPath() const {
     if (!mCoastPath.empty()) {
@@ -90,3 +92,79 @@ int PythonWrapper::runPythonFile(filesystem::path filepath) const {
     return retval;
 }
 
+
+
+PyObject * PythonWrapper::getMemoryView(const double * data,
+                                        Py_ssize_t size) const {
+    return getMemoryView(data, "d", sizeof(double), 1, &size);
+}
+
+
+PyObject * PythonWrapper::getMemoryView(const int * data,
+                                        Py_ssize_t size) const {
+    return getMemoryView(data, "i", sizeof(int), 1, &size);
+}
+
+
+PyObject * PythonWrapper::getMemoryView(const float * data,
+                                        Py_ssize_t size) const {
+    return getMemoryView(data, "f", sizeof(float), 1, &size);
+}
+
+
+PyObject * PythonWrapper::getMemoryView(const float * data, Py_ssize_t rows,
+                                        Py_ssize_t cols) const {
+    const Py_ssize_t shape[2] = {rows, cols};
+    return getMemoryView(data, "f", sizeof(float), 2, shape);
+}
+
+
+PyObject * PythonWrapper::getMemoryView(const double * data, Py_ssize_t rows,
+                                        Py_ssize_t cols) const {
+    const Py_ssize_t shape[2] = {rows, cols};
+    return getMemoryView(data, "d", sizeof(double), 2, shape);
+}
+
+
+PyObject * PythonWrapper::getMemoryView(
+        const double * data, const std::vector<Py_ssize_t> & shape) const {
+    return getMemoryView(data, "d", sizeof(double),
+                         static_cast<int>(shape.size()), shape.data());
+}
+
+
+PyObject * PythonWrapper::getMemoryView(
+        const void * data, const char * format, Py_ssize_t itemsize,
+        int ndim, const Py_ssize_t * shape) const {
+    // C-contiguous strides; memoryview copies shape and strides but keeps the
+    // format pointer, which is why format has to be a string literal
+    Py_ssize_t strides[PyBUF_MAX_NDIM];
+    Py_ssize_t len = itemsize;
+    for (int i = ndim - 1; i >= 0; --i) {
+        strides[i] = len;
+        len *= shape[i];
+    }
+
+    // memoryview rejects NULL, which empty vectors may return
+    static const double empty = 0.0;
+    Py_buffer buffer;
+    buffer.buf = const_cast<void *>(data != NULL ? data : &empty);
+    buffer.obj = NULL;
+    buffer.len = len;
+    buffer.itemsize = itemsize;
+    buffer.readonly = 1;
+    buffer.ndim = ndim;
+    buffer.format = const_cast<char *>(format);
+    buffer.shape = const_cast<Py_ssize_t *>(shape);
+    buffer.strides = strides;
+    buffer.suboffsets = NULL;
+    buffer.internal = NULL;
+
+    PyObject * view = PyMemoryView_FromBuffer(&buffer);
+    if (view == NULL) {
+        PyErr_Print();
+        throw std::runtime_error("cannot create python memoryview");
+    }
+
+    return view;
+}
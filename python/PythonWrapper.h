@@ -4,6 +4,9 @@
 #define PY_SSIZE_T_CLEAN
 #include <Python.h>
 
+#include <string>
+#include <vector>
+
 #include "stdfilesystem.h"
 
 
@@ -53,6 +56,78 @@ class PythonWrapper {
          */
         int runPythonFile(filesystem::path filepath) const;
 
+        /** Create a read-only memoryview of C++ owned doubles.
+         *
+         * No data is copied. The memory has to stay valid as long as python
+         * code accesses the view.
+         *
+         * @param data Pointer to the first element.
+         * @param size Number of elements.
+         */
+        PyObject * getMemoryView(const double * data, Py_ssize_t size) const;
+
+        /** Create a read-only memoryview of C++ owned integers.
+         *
+         * No data is copied. The memory has to stay valid as long as python
+         * code accesses the view.
+         *
+         * @param data Pointer to the first element.
+         * @param size Number of elements.
+         */
+        PyObject * getMemoryView(const int * data, Py_ssize_t size) const;
+
+        /** Create a read-only memoryview of C++ owned floats.
+         *
+         * No data is copied. The memory has to stay valid as long as python
+         * code accesses the view.
+         *
+         * @param data Pointer to the first element.
+         * @param size Number of elements.
+         */
+        PyObject * getMemoryView(const float * data, Py_ssize_t size) const;
+
+        /** Create a read-only two-dimensional memoryview of C++ owned floats.
+         *
+         * No data is copied. The memory has to stay valid as long as python
+         * code accesses the view.
+         *
+         * @param data Pointer to the first element of a row-major matrix.
+         * @param rows Number of rows.
+         * @param cols Number of columns.
+         */
+        PyObject * getMemoryView(const float * data, Py_ssize_t rows,
+                                 Py_ssize_t cols) const;
+
+        /** Create a read-only two-dimensional memoryview of C++ owned
+         * doubles.
+         *
+         * No data is copied. The memory has to stay valid as long as python
+         * code accesses the view.
+         *
+         * @param data Pointer to the first element of a row-major matrix.
+         * @param rows Number of rows.
+         * @param cols Number of columns.
+         */
+        PyObject * getMemoryView(const double * data, Py_ssize_t rows,
+                                 Py_ssize_t cols) const;
+
+        /** Create a read-only multi-dimensional memoryview of C++ owned
+         * doubles in C order.
+         *
+         * No data is copied. The memory has to stay valid as long as python
+         * code accesses the view.
+         *
+         * @param shape Size of every dimension (at most PyBUF_MAX_NDIM).
+         */
+        PyObject * getMemoryView(const double * data,
+                                 const std::vector<Py_ssize_t> & shape) const;
+
+
+    private:
+        PyObject * getMemoryView(const void * data, const char * format,
+                                 Py_ssize_t itemsize, int ndim,
+                                 const Py_ssize_t * shape) const;
+
 };
 
 
@@ -0,0 +1,270 @@
+#include "RecordFilter.h"
+
+#include <cmath>
+#include <cstddef>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+// variable layout
+
+namespace {
+
+enum TrackVariable : std::size_t {
+    PRE_TIME, PRE_X, PRE_Y, PRE_Z, PRE_DEPTH, PRE_ENERGY, PRE_WEIGHT,
+    PRE_ID, PRE_HADGEN,
+    POST_TIME, POST_X, POST_Y, POST_Z, POST_DEPTH, POST_ENERGY, POST_WEIGHT,
+    POST_ID, POST_HADGEN,
+    LENGTH,
+    TRACK_VARIABLES
+};
+
+enum InteractionVariable : std::size_t {
+    X, Y, Z, ETOT, SIGMA, KELA, PROJID, TARGETID, SAMPLING_WEIGHT,
+    INTERACTION_VARIABLES
+};
+
+enum ParticleVariable : std::size_t {
+    DESCRIPTION, PARTICLE_ID, HADRONIC_GENERATION, OBSERVATION_LEVEL,
+    PX, PY, PZ, PARTICLE_X, PARTICLE_Y, TIME, WEIGHT,
+    PARTICLE_VARIABLES
+};
+
+
+std::map<std::string, std::size_t> createTrackVariableNames() {
+    const std::map<std::string, std::size_t> particle = {
+        {"time", PRE_TIME}, {"x", PRE_X}, {"y", PRE_Y}, {"z", PRE_Z},
+        {"atmosphericDepth", PRE_DEPTH}, {"depth", PRE_DEPTH},
+        {"energy", PRE_ENERGY}, {"weight", PRE_WEIGHT},
+        {"particleID", PRE_ID}, {"hadronicGeneration", PRE_HADGEN}
+    };
+
+    std::map<std::string, std::size_t> names = {{"length", LENGTH}};
+    for (const auto & [name, index] : particle) {
+        names[name] = index;
+        names["pre." + name] = index;
+        names["post." + name] = index + POST_TIME;
+    }
+
+    return names;
+}
+
+const std::map<std::string, std::size_t> trackVariableNames =
+    createTrackVariableNames();
+
+const std::map<std::string, std::size_t> interactionVariableNames = {
+    {"x", X}, {"y", Y}, {"z", Z},
+    {"labEnergy", ETOT}, {"etot", ETOT},
+    {"crossSection", SIGMA}, {"sigma", SIGMA},
+    {"elasticity", KELA}, {"kela", KELA},
+    {"projectileID", PROJID}, {"projId", PROJID},
+    {"targetID", TARGETID}, {"targetId", TARGETID},
+    {"samplingWeight", SAMPLING_WEIGHT}
+};
+
+const std::map<std::string, std::size_t> particleVariableNames = {
+    {"description", DESCRIPTION}, {"particleID", PARTICLE_ID},
+    {"hadronicGeneration", HADRONIC_GENERATION},
+    {"observationLevel", OBSERVATION_LEVEL},
+    {"px", PX}, {"py", PY}, {"pz", PZ},
+    {"x", PARTICLE_X}, {"y", PARTICLE_Y},
+    {"time", TIME}, {"t", TIME}, {"weight", WEIGHT}
+};
+
+
+const std::map<std::string, std::size_t> & getVariableNames(
+        RecordFilter::RecordType type) {
+    switch (type) {
+        case RecordFilter::RecordType::TRACK:
+            return trackVariableNames;
+        case RecordFilter::RecordType::INTERACTION:
+            return interactionVariableNames;
+        default:
+            return particleVariableNames;
+    }
+}
+
+}
+
+
+// filter
+
+RecordFilter::RecordFilter(RecordType type)
+    : mVariableNames(::getVariableNames(type))
+{
+    std::size_t count = PARTICLE_VARIABLES;
+    if (type == RecordType::TRACK) {
+        count = TRACK_VARIABLES;
+    }
+    else if (type == RecordType::INTERACTION) {
+        count = INTERACTION_VARIABLES;
+    }
+
+    mVariables.resize(count * Expression::BLOCK);
+    for (std::size_t i = 0; i < count; ++i) {
+        mColumns.push_back(mVariables.data() + i * Expression::BLOCK);
+    }
+
+    mAccepted.resize(Expression::BLOCK);
+    mResult.resize(Expression::BLOCK);
+}
+
+
+void RecordFilter::setFilter(const std::string & source) {
+    if (source.empty()) {
+        mFilter = Expression();
+        return;
+    }
+
+    mFilter = Expression(source, mVariableNames);
+}
+
+const std::string & RecordFilter::getFilter() const {
+    return mFilter.getSource();
+}
+
+
+void RecordFilter::addColumn(const std::string & name,
+                             const std::string & source) {
+    for (const auto & columnName : mColumnNames) {
+        if (columnName == name) {
+            throw std::invalid_argument(
+                    "derived column '" + name + "' already exists");
+        }
+    }
+
+    Expression expression(source, mVariableNames);
+    mColumnNames.push_back(name);
+    mColumnExpressions.push_back(expression);
+    mDerived.resize(mColumnNames.size() * Expression::BLOCK);
+}
+
+const std::vector<std::string> & RecordFilter::getColumnNames() const {
+    return mColumnNames;
+}
+
+
+void RecordFilter::clear() {
+    mFilter = Expression();
+    mColumnNames.clear();
+    mColumnExpressions.clear();
+    mDerived.clear();
+}
+
+bool RecordFilter::isActive() const {
+    return !mFilter.isEmpty() || !mColumnNames.empty();
+}
+
+
+void RecordFilter::load(std::size_t row, const crs::CParticle & pre,
+                        const crs::CParticle & post) {
+    double * v = mVariables.data() + row;
+    constexpr std::size_t B = Expression::BLOCK;
+
+    v[PRE_TIME * B] = pre.time;
+    v[PRE_X * B] = pre.x;
+    v[PRE_Y * B] = pre.y;
+    v[PRE_Z * B] = pre.z;
+    v[PRE_DEPTH * B] = pre.depth;
+    v[PRE_ENERGY * B] = pre.energy;
+    v[PRE_WEIGHT * B] = pre.weight;
+    v[PRE_ID * B] = pre.particleId;
+    v[PRE_HADGEN * B] = pre.hadronicGeneration;
+
+    v[POST_TIME * B] = post.time;
+    v[POST_X * B] = post.x;
+    v[POST_Y * B] = post.y;
+    v[POST_Z * B] = post.z;
+    v[POST_DEPTH * B] = post.depth;
+    v[POST_ENERGY * B] = post.energy;
+    v[POST_WEIGHT * B] = post.weight;
+    v[POST_ID * B] = post.particleId;
+    v[POST_HADGEN * B] = post.hadronicGeneration;
+
+    v[LENGTH * B] = std::sqrt((post.x - pre.x) * (post.x - pre.x) +
+                              (post.y - pre.y) * (post.y - pre.y) +
+                              (post.z - pre.z) * (post.z - pre.z));
+}
+
+
+void RecordFilter::load(std::size_t row, const crs::CInteraction & info,
+                        double samplingWeight) {
+    double * v = mVariables.data() + row;
+    constexpr std::size_t B = Expression::BLOCK;
+
+    v[X * B] = info.x;
+    v[Y * B] = info.y;
+    v[Z * B] = info.z;
+    v[ETOT * B] = info.etot;
+    v[SIGMA * B] = info.sigma;
+    v[KELA * B] = info.kela;
+    v[PROJID * B] = info.projId;
+    v[TARGETID * B] = info.targetId;
+    v[SAMPLING_WEIGHT * B] = samplingWeight;
+}
+
+
+void RecordFilter::load(std::size_t row, const CREAL * line,
+                        int entries) {
+    double * v = mVariables.data() + row;
+    constexpr std::size_t B = Expression::BLOCK;
+
+    // description = particle ID * 1000 + hadronic generation * 10 +
+    // observation level
+    const double description = line[0];
+    const double id = std::floor(description / 1000);
+    const double rest = description - id * 1000;
+    v[DESCRIPTION * B] = description;
+    v[PARTICLE_ID * B] = id;
+    v[HADRONIC_GENERATION * B] = std::floor(rest / 10);
+    v[OBSERVATION_LEVEL * B] = rest - std::floor(rest / 10) * 10;
+    v[PX * B] = line[1];
+    v[PY * B] = line[2];
+    v[PZ * B] = line[3];
+    v[PARTICLE_X * B] = line[4];
+    v[PARTICLE_Y * B] = line[5];
+    v[TIME * B] = line[6];
+    v[WEIGHT * B] = entries > 7 ? line[7] : 1.0;
+}
+
+
+const std::map<std::string, std::size_t> &
+RecordFilter::getVariableNames() const {
+    return mVariableNames;
+}
+
+const double * const * RecordFilter::getColumns() const {
+    return mColumns.data();
+}
+
+
+void RecordFilter::evaluate(std::size_t n) {
+    if (mFilter.isEmpty()) {
+        for (std::size_t i = 0; i < n; ++i) {
+            mAccepted[i] = 1.0;
+        }
+    }
+    else {
+        mFilter.evaluate(mColumns.data(), n, mAccepted.data());
+    }
+
+    // derived values are stored row-major for delivery
+    const std::size_t count = mColumnExpressions.size();
+    for (std::size_t k = 0; k < count; ++k) {
+        mColumnExpressions[k].evaluate(mColumns.data(), n, mResult.data());
+        for (std::size_t i = 0; i < n; ++i) {
+            mDerived[i * count + k] = mResult[i];
+        }
+    }
+}
+
+
+bool RecordFilter::isAccepted(std::size_t row) const {
+    return mAccepted[row] != 0.0;
+}
+
+const double * RecordFilter::getDerived(std::size_t row) const {
+    return mDerived.data() + row * mColumnExpressions.size();
+}
@@ -0,0 +1,139 @@
+/** \file
+ * Native filter and derived-column expressions for COAST track and
+ * interaction records.
+ */
+#ifndef __RECORDFILTER_H__
+#define __RECORDFILTER_H__
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <crs/CorsikaTypes.h>
+#include <crs/CInteraction.h>
+#include <crs/CParticle.h>
+
+#include "Expression.h"
+
+
+/** Evaluates a filter expression and derived-column expressions on blocks
+ * of track or interaction records.
+ *
+ * Records are loaded row by row into a block of at most Expression::BLOCK
+ * rows, then evaluate(...) computes for every row whether it passes the
+ * filter and the values of all derived columns.
+ *
+ * Track variables are the Particle attribute names of the pre particle
+ * (time, x, y, z, atmosphericDepth or depth, energy, weight, particleID,
+ * hadronicGeneration), optionally prefixed with "pre." or "post.", and the
+ * segment length between pre and post position. Interaction variables are
+ * the Interaction attribute names (x, y, z, labEnergy, crossSection,
+ * elasticity, projectileID, targetID) or the CInteraction member names and
+ * samplingWeight, the weight factor of interaction sampling. Particle
+ * variables of CORSIKA subblock lines are description, particleID,
+ * hadronicGeneration, observationLevel, px, py, pz, x, y, time (or t) and
+ * weight (1 without thinning).
+ */
+class RecordFilter {
+
+    // interface types
+    public:
+        /** Record type that determines the available variables. */
+        enum class RecordType {
+            TRACK,       /**< Pairs of crs::CParticle. */
+            INTERACTION, /**< crs::CInteraction. */
+            PARTICLE     /**< Particle line of a CORSIKA subblock. */
+        };
+
+
+    // members
+    private:
+        const std::map<std::string, std::size_t> & mVariableNames;
+        std::vector<double> mVariables;
+        std::vector<const double *> mColumns;
+
+        Expression mFilter;
+        std::vector<std::string> mColumnNames;
+        std::vector<Expression> mColumnExpressions;
+
+        std::vector<double> mAccepted;
+        std::vector<double> mDerived;
+        std::vector<double> mResult;
+
+
+    // public functions
+    public:
+        /** Construct a filter that accepts everything and has no derived
+         * columns. */
+        explicit RecordFilter(RecordType type);
+
+        /** Set the filter expression.
+         *
+         * Throws a std::invalid_argument if the expression cannot be
+         * compiled, in which case the previous filter is kept.
+         *
+         * @param source Expression in python syntax; empty = accept all.
+         */
+        void setFilter(const std::string & source);
+
+        /** Get the source of the filter expression; empty = accept all. */
+        const std::string & getFilter() const;
+
+        /** Add a derived column.
+         *
+         * Throws a std::invalid_argument if the expression cannot be
+         * compiled or the name is already used.
+         *
+         * @param name Name under which the values are delivered.
+         * @param source Expression in python syntax.
+         */
+        void addColumn(const std::string & name, const std::string & source);
+
+        /** Get the names of all derived columns. */
+        const std::vector<std::string> & getColumnNames() const;
+
+        /** Remove the filter expression and all derived columns. */
+        void clear();
+
+        /** Indicate if a filter or at least one derived column is set. */
+        bool isActive() const;
+
+        /** Load a track into the given row of the current block. */
+        void load(std::size_t row, const crs::CParticle & pre,
+                  const crs::CParticle & post);
+
+        /** Load an interaction and its sampling weight factor into the given
+         * row of the current block. */
+        void load(std::size_t row, const crs::CInteraction & info,
+                  double samplingWeight = 1.0);
+
+        /** Load a particle line of a CORSIKA subblock into the given row of
+         * the current block.
+         *
+         * @param line Particle line with 7 or 8 (thinned) entries.
+         * @param entries Number of entries of the line.
+         */
+        void load(std::size_t row, const CREAL * line, int entries);
+
+        /** Get the map of variable names to column indices. */
+        const std::map<std::string, std::size_t> & getVariableNames() const;
+
+        /** Get the pointers to the variable columns of the current block,
+         * which can be passed to Expression::evaluate(...). */
+        const double * const * getColumns() const;
+
+        /** Evaluate the filter and derived columns for the first n rows of
+         * the current block (n <= Expression::BLOCK). */
+        void evaluate(std::size_t n);
+
+        /** Indicate if the record in the given row passed the filter. */
+        bool isAccepted(std::size_t row) const;
+
+        /** Get the derived values of the given row, one per column. */
+        const double * getDerived(std::size_t row) const;
+
+};
+
+
+#endif
@@ -0,0 +1,293 @@
+#include "RecordQueue.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+
+namespace {
+
+// smallest ring that fits a thinned subblock many times
+constexpr std::size_t MINIMUM_CAPACITY = 1 << 16;
+
+// waits are additionally bounded to survive a missed notification
+constexpr std::chrono::milliseconds WAIT_TIMEOUT(1);
+
+
+std::size_t align(std::size_t size) {
+    return (size + 7) & ~static_cast<std::size_t>(7);
+}
+
+}
+
+
+// segment
+
+RecordQueue::Segment::Segment(std::size_t capacity)
+    : storage(capacity / sizeof(std::uint64_t)), capacity(capacity)
+{}
+
+
+// queue
+
+RecordQueue::RecordQueue(std::size_t capacity, Policy policy)
+    : mPolicy(policy)
+{
+    std::size_t size = MINIMUM_CAPACITY;
+    while (size < capacity) {
+        size *= 2;
+    }
+
+    mProducerSegment = new Segment(size);
+    mConsumerSegment = mProducerSegment;
+    mCapacity.store(size);
+}
+
+
+RecordQueue::~RecordQueue() {
+    Segment * segment = mConsumerSegment;
+    while (segment != nullptr) {
+        Segment * next = segment->next.load();
+        delete segment;
+        segment = next;
+    }
+}
+
+
+RecordQueue::Policy RecordQueue::getPolicy(const std::string & name) {
+    if (name == "block") {
+        return Policy::BLOCK;
+    }
+    if (name == "drop") {
+        return Policy::DROP;
+    }
+    if (name == "grow") {
+        return Policy::GROW;
+    }
+
+    throw std::invalid_argument("unknown backpressure policy '" + name +
+                                "'; expected block, drop or grow");
+}
+
+
+bool RecordQueue::push(RecordType type, std::uint16_t flags,
+                       const void * first, std::size_t firstSize,
+                       const void * second, std::size_t secondSize) {
+    return append(mPolicy, type, flags, first, firstSize, second,
+                  secondSize);
+}
+
+
+bool RecordQueue::pushRequired(RecordType type, std::uint16_t flags,
+                               const void * first, std::size_t firstSize) {
+    // records that must not be lost wait for the consumer instead
+    const Policy policy =
+        mPolicy == Policy::DROP ? Policy::BLOCK : mPolicy;
+    return append(policy, type, flags, first, firstSize, nullptr, 0);
+}
+
+
+bool RecordQueue::append(Policy policy, RecordType type, std::uint16_t flags,
+                         const void * first, std::size_t firstSize,
+                         const void * second, std::size_t secondSize) {
+    const std::size_t payload = firstSize + secondSize;
+    const std::size_t length = align(sizeof(Record) + payload);
+
+    while (!mFailed.load(std::memory_order_acquire)) {
+        Segment * segment = mProducerSegment;
+        const std::size_t head = segment->head.load(std::memory_order_relaxed);
+        const std::size_t offset = head & (segment->capacity - 1);
+        const std::size_t contiguous = segment->capacity - offset;
+        const std::size_t padding = contiguous < length ? contiguous : 0;
+        const std::size_t tail =
+            segment->tail.load(std::memory_order_acquire);
+
+        if (length + padding <= segment->capacity - (head - tail)) {
+            auto * base =
+                reinterpret_cast<unsigned char *>(segment->storage.data());
+
+            // payloads never wrap around the end of the ring
+            if (padding > 0) {
+                auto * record = reinterpret_cast<Record *>(base + offset);
+                record->type = RecordType::PADDING;
+                record->flags = 0;
+                record->size =
+                    static_cast<std::uint32_t>(padding - sizeof(Record));
+            }
+
+            const std::size_t position = head + padding;
+            unsigned char * out = base + (position & (segment->capacity - 1));
+            auto * record = reinterpret_cast<Record *>(out);
+            record->type = type;
+            record->flags = flags;
+            record->size = static_cast<std::uint32_t>(payload);
+            std::memcpy(out + sizeof(Record), first, firstSize);
+            if (secondSize > 0) {
+                std::memcpy(out + sizeof(Record) + firstSize, second,
+                            secondSize);
+            }
+
+            segment->head.store(position + length, std::memory_order_release);
+            notify(mConsumerWaiting);
+            return true;
+        }
+
+        switch (policy) {
+            case Policy::DROP:
+                mDropped[static_cast<std::size_t>(type)].fetch_add(
+                        1, std::memory_order_relaxed);
+                return false;
+
+            case Policy::GROW: {
+                // the consumer switches once the old segment is drained
+                Segment * next = new Segment(segment->capacity * 2);
+                mCapacity.store(next->capacity, std::memory_order_relaxed);
+                mProducerSegment = next;
+                segment->next.store(next, std::memory_order_release);
+                break;
+            }
+
+            case Policy::BLOCK: {
+                mProducerWaiting.store(true);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                std::unique_lock<std::mutex> lock(mMutex);
+                mCondition.wait_for(lock, WAIT_TIMEOUT, [&]() {
+                    return mFailed.load() || isHalfEmpty(*segment);
+                });
+                mProducerWaiting.store(false);
+                break;
+            }
+        }
+    }
+
+    return false;
+}
+
+
+void RecordQueue::close() {
+    mClosed.store(true, std::memory_order_release);
+    std::lock_guard<std::mutex> lock(mMutex);
+    mCondition.notify_all();
+}
+
+
+const RecordQueue::Record * RecordQueue::front() {
+    Segment * segment = mConsumerSegment;
+    for (;;) {
+        const std::size_t tail = segment->tail.load(std::memory_order_relaxed);
+        if (tail != segment->head.load(std::memory_order_acquire)) {
+            auto * base = reinterpret_cast<const unsigned char *>(
+                    segment->storage.data());
+            auto * record = reinterpret_cast<const Record *>(
+                    base + (tail & (segment->capacity - 1)));
+            if (record->type != RecordType::PADDING) {
+                return record;
+            }
+
+            segment->tail.store(tail + sizeof(Record) + record->size,
+                                std::memory_order_release);
+            continue;
+        }
+
+        Segment * next = segment->next.load(std::memory_order_acquire);
+        if (next == nullptr) {
+            return nullptr;
+        }
+
+        // the producer does not touch a segment after linking its successor
+        if (tail != segment->head.load(std::memory_order_acquire)) {
+            continue;
+        }
+
+        delete segment;
+        mConsumerSegment = segment = next;
+    }
+}
+
+
+void RecordQueue::pop() {
+    Segment * segment = mConsumerSegment;
+    const std::size_t tail = segment->tail.load(std::memory_order_relaxed);
+    auto * base =
+        reinterpret_cast<const unsigned char *>(segment->storage.data());
+    auto * record = reinterpret_cast<const Record *>(
+            base + (tail & (segment->capacity - 1)));
+
+    segment->tail.store(tail + align(sizeof(Record) + record->size),
+                        std::memory_order_release);
+
+    // a blocked producer resumes once half of the ring is free, which
+    // avoids a thread switch per record; it also waits under Policy::DROP
+    // for records that must not be dropped
+    if (mPolicy != Policy::GROW && isHalfEmpty(*segment)) {
+        notify(mProducerWaiting);
+    }
+}
+
+
+bool RecordQueue::wait() {
+    for (;;) {
+        if (front() != nullptr) {
+            return true;
+        }
+
+        if (mClosed.load(std::memory_order_acquire)) {
+            return front() != nullptr;
+        }
+
+        mConsumerWaiting.store(true);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCondition.wait_for(lock, WAIT_TIMEOUT, [this]() {
+                const Segment * segment = mConsumerSegment;
+                return mClosed.load() || segment->next.load() != nullptr ||
+                       segment->tail.load() != segment->head.load();
+            });
+        }
+        mConsumerWaiting.store(false);
+    }
+}
+
+
+void RecordQueue::fail() {
+    mFailed.store(true, std::memory_order_release);
+    std::lock_guard<std::mutex> lock(mMutex);
+    mCondition.notify_all();
+}
+
+
+bool RecordQueue::isFailed() const {
+    return mFailed.load(std::memory_order_acquire);
+}
+
+
+std::uint64_t RecordQueue::getDropped(RecordType type) const {
+    return mDropped[static_cast<std::size_t>(type)].load(
+            std::memory_order_relaxed);
+}
+
+
+std::size_t RecordQueue::getCapacity() const {
+    return mCapacity.load(std::memory_order_relaxed);
+}
+
+
+bool RecordQueue::isHalfEmpty(const Segment & segment) {
+    return segment.head.load() - segment.tail.load() <= segment.capacity / 2;
+}
+
+
+void RecordQueue::notify(std::atomic<bool> & waiting) {
+    // pairs with the fence of the waiting thread after raising its flag
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiting.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mCondition.notify_all();
+    }
+}
@@ -0,0 +1,174 @@
+/** \file
+ * Single-producer/single-consumer queue for COAST records that are handed
+ * over from CORSIKA to the python consumer thread.
+ */
+#ifndef __RECORDQUEUE_H__
+#define __RECORDQUEUE_H__
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+/** Lock-free bounded SPSC ring of variable sized records.
+ *
+ * Every record consists of an 8 byte header and its payload, which always
+ * lies contiguously in memory such that the consumer can use it in place.
+ * When the ring is full, the producer either waits for the consumer
+ * (Policy::BLOCK), drops the record and counts it (Policy::DROP) or
+ * continues in a new ring of twice the size (Policy::GROW), which the
+ * consumer switches to as soon as the old ring is drained. Records pushed
+ * with pushRequired(...) are never dropped.
+ *
+ * push(...) and close() must only be called by the producer thread; front(),
+ * pop(), wait() and fail() only by the consumer thread.
+ */
+class RecordQueue {
+
+    // interface types
+    public:
+        /** Behaviour of push(...) when the ring is full. */
+        enum class Policy {
+            BLOCK, /**< Wait until the consumer made room. */
+            DROP,  /**< Discard the record and count it. */
+            GROW   /**< Allocate a larger ring. */
+        };
+
+        /** Type of a record. */
+        enum class RecordType : std::uint16_t {
+            PADDING,     /**< Unused space at the end of a ring. */
+            WRITE,       /**< CORSIKA subblock. */
+            INTERACTION, /**< crs::CInteraction. */
+            TRACK        /**< Pair of crs::CParticle. */
+        };
+
+        /** Record header, directly followed by the payload. */
+        struct Record {
+            RecordType type;
+            std::uint16_t flags; /**< Passed unchanged from push(...). */
+            std::uint32_t size;
+
+            /** Get the payload of the record. */
+            const void * getData() const {
+                return this + 1;
+            }
+        };
+
+
+    // internal types
+    private:
+        struct Segment {
+            explicit Segment(std::size_t capacity);
+
+            std::vector<std::uint64_t> storage;
+            std::size_t capacity;
+            alignas(64) std::atomic<std::size_t> head{0};
+            alignas(64) std::atomic<std::size_t> tail{0};
+            std::atomic<Segment *> next{nullptr};
+        };
+
+
+    // members
+    private:
+        const Policy mPolicy;
+        Segment * mProducerSegment;
+        Segment * mConsumerSegment;
+
+        std::atomic<bool> mClosed{false};
+        std::atomic<bool> mFailed{false};
+        std::atomic<bool> mConsumerWaiting{false};
+        std::atomic<bool> mProducerWaiting{false};
+        std::mutex mMutex;
+        std::condition_variable mCondition;
+
+        std::array<std::atomic<std::uint64_t>, 4> mDropped{};
+        std::atomic<std::size_t> mCapacity{0};
+
+
+    // public functions
+    public:
+        /** Construct an empty queue.
+         *
+         * @param capacity Ring size in bytes, rounded up to a power of two.
+         * @param policy Behaviour when the ring is full.
+         */
+        RecordQueue(std::size_t capacity, Policy policy);
+        RecordQueue(const RecordQueue &) = delete;
+        RecordQueue & operator=(const RecordQueue &) = delete;
+        ~RecordQueue();
+
+        /** Parse a policy name ("block", "drop" or "grow").
+         *
+         * Throws a std::invalid_argument for unknown names.
+         */
+        static Policy getPolicy(const std::string & name);
+
+        /** Append a record whose payload is the concatenation of two
+         * memory areas.
+         *
+         * @param flags State of the producer at the time of the push that
+         * the consumer reads from the record header.
+         * @retval true Record was appended.
+         * @retval false Record was dropped or the consumer failed.
+         */
+        bool push(RecordType type, std::uint16_t flags, const void * first,
+                  std::size_t firstSize, const void * second = nullptr,
+                  std::size_t secondSize = 0);
+
+        /** Append a record that is never dropped.
+         *
+         * Under Policy::DROP, waits for the consumer like Policy::BLOCK if
+         * the ring is full; otherwise like push(...).
+         *
+         * @retval true Record was appended.
+         * @retval false The consumer failed.
+         */
+        bool pushRequired(RecordType type, std::uint16_t flags,
+                          const void * first, std::size_t firstSize);
+
+        /** Signal that no further records will be pushed. */
+        void close();
+
+        /** Get the oldest record or nullptr if the queue is empty. */
+        const Record * front();
+
+        /** Remove the record returned by front(). */
+        void pop();
+
+        /** Wait until a record is available.
+         *
+         * @retval true A record is available.
+         * @retval false The queue is closed and drained.
+         */
+        bool wait();
+
+        /** Signal that the consumer stopped; unblocks the producer. */
+        void fail();
+
+        /** Indicate if the consumer stopped because of an error. */
+        bool isFailed() const;
+
+        /** Get the number of dropped records of a type. */
+        std::uint64_t getDropped(RecordType type) const;
+
+        /** Get the current ring size in bytes. */
+        std::size_t getCapacity() const;
+
+
+    // private functions
+    private:
+        bool append(Policy policy, RecordType type, std::uint16_t flags,
+                    const void * first, std::size_t firstSize,
+                    const void * second, std::size_t secondSize);
+        static bool isHalfEmpty(const Segment & segment);
+        void notify(std::atomic<bool> & waiting);
+
+};
+
+
+#endif
@@ -0,0 +1,158 @@
+#include "RecordSampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+
+RecordSampler::RecordSampler() {
+    rebuild();
+}
+
+
+RecordSampler::Rule RecordSampler::createRule(const std::string & mode,
+                                              double value, double exponent) {
+    Rule rule;
+    if (mode == "all") {
+        return rule;
+    }
+
+    if (mode == "every") {
+        if (!(value >= 1.0 && value <= 1e18) || std::floor(value) != value) {
+            throw std::invalid_argument("sampling every n-th record "
+                                        "requires an integer n >= 1");
+        }
+        rule.mode = Mode::EVERY_NTH;
+        rule.n = static_cast<std::uint64_t>(value);
+        return rule;
+    }
+
+    if (mode == "probability") {
+        rule.mode = Mode::PROBABILITY;
+        rule.probability = value;
+        return rule;
+    }
+
+    if (mode == "energy") {
+        rule.mode = Mode::ENERGY;
+        rule.referenceEnergy = value;
+        rule.exponent = exponent;
+        return rule;
+    }
+
+    throw std::invalid_argument("unknown sampling mode '" + mode + "'; "
+                                "expected all, every, probability or energy");
+}
+
+
+void RecordSampler::setRule(int particleId, const Rule & rule) {
+    if (particleId != DEFAULT_SPECIES &&
+        (particleId < 1 || particleId >= MAX_PARTICLE_ID)) {
+        throw std::invalid_argument("particle IDs have to be in [1, " +
+                                    std::to_string(MAX_PARTICLE_ID) + ")");
+    }
+
+    switch (rule.mode) {
+        case Mode::ALL:
+            break;
+
+        case Mode::EVERY_NTH:
+            if (rule.n < 1) {
+                throw std::invalid_argument("sampling every n-th record "
+                                            "requires n >= 1");
+            }
+            break;
+
+        case Mode::PROBABILITY:
+            if (!(rule.probability > 0.0 && rule.probability <= 1.0)) {
+                throw std::invalid_argument("sampling probability has to be "
+                                            "in (0, 1]");
+            }
+            break;
+
+        case Mode::ENERGY:
+            if (!(rule.referenceEnergy > 0.0) ||
+                !std::isfinite(rule.exponent)) {
+                throw std::invalid_argument("energy dependent sampling "
+                                            "requires a reference energy > 0 "
+                                            "and a finite exponent");
+            }
+            break;
+    }
+
+    mRules[particleId] = rule;
+    rebuild();
+}
+
+
+void RecordSampler::clear() {
+    mRules.clear();
+    rebuild();
+}
+
+
+void RecordSampler::setSeed(std::uint64_t seed) {
+    mSeed = seed;
+    rebuild();
+}
+
+std::uint64_t RecordSampler::getSeed() const {
+    return mSeed;
+}
+
+
+bool RecordSampler::isActive() const {
+    return mActive;
+}
+
+
+void RecordSampler::rebuild() {
+    // state 0 belongs to the default rule
+    mStates.assign(1, State());
+    mSpeciesState.clear();
+    mRandom = mSeed;
+
+    std::size_t maxSpecies = 0;
+    for (const auto & [particleId, rule] : mRules) {
+        if (particleId == DEFAULT_SPECIES) {
+            mStates[0].rule = rule;
+        }
+        else {
+            maxSpecies = std::max(maxSpecies,
+                                  static_cast<std::size_t>(particleId) + 1);
+        }
+    }
+
+    mSpeciesState.assign(maxSpecies, 0);
+    for (const auto & [particleId, rule] : mRules) {
+        if (particleId != DEFAULT_SPECIES) {
+            mSpeciesState[particleId] =
+                static_cast<std::uint32_t>(mStates.size());
+            mStates.push_back(State{rule, 0});
+        }
+    }
+
+    mActive = false;
+    for (const auto & state : mStates) {
+        mActive = mActive || state.rule.mode != Mode::ALL;
+    }
+}
+
+
+double RecordSampler::sampleEnergy(const Rule & rule, double energy) {
+    const double ratio = energy / rule.referenceEnergy;
+    const double probability = rule.exponent == 1.0
+                             ? ratio : std::pow(ratio, rule.exponent);
+
+    // the random number is drawn in any case to keep the sequence
+    // independent of the energies
+    const double random = nextUniform();
+    if (!(probability < 1.0)) {
+        return 1.0;
+    }
+
+    return random < probability ? 1.0 / probability : 0.0;
+}
@@ -0,0 +1,164 @@
+/** \file
+ * Statistical downsampling of COAST track and interaction records.
+ */
+#ifndef __RECORDSAMPLER_H__
+#define __RECORDSAMPLER_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ParticleId.h"
+
+
+/** Decides per record whether it is delivered and with which weight.
+ *
+ * Every particle species can have its own sampling rule; species without an
+ * own rule use the default rule. A delivered record has to be weighted with
+ * the inverse of its selection probability to keep results unbiased, which is
+ * returned by sample(...).
+ *
+ * Random decisions come from a counter-based generator such that the same
+ * seed and the same sequence of records reproduce the same selection.
+ */
+class RecordSampler {
+
+    // interface types
+    public:
+        /** Sampling mode of a rule. */
+        enum class Mode {
+            ALL,         /**< Deliver every record with weight 1. */
+            EVERY_NTH,   /**< Deliver every n-th record with weight n. */
+            PROBABILITY, /**< Deliver with fixed probability p, weight 1/p. */
+            ENERGY       /**< Deliver with probability
+                              min(1, (E / E0)^exponent), weight 1/p. */
+        };
+
+        /** Sampling rule of one particle species. */
+        struct Rule {
+            Mode mode = Mode::ALL;
+            std::uint64_t n = 1;
+            double probability = 1.0;
+            double referenceEnergy = 1.0;
+            double exponent = 1.0;
+        };
+
+        /** Species key of the default rule. */
+        static constexpr int DEFAULT_SPECIES = -1;
+
+
+    // internal types
+    private:
+        struct State {
+            Rule rule;
+            std::uint64_t counter = 0;
+        };
+
+
+    // members
+    private:
+        std::vector<State> mStates;
+        std::vector<std::uint32_t> mSpeciesState;
+        std::map<int, Rule> mRules;
+        std::uint64_t mSeed = 0;
+        std::uint64_t mRandom = 0;
+        bool mActive = false;
+
+
+    // public functions
+    public:
+        /** Construct a sampler that delivers everything. */
+        RecordSampler();
+
+        /** Create a rule from a mode name and its parameter.
+         *
+         * - "all": deliver everything; value is ignored.
+         * - "every": deliver every value-th record (integer >= 1).
+         * - "probability": deliver with probability value.
+         * - "energy": deliver with probability min(1, (E / value)^exponent).
+         *
+         * Throws a std::invalid_argument for unknown names or a non-integer
+         * value in mode "every".
+         */
+        static Rule createRule(const std::string & mode, double value,
+                               double exponent = 1.0);
+
+        /** Set the rule of a particle species.
+         *
+         * Throws a std::invalid_argument for particle IDs outside
+         * [1, MAX_PARTICLE_ID) or invalid rule parameters, i.e. n < 1, a
+         * probability outside (0, 1] or a reference energy <= 0. Resets all
+         * counters and the random sequence.
+         *
+         * @param particleId CORSIKA particle ID or DEFAULT_SPECIES.
+         * @param rule Sampling rule.
+         */
+        void setRule(int particleId, const Rule & rule);
+
+        /** Remove all rules, i.e. deliver everything. */
+        void clear();
+
+        /** Set the seed of the random sequence and reset all counters. */
+        void setSeed(std::uint64_t seed);
+
+        /** Get the seed of the random sequence. */
+        std::uint64_t getSeed() const;
+
+        /** Indicate if at least one rule does not deliver everything. */
+        bool isActive() const;
+
+        /** Decide if a record is delivered.
+         *
+         * @param particleId CORSIKA particle ID of the record.
+         * @param energy Energy of the record in GeV.
+         * @return 0 if the record is dropped, otherwise the weight factor
+         * (>= 1) of the delivered record.
+         */
+        double sample(int particleId, double energy) {
+            const std::size_t species = static_cast<std::size_t>(particleId);
+            State & state = mStates[species < mSpeciesState.size()
+                                    ? mSpeciesState[species] : 0];
+
+            switch (state.rule.mode) {
+                case Mode::ALL:
+                    return 1.0;
+
+                case Mode::EVERY_NTH:
+                    if (++state.counter < state.rule.n) {
+                        return 0.0;
+                    }
+                    state.counter = 0;
+                    return static_cast<double>(state.rule.n);
+
+                case Mode::PROBABILITY:
+                    return nextUniform() < state.rule.probability
+                         ? 1.0 / state.rule.probability : 0.0;
+
+                case Mode::ENERGY:
+                    return sampleEnergy(state.rule, energy);
+            }
+
+            return 1.0;
+        }
+
+
+    // private functions
+    private:
+        void rebuild();
+        double sampleEnergy(const Rule & rule, double energy);
+
+        /** Uniform random number in [0, 1) (splitmix64). */
+        double nextUniform() {
+            std::uint64_t z = (mRandom += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            z ^= z >> 31;
+            return static_cast<double>(z >> 11) * 0x1.0p-53;
+        }
+
+};
+
+
+#endif
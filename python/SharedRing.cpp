@@ -0,0 +1,555 @@
+#include "SharedRing.h"
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ShowerBoundary.h"
+
+
+namespace {
+
+constexpr char MAGIC[8] = {'C', 'O', 'A', 'S', 'T', 'S', 'H', 'M'};
+constexpr std::uint64_t MIN_CAPACITY = 1ull << 20;
+constexpr std::size_t PAGE_SIZE = 4096;
+constexpr int SPIN_COUNT = 1024;
+// sleeping sides wake up this often to check that the other side is alive
+constexpr long WAIT_TIMEOUT_NS = 100000000;
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free &&
+              std::atomic<std::uint32_t>::is_always_lock_free,
+              "shared ring requires lock-free atomics");
+
+
+std::string getObjectName(const std::string & name) {
+    if (name.empty() || name == "/") {
+        throw std::invalid_argument("shared memory name must not be empty");
+    }
+    return name[0] == '/' ? name : "/" + name;
+}
+
+}
+
+
+std::unique_ptr<SharedRing> SharedRing::create(const std::string & name,
+                                               std::uint64_t capacity) {
+    std::uint64_t size = MIN_CAPACITY;
+    while (size < capacity) {
+        size <<= 1;
+    }
+
+    std::unique_ptr<SharedRing> ring(new SharedRing(name, true));
+    int fd = shm_open(ring->mName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0 && errno == EEXIST && isStale(ring->mName)) {
+        shm_unlink(ring->mName.c_str());
+        fd = shm_open(ring->mName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    }
+    if (fd < 0) {
+        throw std::runtime_error("cannot create shared memory " +
+                                 ring->mName + ": " + std::strerror(errno));
+    }
+
+    const std::size_t controlSize =
+        (sizeof(Control) + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE;
+    if (ftruncate(fd, controlSize + size) != 0) {
+        ::close(fd);
+        shm_unlink(ring->mName.c_str());
+        throw std::runtime_error("cannot size shared memory " + ring->mName);
+    }
+    ring->map(fd, controlSize + size);
+
+    Control * control = new (ring->mControl) Control();
+    control->version = VERSION;
+    control->particleSize = sizeof(crs::CParticle);
+    control->interactionSize = sizeof(crs::CInteraction);
+    control->capacity = size;
+    control->producerPid = getpid();
+    // consumers check the magic last
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(control->magic, MAGIC, sizeof(MAGIC));
+
+    ring->mData = reinterpret_cast<unsigned char *>(control) + controlSize;
+    ring->mMask = size - 1;
+    return ring;
+}
+
+
+std::unique_ptr<SharedRing> SharedRing::attach(const std::string & name) {
+    std::unique_ptr<SharedRing> ring(new SharedRing(name, false));
+
+    // consumers are usually started before CORSIKA creates the ring
+    for (;;) {
+        const int fd = shm_open(ring->mName.c_str(), O_RDWR, 0);
+        if (fd < 0 && errno != ENOENT) {
+            throw std::runtime_error("cannot open shared memory " +
+                                     ring->mName + ": " +
+                                     std::strerror(errno));
+        }
+
+        struct stat info;
+        if (fd >= 0 && fstat(fd, &info) == 0 &&
+            info.st_size >= static_cast<off_t>(sizeof(Control))) {
+            ring->map(fd, info.st_size);
+            // a ring left behind by a killed producer is replaced
+            if (std::memcmp(ring->mControl->magic, MAGIC,
+                            sizeof(MAGIC)) == 0 &&
+                isAlive(ring->mControl->producerPid)) {
+                break;
+            }
+            munmap(ring->mControl, ring->mMappedSize);
+            ring->mControl = NULL;
+        }
+        else if (fd >= 0) {
+            ::close(fd);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    const Control * control = ring->mControl;
+    if (control->version != VERSION) {
+        throw std::runtime_error("shared memory " + ring->mName +
+                                 " is not a shared ring of version " +
+                                 std::to_string(VERSION));
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (control->particleSize != sizeof(crs::CParticle) ||
+        control->interactionSize != sizeof(crs::CInteraction)) {
+        throw std::runtime_error("shared ring was created with different "
+                                 "COAST types");
+    }
+    if (control->capacity == 0 ||
+        (control->capacity & (control->capacity - 1)) != 0 ||
+        control->capacity + sizeof(Control) > ring->mMappedSize) {
+        throw std::runtime_error("shared ring " + ring->mName +
+                                 " has an invalid capacity");
+    }
+    ring->mMask = control->capacity - 1;
+    ring->mData = reinterpret_cast<unsigned char *>(ring->mControl) +
+                  (ring->mMappedSize - control->capacity);
+
+    for (Consumer & consumer : ring->mControl->consumers) {
+        std::uint32_t state = FREE;
+        if (!consumer.state.compare_exchange_strong(state, CLAIMED)) {
+            continue;
+        }
+
+        consumer.readPosition.store(0);
+        consumer.required.store(ALL);
+        consumer.pid.store(getpid());
+        consumer.state.store(ATTACHED);
+        if (ring->mControl->started.load() != 0) {
+            consumer.state.store(FREE);
+            throw std::runtime_error("shared ring " + ring->mName +
+                                     " was already started");
+        }
+        ring->mConsumer = &consumer;
+        return ring;
+    }
+
+    throw std::runtime_error("all consumers of shared ring " + ring->mName +
+                             " are attached");
+}
+
+
+SharedRing::SharedRing(const std::string & name, bool producer)
+    : mName(getObjectName(name)),
+      mProducer(producer)
+{
+}
+
+
+SharedRing::~SharedRing() {
+    if (mControl == NULL) {
+        return;
+    }
+
+    if (mProducer) {
+        if (mControl->closed.load() == 0) {
+            mControl->closed.store(1);
+            wake(mControl->dataSequence);
+        }
+        shm_unlink(mName.c_str());
+    }
+    else if (mConsumer != NULL) {
+        mConsumer->state.store(FREE);
+        mControl->requiredSequence.fetch_add(1);
+        wake(mControl->spaceSequence);
+    }
+
+    munmap(mControl, mMappedSize);
+}
+
+
+const std::string & SharedRing::getName() const {
+    return mName;
+}
+
+
+void SharedRing::map(int fd, std::size_t size) {
+    void * data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        if (mProducer) {
+            shm_unlink(mName.c_str());
+        }
+        throw std::runtime_error("cannot map shared memory " + mName);
+    }
+
+    mControl = static_cast<Control *>(data);
+    mMappedSize = size;
+}
+
+
+void SharedRing::start(std::uint32_t consumers,
+                       const std::vector<int> & children) {
+    if (consumers == 0 || consumers > MAX_CONSUMERS) {
+        throw std::invalid_argument("a shared ring has 1 to " +
+                                    std::to_string(MAX_CONSUMERS) +
+                                    " consumers");
+    }
+
+    for (;;) {
+        std::uint32_t attached = 0;
+        for (Consumer & consumer : mControl->consumers) {
+            if (consumer.state.load() != ATTACHED) {
+                continue;
+            }
+            if (isAlive(consumer.pid.load())) {
+                ++attached;
+            }
+            else {
+                consumer.state.store(FREE);
+            }
+        }
+
+        if (attached >= consumers) {
+            mControl->started.store(1);
+            updateRequired();
+            return;
+        }
+
+        for (const int child : children) {
+            if (waitpid(child, NULL, WNOHANG) == child) {
+                throw std::runtime_error("consumer process " +
+                                         std::to_string(child) +
+                                         " exited before it attached to " +
+                                         mName);
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
+
+void SharedRing::publishInit(const CorsikaConfig & config) {
+    mSubBlockSize = CallRecorder::getSubBlockSize(config);
+    const std::string payload = CallRecorder::getInitPayload(config);
+
+    mStart = std::chrono::steady_clock::now();
+    publish(Call::INIT, payload.data(), payload.size());
+}
+
+
+void SharedRing::publishWrite(const CREAL * DataSubBlock) {
+    // header and trailer subblocks mark the showers for every consumer
+    if (!isRequired(WRITE) &&
+        ShowerBoundary::getBlockType(DataSubBlock) ==
+            ShowerBoundary::BlockType::PARTICLES) {
+        return;
+    }
+    publish(Call::WRITE, DataSubBlock, mSubBlockSize);
+}
+
+
+void SharedRing::publishInteraction(const crs::CInteraction & info) {
+    if (!isRequired(INTERACTION)) {
+        return;
+    }
+    publish(Call::INTERACTION, &info, sizeof(info));
+}
+
+
+void SharedRing::publishTrack(const crs::CParticle & pre,
+                              const crs::CParticle & post) {
+    if (!isRequired(TRACK)) {
+        return;
+    }
+    publish(Call::TRACK, &pre, sizeof(pre), &post, sizeof(post));
+}
+
+
+void SharedRing::close() {
+    if (mControl->closed.load() != 0) {
+        return;
+    }
+
+    publish(Call::CLOSE, nullptr, 0);
+    mControl->closed.store(1);
+    wake(mControl->dataSequence);
+}
+
+
+const SharedRing::CallHeader * SharedRing::next() {
+    const std::uint64_t capacity = mMask + 1;
+    int spins = 0;
+
+    for (;;) {
+        const std::uint64_t write =
+            mControl->writePosition.load(std::memory_order_acquire);
+        if (mReadPosition == write) {
+            if (mControl->closed.load() != 0 &&
+                mControl->writePosition.load() == mReadPosition) {
+                return NULL;
+            }
+            if (++spins < SPIN_COUNT) {
+                continue;
+            }
+
+            // announce the wait before the last check, the producer only
+            // wakes announced consumers
+            const std::uint32_t sequence = mControl->dataSequence.load();
+            mControl->consumersWaiting.fetch_add(1);
+            if (mControl->writePosition.load() == mReadPosition &&
+                mControl->closed.load() == 0) {
+                wait(mControl->dataSequence, sequence);
+            }
+            mControl->consumersWaiting.fetch_sub(1);
+
+            if (mControl->writePosition.load() == mReadPosition &&
+                mControl->closed.load() == 0 &&
+                !isAlive(mControl->producerPid)) {
+                throw std::runtime_error("producer of shared ring " + mName +
+                                         " exited without closing it");
+            }
+            continue;
+        }
+
+        spins = 0;
+        const std::uint64_t offset = mReadPosition & mMask;
+        if (capacity - offset < sizeof(CallHeader)) {
+            mReadPosition += capacity - offset;
+            continue;
+        }
+
+        const auto * header =
+            reinterpret_cast<const CallHeader *>(mData + offset);
+        const std::uint64_t size =
+            sizeof(CallHeader) + CallRecorder::getPaddedSize(header->size);
+        if (static_cast<std::uint32_t>(header->call) == PADDING) {
+            mReadPosition += size;
+            continue;
+        }
+
+        mRecordSize = size;
+        return header;
+    }
+}
+
+
+void SharedRing::release() {
+    mReadPosition += mRecordSize;
+    mRecordSize = 0;
+    mConsumer->readPosition.store(mReadPosition);
+    if (mControl->producerWaiting.load() != 0 &&
+        mReadPosition >= mControl->wakePosition.load()) {
+        wake(mControl->spaceSequence);
+    }
+}
+
+
+void SharedRing::setRequired(std::uint32_t required) {
+    if (mConsumer->required.load(std::memory_order_relaxed) != required) {
+        mConsumer->required.store(required);
+        mControl->requiredSequence.fetch_add(1);
+    }
+}
+
+
+bool SharedRing::isRequired(std::uint32_t call) {
+    // one relaxed load per call unless a consumer changed its mask
+    if (mControl->requiredSequence.load(std::memory_order_acquire) !=
+        mRequiredSequence) {
+        updateRequired();
+    }
+    return (mRequired & call) != 0;
+}
+
+
+void SharedRing::updateRequired() {
+    mRequiredSequence = mControl->requiredSequence.load();
+    std::uint32_t required = 0;
+    for (const Consumer & consumer : mControl->consumers) {
+        if (consumer.state.load() == ATTACHED) {
+            required |= consumer.required.load();
+        }
+    }
+    mRequired = required;
+}
+
+
+void SharedRing::publish(Call call, const void * first,
+                         std::uint32_t firstSize, const void * second,
+                         std::uint32_t secondSize) {
+    const std::uint32_t size = firstSize + secondSize;
+    const std::uint64_t recordSize =
+        sizeof(CallHeader) + CallRecorder::getPaddedSize(size);
+    unsigned char * record = reserve(recordSize);
+
+    const CallHeader header = {
+        call, size, static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - mStart).count())
+    };
+    std::memcpy(record, &header, sizeof(header));
+    if (firstSize > 0) {
+        std::memcpy(record + sizeof(header), first, firstSize);
+    }
+    if (secondSize > 0) {
+        std::memcpy(record + sizeof(header) + firstSize, second, secondSize);
+    }
+
+    mWritePosition += recordSize;
+    mControl->writePosition.store(mWritePosition);
+    if (mWritePosition >= mNextWake &&
+        mControl->consumersWaiting.load() != 0) {
+        wake(mControl->dataSequence);
+        mNextWake = mWritePosition + (mMask + 1) / 16;
+    }
+}
+
+
+unsigned char * SharedRing::reserve(std::uint64_t size) {
+    const std::uint64_t capacity = mMask + 1;
+    std::uint64_t offset = mWritePosition & mMask;
+
+    // records are contiguous, the rest of the ring is skipped
+    if (capacity - offset < size) {
+        const std::uint64_t rest = capacity - offset;
+        waitForSpace(mWritePosition + rest);
+        if (rest >= sizeof(CallHeader)) {
+            const CallHeader padding = {
+                static_cast<Call>(PADDING),
+                static_cast<std::uint32_t>(rest - sizeof(CallHeader)), 0
+            };
+            std::memcpy(mData + offset, &padding, sizeof(padding));
+        }
+        mWritePosition += rest;
+        offset = 0;
+    }
+
+    waitForSpace(mWritePosition + size);
+    return mData + offset;
+}
+
+
+void SharedRing::waitForSpace(std::uint64_t end) {
+    if (end <= mWriteLimit) {
+        return;
+    }
+
+    const std::uint64_t capacity = mMask + 1;
+    int spins = 0;
+    for (;;) {
+        mWriteLimit = getSlowestPosition() + capacity;
+        if (end <= mWriteLimit) {
+            return;
+        }
+        if (++spins < SPIN_COUNT) {
+            continue;
+        }
+
+        const std::uint32_t sequence = mControl->spaceSequence.load();
+        mControl->wakePosition.store(end - capacity + capacity / 8);
+        mControl->producerWaiting.store(1);
+        if (getSlowestPosition() + capacity < end) {
+            wait(mControl->spaceSequence, sequence);
+        }
+        mControl->producerWaiting.store(0);
+
+        // a consumer that exited without detaching would block forever
+        for (Consumer & consumer : mControl->consumers) {
+            if (consumer.state.load() == ATTACHED &&
+                !isAlive(consumer.pid.load())) {
+                consumer.state.store(FREE);
+                mControl->requiredSequence.fetch_add(1);
+            }
+        }
+    }
+}
+
+
+std::uint64_t SharedRing::getSlowestPosition() {
+    std::uint64_t slowest = mWritePosition;
+    for (const Consumer & consumer : mControl->consumers) {
+        if (consumer.state.load(std::memory_order_acquire) == ATTACHED) {
+            const std::uint64_t position =
+                consumer.readPosition.load(std::memory_order_acquire);
+            slowest = position < slowest ? position : slowest;
+        }
+    }
+    return slowest;
+}
+
+
+void SharedRing::wait(std::atomic<std::uint32_t> & word,
+                      std::uint32_t value) {
+    const timespec timeout = {0, WAIT_TIMEOUT_NS};
+    syscall(SYS_futex, reinterpret_cast<std::uint32_t *>(&word), FUTEX_WAIT,
+            value, &timeout, NULL, 0);
+}
+
+
+void SharedRing::wake(std::atomic<std::uint32_t> & word) {
+    word.fetch_add(1);
+    syscall(SYS_futex, reinterpret_cast<std::uint32_t *>(&word), FUTEX_WAKE,
+            INT_MAX, NULL, NULL, 0);
+}
+
+
+bool SharedRing::isStale(const std::string & name) {
+    const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    bool stale = false;
+    if (fstat(fd, &info) == 0 &&
+        info.st_size >= static_cast<off_t>(sizeof(Control))) {
+        void * data = mmap(NULL, sizeof(Control), PROT_READ, MAP_SHARED, fd,
+                           0);
+        if (data != MAP_FAILED) {
+            const Control * control = static_cast<const Control *>(data);
+            stale = std::memcmp(control->magic, MAGIC, sizeof(MAGIC)) == 0 &&
+                    !isAlive(control->producerPid);
+            munmap(data, sizeof(Control));
+        }
+    }
+    ::close(fd);
+    return stale;
+}
+
+
+bool SharedRing::isAlive(std::int32_t pid) {
+    return kill(pid, 0) == 0 || errno != ESRCH;
+}
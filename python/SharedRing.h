@@ -0,0 +1,249 @@
+/** \file
+ * POSIX shared-memory ring that transports COAST calls to consumer
+ * processes.
+ */
+#ifndef __SHAREDRING_H__
+#define __SHAREDRING_H__
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <crs/CorsikaTypes.h>
+#include <crs/CInteraction.h>
+#include <crs/CParticle.h>
+
+#include "CallRecorder.h"
+
+
+/** Single producer, multiple consumer ring of COAST call records in POSIX
+ * shared memory.
+ *
+ * Records have the layout of the CallRecorder log (CallHeader followed by
+ * the payload, padded to 8 bytes) and never wrap around the end of the
+ * ring: the remainder is skipped with a record of call 0. Every consumer
+ * reads every record; the producer waits while the slowest consumer is a
+ * full ring behind. Waiting sides sleep on process-shared futexes and are
+ * only woken if they announced that they sleep, such that publishing costs
+ * no system call while the consumers keep up. To avoid a system call per
+ * record, sleeping consumers are woken once a sixteenth of the ring was
+ * written since the last wake-up, and a waiting producer once an eighth of
+ * the ring is free. Consumers that exit without
+ * detaching are dropped when the producer waits for them.
+ *
+ * The producer waits for the requested number of consumers before the
+ * first record, later consumers cannot attach. Consumers may be started
+ * before the producer.
+ *
+ * Every consumer announces which of write, interaction and track calls it
+ * currently processes; calls that no consumer processes are not published.
+ * The producer sees a change of these masks up to a ring later than the
+ * consumer makes it, so a consumer that re-enables a call type can miss
+ * calls it disabled before.
+ */
+class SharedRing {
+
+    // interface types
+    public:
+        /** Maximum number of consumers per ring. */
+        static constexpr std::uint32_t MAX_CONSUMERS = 16;
+
+        /** Default ring capacity in bytes. */
+        static constexpr std::uint64_t DEFAULT_CAPACITY = 64ull << 20;
+
+        /** Record that skips the rest of the ring. */
+        static constexpr std::uint32_t PADDING = 0;
+
+        /** Current layout version. */
+        static constexpr std::uint32_t VERSION = 2;
+
+        /** Bits of the calls processed by a consumer, in the order of the
+         * PythonInterface capture flags. */
+        enum Required : std::uint32_t {
+            WRITE = 1u << 0,
+            INTERACTION = 1u << 1,
+            TRACK = 1u << 2,
+            ALL = WRITE | INTERACTION | TRACK
+        };
+
+
+    // internal types
+    private:
+        enum ConsumerState : std::uint32_t {
+            FREE = 0,
+            CLAIMED,
+            ATTACHED
+        };
+
+        struct alignas(64) Consumer {
+            std::atomic<std::uint32_t> state;
+            std::atomic<std::int32_t> pid;
+            std::atomic<std::uint64_t> readPosition;
+            std::atomic<std::uint32_t> required;
+        };
+
+        struct Control {
+            char magic[8];
+            std::uint32_t version;
+            std::uint16_t particleSize;
+            std::uint16_t interactionSize;
+            std::uint64_t capacity;
+            std::int32_t producerPid;
+            std::atomic<std::uint32_t> started;
+            std::atomic<std::uint32_t> closed;
+
+            alignas(64) std::atomic<std::uint64_t> writePosition;
+            std::atomic<std::uint32_t> dataSequence;
+            std::atomic<std::uint32_t> consumersWaiting;
+
+            alignas(64) std::atomic<std::uint32_t> spaceSequence;
+            std::atomic<std::uint32_t> producerWaiting;
+            std::atomic<std::uint64_t> wakePosition;
+
+            alignas(64) std::atomic<std::uint32_t> requiredSequence;
+
+            Consumer consumers[MAX_CONSUMERS];
+        };
+
+        using Call = CallRecorder::Call;
+        using CallHeader = CallRecorder::CallHeader;
+
+
+    // members
+    private:
+        std::string mName;
+        bool mProducer = false;
+        Control * mControl = NULL;
+        unsigned char * mData = NULL;
+        std::size_t mMappedSize = 0;
+        std::uint64_t mMask = 0;
+
+        // producer
+        std::uint64_t mWritePosition = 0;
+        std::uint64_t mWriteLimit = 0;
+        std::uint64_t mNextWake = 0;
+        std::uint32_t mRequired = ALL;
+        std::uint32_t mRequiredSequence = 0;
+        std::uint32_t mSubBlockSize = 0;
+        std::chrono::steady_clock::time_point mStart;
+
+        // consumer
+        Consumer * mConsumer = NULL;
+        std::uint64_t mReadPosition = 0;
+        std::uint64_t mRecordSize = 0;
+
+
+    // public functions
+    public:
+        /** Create the ring; consumers can attach until start().
+         *
+         * A ring of the same name whose producer exited is replaced.
+         *
+         * Throws a std::runtime_error if the shared memory cannot be
+         * created.
+         *
+         * @param name Name of the shared memory object, a leading '/' is
+         * added if missing.
+         * @param capacity Ring size in bytes, rounded up to a power of two
+         * of at least 1 MiB.
+         */
+        static std::unique_ptr<SharedRing> create(const std::string & name,
+                                                  std::uint64_t capacity);
+
+        /** Attach a consumer to a ring that was not started yet.
+         *
+         * Waits until the ring is created. Throws a std::runtime_error if
+         * the ring has a different layout, was started or all consumers
+         * are attached.
+         */
+        static std::unique_ptr<SharedRing> attach(const std::string & name);
+
+        SharedRing(const SharedRing &) = delete;
+        SharedRing & operator=(const SharedRing &) = delete;
+
+        /** Close a producer or detach a consumer and unmap the ring. */
+        ~SharedRing();
+
+        /** Get the name of the shared memory object. */
+        const std::string & getName() const;
+
+        /** Wait for the consumers of a producer.
+         *
+         * Throws a std::invalid_argument for an invalid number of consumers
+         * and a std::runtime_error if one of the given child processes
+         * exits before all consumers are attached.
+         *
+         * @param consumers Number of consumers to wait for, 1 to
+         * MAX_CONSUMERS.
+         * @param children Processes that are expected to attach.
+         */
+        void start(std::uint32_t consumers,
+                   const std::vector<int> & children = {});
+
+        /** Publish inida_(...) and start the clock.
+         *
+         * Throws a std::invalid_argument if thinning is unknown.
+         */
+        void publishInit(const CorsikaConfig & config);
+
+        /** Publish wrida_(...). */
+        void publishWrite(const CREAL * DataSubBlock);
+
+        /** Publish interaction_(...). */
+        void publishInteraction(const crs::CInteraction & info);
+
+        /** Publish track_(...). */
+        void publishTrack(const crs::CParticle & pre,
+                          const crs::CParticle & post);
+
+        /** Publish cloda_() and mark the ring as closed. */
+        void close();
+
+        /** Wait for the next record of a consumer.
+         *
+         * The record and its payload stay valid until release().
+         *
+         * Throws a std::runtime_error if the producer exited without
+         * closing the ring.
+         *
+         * @return The record header, followed by the payload; NULL if the
+         * ring was closed and all records were read.
+         */
+        const CallHeader * next();
+
+        /** Release the record returned by next(). */
+        void release();
+
+        /** Announce the calls a consumer processes.
+         *
+         * @param required Combination of Required bits.
+         */
+        void setRequired(std::uint32_t required);
+
+
+    // private functions
+    private:
+        SharedRing(const std::string & name, bool producer);
+        void map(int fd, std::size_t size);
+        void publish(Call call, const void * first, std::uint32_t firstSize,
+                     const void * second = nullptr,
+                     std::uint32_t secondSize = 0);
+        unsigned char * reserve(std::uint64_t size);
+        void waitForSpace(std::uint64_t end);
+        std::uint64_t getSlowestPosition();
+        bool isRequired(std::uint32_t call);
+        void updateRequired();
+        static void wait(std::atomic<std::uint32_t> & word,
+                         std::uint32_t value);
+        static void wake(std::atomic<std::uint32_t> & word);
+        static bool isStale(const std::string & name);
+        static bool isAlive(std::int32_t pid);
+
+};
+
+
+#endif
@@ -0,0 +1,149 @@
+#include "ShowerBoundary.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+
+namespace {
+
+// block markers interpreted as CORSIKA single precision float, which in
+// contrast to particle descriptions are not integral
+constexpr float RUN_HEADER = 211285.28125f;
+constexpr float EVENT_HEADER = 217433.078125f;
+constexpr float LONGITUDINAL = 52815.296875f;
+constexpr float EVENT_END = 3397.391845703125f;
+constexpr float RUN_END = 3301.33251953125f;
+
+// maximum number of random sequences and observation levels in EVTH
+constexpr int MAX_SEEDS = 10;
+constexpr int MAX_LEVELS = 10;
+
+int getInt(const CREAL * DataSubBlock, int word) {
+    return static_cast<int>(DataSubBlock[word - 1]);
+}
+
+}
+
+
+ShowerBoundary::BlockType ShowerBoundary::getBlockType(
+        const CREAL * DataSubBlock) {
+    const float marker = static_cast<float>(DataSubBlock[0]);
+    if (marker == EVENT_HEADER) {
+        return BlockType::EVENT_HEADER;
+    }
+    if (marker == EVENT_END) {
+        return BlockType::EVENT_END;
+    }
+    if (marker == LONGITUDINAL) {
+        return BlockType::LONGITUDINAL;
+    }
+    if (marker == RUN_HEADER) {
+        return BlockType::RUN_HEADER;
+    }
+    if (marker == RUN_END) {
+        return BlockType::RUN_END;
+    }
+    return BlockType::PARTICLES;
+}
+
+
+bool ShowerBoundary::isBoundary(const CREAL * DataSubBlock) {
+    const BlockType type = getBlockType(DataSubBlock);
+    return type != BlockType::PARTICLES && type != BlockType::LONGITUDINAL;
+}
+
+
+ShowerBoundary::BlockType ShowerBoundary::process(
+        const CREAL * DataSubBlock) {
+    const BlockType type = getBlockType(DataSubBlock);
+
+    switch (type) {
+        case BlockType::RUN_HEADER:
+            mRunNumber = getInt(DataSubBlock, 2);
+            break;
+
+        case BlockType::EVENT_HEADER: {
+            Header header;
+            header.eventNumber = getInt(DataSubBlock, 2);
+            header.particleId = getInt(DataSubBlock, 3);
+            header.energy = DataSubBlock[3];
+            header.startingAltitude = DataSubBlock[4];
+            header.firstInteractionHeight = DataSubBlock[6];
+            header.px = DataSubBlock[7];
+            header.py = DataSubBlock[8];
+            header.pz = DataSubBlock[9];
+            header.zenith = DataSubBlock[10];
+            header.azimuth = DataSubBlock[11];
+
+            // words 14 + 3 i: seed, calls mod 10^6, calls div 10^6
+            const int seeds = getInt(DataSubBlock, 13);
+            for (int i = 0; i < seeds && i < MAX_SEEDS; ++i) {
+                const int word = 14 + 3 * i;
+                header.seeds.push_back({
+                    getInt(DataSubBlock, word),
+                    getInt(DataSubBlock, word + 1) +
+                        std::int64_t(1000000) * getInt(DataSubBlock, word + 2)
+                });
+            }
+
+            header.runNumber = getInt(DataSubBlock, 44);
+            const int levels = getInt(DataSubBlock, 47);
+            for (int i = 0; i < levels && i < MAX_LEVELS; ++i) {
+                header.observationLevels.push_back(DataSubBlock[47 + i]);
+            }
+
+            mRunNumber = header.runNumber;
+            mHeader = std::move(header);
+            mInShower = true;
+            ++mShowers;
+            break;
+        }
+
+        case BlockType::EVENT_END: {
+            Trailer trailer;
+            trailer.runNumber = mRunNumber;
+            trailer.eventNumber = getInt(DataSubBlock, 2);
+            trailer.photons = DataSubBlock[2];
+            trailer.electrons = DataSubBlock[3];
+            trailer.hadrons = DataSubBlock[4];
+            trailer.muons = DataSubBlock[5];
+            trailer.particles = DataSubBlock[6];
+
+            mTrailer = trailer;
+            mInShower = false;
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    return type;
+}
+
+
+bool ShowerBoundary::isInShower() const {
+    return mInShower;
+}
+
+std::uint64_t ShowerBoundary::getShowerCount() const {
+    return mShowers;
+}
+
+int ShowerBoundary::getRunNumber() const {
+    return mRunNumber;
+}
+
+const ShowerBoundary::Header & ShowerBoundary::getHeader() const {
+    return mHeader;
+}
+
+const ShowerBoundary::Trailer & ShowerBoundary::getTrailer() const {
+    return mTrailer;
+}
+
+
+void ShowerBoundary::reset() {
+    *this = ShowerBoundary();
+}
@@ -0,0 +1,112 @@
+/** \file
+ * Detection of run and shower boundaries in the CORSIKA subblock stream.
+ */
+#ifndef __SHOWERBOUNDARY_H__
+#define __SHOWERBOUNDARY_H__
+
+#include <cstdint>
+#include <vector>
+
+#include <crs/CorsikaTypes.h>
+
+
+/** Classifies the subblocks of wrida_(...) and parses the run and event
+ * headers and trailers.
+ *
+ * Words are referred to by their 1-based number in the CORSIKA user guide,
+ * e.g. word 4 of EVTH (total energy) is DataSubBlock[3].
+ */
+class ShowerBoundary {
+
+    // interface types
+    public:
+        /** Kind of a subblock. */
+        enum class BlockType {
+            PARTICLES,     /**< particle lines */
+            RUN_HEADER,    /**< RUNH */
+            EVENT_HEADER,  /**< EVTH */
+            LONGITUDINAL,  /**< LONG */
+            EVENT_END,     /**< EVTE */
+            RUN_END        /**< RUNE */
+        };
+
+        /** Random number sequence at the start of a shower. */
+        struct Seed {
+            int seed;
+            std::int64_t calls;  /**< Number of calls before the shower. */
+        };
+
+        /** Parsed EVTH subblock. */
+        struct Header {
+            int runNumber = 0;
+            int eventNumber = 0;
+            int particleId = 0;                  /**< Primary particle. */
+            double energy = 0;                   /**< Total energy in GeV. */
+            double startingAltitude = 0;         /**< In g/cm^2. */
+            double firstInteractionHeight = 0;   /**< In cm. */
+            double px = 0;                       /**< Momentum in GeV/c. */
+            double py = 0;
+            double pz = 0;
+            double zenith = 0;                   /**< In rad. */
+            double azimuth = 0;                  /**< In rad. */
+            std::vector<Seed> seeds;
+            std::vector<double> observationLevels;  /**< Heights in cm. */
+        };
+
+        /** Parsed EVTE subblock. */
+        struct Trailer {
+            int runNumber = 0;
+            int eventNumber = 0;
+            double photons = 0;     /**< Weighted numbers of particles. */
+            double electrons = 0;
+            double hadrons = 0;
+            double muons = 0;
+            double particles = 0;   /**< Written to the particle output. */
+        };
+
+
+    // members
+    private:
+        int mRunNumber = 0;
+        bool mInShower = false;
+        std::uint64_t mShowers = 0;
+        Header mHeader;
+        Trailer mTrailer;
+
+
+    // public functions
+    public:
+        /** Get the kind of a subblock from its first word. */
+        static BlockType getBlockType(const CREAL * DataSubBlock);
+
+        /** Indicate if a subblock is a RUNH, EVTH, EVTE or RUNE. */
+        static bool isBoundary(const CREAL * DataSubBlock);
+
+        /** Classify a subblock and parse it if it is a header or trailer.
+         *
+         * @return Kind of the subblock.
+         */
+        BlockType process(const CREAL * DataSubBlock);
+
+        /** Indicate if an EVTH was processed without the matching EVTE. */
+        bool isInShower() const;
+
+        /** Get the number of processed EVTH subblocks. */
+        std::uint64_t getShowerCount() const;
+
+        /** Get the run number of the last RUNH or EVTH. */
+        int getRunNumber() const;
+
+        /** Get the last parsed EVTH. */
+        const Header & getHeader() const;
+
+        /** Get the last parsed EVTE. */
+        const Trailer & getTrailer() const;
+
+        /** Forget the processed subblocks. */
+        void reset();
+
+};
+
+
+#endif
@@ -0,0 +1,351 @@
+#include "SurfaceDetector.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+
+namespace {
+
+constexpr double INFINITE = std::numeric_limits<double>::infinity();
+
+double dot(const double * a, const double * b) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+}
+
+
+SurfaceDetector::SurfaceDetector(std::size_t capacity)
+    : mCapacity(capacity)
+{
+}
+
+
+int SurfaceDetector::addPlane(const std::array<double, 3> & point,
+                              const std::array<double, 3> & normal,
+                              double radius) {
+    const double length = std::sqrt(dot(normal.data(), normal.data()));
+    if (!(length > 0) || !std::isfinite(length)) {
+        throw std::invalid_argument("plane normals have to be finite and "
+                                    "non-zero");
+    }
+    if (!(radius >= 0)) {
+        throw std::invalid_argument("disc radii have to be >= 0");
+    }
+
+    const std::array<double, 3> unit = {
+        normal[0] / length, normal[1] / length, normal[2] / length
+    };
+
+    // planes of equal normal share one sorted list
+    auto group = std::find_if(mPlaneGroups.begin(), mPlaneGroups.end(),
+                              [&unit](const PlaneGroup & entry) {
+                                  return entry.normal == unit;
+                              });
+    if (group == mPlaneGroups.end()) {
+        mPlaneGroups.push_back({unit, {}});
+        group = mPlaneGroups.end() - 1;
+    }
+
+    group->planes.push_back({dot(unit.data(), point.data()), point,
+                             radius * radius, mSurfaces});
+    mDirty = true;
+    return mSurfaces++;
+}
+
+
+int SurfaceDetector::addSphere(const std::array<double, 3> & center,
+                               double radius) {
+    if (!(radius > 0) || !std::isfinite(radius)) {
+        throw std::invalid_argument("sphere radii have to be > 0");
+    }
+
+    mSpheres.push_back({center, radius, mSurfaces});
+    mDirty = true;
+    return mSurfaces++;
+}
+
+
+void SurfaceDetector::clear() {
+    mPlaneGroups.clear();
+    mSpheres.clear();
+    mNodes.clear();
+    mDirty = false;
+    mSurfaces = 0;
+    clearCrossings();
+}
+
+
+bool SurfaceDetector::isActive() const {
+    return mSurfaces > 0;
+}
+
+std::size_t SurfaceDetector::getSurfaceCount() const {
+    return mSurfaces;
+}
+
+
+void SurfaceDetector::detect(const crs::CParticle & pre,
+                             const crs::CParticle & post) {
+    const double start[3] = {pre.x, pre.y, pre.z};
+    const double delta[3] = {post.x - pre.x, post.y - pre.y, post.z - pre.z};
+    const double end[3] = {post.x, post.y, post.z};
+    const double length = std::sqrt(dot(delta, delta));
+    if (length == 0) {
+        return;
+    }
+
+    if (mDirty) {
+        build();
+    }
+
+    mHits.clear();
+    detectPlanes(start, end);
+    detectSpheres(start, delta);
+    if (mHits.empty()) {
+        return;
+    }
+
+    if (mHits.size() > 1) {
+        std::sort(mHits.begin(), mHits.end(),
+                  [](const Hit & a, const Hit & b) {
+                      return a.t < b.t || (a.t == b.t && a.id < b.id);
+                  });
+    }
+
+    for (const Hit & hit : mHits) {
+        const double t = hit.t;
+        mCrossings.surfaceId.push_back(hit.id);
+        mCrossings.particleId.push_back(pre.particleId);
+        mCrossings.x.push_back(start[0] + t * delta[0]);
+        mCrossings.y.push_back(start[1] + t * delta[1]);
+        mCrossings.z.push_back(start[2] + t * delta[2]);
+        mCrossings.depth.push_back(pre.depth + t * (post.depth - pre.depth));
+        mCrossings.time.push_back(pre.time + t * (post.time - pre.time));
+        mCrossings.energy.push_back(pre.energy +
+                                    t * (post.energy - pre.energy));
+        mCrossings.weight.push_back(pre.weight);
+        mCrossings.ux.push_back(delta[0] / length);
+        mCrossings.uy.push_back(delta[1] / length);
+        mCrossings.uz.push_back(delta[2] / length);
+    }
+}
+
+
+std::size_t SurfaceDetector::getSize() const {
+    return mCrossings.surfaceId.size();
+}
+
+bool SurfaceDetector::isFull() const {
+    return getSize() >= mCapacity;
+}
+
+const SurfaceDetector::Crossings & SurfaceDetector::getCrossings() const {
+    return mCrossings;
+}
+
+
+void SurfaceDetector::clearCrossings() {
+    mCrossings.surfaceId.clear();
+    mCrossings.particleId.clear();
+    mCrossings.x.clear();
+    mCrossings.y.clear();
+    mCrossings.z.clear();
+    mCrossings.depth.clear();
+    mCrossings.time.clear();
+    mCrossings.energy.clear();
+    mCrossings.weight.clear();
+    mCrossings.ux.clear();
+    mCrossings.uy.clear();
+    mCrossings.uz.clear();
+}
+
+
+void SurfaceDetector::build() {
+    for (PlaneGroup & group : mPlaneGroups) {
+        std::sort(group.planes.begin(), group.planes.end(),
+                  [](const Plane & a, const Plane & b) {
+                      return a.offset < b.offset;
+                  });
+    }
+
+    mNodes.clear();
+    if (!mSpheres.empty()) {
+        buildNode(0, mSpheres.size());
+    }
+    mDirty = false;
+}
+
+
+std::uint32_t SurfaceDetector::buildNode(std::uint32_t first,
+                                         std::uint32_t count) {
+    const std::uint32_t index = mNodes.size();
+    mNodes.emplace_back();
+
+    Node node;
+    std::array<double, 3> lowerCenter;
+    std::array<double, 3> upperCenter;
+    for (std::size_t i = 0; i < 3; ++i) {
+        node.lower[i] = INFINITE;
+        node.upper[i] = -INFINITE;
+        lowerCenter[i] = INFINITE;
+        upperCenter[i] = -INFINITE;
+    }
+    for (std::uint32_t k = first; k < first + count; ++k) {
+        const Sphere & sphere = mSpheres[k];
+        for (std::size_t i = 0; i < 3; ++i) {
+            node.lower[i] = std::min(node.lower[i],
+                                     sphere.center[i] - sphere.radius);
+            node.upper[i] = std::max(node.upper[i],
+                                     sphere.center[i] + sphere.radius);
+            lowerCenter[i] = std::min(lowerCenter[i], sphere.center[i]);
+            upperCenter[i] = std::max(upperCenter[i], sphere.center[i]);
+        }
+    }
+
+    if (count <= LEAF_SPHERES) {
+        node.first = first;
+        node.count = count;
+        mNodes[index] = node;
+        return index;
+    }
+
+    // median split along the largest extent of the centers
+    std::size_t axis = 0;
+    for (std::size_t i = 1; i < 3; ++i) {
+        if (upperCenter[i] - lowerCenter[i] >
+            upperCenter[axis] - lowerCenter[axis]) {
+            axis = i;
+        }
+    }
+    const std::uint32_t middle = first + count / 2;
+    std::nth_element(mSpheres.begin() + first, mSpheres.begin() + middle,
+                     mSpheres.begin() + first + count,
+                     [axis](const Sphere & a, const Sphere & b) {
+                         return a.center[axis] < b.center[axis];
+                     });
+
+    buildNode(first, middle - first);
+    node.first = buildNode(middle, first + count - middle);
+    node.count = 0;
+    mNodes[index] = node;
+    return index;
+}
+
+
+void SurfaceDetector::detectPlanes(const double * start,
+                                   const double * end) {
+    // the side of post is computed like the side of the next pre, such
+    // that consecutive segments agree on it
+    for (const PlaneGroup & group : mPlaneGroups) {
+        const double a = dot(group.normal.data(), start);
+        const double b = dot(group.normal.data(), end);
+        if (a == b) {
+            continue;
+        }
+
+        // planes with an offset in (min, max] separate pre and post
+        const auto below = [](double value, const Plane & plane) {
+            return value < plane.offset;
+        };
+        const auto first = std::upper_bound(group.planes.begin(),
+                                            group.planes.end(),
+                                            std::min(a, b), below);
+        const auto last = std::upper_bound(first, group.planes.end(),
+                                           std::max(a, b), below);
+
+        for (auto plane = first; plane != last; ++plane) {
+            const double t = (plane->offset - a) / (b - a);
+            if (plane->radius2 > 0) {
+                double distance2 = 0;
+                for (std::size_t i = 0; i < 3; ++i) {
+                    const double d = start[i] + t * (end[i] - start[i]) -
+                                     plane->center[i];
+                    distance2 += d * d;
+                }
+                if (distance2 > plane->radius2) {
+                    continue;
+                }
+            }
+            mHits.push_back({t, plane->id});
+        }
+    }
+}
+
+
+void SurfaceDetector::detectSpheres(const double * start,
+                                    const double * delta) {
+    if (mNodes.empty()) {
+        return;
+    }
+
+    double lower[3];
+    double upper[3];
+    for (std::size_t i = 0; i < 3; ++i) {
+        lower[i] = std::min(start[i], start[i] + delta[i]);
+        upper[i] = std::max(start[i], start[i] + delta[i]);
+    }
+
+    mStack.clear();
+    mStack.push_back(0);
+    while (!mStack.empty()) {
+        const std::uint32_t index = mStack.back();
+        mStack.pop_back();
+        const Node & node = mNodes[index];
+
+        bool overlap = true;
+        for (std::size_t i = 0; i < 3; ++i) {
+            overlap = overlap && lower[i] <= node.upper[i] &&
+                      upper[i] >= node.lower[i];
+        }
+        if (!overlap) {
+            continue;
+        }
+
+        if (node.count == 0) {
+            mStack.push_back(node.first);
+            mStack.push_back(index + 1);
+            continue;
+        }
+
+        for (std::uint32_t k = node.first; k < node.first + node.count; ++k) {
+            intersectSphere(mSpheres[k], start, delta);
+        }
+    }
+}
+
+
+void SurfaceDetector::intersectSphere(const Sphere & sphere,
+                                      const double * start,
+                                      const double * delta) {
+    const double offset[3] = {
+        start[0] - sphere.center[0],
+        start[1] - sphere.center[1],
+        start[2] - sphere.center[2]
+    };
+    const double a = dot(delta, delta);
+    const double b = 2 * dot(delta, offset);
+    const double c = dot(offset, offset) - sphere.radius * sphere.radius;
+    const double discriminant = b * b - 4 * a * c;
+    if (discriminant <= 0) {
+        // missed or touched
+        return;
+    }
+
+    // the inside changes after entering and at leaving
+    const double root = std::sqrt(discriminant);
+    const double enter = (-b - root) / (2 * a);
+    const double exit = (-b + root) / (2 * a);
+    if (enter >= 0 && enter < 1) {
+        mHits.push_back({enter, sphere.id});
+    }
+    if (exit > 0 && exit <= 1) {
+        mHits.push_back({exit, sphere.id});
+    }
+}
@@ -0,0 +1,173 @@
+/** \file
+ * Crossings of track segments with planes, discs and spheres.
+ */
+#ifndef __SURFACEDETECTOR_H__
+#define __SURFACEDETECTOR_H__
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <crs/CParticle.h>
+
+
+/** Intersects track segments with registered surfaces and collects the
+ * interpolated crossings as columns.
+ *
+ * Planes are grouped by their normal and sorted by their distance to the
+ * origin, such that the planes a segment crosses are found by a binary
+ * search per group, e.g. for hundreds of horizontal planes. Spheres are
+ * kept in a bounding volume hierarchy that is rebuilt when spheres are
+ * added.
+ *
+ * A segment crosses a surface where the side of pre and post differ,
+ * points on a plane count as above and points on a sphere as outside.
+ * A particle that stops on a surface is thus counted once, also if the
+ * next segment starts there.
+ */
+class SurfaceDetector {
+
+    // interface types
+    public:
+        /** Crossings in order of the segments and, per segment, in order
+         * along the segment. */
+        struct Crossings {
+            std::vector<int> surfaceId;
+            std::vector<int> particleId;
+            std::vector<double> x;         /**< Interpolated position. */
+            std::vector<double> y;
+            std::vector<double> z;
+            std::vector<double> depth;     /**< Interpolated slant depth. */
+            std::vector<double> time;      /**< Interpolated time. */
+            std::vector<double> energy;    /**< Interpolated energy. */
+            std::vector<double> weight;    /**< Weight of pre. */
+            std::vector<double> ux;        /**< Unit direction of the
+                                                segment. */
+            std::vector<double> uy;
+            std::vector<double> uz;
+        };
+
+        /** Number of crossings after which isFull() holds. */
+        static constexpr std::size_t DEFAULT_CAPACITY = 4096;
+
+
+    // internal types
+    private:
+        struct Plane {
+            double offset;                 // normal * point
+            std::array<double, 3> center;
+            double radius2;                // 0 = unbounded
+            int id;
+        };
+
+        struct PlaneGroup {
+            std::array<double, 3> normal;
+            std::vector<Plane> planes;     // sorted by offset
+        };
+
+        struct Sphere {
+            std::array<double, 3> center;
+            double radius;
+            int id;
+        };
+
+        // leaves hold count > 0 spheres from first, inner nodes have their
+        // left child next to them and the right child at first
+        struct Node {
+            std::array<double, 3> lower;
+            std::array<double, 3> upper;
+            std::uint32_t first;
+            std::uint32_t count;
+        };
+
+        struct Hit {
+            double t;
+            int id;
+        };
+
+        static constexpr std::uint32_t LEAF_SPHERES = 4;
+
+
+    // members
+    private:
+        std::vector<PlaneGroup> mPlaneGroups;
+        std::vector<Sphere> mSpheres;
+        std::vector<Node> mNodes;
+        bool mDirty = false;
+        int mSurfaces = 0;
+
+        std::size_t mCapacity;
+        Crossings mCrossings;
+        std::vector<Hit> mHits;
+        std::vector<std::uint32_t> mStack;
+
+
+    // public functions
+    public:
+        /** Create a detector without surfaces.
+         *
+         * @param capacity Number of crossings after which isFull() holds.
+         */
+        explicit SurfaceDetector(std::size_t capacity = DEFAULT_CAPACITY);
+
+        /** Add a plane or a disc.
+         *
+         * Throws a std::invalid_argument for a zero normal or a negative
+         * radius.
+         *
+         * @param point Point on the plane, the center of a disc.
+         * @param normal Normal of the plane; need not be normalized.
+         * @param radius Radius of a disc; 0 = unbounded plane.
+         * @return Surface ID.
+         */
+        int addPlane(const std::array<double, 3> & point,
+                     const std::array<double, 3> & normal, double radius);
+
+        /** Add a sphere.
+         *
+         * Throws a std::invalid_argument for radius <= 0.
+         *
+         * @return Surface ID.
+         */
+        int addSphere(const std::array<double, 3> & center, double radius);
+
+        /** Remove all surfaces and crossings. */
+        void clear();
+
+        /** Indicate if surfaces are registered. */
+        bool isActive() const;
+
+        /** Get the number of registered surfaces. */
+        std::size_t getSurfaceCount() const;
+
+        /** Add the crossings of a track segment. */
+        void detect(const crs::CParticle & pre, const crs::CParticle & post);
+
+        /** Get the number of collected crossings. */
+        std::size_t getSize() const;
+
+        /** Indicate if the collected crossings reached the capacity. */
+        bool isFull() const;
+
+        /** Get the collected crossings. */
+        const Crossings & getCrossings() const;
+
+        /** Remove the collected crossings; their memory stays valid until
+         * the next detect(). */
+        void clearCrossings();
+
+
+    // private functions
+    private:
+        void build();
+        std::uint32_t buildNode(std::uint32_t first, std::uint32_t count);
+        void detectPlanes(const double * start, const double * end);
+        void detectSpheres(const double * start, const double * delta);
+        void intersectSphere(const Sphere & sphere, const double * start,
+                             const double * delta);
+
+};
+
+
+#endif
@@ -0,0 +1,161 @@
+#include "Tracer.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+
+namespace {
+
+std::atomic<std::uint64_t> nextTracerId{1};
+
+// buffer of the last tracer that the thread recorded to; tracer ids are
+// never reused, such that a stale buffer pointer is never followed
+struct ThreadCache {
+    std::uint64_t tracer = 0;
+    void * buffer = nullptr;
+};
+
+thread_local ThreadCache threadCache;
+
+
+void writeEscaped(std::FILE * file, const char * text) {
+    for (const char * c = text; *c != '\0'; ++c) {
+        if (*c == '"' || *c == '\\') {
+            std::fputc('\\', file);
+            std::fputc(*c, file);
+        }
+        else if (static_cast<unsigned char>(*c) < 0x20) {
+            std::fprintf(file, "\\u%04x", static_cast<unsigned char>(*c));
+        }
+        else {
+            std::fputc(*c, file);
+        }
+    }
+}
+
+}
+
+
+Tracer::Tracer(const std::string & path, std::uint64_t sampleEvery)
+    : mPath(path), mSampleEvery(sampleEvery), mId(nextTracerId++),
+      mStart(std::chrono::steady_clock::now())
+{
+    if (sampleEvery == 0) {
+        throw std::invalid_argument("trace sampling interval has to be > 0");
+    }
+}
+
+
+const std::string & Tracer::getPath() const {
+    return mPath;
+}
+
+
+std::uint64_t Tracer::getSampleEvery() const {
+    return mSampleEvery;
+}
+
+
+void Tracer::begin(const char * name) {
+    append(name, 'B');
+}
+
+
+void Tracer::begin(const std::string & name) {
+    ThreadBuffer & buffer = getThreadBuffer();
+    auto it = buffer.names.insert(name).first;
+    append(it->c_str(), 'B');
+}
+
+
+void Tracer::end() {
+    append("", 'E');
+}
+
+
+void Tracer::setThreadName(const std::string & name) {
+    getThreadBuffer().name = name;
+}
+
+
+Tracer::ThreadBuffer & Tracer::getThreadBuffer() {
+    if (threadCache.tracer == mId) {
+        return *static_cast<ThreadBuffer *>(threadCache.buffer);
+    }
+
+    std::lock_guard<std::mutex> lock(mThreadsMutex);
+    mThreads.push_back(std::make_unique<ThreadBuffer>());
+    ThreadBuffer & buffer = *mThreads.back();
+    buffer.id = mThreads.size();
+    buffer.name = "thread " + std::to_string(buffer.id);
+
+    threadCache.tracer = mId;
+    threadCache.buffer = &buffer;
+    return buffer;
+}
+
+
+void Tracer::append(const char * name, char phase) {
+    const std::uint64_t time =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - mStart).count();
+
+    ThreadBuffer & buffer = getThreadBuffer();
+    if (buffer.used == CHUNK_EVENTS) {
+        buffer.chunks.push_back(std::make_unique<Event[]>(CHUNK_EVENTS));
+        buffer.used = 0;
+    }
+    buffer.chunks.back()[buffer.used++] = {time, name, phase};
+}
+
+
+void Tracer::write() {
+    std::FILE * file = std::fopen(mPath.c_str(), "w");
+    if (file == NULL) {
+        throw std::runtime_error("cannot create trace file " + mPath);
+    }
+    std::setvbuf(file, NULL, _IOFBF, 1 << 20);
+
+    std::lock_guard<std::mutex> lock(mThreadsMutex);
+    std::fprintf(file, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n"
+                 "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, "
+                 "\"tid\": 0, \"args\": {\"name\": \"CORSIKA\"}}");
+
+    for (const auto & buffer : mThreads) {
+        std::fprintf(file, ",\n{\"name\": \"thread_name\", \"ph\": \"M\", "
+                     "\"pid\": 1, \"tid\": %u, \"args\": {\"name\": \"",
+                     buffer->id);
+        writeEscaped(file, buffer->name.c_str());
+        std::fprintf(file, "\"}}");
+
+        for (std::size_t chunk = 0; chunk < buffer->chunks.size(); ++chunk) {
+            const std::size_t events = chunk + 1 < buffer->chunks.size()
+                                     ? CHUNK_EVENTS : buffer->used;
+            for (std::size_t i = 0; i < events; ++i) {
+                const Event & event = buffer->chunks[chunk][i];
+                std::fprintf(file, ",\n{\"name\": \"");
+                writeEscaped(file, event.name);
+                std::fprintf(file, "\", \"ph\": \"%c\", \"pid\": 1, "
+                             "\"tid\": %u, \"ts\": %llu.%03u}",
+                             event.phase, buffer->id,
+                             static_cast<unsigned long long>(
+                                 event.time / 1000),
+                             static_cast<unsigned int>(event.time % 1000));
+            }
+        }
+    }
+
+    std::fprintf(file, "\n]}\n");
+
+    const bool failed = std::ferror(file) != 0;
+    if (std::fclose(file) != 0 || failed) {
+        throw std::runtime_error("cannot write trace file " + mPath);
+    }
+}
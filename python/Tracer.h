@@ -0,0 +1,143 @@
+/** \file
+ * Timeline of interface activity in Chrome trace-event format.
+ */
+#ifndef __TRACER_H__
+#define __TRACER_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+
+/** Records begin and end events of the interface callbacks and of user
+ * spans per thread and writes them as Chrome/Perfetto trace JSON.
+ *
+ * Every thread appends to its own buffer of fixed size chunks without
+ * locks; only the first event of a thread registers its buffer. Callback
+ * events are sampled: sample() accepts every n-th call of a callback. The
+ * buffers are written by write(), which requires that no other thread
+ * records events anymore.
+ */
+class Tracer {
+
+    // interface types
+    public:
+        /** Number of events per buffer chunk. */
+        static constexpr std::size_t CHUNK_EVENTS = 4096;
+
+        /** Maximum number of sampled callbacks. */
+        static constexpr std::size_t MAX_CALLBACKS = 16;
+
+        /** Span that ends when it goes out of scope. */
+        class Span {
+            private:
+                Tracer & mTracer;
+
+            public:
+                Span(Tracer & tracer, const char * name)
+                    : mTracer(tracer)
+                {
+                    mTracer.begin(name);
+                }
+                Span(const Span &) = delete;
+                Span & operator=(const Span &) = delete;
+                ~Span() {
+                    mTracer.end();
+                }
+        };
+
+
+    // internal types
+    private:
+        struct Event {
+            std::uint64_t time;
+            const char * name;
+            char phase;
+        };
+
+        struct ThreadBuffer {
+            std::uint32_t id;
+            std::string name;
+            std::vector<std::unique_ptr<Event[]>> chunks;
+            std::size_t used = CHUNK_EVENTS;
+            std::unordered_set<std::string> names;
+        };
+
+
+    // members
+    private:
+        std::string mPath;
+        std::uint64_t mSampleEvery;
+        std::uint64_t mSampleCounters[MAX_CALLBACKS] = {};
+        std::uint64_t mId;
+        std::chrono::steady_clock::time_point mStart;
+        std::mutex mThreadsMutex;
+        std::vector<std::unique_ptr<ThreadBuffer>> mThreads;
+
+
+    // public functions
+    public:
+        /** Start the clock of the timeline.
+         *
+         * Throws a std::invalid_argument if sampleEvery is 0.
+         *
+         * @param path Output file of write().
+         * @param sampleEvery Record every n-th call of a callback.
+         */
+        Tracer(const std::string & path, std::uint64_t sampleEvery);
+        Tracer(const Tracer &) = delete;
+        Tracer & operator=(const Tracer &) = delete;
+
+        /** Get the output file. */
+        const std::string & getPath() const;
+
+        /** Get the sampling interval of callbacks. */
+        std::uint64_t getSampleEvery() const;
+
+        /** Decide if a call of a callback is recorded.
+         *
+         * Must only be called by the thread that handles the callback.
+         *
+         * @param callback Index of the callback, < MAX_CALLBACKS.
+         */
+        bool sample(std::size_t callback) {
+            if (++mSampleCounters[callback] < mSampleEvery) {
+                return false;
+            }
+            mSampleCounters[callback] = 0;
+            return true;
+        }
+
+        /** Begin a span with a name of static storage duration. */
+        void begin(const char * name);
+
+        /** Begin a span with a name that is copied once per thread. */
+        void begin(const std::string & name);
+
+        /** End the innermost span of the calling thread. */
+        void end();
+
+        /** Name the calling thread in the timeline. */
+        void setThreadName(const std::string & name);
+
+        /** Write all events into the output file.
+         *
+         * Throws a std::runtime_error if the file cannot be written.
+         */
+        void write();
+
+
+    // private functions
+    private:
+        ThreadBuffer & getThreadBuffer();
+        void append(const char * name, char phase);
+
+};
+
+
+#endif
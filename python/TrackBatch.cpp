@@ -0,0 +1,99 @@
+#include "TrackBatch.h"
+
+#include <cstddef>
+#include <vector>
+
+
+void TrackBatch::ParticleColumns::resize(std::size_t size) {
+    time.resize(size);
+    x.resize(size);
+    y.resize(size);
+    z.resize(size);
+    depth.resize(size);
+    energy.resize(size);
+    weight.resize(size);
+    particleId.resize(size);
+    hadronicGeneration.resize(size);
+}
+
+void TrackBatch::ParticleColumns::set(std::size_t index,
+                                      const crs::CParticle & particle) {
+    time[index] = particle.time;
+    x[index] = particle.x;
+    y[index] = particle.y;
+    z[index] = particle.z;
+    depth[index] = particle.depth;
+    energy[index] = particle.energy;
+    weight[index] = particle.weight;
+    particleId[index] = particle.particleId;
+    hadronicGeneration[index] = particle.hadronicGeneration;
+}
+
+
+void TrackBatch::setCapacity(std::size_t capacity) {
+    mPre.resize(capacity);
+    mPost.resize(capacity);
+    mDerived.resize(mDerivedCount * capacity);
+    mSize = 0;
+}
+
+std::size_t TrackBatch::getCapacity() const {
+    return mPre.time.size();
+}
+
+std::size_t TrackBatch::getSize() const {
+    return mSize;
+}
+
+bool TrackBatch::isEmpty() const {
+    return mSize == 0;
+}
+
+bool TrackBatch::isFull() const {
+    return mSize >= getCapacity();
+}
+
+
+void TrackBatch::push(const crs::CParticle & pre,
+                      const crs::CParticle & post) {
+    mPre.set(mSize, pre);
+    mPost.set(mSize, post);
+    ++mSize;
+}
+
+void TrackBatch::push(const crs::CParticle & pre,
+                      const crs::CParticle & post, const double * derived) {
+    const std::size_t capacity = getCapacity();
+    for (std::size_t k = 0; k < mDerivedCount; ++k) {
+        mDerived[k * capacity + mSize] = derived[k];
+    }
+    push(pre, post);
+}
+
+void TrackBatch::clear() {
+    mSize = 0;
+}
+
+
+void TrackBatch::setDerivedCount(std::size_t count) {
+    mDerivedCount = count;
+    mDerived.resize(mDerivedCount * getCapacity());
+    mSize = 0;
+}
+
+std::size_t TrackBatch::getDerivedCount() const {
+    return mDerivedCount;
+}
+
+const double * TrackBatch::getDerived(std::size_t column) const {
+    return mDerived.data() + column * getCapacity();
+}
+
+
+const TrackBatch::ParticleColumns & TrackBatch::getPre() const {
+    return mPre;
+}
+
+const TrackBatch::ParticleColumns & TrackBatch::getPost() const {
+    return mPost;
+}
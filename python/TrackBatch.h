@@ -0,0 +1,118 @@
+/** \file
+ * Column buffers that collect COAST track_(...) calls for batched delivery.
+ */
+#ifndef __TRACKBATCH_H__
+#define __TRACKBATCH_H__
+
+#include <cstddef>
+#include <vector>
+
+#include <crs/CParticle.h>
+
+
+/** Preallocated structure-of-arrays storage for particle track segments.
+ *
+ * Every member of crs::CParticle is stored in its own column, separately for
+ * the pre and post particle of a track. Column memory is only allocated in
+ * setCapacity(...) such that pointers to the column data stay valid until the
+ * capacity changes.
+ */
+class TrackBatch {
+
+    // interface types
+    public:
+        /** One column per crs::CParticle member. */
+        struct ParticleColumns {
+            std::vector<double> time;
+            std::vector<double> x;
+            std::vector<double> y;
+            std::vector<double> z;
+            std::vector<double> depth;
+            std::vector<double> energy;
+            std::vector<double> weight;
+            std::vector<int> particleId;
+            std::vector<int> hadronicGeneration;
+
+            /** Resize all columns to the given number of entries. */
+            void resize(std::size_t size);
+
+            /** Store a particle at the given row. */
+            void set(std::size_t index, const crs::CParticle & particle);
+        };
+
+
+    // members
+    private:
+        std::size_t mSize = 0;
+        std::size_t mDerivedCount = 0;
+        std::vector<double> mDerived;
+        ParticleColumns mPre;
+        ParticleColumns mPost;
+
+
+    // public functions
+    public:
+        /** Set the number of tracks that fit into the batch.
+         *
+         * Discards all stored tracks.
+         */
+        void setCapacity(std::size_t capacity);
+
+        /** Get the number of tracks that fit into the batch. */
+        std::size_t getCapacity() const;
+
+        /** Get the number of currently stored tracks. */
+        std::size_t getSize() const;
+
+        /** Indicate if no track is stored. */
+        bool isEmpty() const;
+
+        /** Indicate if no further track fits into the batch. */
+        bool isFull() const;
+
+        /** Append a track.
+         *
+         * The caller has to make sure that the batch is not full.
+         *
+         * @param pre Particle information at the beginning of the track.
+         * @param post Particle information at the end of the track.
+         */
+        void push(const crs::CParticle & pre, const crs::CParticle & post);
+
+        /** Append a track together with its derived values.
+         *
+         * The caller has to make sure that the batch is not full.
+         *
+         * @param pre Particle information at the beginning of the track.
+         * @param post Particle information at the end of the track.
+         * @param derived getDerivedCount() values of derived columns.
+         */
+        void push(const crs::CParticle & pre, const crs::CParticle & post,
+                  const double * derived);
+
+        /** Discard all stored tracks but keep the allocated memory. */
+        void clear();
+
+        /** Set the number of derived columns that are stored in addition to
+         * the COAST information.
+         *
+         * Discards all stored tracks.
+         */
+        void setDerivedCount(std::size_t count);
+
+        /** Get the number of derived columns. */
+        std::size_t getDerivedCount() const;
+
+        /** Get the values of a derived column. */
+        const double * getDerived(std::size_t column) const;
+
+        /** Get the columns of the pre-track particles. */
+        const ParticleColumns & getPre() const;
+
+        /** Get the columns of the post-track particles. */
+        const ParticleColumns & getPost() const;
+
+};
+
+
+#endif
@@ -0,0 +1,457 @@
+#include "VoxelGrid.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace {
+
+constexpr double INFINITE = std::numeric_limits<double>::infinity();
+
+}
+
+
+VoxelGrid::VoxelGrid(Geometry geometry, const std::array<Axis, 3> & axes,
+                     const std::vector<int> & species,
+                     const std::array<double, 3> & core)
+    : mGeometry(geometry),
+      mAxes(axes),
+      mSpecies(species),
+      mSpeciesColumns(MAX_PARTICLE_ID, -1),
+      mStride(ENTRIES + species.size()),
+      mCore(core),
+      mFollowShower(true)
+{
+    for (std::size_t i = 0; i < 3; ++i) {
+        const Axis & axis = mAxes[i];
+        if (axis.bins == 0 || !(axis.upper > axis.lower)) {
+            throw std::invalid_argument("voxel axes need bins > 0 and "
+                                        "upper > lower");
+        }
+
+        mWidths[i] = (axis.upper - axis.lower) / axis.bins;
+        mBricks[i] = ((axis.bins - 1) >> BRICK_BITS) + 1;
+        for (std::size_t j = 0; j <= axis.bins; ++j) {
+            mEdges[i].push_back(axis.lower + j * mWidths[i]);
+        }
+    }
+
+    if (static_cast<double>(mBricks[0]) * mBricks[1] * mBricks[2] >
+        static_cast<double>(std::uint64_t(1) << 52)) {
+        throw std::invalid_argument("too many voxels");
+    }
+
+    if (geometry == Geometry::CYLINDRICAL && mAxes[0].lower < 0) {
+        throw std::invalid_argument("radii have to be >= 0");
+    }
+
+    if (geometry == Geometry::CYLINDRICAL &&
+        mAxes[1].upper - mAxes[1].lower > 2 * M_PI) {
+        throw std::invalid_argument("azimuth axes can span at most 2 pi");
+    }
+
+    for (std::size_t i = 0; i < species.size(); ++i) {
+        if (species[i] < 1 || species[i] >= MAX_PARTICLE_ID) {
+            throw std::invalid_argument("particle IDs have to be in [1, " +
+                                        std::to_string(MAX_PARTICLE_ID) +
+                                        ")");
+        }
+        mSpeciesColumns[species[i]] = i;
+    }
+
+    // vertical until the first shower
+    setDirection(0, 0);
+    mFollowShower = true;
+}
+
+
+void VoxelGrid::setDirection(double zenith, double azimuth) {
+    const double sinZenith = std::sin(zenith);
+    const double cosZenith = std::cos(zenith);
+    const double sinAzimuth = std::sin(azimuth);
+    const double cosAzimuth = std::cos(azimuth);
+
+    // w points upwards against the primary momentum, u and v span the
+    // shower plane with u in the plane of the axis and the vertical
+    mW = {-sinZenith * cosAzimuth, -sinZenith * sinAzimuth, cosZenith};
+    mU = {cosZenith * cosAzimuth, cosZenith * sinAzimuth, sinZenith};
+    mV = {-sinAzimuth, cosAzimuth, 0};
+    mFollowShower = false;
+}
+
+
+void VoxelGrid::beginShower(double zenith, double azimuth) {
+    if (mFollowShower) {
+        setDirection(zenith, azimuth);
+        mFollowShower = true;
+    }
+}
+
+
+void VoxelGrid::deposit(const crs::CParticle & pre,
+                        const crs::CParticle & post) {
+    const double start[3] = {pre.x, pre.y, pre.z};
+    const double delta[3] = {post.x - pre.x, post.y - pre.y, post.z - pre.z};
+
+    mLength = std::sqrt(delta[0] * delta[0] + delta[1] * delta[1] +
+                        delta[2] * delta[2]);
+    mEnergyLoss = pre.energy - post.energy;
+    mWeight = pre.weight;
+    mSpeciesColumn = pre.particleId >= 0 && pre.particleId < MAX_PARTICLE_ID
+                   ? mSpeciesColumns[pre.particleId] : -1;
+    mPreviousVoxel = ~std::uint64_t(0);
+    ++mSegments;
+
+    if (mGeometry == Geometry::CARTESIAN) {
+        traverseCartesian(start, delta);
+    }
+    else {
+        traverseCylindrical(start, delta);
+    }
+}
+
+
+void VoxelGrid::traverseCartesian(const double * start,
+                                  const double * delta) {
+    // clip the segment to the grid
+    double enter = 0.0;
+    double exit = 1.0;
+    for (std::size_t i = 0; i < 3; ++i) {
+        const Axis & axis = mAxes[i];
+        if (delta[i] == 0) {
+            if (start[i] < axis.lower || start[i] >= axis.upper) {
+                return;
+            }
+            continue;
+        }
+
+        double t0 = (axis.lower - start[i]) / delta[i];
+        double t1 = (axis.upper - start[i]) / delta[i];
+        if (t0 > t1) {
+            std::swap(t0, t1);
+        }
+        enter = std::max(enter, t0);
+        exit = std::min(exit, t1);
+    }
+    if (enter > exit || (enter == exit && mLength > 0)) {
+        return;
+    }
+
+    std::size_t index[3];
+    int step[3];
+    double next[3];
+    double advance[3];
+    for (std::size_t i = 0; i < 3; ++i) {
+        const Axis & axis = mAxes[i];
+        const double position =
+            (start[i] + enter * delta[i] - axis.lower) / mWidths[i];
+        double bin = std::floor(position);
+        // a segment that starts on an edge enters the lower bin
+        if (delta[i] < 0 && bin == position) {
+            bin -= 1;
+        }
+        bin = std::min(std::max(bin, 0.0), double(axis.bins - 1));
+        index[i] = static_cast<std::size_t>(bin);
+
+        step[i] = delta[i] > 0 ? 1 : -1;
+        if (delta[i] != 0) {
+            const double edge = mEdges[i][index[i] + (delta[i] > 0)];
+            next[i] = (edge - start[i]) / delta[i];
+            advance[i] = mWidths[i] / std::fabs(delta[i]);
+        }
+        else {
+            next[i] = INFINITE;
+            advance[i] = INFINITE;
+        }
+    }
+
+    double t = enter;
+    while (true) {
+        std::size_t i = next[0] < next[1] ? 0 : 1;
+        i = next[2] < next[i] ? 2 : i;
+
+        const double end = std::min(next[i], exit);
+        if (end > t || mLength == 0) {
+            add(index, end - t);
+        }
+        t = end;
+        if (t >= exit) {
+            break;
+        }
+
+        if ((step[i] < 0 && index[i] == 0) ||
+            (step[i] > 0 && index[i] + 1 == mAxes[i].bins)) {
+            break;
+        }
+        index[i] += step[i];
+        next[i] += advance[i];
+    }
+}
+
+
+void VoxelGrid::traverseCylindrical(const double * start,
+                                    const double * delta) {
+    // local coordinates u, v in the shower plane and w along the axis
+    const double relative[3] = {start[0] - mCore[0], start[1] - mCore[1],
+                                start[2] - mCore[2]};
+    const double local[3] = {
+        relative[0] * mU[0] + relative[1] * mU[1] + relative[2] * mU[2],
+        relative[0] * mV[0] + relative[1] * mV[1] + relative[2] * mV[2],
+        relative[0] * mW[0] + relative[1] * mW[1] + relative[2] * mW[2]
+    };
+    const double localDelta[3] = {
+        delta[0] * mU[0] + delta[1] * mU[1] + delta[2] * mU[2],
+        delta[0] * mV[0] + delta[1] * mV[1] + delta[2] * mV[2],
+        delta[0] * mW[0] + delta[1] * mW[1] + delta[2] * mW[2]
+    };
+
+    mCrossings.clear();
+
+    // cylinders: r^2(t) = a t^2 + b t + c
+    const double a = localDelta[0] * localDelta[0] +
+                     localDelta[1] * localDelta[1];
+    const double b = 2 * (local[0] * localDelta[0] +
+                          local[1] * localDelta[1]);
+    const double c = local[0] * local[0] + local[1] * local[1];
+    if (a > 0) {
+        const double closest = std::min(std::max(-b / (2 * a), 0.0), 1.0);
+        const double lower =
+            std::sqrt(std::max(0.0, (a * closest + b) * closest + c));
+        const double upper = std::sqrt(std::max(c, a + b + c));
+        for (const double radius : mEdges[0]) {
+            if (radius < lower || radius > upper) {
+                continue;
+            }
+            const double discriminant = b * b - 4 * a * (c - radius * radius);
+            if (discriminant < 0) {
+                continue;
+            }
+            const double root = std::sqrt(discriminant);
+            mCrossings.push_back((-b - root) / (2 * a));
+            mCrossings.push_back((-b + root) / (2 * a));
+        }
+    }
+
+    // half-planes of constant azimuth
+    for (const double azimuth : mEdges[1]) {
+        const double cosAzimuth = std::cos(azimuth);
+        const double sinAzimuth = std::sin(azimuth);
+        const double denominator = -sinAzimuth * localDelta[0] +
+                                   cosAzimuth * localDelta[1];
+        if (denominator == 0) {
+            continue;
+        }
+        const double t = (sinAzimuth * local[0] - cosAzimuth * local[1]) /
+                         denominator;
+        if (cosAzimuth * (local[0] + t * localDelta[0]) +
+            sinAzimuth * (local[1] + t * localDelta[1]) > 0) {
+            mCrossings.push_back(t);
+        }
+    }
+
+    // planes along the axis
+    addCrossings(local[2], localDelta[2], mAxes[2], mWidths[2]);
+
+    mCrossings.erase(std::remove_if(mCrossings.begin(), mCrossings.end(),
+                                    [](double t) {
+                                        return !(t > 0.0 && t < 1.0);
+                                    }),
+                     mCrossings.end());
+    std::sort(mCrossings.begin(), mCrossings.end());
+    mCrossings.push_back(1.0);
+
+    // every interval between crossings lies in one voxel
+    double t = 0.0;
+    std::size_t index[3];
+    for (const double end : mCrossings) {
+        if (end > t || mLength == 0) {
+            if (getCylindricalIndex(local, localDelta, 0.5 * (t + end),
+                                    index)) {
+                add(index, end - t);
+            }
+        }
+        t = end;
+    }
+}
+
+
+void VoxelGrid::addCrossings(double start, double delta, const Axis & axis,
+                             double width) {
+    if (delta == 0) {
+        return;
+    }
+
+    const double end = start + delta;
+    const double lower = std::max(std::min(start, end), axis.lower);
+    const double upper = std::min(std::max(start, end), axis.upper);
+    if (lower > upper) {
+        return;
+    }
+
+    const std::size_t first =
+        static_cast<std::size_t>(std::ceil((lower - axis.lower) / width));
+    const std::size_t last = std::min(
+        static_cast<std::size_t>(std::floor((upper - axis.lower) / width)),
+        axis.bins);
+    for (std::size_t j = first; j <= last; ++j) {
+        mCrossings.push_back((axis.lower + j * width - start) / delta);
+    }
+}
+
+
+bool VoxelGrid::getCylindricalIndex(const double * start,
+                                    const double * delta, double t,
+                                    std::size_t * index) const {
+    const double u = start[0] + t * delta[0];
+    const double v = start[1] + t * delta[1];
+    // atan2 is in [-pi, pi], wrap it into [lower, lower + 2 pi)
+    double azimuth = std::atan2(v, u) - mAxes[1].lower;
+    azimuth -= 2 * M_PI * std::floor(azimuth / (2 * M_PI));
+    const double coordinates[3] = {std::sqrt(u * u + v * v),
+                                   mAxes[1].lower + azimuth,
+                                   start[2] + t * delta[2]};
+
+    for (std::size_t i = 0; i < 3; ++i) {
+        const double bin = (coordinates[i] - mAxes[i].lower) / mWidths[i];
+        if (!(bin >= 0 && bin < mAxes[i].bins)) {
+            return false;
+        }
+        index[i] = static_cast<std::size_t>(bin);
+    }
+    return true;
+}
+
+
+void VoxelGrid::add(const std::size_t * index, double fraction) {
+    const std::uint64_t key =
+        ((index[0] >> BRICK_BITS) * mBricks[1] +
+         (index[1] >> BRICK_BITS)) * mBricks[2] + (index[2] >> BRICK_BITS);
+    const std::size_t mask = (std::size_t(1) << BRICK_BITS) - 1;
+    const std::size_t offset =
+        ((((index[0] & mask) << BRICK_BITS) | (index[1] & mask))
+         << BRICK_BITS) | (index[2] & mask);
+
+    double * voxel = getBrick(key) + offset * mStride;
+    voxel[PATH_LENGTH] += fraction * mLength * mWeight;
+    voxel[ENERGY_DEPOSIT] += fraction * mEnergyLoss * mWeight;
+
+    // a particle is counted once per voxel it passes
+    const std::uint64_t linear = key * BRICK_VOXELS + offset;
+    if (linear != mPreviousVoxel) {
+        voxel[COUNT] += mWeight;
+        if (mSpeciesColumn >= 0) {
+            voxel[ENTRIES + mSpeciesColumn] += mWeight;
+        }
+        mPreviousVoxel = linear;
+    }
+}
+
+
+double * VoxelGrid::getBrick(std::uint64_t key) {
+    // consecutive voxels of a segment mostly share a brick
+    if (key == mLastKey) {
+        return mLastBrick;
+    }
+
+    std::unique_ptr<double[]> & brick = mStore[key];
+    if (!brick) {
+        brick.reset(new double[BRICK_VOXELS * mStride]());
+    }
+
+    mLastKey = key;
+    mLastBrick = brick.get();
+    return mLastBrick;
+}
+
+
+const VoxelGrid::Contents & VoxelGrid::collect() {
+    Contents & c = mContents;
+    for (std::size_t i = 0; i < 3; ++i) {
+        c.index[i].clear();
+    }
+    c.pathLength.clear();
+    c.energyDeposit.clear();
+    c.count.clear();
+    c.speciesCount.clear();
+
+    // voxels in C order of the bins
+    struct Voxel {
+        std::size_t index[3];
+        const double * values;
+    };
+    std::vector<Voxel> voxels;
+    const std::size_t mask = (std::size_t(1) << BRICK_BITS) - 1;
+    for (const auto & entry : mStore) {
+        const std::uint64_t key = entry.first;
+        const double * brick = entry.second.get();
+        const std::size_t base[3] = {
+            static_cast<std::size_t>(key / (mBricks[1] * mBricks[2]))
+                << BRICK_BITS,
+            static_cast<std::size_t>(key / mBricks[2] % mBricks[1])
+                << BRICK_BITS,
+            static_cast<std::size_t>(key % mBricks[2]) << BRICK_BITS
+        };
+
+        for (std::size_t offset = 0; offset < BRICK_VOXELS; ++offset) {
+            const double * values = brick + offset * mStride;
+            if (values[COUNT] == 0 && values[PATH_LENGTH] == 0 &&
+                values[ENERGY_DEPOSIT] == 0) {
+                continue;
+            }
+            voxels.push_back({{
+                base[0] + (offset >> (2 * BRICK_BITS)),
+                base[1] + ((offset >> BRICK_BITS) & mask),
+                base[2] + (offset & mask)
+            }, values});
+        }
+    }
+    std::sort(voxels.begin(), voxels.end(),
+              [](const Voxel & x, const Voxel & y) {
+                  return std::lexicographical_compare(
+                          x.index, x.index + 3, y.index, y.index + 3);
+              });
+
+    for (const Voxel & voxel : voxels) {
+        for (std::size_t i = 0; i < 3; ++i) {
+            c.index[i].push_back(static_cast<int>(voxel.index[i]));
+        }
+        c.pathLength.push_back(voxel.values[PATH_LENGTH]);
+        c.energyDeposit.push_back(voxel.values[ENERGY_DEPOSIT]);
+        c.count.push_back(voxel.values[COUNT]);
+        c.speciesCount.insert(c.speciesCount.end(),
+                              voxel.values + ENTRIES,
+                              voxel.values + mStride);
+    }
+
+    return c;
+}
+
+
+const std::vector<double> & VoxelGrid::getEdges(std::size_t axis) const {
+    return mEdges.at(axis);
+}
+
+const std::vector<int> & VoxelGrid::getSpecies() const {
+    return mSpecies;
+}
+
+std::uint64_t VoxelGrid::getSegments() const {
+    return mSegments;
+}
+
+
+void VoxelGrid::reset() {
+    mStore.clear();
+    mLastKey = ~std::uint64_t(0);
+    mLastBrick = NULL;
+    mSegments = 0;
+}
@@ -0,0 +1,175 @@
+/** \file
+ * Energy deposit of track segments in a sparse three-dimensional grid.
+ */
+#ifndef __VOXELGRID_H__
+#define __VOXELGRID_H__
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <crs/CParticle.h>
+
+#include "ParticleId.h"
+
+
+/** Grid of voxels that accumulates, for every track segment, the path
+ * length, the energy loss and the number of particles per voxel.
+ *
+ * Segments are traversed exactly: a CARTESIAN grid in x, y, z is walked
+ * voxel by voxel along the segment (3D-DDA), a CYLINDRICAL grid in radius,
+ * azimuth and height along the shower axis is split at the crossings with
+ * its cylinders, half-planes and planes. The energy loss pre.energy -
+ * post.energy is shared in proportion to the path length in every voxel,
+ * all quantities are multiplied by pre.weight. Counts are kept in total
+ * and for a list of species.
+ *
+ * Voxels are stored in bricks of 4 x 4 x 4 that are allocated when a
+ * segment first touches them, such that memory grows with the touched
+ * volume only.
+ */
+class VoxelGrid {
+
+    // interface types
+    public:
+        /** Coordinates of the grid. */
+        enum class Geometry {
+            CARTESIAN,   /**< x, y, z */
+            CYLINDRICAL  /**< radius, azimuth [rad], height along the axis */
+        };
+
+        /** Equal width bins of an axis. */
+        struct Axis {
+            double lower = 0.0;
+            double upper = 1.0;
+            std::size_t bins = 1;
+        };
+
+        /** Touched voxels in order of their linear index. */
+        struct Contents {
+            std::vector<int> index[3];           /**< Bin per axis. */
+            std::vector<double> pathLength;
+            std::vector<double> energyDeposit;
+            std::vector<double> count;
+            std::vector<double> speciesCount;  /**< Row-major, voxel x
+                                                    species. */
+        };
+
+
+    // internal types
+    private:
+        static constexpr unsigned BRICK_BITS = 2;
+        static constexpr std::size_t BRICK_VOXELS =
+            std::size_t(1) << (3 * BRICK_BITS);
+
+        // first entries of every voxel, followed by the species counts
+        enum Entry : std::size_t {
+            PATH_LENGTH = 0,
+            ENERGY_DEPOSIT,
+            COUNT,
+            ENTRIES
+        };
+
+
+    // members
+    private:
+        Geometry mGeometry;
+        std::array<Axis, 3> mAxes;
+        std::array<double, 3> mWidths;
+        std::array<std::uint64_t, 3> mBricks;
+        std::array<std::vector<double>, 3> mEdges;
+        std::vector<int> mSpecies;
+        std::vector<int> mSpeciesColumns;
+        std::size_t mStride;
+
+        std::array<double, 3> mCore;
+        bool mFollowShower;
+        std::array<double, 3> mU;
+        std::array<double, 3> mV;
+        std::array<double, 3> mW;
+
+        std::unordered_map<std::uint64_t, std::unique_ptr<double[]>>
+            mStore;
+        std::uint64_t mLastKey = ~std::uint64_t(0);
+        double * mLastBrick = NULL;
+        std::uint64_t mSegments = 0;
+
+        // per segment
+        double mLength = 0.0;
+        double mEnergyLoss = 0.0;
+        double mWeight = 0.0;
+        int mSpeciesColumn = -1;
+        std::uint64_t mPreviousVoxel = ~std::uint64_t(0);
+        std::vector<double> mCrossings;
+
+        Contents mContents;
+
+
+    // public functions
+    public:
+        /** Define the grid.
+         *
+         * Throws a std::invalid_argument for empty axes, negative radii,
+         * azimuth axes wider than 2 pi or invalid particle IDs. Azimuths
+         * are wrapped into [lower, lower + 2 pi).
+         *
+         * @param geometry Coordinates of the axes.
+         * @param axes Bins of the three axes.
+         * @param species Particle IDs that are counted separately.
+         * @param core Origin of the shower axis (CYLINDRICAL only).
+         */
+        VoxelGrid(Geometry geometry, const std::array<Axis, 3> & axes,
+                  const std::vector<int> & species,
+                  const std::array<double, 3> & core);
+
+        /** Fix the direction of the shower axis (CYLINDRICAL only).
+         *
+         * Without a fixed direction the axis follows the primary of every
+         * shower (see beginShower()).
+         *
+         * @param zenith, azimuth Direction of the primary momentum in the
+         * CORSIKA convention in rad.
+         */
+        void setDirection(double zenith, double azimuth);
+
+        /** Update the shower axis to the primary of a new shower unless the
+         * direction is fixed. */
+        void beginShower(double zenith, double azimuth);
+
+        /** Add a track segment. */
+        void deposit(const crs::CParticle & pre, const crs::CParticle & post);
+
+        /** Collect the touched voxels; valid until the next call. */
+        const Contents & collect();
+
+        /** Get the bin edges of an axis. */
+        const std::vector<double> & getEdges(std::size_t axis) const;
+
+        /** Get the particle IDs that are counted separately. */
+        const std::vector<int> & getSpecies() const;
+
+        /** Get the number of added segments. */
+        std::uint64_t getSegments() const;
+
+        /** Remove all deposits and release the memory. */
+        void reset();
+
+
+    // private functions
+    private:
+        void traverseCartesian(const double * start, const double * delta);
+        void traverseCylindrical(const double * start, const double * delta);
+        void addCrossings(double start, double delta, const Axis & axis,
+                          double width);
+        bool getCylindricalIndex(const double * start, const double * delta,
+                                 double t, std::size_t * index) const;
+        void add(const std::size_t * index, double fraction);
+        double * getBrick(std::uint64_t key);
+
+};
+
+
+#endif
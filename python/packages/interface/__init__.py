@@ -1,14 +1,44 @@
 """Interface module for handling, reading and writing CORSIKA information
 based on the COAST interface.
+
+Every COAST call reaches the native sinks (plugins, column and block
+writers, histograms, voxel grids, surfaces, observer arrays and Arrow
+collectors) before capture flags, sampling and filters select what the
+python override receives.
 """
 
 from .cppaccess import CppAccess
 from .cppwrapper import disableWrite, enableWrite, \
                         disableInteraction, enableInteraction, \
-                        disableTrack, enableTrack
-from .virtual_override import Override
+                        disableTrack, enableTrack, \
+                        setTrackFilter, addTrackColumn, clearTrackFilter, \
+                        setInteractionFilter, addInteractionColumn, \
+                        clearInteractionFilter, \
+                        setTrackSampling, clearTrackSampling, \
+                        setInteractionSampling, clearInteractionSampling, \
+                        setSamplingSeed, setAsyncMode, getAsyncDropped, \
+                        setColumnWriter, getColumnWriterPath, \
+                        setBlockWriter, getBlockWriterPath, \
+                        addHistogram, getHistogram, resetHistogram, \
+                        stats, setStatsFile, \
+                        setTrace, traceBegin, traceEnd, \
+                        setBatchSize, getBatchSize, \
+                        setWriteBlockCount, getWriteBlockCount, \
+                        setParticleFilter, addPlane, addSphere, \
+                        clearSurfaces, loadPlugin
+from .virtual_override import Override, BatchOverride
 from .interaction import Interaction
 from .particle import Particle
+from .batch import ParticleBatch, InteractionBatch, ObservedParticles
+from .shower import ShowerHeader, ShowerTrailer
+from .columns import ColumnReader, ColumnChunk
+from .blocks import BlockReader, CompressedBlock
+from .histogram import Histogram, HistogramData
+from .voxels import VoxelGrid, VoxelContents
+from .surfaces import SurfaceCrossings, addShowerPlane
+from .observers import ObserverArray, ObserverTraces
+from .arrow import ArrowCollector, ArrowRecords
+from .trace import traceSpan
 
 instance = CppAccess()
 patch = instance.patch
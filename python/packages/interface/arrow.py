@@ -0,0 +1,88 @@
+"""Records collected natively into Arrow columns.
+
+An ArrowCollector appends every track, interaction or decoded ground particle
+to Arrow-layout columns in C++. take() hands the collected records over as
+ArrowRecords, which implement the Arrow PyCapsule interface, such that pyarrow,
+polars and other Arrow libraries use the C++ columns without a copy, e.g.
+
+>>> muons = ArrowCollector("particle", species=[5, 6])
+>>> # in shower_end()
+>>> batch = pyarrow.record_batch(muons.take())
+>>> frame = polars.from_arrow(batch)
+
+Without any python call per record, disableWrite(), disableTrack() or
+disableInteraction() can be combined with a collector.
+"""
+from . import cppwrapper
+
+
+class ArrowCollector:
+    """Collector of records that is filled natively during the simulation.
+
+    The columns have the names of the ColumnWriter for tracks
+    (pre.time, pre.x, ..., post.hadronicGeneration) and interactions (x, y,
+    z, labEnergy, crossSection, elasticity, projectileID, targetID) and of
+    write_particles() for particles (particleID, hadronicGeneration,
+    observationLevel, px, py, pz, x, y, time, weight; 32 bit floats as in
+    the CORSIKA subblocks).
+    """
+
+    def __init__(self, source, species=None, levels=None):
+        """Add the collector to the interface.
+
+        Parameters
+        ----------
+        source : str
+            "track", "interaction" or "particle" (the particle lines of
+            write()).
+        species : sequence of int, optional
+            Collected particle IDs (particles only); all by default.
+        levels : sequence of int, optional
+            Collected observation levels (particles only); all by default.
+        """
+        self.source = source
+        self.id = cppwrapper.addArrowCollector(source, species, levels)
+
+    def take(self):
+        """Hand over the records collected since the last call.
+
+        Returns
+        -------
+        ArrowRecords
+            Records that stay valid as long as they are referenced.
+        """
+        return ArrowRecords(*cppwrapper.takeArrowRecords(self.id))
+
+
+class ArrowRecords:
+    """Collected records as Arrow struct array without nulls.
+
+    Every call of __arrow_c_array__ exports new ArrowSchema and ArrowArray
+    structures whose data buffers point to the C++ columns; they keep the
+    columns alive until the consumer releases them.
+    """
+
+    def __init__(self, handle, size):
+        """Wrap a handle of cppwrapper.takeArrowRecords()."""
+        self._handle = handle
+        self._size = size
+
+    def __len__(self):
+        """Number of records."""
+        return self._size
+
+    def __arrow_c_array__(self, requested_schema=None):
+        """Export the records via the Arrow PyCapsule interface.
+
+        Parameters
+        ----------
+        requested_schema : PyCapsule, optional
+            Ignored, the records are always exported with their own
+            schema.
+
+        Returns
+        -------
+        tuple
+            arrow_schema and arrow_array capsules.
+        """
+        return cppwrapper.exportArrowRecords(self._handle)
@@ -0,0 +1,179 @@
+"""Column containers for batched track and interaction information.
+
+Columns are read-only views on C++ buffers of the interface. When numpy is
+available they are converted to numpy arrays without copying the data. In
+both cases the data is only valid during the call to track_batch(),
+interaction_batch() or write_particles(). The views are released after the
+call, so copy the columns if you need them afterwards.
+"""
+try:
+    import numpy
+except ModuleNotFoundError:
+    numpy = None
+
+
+def _column(values):
+    """Wrap a column as numpy array if numpy is available."""
+    if numpy is None:
+        return values
+    return numpy.asarray(values)
+
+
+def _columns(mapping):
+    """Wrap all columns of a dict as numpy arrays if numpy is available."""
+    return {name: _column(values) for name, values in mapping.items()}
+
+
+class ParticleBatch:
+    """Columns of CParticle information from COAST.
+
+    Attribute names follow the Particle class. Every attribute is a
+    one-dimensional column (numpy.ndarray or memoryview) with one entry per
+    track.
+
+    Attributes
+    ----------
+    time : column of float
+        Time of the CORSIKA particle event in seconds.
+    x, y, z : column of float
+        Particle position in meters.
+    atmosphericDepth : column of float
+        Travel depth in g/cm^2 for the particle.
+    energy : column of float
+        Current total energy of the particle.
+    weight : column of float
+        Thinning weight of the particle.
+    particleID : column of int
+        Particle type as integer ID in CORSIKA convention.
+    hadronicGeneration : column of int
+        Hadronic generation counter of the particle description.
+    """
+
+    def __init__(self, t, x, y, z, depth, energy, weight, ID, hadgen):
+        """Construct particle columns.
+
+        Parameters
+        ----------
+        See Particle. Every parameter is a column instead of a value.
+        """
+
+        self.time = _column(t)
+        self.x = _column(x)
+        self.y = _column(y)
+        self.z = _column(z)
+        self.atmosphericDepth = _column(depth)
+        self.energy = _column(energy)
+        self.weight = _column(weight)
+        self.particleID = _column(ID)
+        self.hadronicGeneration = _column(hadgen)
+
+    def __len__(self):
+        """Number of particles in the batch."""
+        return len(self.time)
+
+    @property
+    def position(self):
+        """x, y, z columns of the particle positions in meters."""
+        return (self.x, self.y, self.z)
+
+
+class InteractionBatch:
+    """Columns of CInteraction information from COAST.
+
+    Attribute names follow the Interaction class. Every attribute is a
+    one-dimensional column (numpy.ndarray or memoryview) with one entry per
+    interaction.
+
+    Attributes
+    ----------
+    x, y, z : column of float
+        Interaction position in meters.
+    labEnergy : column of float
+        Total energy in the laboritory frame.
+    crossSection : column of float
+        Cross section of the particle interaction.
+    elasticity : column of float
+        Elasticity of the interaction.
+    projectileID : column of int
+        Numeric CORSIKA ID of the incident particle.
+    targetID : column of int
+        Numeric CORSIKA ID of the target particle.
+    """
+
+    def __init__(self, x, y, z, etot, sigma, kela, pID, tID):
+        """Construct interaction columns.
+
+        Parameters
+        ----------
+        See Interaction. Every parameter is a column instead of a value.
+        """
+
+        self.x = _column(x)
+        self.y = _column(y)
+        self.z = _column(z)
+        self.labEnergy = _column(etot)
+        self.crossSection = _column(sigma)
+        self.elasticity = _column(kela)
+        self.projectileID = _column(pID)
+        self.targetID = _column(tID)
+
+    def __len__(self):
+        """Number of interactions in the batch."""
+        return len(self.x)
+
+    @property
+    def position(self):
+        """x, y, z columns of the interaction positions in meters."""
+        return (self.x, self.y, self.z)
+
+
+class ObservedParticles:
+    """Columns of particles at the observation levels from COAST wrida_().
+
+    Decoded from the CORSIKA particle subblocks in C++. Empty lines, lines
+    without a particle (EHISTORY mother and grandmother lines, muon
+    additional information) and header and trailer subblocks are dropped.
+    Every attribute is a one-dimensional column (numpy.ndarray or
+    memoryview) with one entry per particle.
+
+    Attributes
+    ----------
+    particleID : column of int
+        Particle type as integer ID in CORSIKA convention.
+    hadronicGeneration : column of int
+        Hadronic generation of the particle description.
+    observationLevel : column of int
+        Observation level of the particle description.
+    px, py, pz : column of float
+        Momentum in GeV/c.
+    x, y : column of float
+        Position at the observation level in cm.
+    time : column of float
+        Time since the first interaction or since entering the atmosphere
+        in ns.
+    weight : column of float
+        Thinning weight of the particle, 1 without thinning.
+    """
+
+    def __init__(self, ID, hadgen, level, px, py, pz, x, y, t, weight):
+        """Construct particle columns."""
+
+        self.particleID = _column(ID)
+        self.hadronicGeneration = _column(hadgen)
+        self.observationLevel = _column(level)
+        self.px = _column(px)
+        self.py = _column(py)
+        self.pz = _column(pz)
+        self.x = _column(x)
+        self.y = _column(y)
+        self.time = _column(t)
+        self.weight = _column(weight)
+
+    def __len__(self):
+        """Number of particles."""
+        return len(self.particleID)
+
+    @property
+    def momentum(self):
+        """px, py, pz columns of the particle momenta in GeV/c."""
+        return (self.px, self.py, self.pz)
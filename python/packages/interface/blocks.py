@@ -0,0 +1,210 @@
+"""Reader for compressed subblock files of the native block writer.
+
+Files are written by interface.setBlockWriter() or by setting the environment
+variable CORSIKA_PYTHON_BLOCKS. They contain the CORSIKA particle output,
+i.e. the subblocks of 39 particle lines, zlib compressed in blocks of
+consecutive subblocks of the same shower and subblock type, and an index that
+allows to decompress only the blocks of selected showers and types. The file
+is memory-mapped, such that only the selected blocks are read from disk.
+"""
+import array
+import mmap
+import struct
+import zlib
+
+try:
+    import numpy
+except ModuleNotFoundError:
+    numpy = None
+
+
+_FILE_MAGIC = b"COASTBLK"
+_INDEX_MAGIC = b"COASTIDX"
+_HEADER = struct.Struct("=8sII")
+_TRAILER = struct.Struct("=Q8s")
+_BLOCK = struct.Struct("=QIIQQQ")
+_LINES = 39
+
+# subblock types in the order of ShowerBoundary::BlockType
+TYPES = ("particle", "run_header", "event_header", "longitudinal",
+         "event_end", "run_end")
+
+
+class CompressedBlock:
+    """Block of consecutive subblocks of one shower and type.
+
+    Attributes
+    ----------
+    shower : int
+        Event number of the shower (0 for run headers and ends).
+    type : str
+        Subblock type, one of TYPES.
+    subblocks : int
+        Number of subblocks in the block.
+    first : int
+        Position of the first subblock in the particle output.
+    """
+
+    def __init__(self, reader, shower, type, subblocks, first, offset, size):
+        self.shower = shower
+        self.type = type
+        self.subblocks = subblocks
+        self.first = first
+        self._reader = reader
+        self._offset = offset
+        self._size = size
+
+    def decompress(self):
+        """Decompress the subblocks of the block.
+
+        Returns
+        -------
+        bytes
+            subblocks * 39 * entries float32 values in native byte order.
+        """
+        data = zlib.decompress(
+            self._reader._view[self._offset:self._offset + self._size])
+        if len(data) != self.subblocks * _LINES * self._reader.entries * 4:
+            raise ValueError("corrupt block of shower {} at offset {}"
+                             .format(self.shower, self._offset))
+        return data
+
+
+class BlockReader:
+    """Memory-mapped reader for compressed subblock files.
+
+    Attributes
+    ----------
+    entries : int
+        Values per particle line (8 thinned, 7 not thinned).
+
+    Examples
+    --------
+    >>> with BlockReader("DAT000001.blk") as reader:
+    ...     for shower in reader.showers():
+    ...         particles = reader.particles(shower)
+    """
+
+    def __init__(self, path):
+        """Open and map a block file.
+
+        Parameters
+        ----------
+        path : str
+            Path of the file.
+        """
+        self._file = open(path, "rb")
+        self._map = mmap.mmap(self._file.fileno(), 0, access=mmap.ACCESS_READ)
+        self._view = memoryview(self._map)
+        try:
+            self._readIndex()
+        except Exception:
+            self.close()
+            raise
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+    def close(self):
+        """Unmap and close the file."""
+        self._view.release()
+        self._map.close()
+        self._file.close()
+
+    def showers(self):
+        """Get the sorted event numbers of all showers."""
+        return sorted({block.shower for block in self._blocks
+                       if block.shower != 0})
+
+    def types(self):
+        """Get the subblock types that occur in the file."""
+        present = {block.type for block in self._blocks}
+        return [name for name in TYPES if name in present]
+
+    def blocks(self, showers=None, types=None):
+        """Get the blocks in file order.
+
+        Parameters
+        ----------
+        showers : iterable of int, optional
+            Only blocks of these showers.
+        types : iterable of str, optional
+            Only blocks of these subblock types, see TYPES.
+
+        Returns
+        -------
+        list of CompressedBlock
+        """
+        showers = None if showers is None else set(showers)
+        types = None if types is None else set(types)
+        if types is not None and not types <= set(TYPES):
+            raise KeyError("unknown subblock types {}"
+                           .format(sorted(types - set(TYPES))))
+        return [block for block in self._blocks
+                if (showers is None or block.shower in showers)
+                and (types is None or block.type in types)]
+
+    def read(self, showers=None, types=None):
+        """Decompress the subblocks of all selected blocks.
+
+        See blocks() for the parameters.
+
+        Returns
+        -------
+        numpy.ndarray or memoryview
+            float32 values of shape (subblocks * 39, entries) in file order,
+            i.e. one row per particle line. Empty lines of particle subblocks
+            are included and have a particle description of 0. Without numpy
+            an empty selection gives an empty array.array.
+        """
+        data = b"".join(block.decompress()
+                        for block in self.blocks(showers, types))
+        rows = len(data) // (4 * self.entries)
+        if numpy is not None:
+            return numpy.frombuffer(data, dtype="f4").reshape(rows,
+                                                              self.entries)
+        if rows == 0:
+            return array.array("f")
+        return memoryview(data).cast("f", (rows, self.entries))
+
+    def particles(self, shower):
+        """Decompress the particle subblocks of a shower.
+
+        Parameters
+        ----------
+        shower : int
+            Event number of the shower.
+
+        Returns
+        -------
+        numpy.ndarray or memoryview
+            See read().
+        """
+        return self.read(showers=[shower], types=["particle"])
+
+    def _readIndex(self):
+        """Parse header, footer and trailer of the file."""
+        if len(self._map) < _HEADER.size + _TRAILER.size:
+            raise ValueError("file too short for a block file")
+
+        magic, version, self.entries = _HEADER.unpack_from(self._map, 0)
+        if magic != _FILE_MAGIC or version != 1:
+            raise ValueError("not a block file of version 1")
+
+        offset, magic = _TRAILER.unpack_from(self._map,
+                                             len(self._map) - _TRAILER.size)
+        if magic != _INDEX_MAGIC:
+            raise ValueError("block file is incomplete (no index)")
+
+        blockCount, = struct.unpack_from("=Q", self._map, offset)
+        offset += 8
+        self._blocks = []
+        for shower, type, subblocks, first, start, size \
+                in _BLOCK.iter_unpack(self._map[offset:offset + blockCount *
+                                                _BLOCK.size]):
+            self._blocks.append(CompressedBlock(self, shower, TYPES[type],
+                                                subblocks, first, start,
+                                                size))
@@ -0,0 +1,257 @@
+"""Reader for columnar files of the native column writer.
+
+Files are written by interface.setColumnWriter() or by setting the
+environment variable CORSIKA_PYTHON_COLUMNS. They contain chunks of track and
+interaction records, grouped by shower and particle species, and an index
+that allows to read only the needed columns, showers and species. The file is
+memory-mapped, such that only the accessed parts are read from disk.
+"""
+import array
+import mmap
+import struct
+
+try:
+    import numpy
+except ModuleNotFoundError:
+    numpy = None
+
+
+_FILE_MAGIC = b"COASTCOL"
+_INDEX_MAGIC = b"COASTIDX"
+_HEADER = struct.Struct("=8sII")
+_TRAILER = struct.Struct("=Q8s")
+_CHUNK = struct.Struct("=IiQQQ")
+_ITEMSIZE = {"d": 8, "i": 4}
+
+
+class ColumnChunk:
+    """Chunk of consecutive records of one stream, shower and species.
+
+    Attributes
+    ----------
+    stream : str
+        "track" or "interaction".
+    species : int
+        Particle ID of the pre particle (tracks) or projectile ID
+        (interactions).
+    shower : int
+        Event number of the shower (0 before the first event header).
+    rows : int
+        Number of records in the chunk.
+    """
+
+    def __init__(self, reader, stream, species, shower, offset, rows):
+        self.stream = stream
+        self.species = species
+        self.shower = shower
+        self.rows = rows
+        self._reader = reader
+        self._offset = offset
+
+    def column(self, name):
+        """Get a column of the chunk without copying.
+
+        Parameters
+        ----------
+        name : str
+            Column name, see ColumnReader.columns().
+
+        Returns
+        -------
+        numpy.ndarray or memoryview
+            Read-only view on the memory-mapped file.
+        """
+        offset = self._offset
+        for dtype, column in self._reader._schema[self.stream]:
+            size = self.rows * _ITEMSIZE[dtype]
+            if column == name:
+                view = self._reader._view[offset:offset + size].cast(dtype)
+                return view if numpy is None else numpy.asarray(view)
+            offset += (size + 7) & ~7
+        raise KeyError("unknown {} column '{}'".format(self.stream, name))
+
+
+class ColumnReader:
+    """Memory-mapped reader for columnar track and interaction files.
+
+    Column views refer to the mapped file; delete them before calling
+    close().
+
+    Examples
+    --------
+    >>> with ColumnReader("tracks.col") as reader:
+    ...     energy = reader.column("track", "pre.energy", species=[5, 6])
+    """
+
+    def __init__(self, path):
+        """Open and map a column file.
+
+        Parameters
+        ----------
+        path : str
+            Path of the file.
+        """
+        self._file = open(path, "rb")
+        self._map = mmap.mmap(self._file.fileno(), 0, access=mmap.ACCESS_READ)
+        self._view = memoryview(self._map)
+        try:
+            self._readIndex()
+        except Exception:
+            self.close()
+            raise
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+    def close(self):
+        """Unmap and close the file."""
+        self._view.release()
+        self._map.close()
+        self._file.close()
+
+    def streams(self):
+        """Get the names of the streams in the file."""
+        return list(self._schema)
+
+    def columns(self, stream):
+        """Get the column names of a stream."""
+        return [name for dtype, name in self._schema[stream]]
+
+    def showers(self, stream=None):
+        """Get the sorted event numbers of all showers (of a stream)."""
+        return sorted({chunk.shower for chunk in self._chunks
+                       if stream is None or chunk.stream == stream})
+
+    def species(self, stream):
+        """Get the sorted particle IDs that occur in a stream."""
+        return sorted({chunk.species for chunk in self._chunks
+                       if chunk.stream == stream})
+
+    def chunks(self, stream, showers=None, species=None):
+        """Get the chunks of a stream in file order.
+
+        Parameters
+        ----------
+        stream : str
+            "track" or "interaction".
+        showers : iterable of int, optional
+            Only chunks of these showers.
+        species : iterable of int, optional
+            Only chunks of these particle IDs.
+
+        Returns
+        -------
+        list of ColumnChunk
+        """
+        showers = None if showers is None else set(showers)
+        species = None if species is None else set(species)
+        return [chunk for chunk in self._chunks
+                if chunk.stream == stream
+                and (showers is None or chunk.shower in showers)
+                and (species is None or chunk.species in species)]
+
+    def column(self, stream, name, showers=None, species=None):
+        """Read a column of all selected chunks.
+
+        Parameters
+        ----------
+        stream : str
+            "track" or "interaction".
+        name : str
+            Column name, see columns().
+        showers, species : iterable of int, optional
+            See chunks().
+
+        Returns
+        -------
+        numpy.ndarray or array.array
+            Copy of the concatenated column; a view if only one chunk is
+            selected and numpy is available.
+        """
+        dtype = dict((column, dtype) for dtype, column
+                     in self._schema[stream]).get(name)
+        if dtype is None:
+            raise KeyError("unknown {} column '{}'".format(stream, name))
+
+        views = [chunk.column(name)
+                 for chunk in self.chunks(stream, showers, species)]
+        if numpy is not None:
+            if len(views) == 1:
+                return views[0]
+            if not views:
+                return numpy.empty(0, dtype="f8" if dtype == "d" else "i4")
+            return numpy.concatenate(views)
+
+        values = array.array(dtype)
+        for view in views:
+            values.frombytes(view.cast("B"))
+            view.release()
+        return values
+
+    def read(self, stream, names=None, showers=None, species=None):
+        """Read several columns of all selected chunks.
+
+        Parameters
+        ----------
+        names : iterable of str, optional
+            Column names; all columns if omitted.
+
+        See column() for the other parameters.
+
+        Returns
+        -------
+        dict
+            Column name to column.
+        """
+        if names is None:
+            names = self.columns(stream)
+        return {name: self.column(stream, name, showers, species)
+                for name in names}
+
+    def _readIndex(self):
+        """Parse header, footer and trailer of the file."""
+        if len(self._map) < _HEADER.size + _TRAILER.size:
+            raise ValueError("file too short for a column file")
+
+        magic, version, _ = _HEADER.unpack_from(self._map, 0)
+        if magic != _FILE_MAGIC or version != 1:
+            raise ValueError("not a column file of version 1")
+
+        offset, magic = _TRAILER.unpack_from(self._map,
+                                             len(self._map) - _TRAILER.size)
+        if magic != _INDEX_MAGIC:
+            raise ValueError("column file is incomplete (no index)")
+
+        def unpack(fmt):
+            nonlocal offset
+            values = struct.unpack_from(fmt, self._map, offset)
+            offset += struct.calcsize(fmt)
+            return values
+
+        def unpackString():
+            size, = unpack("=I")
+            return bytes(unpack("={}s".format(size))[0]).decode()
+
+        self._schema = {}
+        names = []
+        streamCount, = unpack("=I")
+        for _ in range(streamCount):
+            stream = unpackString()
+            columnCount, = unpack("=I")
+            columns = []
+            for _ in range(columnCount):
+                dtype = unpack("=c")[0].decode()
+                columns.append((dtype, unpackString()))
+            self._schema[stream] = columns
+            names.append(stream)
+
+        chunkCount, = unpack("=Q")
+        self._chunks = []
+        for stream, species, shower, start, rows \
+                in _CHUNK.iter_unpack(self._map[offset:offset + chunkCount *
+                                                _CHUNK.size]):
+            self._chunks.append(ColumnChunk(self, names[stream], species,
+                                            shower, start, rows))
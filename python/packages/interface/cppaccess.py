@@ -1,25 +1,36 @@
-from .virtual_override import Override, DefaultOverride
+from .virtual_override import Override, BatchOverride, DefaultOverride
 from .interaction import Interaction
 from .particle import Particle
+from .batch import ParticleBatch, InteractionBatch, ObservedParticles, \
+                   _columns
+from .shower import ShowerHeader, ShowerTrailer
+from .surfaces import SurfaceCrossings
+from .cppwrapper import setBatchSize, _updateCallbacks
 
 class CppAccess:
     """Intermediate class between user defined interface and C++ calls.
 
     This class acts as a mediator between the C++ and python part of the
-    interface. The user defined init(), close(), write(), interaction()
-    and track() methods are called from here in order to allow some pythonic
-    level of abstraction between C++ calls and the interface.
+    interface. By default C++ calls the user defined init(), close(),
+    write(), interaction() and track() methods directly after resolving them
+    via _callbacks(). Overrides with directCalls = False are called from
+    here in order to allow some pythonic level of abstraction between C++
+    calls and the interface.
 
     Attributes
     ----------
     _override : Override
         Stores the currently used python interface. By default it is
         initialized with DefaultOverride()
+    _batchSize : int
+        Batch size that was requested from C++. Non-zero for BatchOverride
+        interfaces.
     """
 
     def __init__(self):
         """Construct class and set DefaultOverride as interface"""
         self._override = DefaultOverride()
+        self._batchSize = 0
 
     def patch(self, classtype, runtest=False, *args, **kwargs):
         """Set new interface class and run tests if neccessary.
@@ -43,11 +54,45 @@ class CppAccess:
         assert issubclass(classtype, Override)
         self._override = classtype(*args, **kwargs)
 
+        batchSize = 0
+        if isinstance(self._override, BatchOverride):
+            batchSize = self._override.batchSize
+        if batchSize != self._batchSize:
+            setBatchSize(batchSize)
+            self._batchSize = batchSize
+
+        _updateCallbacks()
+
         if runtest:
             print("running interface tests")
             # TODO: implement interface tests
             pass
 
+    def _callbacks(self):
+        """Get the callables for init(), close(), write(), interaction(),
+        track(), write_particles(), shower_begin(), shower_end(),
+        crossings(), track_batch() and interaction_batch() that are called
+        by C++.
+
+        Returns bound methods of the current interface, or the methods of
+        this class if the interface sets directCalls to False. The optional
+        methods are always called through this class and are None if the
+        interface does not define them. Batches are always delivered
+        through this class.
+        """
+        names = ("init", "close", "write", "interaction", "track")
+        optional = tuple(
+            getattr(self, "_" + name)
+            if callable(getattr(self._override, name, None)) else None
+            for name in ("write_particles", "shower_begin", "shower_end",
+                         "crossings"))
+        batches = (self._track_batch, self._interaction_batch)
+        if getattr(self._override, "directCalls", True):
+            return tuple(getattr(self._override, name) for name in names) + \
+                   optional + batches
+        return tuple(getattr(self, "_" + name) for name in names) + \
+               optional + batches
+
     def _init(self):
         """Call interface init()"""
         self._override.init()
@@ -60,16 +105,47 @@ class CppAccess:
         """Call interface write()"""
         self._override.write(subblock)
 
-    def _interaction(self, x, y, z, etot, sigma, kela, pID, tID):
-        """Create Interaction instance and call interface interaction()"""
-        info = Interaction(x, z, z, etot, sigma, kela, pID, tID)
-        self._override.interaction(info)
+    def _write_particles(self, *columns):
+        """Create ObservedParticles instance and call interface
+        write_particles()"""
+        self._override.write_particles(ObservedParticles(*columns))
+
+    def _shower_begin(self, *values):
+        """Create ShowerHeader instance and call interface shower_begin()"""
+        self._override.shower_begin(ShowerHeader(*values))
+
+    def _shower_end(self, *values):
+        """Create ShowerTrailer instance and call interface shower_end()"""
+        self._override.shower_end(ShowerTrailer(*values))
+
+    def _crossings(self, *columns):
+        """Create SurfaceCrossings instance and call interface crossings()"""
+        self._override.crossings(SurfaceCrossings(*columns))
+
+    def _interaction(self, info: Interaction, *derived):
+        """Call interface interaction()"""
+        self._override.interaction(info, *derived)
+
+    def _track(self, pre: Particle, post: Particle, *derived):
+        """Call interface track()"""
+        self._override.track(pre, post, *derived)
+
 
-    def _track(self,
-            t_1, x_1, y_1, z_1, depth_1, energy_1, weight_1, ID_1, hadgen_1,
-            t_2, x_2, y_2, z_2, depth_2, energy_2, weight_2, ID_2, hadgen_2):
-        """Create Particle instances and call interface track()"""
-        particle_1 = Particle(t_1, x_1, y_1, z_1, depth_1, energy_1, weight_1, ID_1, hadgen_1)
-        particle_2 = Particle(t_2, x_2, y_2, z_2, depth_2, energy_2, weight_2, ID_2, hadgen_2)
-        self._override.track(particle_1, particle_2)
+    def _interaction_batch(self, x, y, z, etot, sigma, kela, pID, tID,
+                           derived=None):
+        """Create InteractionBatch instance and call interface
+        interaction_batch()"""
+        info = InteractionBatch(x, y, z, etot, sigma, kela, pID, tID)
+        if derived:
+            self._override.interaction_batch(info, _columns(derived))
+        else:
+            self._override.interaction_batch(info)
 
+    def _track_batch(self, pre, post, derived=None):
+        """Create ParticleBatch instances and call interface track_batch()"""
+        pre = ParticleBatch(*pre)
+        post = ParticleBatch(*post)
+        if derived:
+            self._override.track_batch(pre, post, _columns(derived))
+        else:
+            self._override.track_batch(pre, post)
@@ -50,6 +50,382 @@ except ModuleNotFoundError:
         eprint("warning: not in embedding mode - cppwrapper is ineffective")
         pass
 
+    def setTrackFilter(expression):
+        """Only deliver tracks that pass the given expression."""
+        eprint("warning: not in embedding mode - cppwrapper is ineffective")
+        pass
+
+    def addTrackColumn(name, expression):
+        """Deliver tracks with an additional natively computed column."""
+        eprint("warning: not in embedding mode - cppwrapper is ineffective")
+        pass
+
+    def clearTrackFilter():
+        """Remove the track filter and all derived track columns."""
+        eprint("warning: not in embedding mode - cppwrapper is ineffective")
+        pass
+
+    def setInteractionFilter(expression):
+        """Only deliver interactions that pass the given expression."""
+        eprint("warning: not in embedding mode - cppwrapper is ineffective")
+        pass
+
+    def addInteractionColumn(name, expression):
+        """Deliver interactions with an additional natively computed column."""
+        eprint("warning: not in embedding mode - cppwrapper is ineffective")
+        pass
+
+    def clearInteractionFilter():
+        """Remove the interaction filter and all derived interaction columns."""
+        eprint("warning: not in embedding mode - cppwrapper is ineffective")
+        pass
+
+    def setTrackSampling(mode, value=1, particleID=-1, exponent=1.0):
+        """Deliver only a sample of tracks; weights are corrected.
+
+        Parameters
+        ----------
+        mode : str
+            "all" (no sampling), "every" (every value-th track),
+            "probability" (with probability value) or "energy" (with
+            probability min(1, (E / value)**exponent)).
+        value : float
+            Parameter of the mode.
+        particleID : int
+            CORSIKA particle ID in [1, 10000) the rule applies to; -1 = all
+            species without own rule.
+        exponent : float
+            Exponent of mode "energy".
+        """
+        eprint("warning: not in embedding mode - cppwrapper is ineffective")
+        pass
+
+    def clearTrackSampling():
+        """Remove all track sampling rules."""
+        eprint("warning: not in embedding mode - cppwrapper is ineffective")
+        pass
+
+    def setInteractionSampling(mode, value=1, particleID=-1, exponent=1.0):
+        """Deliver only a sample of interactions.
+
+        See setTrackSampling(). The rule applies to the projectile ID and the
+        lab energy. The weight factor is available as variable
+        samplingWeight in interaction filters and derived columns.
+        """
+        eprint("warning: not in embedding mode - cppwrapper is ineffective")
+        pass
+
+    def clearInteractionSampling():
+        """Remove all interaction sampling rules."""
+        eprint("warning: not in embedding mode - cppwrapper is ineffective")
+        pass
+
+    def setSamplingSeed(seed):
+        """Set the seed of track and interaction sampling."""
+        eprint("warning: not in embedding mode - cppwrapper is ineffective")
+        pass
+
+    def setAsyncMode(capacity, policy="block"):
+        """Deliver COAST calls to python in a separate thread.
+
+        Parameters
+        ----------
+        capacity : int
+            Size in bytes of the queue between CORSIKA and python; 0 =
+            synchronous calls. Takes effect when init() returned.
+        policy : str
+            Behaviour when the queue is full: "block" (CORSIKA waits),
+            "drop" (records are discarded and counted) or "grow" (the queue
+            is enlarged).
+        """
+        eprint("warning: not in embedding mode - cppwrapper is ineffective")
+        pass
+
+    def getAsyncDropped():
+        """Get the number of records dropped in asynchronous mode per type."""
+        eprint("warning: not in embedding mode - cppwrapper is ineffective")
+        return {"write": 0, "interaction": 0, "track": 0}
+
+    def setColumnWriter(path, chunkRows=4096):
+        """Stream all tracks and interactions into a columnar file.
+
+        Parameters
+        ----------
+        path : str
+            Output file, read with interface.ColumnReader; "" = stop
+            writing.
+        chunkRows : int
+            Maximum number of records per chunk.
+        """
+        eprint("warning: not in embedding mode - cppwrapper is ineffective")
+        pass
+
+    def getColumnWriterPath():
+        """Get the path of the columnar file (empty = not writing)."""
+        eprint("warning: not in embedding mode - cppwrapper is ineffective")
+        return ""
+
+    def setBlockWriter(path, level=6, blockSubBlocks=1024):
+        """Compress all subblocks of write() into a block indexed file.
+
+        Parameters
+        ----------
+        path : str
+            Output file, read with interface.BlockReader; "" = stop
+            writing.
+        level : int
+            zlib compression level in [0, 9].
+        blockSubBlocks : int
+            Maximum number of subblocks per compressed block.
+        """
+        eprint("warning: not in embedding mode - cppwrapper is ineffective")
+        pass
+
+    def getBlockWriterPath():
+        """Get the path of the block file (empty = not writing)."""
+        eprint("warning: not in embedding mode - cppwrapper is ineffective")
+        return ""
+
+    def addHistogram(source, axes, weight="", filter=""):
+        """Add a natively filled histogram of tracks, interactions or
+        particles.
+
+        Parameters
+        ----------
+        source : str
+            "track", "interaction" or "particle" (particle lines of the
+            write() subblocks).
+        axes : sequence of tuple
+            One to three axes, either (expression, "fixed" | "log", bins,
+            lower, upper) or (expression, edges).
+        weight : str
+            Weight expression; "" = 1.
+        filter : str
+            Selection expression; "" = all records.
+
+        Returns
+        -------
+        int
+            Histogram ID.
+        """
+        eprint("warning: not in embedding mode - cppwrapper is ineffective")
+        return -1
+
+    def getHistogram(id):
+        """Get memoryviews on the contents and bin edges of a histogram.
+
+        Returns
+        -------
+        tuple
+            Sum of weights and sum of squared weights including flow bins,
+            tuple of bin edges per axis and the number of entries.
+        """
+        eprint("warning: not in embedding mode - cppwrapper is ineffective")
+        empty = memoryview(bytes()).cast("d")
+        return empty, empty, (), 0
+
+    def resetHistogram(id):
+        """Set the contents of a histogram to zero."""
+        eprint("warning: not in embedding mode - cppwrapper is ineffective")
+        pass
+
+    def stats():
+        """Get call counters and python latency histograms per callback.
+
+        Returns
+        -------
+        dict
+            Per callback ("init", "write", "interaction", "track", "close",
+            "shower_begin", "shower_end", "write_particles", "crossings") a
+            dict with calls, captured, skipped, bytes, python_calls,
+            python_ns and latency_ns_log2, where bucket i counts python
+            calls that took [2**i, 2**(i+1)) ns. "enabled" indicates if the
+            interface was compiled with USE_INTERFACE_STATS.
+        """
+        eprint("warning: not in embedding mode - cppwrapper is ineffective")
+        return {"enabled": False}
+
+    def setStatsFile(path):
+        """Write the call counters to a JSON file at cloda_ (empty = no
+        file)."""
+        eprint("warning: not in embedding mode - cppwrapper is ineffective")
+        pass
+
+    def setTrace(path, sampleEvery=1):
+        """Record a timeline of the interface in Chrome trace-event format.
+
+        Parameters
+        ----------
+        path : str
+            Output file, written when CORSIKA closes the interface; "" =
+            stop tracing.
+        sampleEvery : int
+            Record every n-th write(), interaction() and track() call.
+        """
+        eprint("warning: not in embedding mode - cppwrapper is ineffective")
+        pass
+
+    def traceBegin(name):
+        """Begin a user span in the timeline."""
+        pass
+
+    def traceEnd():
+        """End the innermost user span in the timeline."""
+        pass
+
+    def setBatchSize(size):
+        """Deliver track() and interaction() calls in batches of given size."""
+        eprint("warning: not in embedding mode - cppwrapper is ineffective")
+        pass
+
+    def getBatchSize():
+        """Get the number of entries per batch (0 = no batching)."""
+        eprint("warning: not in embedding mode - cppwrapper is ineffective")
+        return 0
+
+    def _updateCallbacks():
+        """Resolve the python callables that are called by COAST."""
+        pass
+
+    def setWriteBlockCount(count):
+        """Deliver given number of subblocks per write() call as memoryview
+        (0 = bytes)."""
+        eprint("warning: not in embedding mode - cppwrapper is ineffective")
+        pass
+
+    def getWriteBlockCount():
+        """Get the number of subblocks per write() call (0 = bytes)."""
+        eprint("warning: not in embedding mode - cppwrapper is ineffective")
+        return 0
+
+    def setParticleFilter(species=(), levels=()):
+        """Only deliver particles of given IDs and observation levels to
+        write_particles() (empty = all)."""
+        eprint("warning: not in embedding mode - cppwrapper is ineffective")
+        pass
+
+    def addVoxelGrid(geometry, axes, species=(), core=(0, 0, 0),
+                     direction=None):
+        """Add a voxel grid that accumulates the energy deposit of tracks.
+
+        Returns
+        -------
+        int
+            Voxel grid ID.
+        """
+        eprint("warning: not in embedding mode - cppwrapper is ineffective")
+        return -1
+
+    def getVoxelGrid(id):
+        """Get memoryviews on the touched voxels of a voxel grid.
+
+        Returns
+        -------
+        tuple
+            Bin indices per axis, path length, energy deposit, count,
+            species counts, a tuple of bin edges per axis and the number of
+            segments.
+        """
+        eprint("warning: not in embedding mode - cppwrapper is ineffective")
+        index = memoryview(bytes()).cast("i")
+        empty = memoryview(bytes()).cast("d")
+        return index, index, index, empty, empty, empty, empty, \
+               (empty, empty, empty), 0
+
+    def resetVoxelGrid(id):
+        """Remove all deposits of a voxel grid."""
+        eprint("warning: not in embedding mode - cppwrapper is ineffective")
+        pass
+
+    def addPlane(point, normal, radius=0):
+        """Add a plane or disc whose crossings are delivered to crossings().
+
+        Returns
+        -------
+        int
+            Surface ID.
+        """
+        eprint("warning: not in embedding mode - cppwrapper is ineffective")
+        return -1
+
+    def addSphere(center, radius):
+        """Add a sphere whose crossings are delivered to crossings().
+
+        Returns
+        -------
+        int
+            Surface ID.
+        """
+        eprint("warning: not in embedding mode - cppwrapper is ineffective")
+        return -1
+
+    def clearSurfaces():
+        """Deliver the pending crossings and remove all surfaces."""
+        eprint("warning: not in embedding mode - cppwrapper is ineffective")
+        pass
+
+    def addObserverArray(positions, binning, offsets=None,
+                         refractivity=2.92e-4, scaleHeight=8.0e5,
+                         speedOfLight=29.9792458):
+        """Add observers that accumulate the radio emission of tracks.
+
+        Returns
+        -------
+        int
+            Observer array ID.
+        """
+        eprint("warning: not in embedding mode - cppwrapper is ineffective")
+        return -1
+
+    def getObserverTraces(id):
+        """Get the traces of an observer array.
+
+        Returns
+        -------
+        tuple
+            Memoryviews on the vector potential and the electric field,
+            start and width of the time bins and the number of segments.
+        """
+        eprint("warning: not in embedding mode - cppwrapper is ineffective")
+        empty = memoryview(bytes()).cast("d")
+        return empty, empty, 0.0, 1.0, 0
+
+    def resetObserverArray(id):
+        """Set the traces of an observer array to zero."""
+        eprint("warning: not in embedding mode - cppwrapper is ineffective")
+        pass
+
+    def addArrowCollector(source, species=None, levels=None):
+        """Add a collector that appends records to Arrow columns.
+
+        Returns
+        -------
+        int
+            Collector ID.
+        """
+        eprint("warning: not in embedding mode - cppwrapper is ineffective")
+        return -1
+
+    def takeArrowRecords(id):
+        """Hand over the collected records of a collector.
+
+        Returns
+        -------
+        tuple
+            Handle on the records and their number.
+        """
+        eprint("warning: not in embedding mode - cppwrapper is ineffective")
+        return None, 0
+
+    def exportArrowRecords(handle):
+        """Export records as arrow_schema and arrow_array capsules."""
+        raise RuntimeError("Arrow export needs the embedding mode")
+
+    def loadPlugin(path):
+        """Load a native plugin that receives the COAST calls."""
+        eprint("warning: not in embedding mode - cppwrapper is ineffective")
+        pass
+
 else:
 
     disableWrite = cppwrapper_emb.disableWrite
@@ -58,4 +434,48 @@ else:
     enableInteraction = cppwrapper_emb.enableInteraction
     disableTrack = cppwrapper_emb.disableTrack
     enableTrack = cppwrapper_emb.enableTrack
+    setTrackFilter = cppwrapper_emb.setTrackFilter
+    addTrackColumn = cppwrapper_emb.addTrackColumn
+    clearTrackFilter = cppwrapper_emb.clearTrackFilter
+    setInteractionFilter = cppwrapper_emb.setInteractionFilter
+    addInteractionColumn = cppwrapper_emb.addInteractionColumn
+    clearInteractionFilter = cppwrapper_emb.clearInteractionFilter
+    setTrackSampling = cppwrapper_emb.setTrackSampling
+    clearTrackSampling = cppwrapper_emb.clearTrackSampling
+    setInteractionSampling = cppwrapper_emb.setInteractionSampling
+    clearInteractionSampling = cppwrapper_emb.clearInteractionSampling
+    setSamplingSeed = cppwrapper_emb.setSamplingSeed
+    setAsyncMode = cppwrapper_emb.setAsyncMode
+    getAsyncDropped = cppwrapper_emb.getAsyncDropped
+    setColumnWriter = cppwrapper_emb.setColumnWriter
+    getColumnWriterPath = cppwrapper_emb.getColumnWriterPath
+    setBlockWriter = cppwrapper_emb.setBlockWriter
+    getBlockWriterPath = cppwrapper_emb.getBlockWriterPath
+    addHistogram = cppwrapper_emb.addHistogram
+    getHistogram = cppwrapper_emb.getHistogram
+    resetHistogram = cppwrapper_emb.resetHistogram
+    stats = cppwrapper_emb.stats
+    setStatsFile = cppwrapper_emb.setStatsFile
+    setTrace = cppwrapper_emb.setTrace
+    traceBegin = cppwrapper_emb.traceBegin
+    traceEnd = cppwrapper_emb.traceEnd
+    setBatchSize = cppwrapper_emb.setBatchSize
+    getBatchSize = cppwrapper_emb.getBatchSize
+    _updateCallbacks = cppwrapper_emb._updateCallbacks
+    setWriteBlockCount = cppwrapper_emb.setWriteBlockCount
+    getWriteBlockCount = cppwrapper_emb.getWriteBlockCount
+    setParticleFilter = cppwrapper_emb.setParticleFilter
+    addVoxelGrid = cppwrapper_emb.addVoxelGrid
+    getVoxelGrid = cppwrapper_emb.getVoxelGrid
+    resetVoxelGrid = cppwrapper_emb.resetVoxelGrid
+    addPlane = cppwrapper_emb.addPlane
+    addSphere = cppwrapper_emb.addSphere
+    clearSurfaces = cppwrapper_emb.clearSurfaces
+    addObserverArray = cppwrapper_emb.addObserverArray
+    getObserverTraces = cppwrapper_emb.getObserverTraces
+    resetObserverArray = cppwrapper_emb.resetObserverArray
+    addArrowCollector = cppwrapper_emb.addArrowCollector
+    takeArrowRecords = cppwrapper_emb.takeArrowRecords
+    exportArrowRecords = cppwrapper_emb.exportArrowRecords
+    loadPlugin = cppwrapper_emb.loadPlugin
 
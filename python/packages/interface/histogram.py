@@ -0,0 +1,243 @@
+"""Natively filled histograms and their merging across runs.
+
+A Histogram is filled in C++ with every track, interaction or particle record,
+such that no python call is needed per record. Axis values, weights and the
+selection are expressions of the record variables, see
+interface.setTrackFilter(). The contents are available at any time as views on
+the C++ memory. Snapshots (HistogramData) can be saved to files and merged,
+e.g. to combine the output of several CORSIKA runs.
+
+Every axis has an underflow bin (index 0) and an overflow bin (index -1).
+"""
+import array
+import json
+import struct
+
+from . import cppwrapper
+
+try:
+    import numpy
+except ModuleNotFoundError:
+    numpy = None
+
+
+_FILE_MAGIC = b"COASTHST"
+_HEADER = struct.Struct("=8sII")
+_SIZE = struct.Struct("=Q")
+
+
+def _asarray(view):
+    """Return a numpy array on a view if numpy is available."""
+    return view if numpy is None else numpy.asarray(view)
+
+
+class Histogram:
+    """Histogram that is filled natively during the simulation.
+
+    Examples
+    --------
+    >>> energy = Histogram("track", [("pre.energy", "log", 60, 1e-3, 1e6)],
+    ...                    weight="pre.weight", filter="pre.particleID == 1")
+    >>> depth = Histogram("particle", [("x", "fixed", 100, -1e5, 1e5),
+    ...                                ("y", "fixed", 100, -1e5, 1e5)])
+    """
+
+    def __init__(self, source, axes, weight="", filter=""):
+        """Add the histogram to the interface.
+
+        Parameters
+        ----------
+        source : str
+            "track", "interaction" or "particle" (particle lines of the
+            write() subblocks).
+        axes : sequence of tuple
+            One to three axes, either (expression, "fixed" | "log", bins,
+            lower, upper) or (expression, edges).
+        weight : str
+            Weight expression; "" = 1.
+        filter : str
+            Selection expression; "" = all records.
+        """
+        self.source = source
+        self.expressions = [axis[0] for axis in axes]
+        self.weight = weight
+        self.filter = filter
+        self.id = cppwrapper.addHistogram(source, axes, weight, filter)
+
+    @property
+    def sumw(self):
+        """Sum of weights per bin including flow bins (read-only view)."""
+        return _asarray(cppwrapper.getHistogram(self.id)[0])
+
+    @property
+    def sumw2(self):
+        """Sum of squared weights per bin including flow bins (read-only
+        view)."""
+        return _asarray(cppwrapper.getHistogram(self.id)[1])
+
+    @property
+    def edges(self):
+        """Bin edges per axis (read-only views)."""
+        return tuple(_asarray(edges)
+                     for edges in cppwrapper.getHistogram(self.id)[2])
+
+    @property
+    def entries(self):
+        """Number of filled records."""
+        return cppwrapper.getHistogram(self.id)[3]
+
+    def reset(self):
+        """Set all contents to zero."""
+        cppwrapper.resetHistogram(self.id)
+
+    def snapshot(self):
+        """Copy the current contents.
+
+        Returns
+        -------
+        HistogramData
+        """
+        sumw, sumw2, edges, entries = cppwrapper.getHistogram(self.id)
+        return HistogramData(
+                {"source": self.source, "expressions": self.expressions,
+                 "weight": self.weight, "filter": self.filter},
+                [array.array("d", axis) for axis in edges],
+                array.array("d", sumw.cast("B").cast("d")),
+                array.array("d", sumw2.cast("B").cast("d")), entries)
+
+    def save(self, path):
+        """Save the current contents, see HistogramData.save()."""
+        self.snapshot().save(path)
+
+
+class HistogramData:
+    """Copy of histogram contents that can be saved, loaded and merged.
+
+    Attributes
+    ----------
+    definition : dict
+        Source, axis expressions, weight and filter of the histogram.
+    edges : list of array.array
+        Bin edges per axis.
+    shape : tuple of int
+        Number of bins per axis including flow bins.
+    entries : int
+        Number of filled records.
+    """
+
+    def __init__(self, definition, edges, sumw, sumw2, entries):
+        self.definition = definition
+        self.edges = edges
+        self.shape = tuple(len(axis) + 1 for axis in edges)
+        self.entries = entries
+        self._sumw = sumw
+        self._sumw2 = sumw2
+
+    @property
+    def sumw(self):
+        """Sum of weights per bin including flow bins."""
+        return self._reshape(self._sumw)
+
+    @property
+    def sumw2(self):
+        """Sum of squared weights per bin including flow bins."""
+        return self._reshape(self._sumw2)
+
+    def _reshape(self, values):
+        """Shape flat contents as numpy array or memoryview."""
+        view = memoryview(values).cast("B").cast("d", self.shape)
+        return _asarray(view)
+
+    def __iadd__(self, other):
+        """Add the contents of a histogram with identical binning."""
+        if self.edges != other.edges:
+            raise ValueError("histograms have different binning")
+        if self.definition != other.definition:
+            raise ValueError("histograms have different definitions")
+
+        for values, others in ((self._sumw, other._sumw),
+                               (self._sumw2, other._sumw2)):
+            for i, value in enumerate(others):
+                values[i] += value
+        self.entries += other.entries
+        return self
+
+    def save(self, path):
+        """Write the contents to a file.
+
+        File layout (native byte order): "COASTHST", uint32 version, uint32
+        axis count, uint64 length and JSON encoded definition, per axis
+        uint64 edge count and float64 edges, uint64 entries, float64 sum of
+        weights and sum of squared weights in C order.
+        """
+        definition = json.dumps(self.definition).encode()
+        with open(path, "wb") as stream:
+            stream.write(_HEADER.pack(_FILE_MAGIC, 1, len(self.edges)))
+            stream.write(_SIZE.pack(len(definition)))
+            stream.write(definition)
+            for axis in self.edges:
+                stream.write(_SIZE.pack(len(axis)))
+                stream.write(axis.tobytes())
+            stream.write(_SIZE.pack(self.entries))
+            stream.write(self._sumw.tobytes())
+            stream.write(self._sumw2.tobytes())
+
+    @classmethod
+    def load(cls, path):
+        """Read contents written by save().
+
+        Returns
+        -------
+        HistogramData
+        """
+        with open(path, "rb") as stream:
+            def read(size):
+                data = stream.read(size)
+                if len(data) != size:
+                    raise ValueError("histogram file is truncated")
+                return data
+
+            def readValues(count):
+                values = array.array("d")
+                values.frombytes(read(count * values.itemsize))
+                return values
+
+            magic, version, ndim = _HEADER.unpack(read(_HEADER.size))
+            if magic != _FILE_MAGIC or version != 1:
+                raise ValueError("not a histogram file of version 1")
+
+            size, = _SIZE.unpack(read(_SIZE.size))
+            definition = json.loads(read(size).decode())
+            edges = [readValues(_SIZE.unpack(read(_SIZE.size))[0])
+                     for _ in range(ndim)]
+            entries, = _SIZE.unpack(read(_SIZE.size))
+
+            bins = 1
+            for axis in edges:
+                bins *= len(axis) + 1
+            return cls(definition, edges, readValues(bins), readValues(bins),
+                       entries)
+
+    @classmethod
+    def merge(cls, paths):
+        """Load and add the histograms of several files.
+
+        Parameters
+        ----------
+        paths : iterable of str
+            Files written by save(), e.g. one per CORSIKA run.
+
+        Returns
+        -------
+        HistogramData
+        """
+        merged = None
+        for path in paths:
+            data = cls.load(path)
+            if merged is None:
+                merged = data
+            else:
+                merged += data
+        if merged is None:
+            raise ValueError("no histogram files given")
+        return merged
@@ -44,3 +44,10 @@ class Interaction:
         self.projectileID = pID
         self.targetID = tID
 
+
+# Use the C++ implementation with fixed attribute slots when running
+# embedded in CORSIKA. The class above documents it and is used otherwise.
+try:
+    from cppwrapper_emb import Interaction
+except ModuleNotFoundError:
+    pass
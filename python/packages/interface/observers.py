@@ -0,0 +1,112 @@
+"""Radio emission of track segments at natively computed observers.
+
+An ObserverArray is filled in C++ with every track segment. For every charged
+segment the arrival times of its signal at all observers are computed with the
+mean refractive index of an exponential atmosphere along the line of sight, and
+its contribution is added to time-binned traces of every observer (see
+ObserverTraces).
+
+Read the traces in shower_end() and reset them for the next shower, e.g.
+
+>>> observers = ObserverArray([(x, 0, 1.4e5) for x in range(0, 50000, 500)],
+...                           binning=(0, 1, 4096), offsets=expected)
+>>> traces = observers.traces()
+>>> peak = abs(traces.electricField).max(axis=2)
+"""
+from . import cppwrapper
+
+try:
+    import numpy
+except ModuleNotFoundError:
+    numpy = None
+
+
+def _asarray(view):
+    """Return a numpy array on a view if numpy is available."""
+    return view if numpy is None else numpy.asarray(view)
+
+
+class ObserverArray:
+    """Observers whose traces are filled natively during the simulation."""
+
+    def __init__(self, positions, binning, offsets=None,
+                 refractivity=2.92e-4, scaleHeight=8.0e5,
+                 speedOfLight=29.9792458):
+        """Add the observers to the interface.
+
+        The defaults assume positions in cm and times in ns as delivered
+        by CORSIKA; scaleHeight and speedOfLight have to be given in the
+        units of the track positions and times.
+
+        Parameters
+        ----------
+        positions : sequence of tuple
+            (x, y, z) of every observer, z is the height.
+        binning : tuple
+            (start, width, bins) of the time bins of every trace, relative
+            to the time offset of the observer.
+        offsets : sequence of float, optional
+            Time offset of every observer, e.g. the expected arrival time
+            of the shower front. By default 0.
+        refractivity : float
+            Refractive index minus one at height 0.
+        scaleHeight : float
+            Scale height of the exponential refractivity profile.
+        speedOfLight : float
+            Speed of light in vacuum.
+        """
+        self.positions = [tuple(float(v) for v in position)
+                          for position in positions]
+        if offsets is not None:
+            offsets = [float(offset) for offset in offsets]
+        self.id = cppwrapper.addObserverArray(
+            self.positions, tuple(binning), offsets, refractivity,
+            scaleHeight, speedOfLight)
+
+    def traces(self):
+        """Get the traces of all observers.
+
+        Returns
+        -------
+        ObserverTraces
+            Views on C++ memory that stay valid until the next call.
+        """
+        return ObserverTraces(*cppwrapper.getObserverTraces(self.id))
+
+    def reset(self):
+        """Set all traces to zero, e.g. at the end of every shower."""
+        cppwrapper.resetObserverArray(self.id)
+
+
+class ObserverTraces:
+    """Time-binned traces of an ObserverArray.
+
+    Every segment contributes a box between the arrival times of the
+    signal emitted at its begin and at its end to the vector potential, as
+    in the ZHS formalism. The electric field is its negative time
+    derivative, which equals the endpoint formalism away from the Cherenkov
+    angle. Multiply both by e / (4 pi epsilon_0 c) for SI units.
+
+    Attributes
+    ----------
+    vectorPotential : array of float
+        Shape (observers, 3, bins) with the x, y and z components.
+    electricField : array of float
+        Shape (observers, 3, bins) with the x, y and z components.
+    start, width : float
+        Begin of the first bin relative to the time offset of an observer
+        and width of the bins.
+    segments : int
+        Number of added charged segments.
+    """
+
+    def __init__(self, potential, field, start, width, segments):
+        self.vectorPotential = _asarray(potential)
+        self.electricField = _asarray(field)
+        self.start = start
+        self.width = width
+        self.segments = segments
+
+    def __len__(self):
+        """Number of observers."""
+        return len(self.electricField)
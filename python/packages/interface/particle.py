@@ -49,3 +49,10 @@ class Particle:
         self.particleID = ID
         self.hadronicGeneration = hadgen
 
+
+# Use the C++ implementation with fixed attribute slots when running
+# embedded in CORSIKA. The class above documents it and is used otherwise.
+try:
+    from cppwrapper_emb import Particle
+except ModuleNotFoundError:
+    pass
@@ -0,0 +1,82 @@
+class ShowerHeader:
+    """Parsed CORSIKA event header (EVTH) at the begin of a shower.
+
+    Attributes
+    ----------
+    runNumber : int
+        Number of the run.
+    eventNumber : int
+        Number of the shower in the run.
+    particleID : int
+        Primary particle as integer ID in CORSIKA convention.
+    energy : float
+        Total energy of the primary in GeV.
+    startingAltitude : float
+        Starting altitude of the primary in g/cm^2.
+    firstInteractionHeight : float
+        Height of the first interaction in cm (negative if the tracking
+        starts at the margin of the atmosphere).
+    momentum : list
+        px, py, pz of the primary in GeV/c.
+    zenith, azimuth : float
+        Direction of the primary in rad.
+    seeds : list
+        (seed, calls) of every random number sequence at the begin of the
+        shower.
+    observationLevels : list
+        Heights of the observation levels in cm.
+    """
+
+    def __init__(self, run, event, ID, energy, altitude, height, px, py, pz,
+                 zenith, azimuth, seeds, levels):
+        """Construct shower header.
+
+        Parameters
+        ----------
+        See the attributes; px, py and pz form the momentum.
+        """
+
+        self.runNumber = run
+        self.eventNumber = event
+        self.particleID = ID
+        self.energy = energy
+        self.startingAltitude = altitude
+        self.firstInteractionHeight = height
+        self.momentum = [px, py, pz]
+        self.zenith = zenith
+        self.azimuth = azimuth
+        self.seeds = list(seeds)
+        self.observationLevels = list(levels)
+
+
+class ShowerTrailer:
+    """Parsed CORSIKA event end (EVTE) at the end of a shower.
+
+    Attributes
+    ----------
+    runNumber : int
+        Number of the run.
+    eventNumber : int
+        Number of the shower in the run.
+    photons, electrons, hadrons, muons : float
+        Weighted numbers of the particles of the shower.
+    particles : float
+        Weighted number of particles written to the particle output.
+    """
+
+    def __init__(self, run, event, photons, electrons, hadrons, muons,
+                 particles):
+        """Construct shower trailer.
+
+        Parameters
+        ----------
+        See the attributes.
+        """
+
+        self.runNumber = run
+        self.eventNumber = event
+        self.photons = photons
+        self.electrons = electrons
+        self.hadrons = hadrons
+        self.muons = muons
+        self.particles = particles
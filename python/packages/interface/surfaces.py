@@ -0,0 +1,102 @@
+"""Crossings of track segments with natively tested surfaces.
+
+Planes, discs and spheres are registered with addPlane(), addSphere() or
+addShowerPlane(), usually in init(). Every track segment is intersected with
+all of them in C++, and an override that defines crossings(self, crossings)
+receives the interpolated crossings as SurfaceCrossings columns. Combined with
+disableTrack(), most segments never reach python, e.g.
+
+>>> levels = [addPlane((0, 0, h), (0, 0, 1)) for h in range(0, 10**6, 10**4)]
+>>> detector = addSphere((0, 0, 1.5e5), 1e3)
+"""
+import math
+
+from .batch import _column
+from .cppwrapper import addPlane
+
+
+def addShowerPlane(zenith, azimuth, point=(0, 0, 0), radius=0):
+    """Add a plane perpendicular to a shower axis.
+
+    Parameters
+    ----------
+    zenith, azimuth : float
+        Direction of the primary momentum in rad (CORSIKA convention).
+    point : tuple of float
+        Point on the plane, e.g. the shower core.
+    radius : float
+        Radius of a disc around point; 0 = unbounded plane.
+
+    Returns
+    -------
+    int
+        Surface ID. Particles moving along the shower cross the plane from
+        above to below, i.e. against its normal.
+    """
+    normal = (-math.sin(zenith) * math.cos(azimuth),
+              -math.sin(zenith) * math.sin(azimuth),
+              math.cos(zenith))
+    return addPlane(point, normal, radius)
+
+
+class SurfaceCrossings:
+    """Columns of crossings of track segments with registered surfaces.
+
+    A segment crosses a surface where pre and post are on different sides,
+    points on a plane count as above (in direction of its normal) and
+    points on a sphere as outside. Crossings are ordered by segment and
+    along every segment. Position, depth, time and energy are interpolated
+    linearly between pre and post. Every attribute is a one-dimensional
+    column (numpy.ndarray or memoryview) that is only valid during the
+    call.
+
+    Attributes
+    ----------
+    surfaceID : column of int
+        ID returned by addPlane(), addSphere() or addShowerPlane().
+    particleID : column of int
+        Particle type as integer ID in CORSIKA convention.
+    x, y, z : column of float
+        Position of the crossing in the units of the track positions.
+    atmosphericDepth : column of float
+        Travel depth of the crossing in g/cm^2.
+    time : column of float
+        Time of the crossing in the units of the track times.
+    energy : column of float
+        Total energy at the crossing.
+    weight : column of float
+        Thinning weight of the particle.
+    ux, uy, uz : column of float
+        Unit direction of the segment.
+    """
+
+    def __init__(self, surface, ID, x, y, z, depth, t, energy, weight, ux,
+                 uy, uz):
+        """Construct crossing columns."""
+
+        self.surfaceID = _column(surface)
+        self.particleID = _column(ID)
+        self.x = _column(x)
+        self.y = _column(y)
+        self.z = _column(z)
+        self.atmosphericDepth = _column(depth)
+        self.time = _column(t)
+        self.energy = _column(energy)
+        self.weight = _column(weight)
+        self.ux = _column(ux)
+        self.uy = _column(uy)
+        self.uz = _column(uz)
+
+    def __len__(self):
+        """Number of crossings."""
+        return len(self.surfaceID)
+
+    @property
+    def position(self):
+        """x, y, z columns of the crossing positions."""
+        return (self.x, self.y, self.z)
+
+    @property
+    def direction(self):
+        """ux, uy, uz columns of the segment directions."""
+        return (self.ux, self.uy, self.uz)
@@ -0,0 +1,25 @@
+"""User spans in the timeline of interface.setTrace()."""
+from contextlib import contextmanager
+
+from .cppwrapper import traceBegin, traceEnd
+
+
+@contextmanager
+def traceSpan(name):
+    """Record the enclosed code as span in the timeline.
+
+    Parameters
+    ----------
+    name : str
+        Name of the span in the trace viewer.
+
+    Examples
+    --------
+    >>> with interface.traceSpan("fill histograms"):
+    ...     fill(batch)
+    """
+    traceBegin(name)
+    try:
+        yield
+    finally:
+        traceEnd()
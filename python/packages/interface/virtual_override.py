@@ -1,6 +1,7 @@
 from abc import ABC, abstractmethod
 from .interaction import Interaction
 from .particle import Particle
+from .batch import ParticleBatch, InteractionBatch
 from .cppwrapper import disableWrite, disableInteraction, disableTrack
 
 class Override(ABC):
@@ -19,7 +20,8 @@ class Override(ABC):
 
     write(self, subblock) :
         called in COAST wrida_()
-        subblock is of type bytes
+        subblock is of type bytes (default) or memoryview (see
+        setWriteBlockCount())
         length is determined by CORSIKA thinning option
 
     interaction(self, info) :
@@ -29,8 +31,53 @@ class Override(ABC):
     track(self, pre, post) :
         called in COAST track_()
         pre and post are of type Particle
+
+    Optional methods
+    ----------------
+    write_particles(self, particles) :
+        called instead of write() if defined
+        particles is of type ObservedParticles with the decoded particles
+        of one or more subblocks (see setWriteBlockCount() and
+        setParticleFilter())
+
+    shower_begin(self, header) :
+        called in COAST wrida_() for the event header (EVTH) of every
+        shower, before write() receives it
+        header is of type ShowerHeader
+
+    shower_end(self, trailer) :
+        called in COAST wrida_() for the event end (EVTE) of every shower,
+        after all particles, tracks and interactions of the shower were
+        delivered
+        trailer is of type ShowerTrailer
+
+    crossings(self, crossings) :
+        called in COAST track_() for the segments that cross a surface of
+        addPlane(), addSphere() or addShowerPlane(), once 4096 crossings
+        are collected, before shower_end() and before close()
+        crossings is of type SurfaceCrossings
+
+    Filters and derived columns
+    ---------------------------
+    setTrackFilter() and setInteractionFilter() register expressions that
+    are evaluated in C++, such that only passing tracks or interactions
+    reach python. Columns registered with addTrackColumn() or
+    addInteractionColumn() are computed in C++ and passed as additional
+    dict argument, e.g. track(self, pre, post, derived) with
+    derived["ekin"] for addTrackColumn("ekin", "energy - mass(particleID)").
+    Batch methods receive a dict of columns in the same way.
+
+    Attributes
+    ----------
+    directCalls : bool
+        If True (default), C++ resolves the methods above once when the
+        interface is patched and calls them directly. Set it to False if the
+        methods are replaced at runtime, e.g. by assigning new functions to
+        instance attributes, in order to look them up on every call.
     """
 
+    directCalls = True
+
     def __init__(self):
         """Construct default virutal interface."""
         pass
@@ -54,9 +101,11 @@ class Override(ABC):
         
         Parameters
         ----------
-        subblock : bytes
+        subblock : bytes or memoryview
             CORSIKA DataSubBlock of size 39*8*4 bytes (thinning) or
-            39*7*4 bytes (no thinning)
+            39*7*4 bytes (no thinning). After setWriteBlockCount(K) with
+            K > 0 it is a read-only float32 memoryview of shape (K*39, 8)
+            or (K*39, 7) that is released after the call.
         """
         pass
 
@@ -87,6 +136,83 @@ class Override(ABC):
         pass
 
 
+class BatchOverride(Override):
+    """Abstract interface class for batched track and interaction info.
+
+    Inherit from this class instead of Override in order to receive
+    track and interaction information in column batches. The C++ part of the
+    interface collects batchSize entries before calling track_batch() or
+    interaction_batch(). Remaining entries are delivered before close().
+
+    Columns are views on C++ memory that are released after the call.
+    Copy them if you need the data afterwards.
+
+    Attributes
+    ----------
+    batchSize : int
+        Number of entries per batch. Set it before calling patch().
+
+    Abstract methods
+    ----------------
+    init(self), close(self), write(self, subblock) :
+        see Override
+
+    interaction_batch(self, info) :
+        called in COAST interaction_() once batchSize entries are collected
+        info is of type InteractionBatch
+
+    track_batch(self, pre, post) :
+        called in COAST track_() once batchSize entries are collected
+        pre and post are of type ParticleBatch
+    """
+
+    batchSize = 4096
+
+
+    @abstractmethod
+    def interaction_batch(self, info: InteractionBatch):
+        """Retrieve a batch of interaction info.
+
+        Parameters
+        ----------
+        info : InteractionBatch
+            Columns of interaction info provided to the COAST interface
+        """
+        pass
+
+
+    @abstractmethod
+    def track_batch(self, pre: ParticleBatch, post: ParticleBatch):
+        """Retrieve a batch of particle track info.
+
+        Parameters
+        ----------
+        pre : ParticleBatch
+            Columns of pre-track particle info provided by COAST
+        post : ParticleBatch
+            Columns of post-track particle info provided by COAST
+        """
+        pass
+
+
+    def interaction(self, info: Interaction):
+        """Forward single interaction info as a batch of size one."""
+        self.interaction_batch(InteractionBatch(
+            [info.position[0]], [info.position[1]], [info.position[2]],
+            [info.labEnergy], [info.crossSection], [info.elasticity],
+            [info.projectileID], [info.targetID]))
+
+
+    def track(self, pre: Particle, post: Particle):
+        """Forward single particle track info as a batch of size one."""
+        self.track_batch(*[
+            ParticleBatch(
+                [p.time], [p.position[0]], [p.position[1]], [p.position[2]],
+                [p.atmosphericDepth], [p.energy], [p.weight],
+                [p.particleID], [p.hadronicGeneration])
+            for p in (pre, post)])
+
+
 class DefaultOverride(Override):
     """Default implementation of the abstract Override class."""
 
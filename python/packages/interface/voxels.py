@@ -0,0 +1,112 @@
+"""Energy deposit of track segments in natively filled voxel grids.
+
+A VoxelGrid is filled in C++ with every track segment. Every segment is
+traversed exactly through the voxels it passes; its path length and energy
+loss (pre.energy - post.energy) are shared between them in proportion to the
+path length in each voxel and, like the particle counts, weighted with the
+thinning weight.
+Only touched voxels use memory.
+
+Read the contents in shower_end() or close(), e.g.
+
+>>> grid = VoxelGrid("cartesian", [(-1e5, 1e5, 200), (-1e5, 1e5, 200),
+...                                (0, 2e6, 400)], species=[5, 6])
+>>> contents = grid.contents()
+>>> contents.energyDeposit[contents.index[2] == 10].sum()
+"""
+from . import cppwrapper
+
+try:
+    import numpy
+except ModuleNotFoundError:
+    numpy = None
+
+
+def _asarray(view):
+    """Return a numpy array on a view if numpy is available."""
+    return view if numpy is None else numpy.asarray(view)
+
+
+class VoxelGrid:
+    """Voxel grid that is filled natively during the simulation."""
+
+    def __init__(self, geometry, axes, species=(), core=(0, 0, 0),
+                 direction=None):
+        """Add the grid to the interface.
+
+        Parameters
+        ----------
+        geometry : str
+            "cartesian" with axes x, y, z or "cylindrical" with axes radius,
+            azimuth in rad and height along the shower axis above core.
+        axes : sequence of tuple
+            Three axes (lower, upper, bins) of equal width bins in the units
+            of the track positions. The azimuth axis spans at most 2 pi and
+            may start anywhere, e.g. (0, 2 pi) or (-pi, pi).
+        species : sequence of int
+            Particle IDs that are counted separately.
+        core : tuple of float
+            Point on the shower axis (cylindrical only).
+        direction : tuple of float, optional
+            (zenith, azimuth) of the primary momentum in rad that fixes the
+            shower axis (cylindrical only). By default the axis follows the
+            primary of every shower.
+        """
+        self.geometry = geometry
+        self.species = list(species)
+        self.id = cppwrapper.addVoxelGrid(geometry, axes, self.species, core,
+                                          direction)
+
+    def contents(self):
+        """Get the touched voxels.
+
+        Returns
+        -------
+        VoxelContents
+            Views on C++ memory that stay valid until the next call.
+        """
+        return VoxelContents(self.species,
+                             *cppwrapper.getVoxelGrid(self.id))
+
+    def reset(self):
+        """Remove all deposits, e.g. at the end of every shower."""
+        cppwrapper.resetVoxelGrid(self.id)
+
+
+class VoxelContents:
+    """Touched voxels of a VoxelGrid in C order of their bins.
+
+    Attributes
+    ----------
+    index : tuple of column of int
+        Bin of every voxel per axis.
+    pathLength : column of float
+        Weighted path length of the segments in the voxel.
+    energyDeposit : column of float
+        Weighted energy loss of the segments in the voxel.
+    count : column of float
+        Weighted number of particles that passed the voxel.
+    speciesCount : matrix of float
+        count per voxel (rows) and species (columns).
+    species : list of int
+        Particle IDs of the speciesCount columns.
+    edges : tuple of column of float
+        Bin edges per axis.
+    segments : int
+        Number of added segments.
+    """
+
+    def __init__(self, species, index0, index1, index2, path, deposit, count,
+                 speciesCount, edges, segments):
+        self.index = (_asarray(index0), _asarray(index1), _asarray(index2))
+        self.pathLength = _asarray(path)
+        self.energyDeposit = _asarray(deposit)
+        self.count = _asarray(count)
+        self.speciesCount = _asarray(speciesCount)
+        self.species = species
+        self.edges = tuple(_asarray(axis) for axis in edges)
+        self.segments = segments
+
+    def __len__(self):
+        """Number of touched voxels."""
+        return len(self.count)
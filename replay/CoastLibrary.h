@@ -0,0 +1,144 @@
+/** \file
+ * Loading of libCOAST.so and issuing of recorded COAST calls, shared by the
+ * standalone drivers.
+ */
+#ifndef __COASTLIBRARY_H__
+#define __COASTLIBRARY_H__
+
+#include <dlfcn.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <crs/CorsikaTypes.h>
+#include <crs/CInteraction.h>
+#include <crs/CParticle.h>
+
+#include "../python/CallRecorder.h"
+
+
+using InitFunction = void (*)(const char *, const bool &, const bool &,
+                              const bool &, const bool &, const bool &, int);
+using WriteFunction = void (*)(const CREAL *);
+using CloseFunction = void (*)();
+using InteractionFunction = void (*)(const crs::CInteraction &);
+using TrackFunction = void (*)(const crs::CParticle &, const crs::CParticle &);
+using CaptureMaskFunction = unsigned int (*)();
+
+
+/** COAST functions of the loaded library. */
+struct CoastLibrary {
+    void * handle = NULL;
+    InitFunction init = NULL;
+    WriteFunction write = NULL;
+    CloseFunction close = NULL;
+    InteractionFunction interaction = NULL;
+    TrackFunction track = NULL;
+    CaptureMaskFunction captureMask = NULL;  /**< Optional. */
+};
+
+
+template <typename Function>
+inline Function getSymbol(void * handle, const char * name) {
+    void * symbol = dlsym(handle, name);
+    if (symbol == NULL) {
+        throw std::runtime_error(std::string("missing symbol ") + name);
+    }
+    return reinterpret_cast<Function>(symbol);
+}
+
+
+/** Load the library with dlopen.
+ *
+ * Throws a std::runtime_error if the library or a COAST function is
+ * missing.
+ */
+inline CoastLibrary loadLibrary(const std::string & path) {
+    // the python interface finds its packages relative to COAST_USER_LIB
+    if (std::getenv("COAST_USER_LIB") == NULL) {
+        const std::size_t slash = path.rfind('/');
+        const std::string directory =
+            slash == std::string::npos ? "." : path.substr(0, slash);
+        setenv("COAST_USER_LIB", directory.c_str(), 0);
+    }
+
+    CoastLibrary library;
+    library.handle = dlopen(path.c_str(), RTLD_NOW | RTLD_GLOBAL);
+    if (library.handle == NULL) {
+        throw std::runtime_error(std::string("cannot load ") + dlerror());
+    }
+
+    library.init = getSymbol<InitFunction>(library.handle, "inida_");
+    library.write = getSymbol<WriteFunction>(library.handle, "wrida_");
+    library.close = getSymbol<CloseFunction>(library.handle, "cloda_");
+    library.interaction =
+        getSymbol<InteractionFunction>(library.handle, "interaction_");
+    library.track = getSymbol<TrackFunction>(library.handle, "track_");
+    library.captureMask = reinterpret_cast<CaptureMaskFunction>(
+            dlsym(library.handle, "capturemask_"));
+    return library;
+}
+
+
+/** Issue a recorded call.
+ *
+ * Throws a std::runtime_error for unknown calls.
+ *
+ * @param library Loaded library.
+ * @param header Record header.
+ * @param payload Payload of the record, 8 byte aligned such that it is
+ * used in place.
+ */
+inline void issueCall(const CoastLibrary & library,
+                      const CallRecorder::CallHeader & header,
+                      const unsigned char * payload) {
+    using Call = CallRecorder::Call;
+
+    switch (header.call) {
+        case Call::INIT: {
+            std::uint32_t options = 0;
+            std::uint32_t length = 0;
+            std::memcpy(&options, payload, sizeof(options));
+            std::memcpy(&length, payload + sizeof(options), sizeof(length));
+            const std::string filename(reinterpret_cast<const char *>(
+                    payload + 2 * sizeof(std::uint32_t)), length);
+            const bool thinning = options & CallRecorder::THINNING;
+            const bool curved = options & CallRecorder::CURVED;
+            const bool slant = options & CallRecorder::SLANT;
+            const bool stackinput = options & CallRecorder::STACKINPUT;
+            const bool preshower = options & CallRecorder::PRESHOWER;
+            library.init(filename.c_str(), thinning, curved, slant,
+                         stackinput, preshower, filename.size());
+            break;
+        }
+
+        case Call::WRITE:
+            library.write(reinterpret_cast<const CREAL *>(payload));
+            break;
+
+        case Call::INTERACTION:
+            library.interaction(
+                    *reinterpret_cast<const crs::CInteraction *>(payload));
+            break;
+
+        case Call::TRACK: {
+            auto * particles =
+                reinterpret_cast<const crs::CParticle *>(payload);
+            library.track(particles[0], particles[1]);
+            break;
+        }
+
+        case Call::CLOSE:
+            library.close();
+            break;
+
+        default:
+            throw std::runtime_error("unknown call");
+    }
+}
+
+
+#endif
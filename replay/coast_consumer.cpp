@@ -0,0 +1,73 @@
+/** \file
+ * Consumer process of a CORSIKA run that publishes its COAST calls into a
+ * shared-memory ring.
+ *
+ * CORSIKA publishes the calls if the environment variable CORSIKA_PYTHON_SHM
+ * is set (see SharedRing). The consumer attaches to the ring, loads
+ * libCOAST.so with dlopen and issues every call in its own process, such
+ * that the override of CORSIKA_PYTHON_INTERFACE runs on its own core and
+ * cannot slow down or crash the simulation beyond the ring capacity.
+ * Several consumers with different overrides may attach to one run, each
+ * with its own capture flags. If CORSIKA_PYTHON_INTERFACES is set, CORSIKA
+ * starts one consumer per override directory itself.
+ *
+ * Usage: coast_consumer NAME [LIBRARY]
+ */
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <memory>
+#include <string>
+
+#include "../python/CallRecorder.h"
+#include "../python/SharedRing.h"
+#include "CoastLibrary.h"
+
+
+int main(int argc, char ** argv) {
+    if (argc < 2 || argc > 3) {
+        std::fprintf(stderr, "usage: %s NAME [LIBRARY]\n", argv[0]);
+        return 2;
+    }
+
+    const std::string name = argv[1];
+    const std::string libraryPath = argc == 3 ? argv[2] : "./libCOAST.so";
+
+    // the library in this process runs the override itself
+    unsetenv("CORSIKA_PYTHON_SHM");
+
+    try {
+        const CoastLibrary library = loadLibrary(libraryPath);
+        std::unique_ptr<SharedRing> ring = SharedRing::attach(name);
+
+        using Clock = std::chrono::steady_clock;
+        std::uint64_t calls = 0;
+        const Clock::time_point start = Clock::now();
+        for (const CallRecorder::CallHeader * header = ring->next();
+             header != NULL; header = ring->next()) {
+            issueCall(library, *header,
+                      reinterpret_cast<const unsigned char *>(header + 1));
+            ring->release();
+            ++calls;
+
+            // CORSIKA skips calls that no consumer processes
+            if (library.captureMask != NULL) {
+                ring->setRequired(library.captureMask());
+            }
+        }
+        const double seconds =
+            std::chrono::duration<double>(Clock::now() - start).count();
+
+        std::fprintf(stderr, "consumed %llu calls in %.3f s from %s\n",
+                     static_cast<unsigned long long>(calls), seconds,
+                     ring->getName().c_str());
+    }
+    catch (const std::exception & e) {
+        std::fprintf(stderr, "coast_consumer: %s\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,295 @@
+/** \file
+ * Standalone driver that feeds an existing CORSIKA particle output file
+ * through libCOAST.so.
+ *
+ * The DAT file is memory-mapped and every subblock is passed to wrida_(...)
+ * as a pointer into the mapping, between inida_(...) and cloda_(...) as in
+ * a live run. Thus an unchanged override.py analyses archived output at disk
+ * speed. The thinned (39 x 8) or not thinned (39 x 7) layout is detected
+ * from the file, files with and without Fortran record markers are
+ * supported. The CURVED, SLANT, STACKIN and PRESHOWER options are not stored
+ * in the file and are set with command line flags.
+ *
+ * Usage: coast_dat [--curved] [--slant] [--stackinput] [--preshower] DAT
+ *        [LIBRARY]
+ */
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <crs/CorsikaTypes.h>
+
+#include "../python/CorsikaConfig.h"
+#include "../python/ShowerBoundary.h"
+#include "CoastLibrary.h"
+
+
+namespace {
+
+static_assert(sizeof(CREAL) == 4, "subblocks are passed in place as float32");
+
+constexpr std::size_t LINES = 39;
+constexpr std::size_t RECORD_SUBBLOCKS = 21;
+
+
+/** Read-only mapping of a CORSIKA particle output file. */
+class DatFile {
+
+    private:
+        const unsigned char * mData = NULL;
+        std::size_t mSize = 0;
+        int mEntries = 0;
+        bool mRecordMarkers = false;
+
+    public:
+        explicit DatFile(const std::string & path) {
+            const int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0) {
+                throw std::runtime_error("cannot open DAT file " + path);
+            }
+
+            struct stat info;
+            if (fstat(fd, &info) != 0 || info.st_size == 0) {
+                ::close(fd);
+                throw std::runtime_error("invalid DAT file " + path);
+            }
+
+            mSize = info.st_size;
+            void * data = mmap(NULL, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (data == MAP_FAILED) {
+                throw std::runtime_error("cannot map DAT file " + path);
+            }
+            mData = static_cast<const unsigned char *>(data);
+            madvise(data, mSize, MADV_SEQUENTIAL);
+
+            if (!detectLayout()) {
+                munmap(data, mSize);
+                throw std::runtime_error(path + " is not a CORSIKA particle "
+                                         "output file");
+            }
+        }
+
+        DatFile(const DatFile &) = delete;
+        DatFile & operator=(const DatFile &) = delete;
+
+        ~DatFile() {
+            munmap(const_cast<unsigned char *>(mData), mSize);
+        }
+
+        /** Get the entries per particle line (8 thinned, 7 not thinned). */
+        int getEntries() const {
+            return mEntries;
+        }
+
+        /** Call function with every subblock up to RUNE in file order.
+         *
+         * @return false if the file ends without RUNE.
+         */
+        template <typename Function>
+        bool forEachSubBlock(Function function) const {
+            const std::size_t subBlockBytes = LINES * mEntries * sizeof(CREAL);
+            const std::size_t recordBytes = RECORD_SUBBLOCKS * subBlockBytes;
+            const std::size_t markerBytes =
+                mRecordMarkers ? sizeof(std::uint32_t) : 0;
+
+            for (std::size_t offset = 0;
+                 offset + 2 * markerBytes + subBlockBytes <= mSize;
+                 offset += recordBytes + 2 * markerBytes) {
+                if (mRecordMarkers && getMarker(offset) != recordBytes) {
+                    throw std::runtime_error(
+                            "unexpected record length at offset " +
+                            std::to_string(offset));
+                }
+
+                // truncated runs end with a partial record
+                const std::size_t end =
+                    std::min(mSize, offset + markerBytes + recordBytes);
+                for (std::size_t position = offset + markerBytes;
+                     position + subBlockBytes <= end;
+                     position += subBlockBytes) {
+                    const CREAL * subBlock =
+                        reinterpret_cast<const CREAL *>(mData + position);
+                    function(subBlock);
+                    if (ShowerBoundary::getBlockType(subBlock) ==
+                            ShowerBoundary::BlockType::RUN_END) {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+    private:
+        std::uint32_t getMarker(std::size_t offset) const {
+            std::uint32_t marker = 0;
+            std::memcpy(&marker, mData + offset, sizeof(marker));
+            return marker;
+        }
+
+        bool isBlockType(std::size_t offset,
+                         ShowerBoundary::BlockType type) const {
+            if (offset + sizeof(CREAL) > mSize) {
+                return false;
+            }
+            const CREAL * subBlock =
+                reinterpret_cast<const CREAL *>(mData + offset);
+            return ShowerBoundary::getBlockType(subBlock) == type;
+        }
+
+        bool detectLayout() {
+            using BlockType = ShowerBoundary::BlockType;
+
+            // gfortran writes a length marker before and after each record
+            for (const int entries : {7, 8}) {
+                const std::size_t recordBytes =
+                    RECORD_SUBBLOCKS * LINES * entries * sizeof(CREAL);
+                if (mSize >= sizeof(std::uint32_t) &&
+                    getMarker(0) == recordBytes &&
+                    isBlockType(sizeof(std::uint32_t),
+                                BlockType::RUN_HEADER)) {
+                    mEntries = entries;
+                    mRecordMarkers = true;
+                    return true;
+                }
+            }
+
+            // without markers, the subblock after RUNH starts a shower or
+            // ends the run
+            if (!isBlockType(0, BlockType::RUN_HEADER)) {
+                return false;
+            }
+            for (const int entries : {7, 8}) {
+                const std::size_t next = LINES * entries * sizeof(CREAL);
+                if (isBlockType(next, BlockType::EVENT_HEADER) ||
+                    isBlockType(next, BlockType::RUN_END)) {
+                    mEntries = entries;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+};
+
+
+struct DatStatistics {
+    std::uint64_t subBlocks = 0;
+    std::uint64_t showers = 0;
+    bool complete = false;
+    double seconds = 0.0;
+};
+
+
+DatStatistics run(const DatFile & file, const CorsikaConfig & config,
+                  const CoastLibrary & library) {
+    using Clock = std::chrono::steady_clock;
+    using Option = CorsikaConfig::CorsikaOption;
+
+    DatStatistics statistics;
+    const Clock::time_point start = Clock::now();
+
+    const std::string filename = config.getFilename();
+    library.init(filename.c_str(), config.getThinning() == Option::TRUE,
+                 config.getCurved() == Option::TRUE,
+                 config.getSlant() == Option::TRUE,
+                 config.getStackinput() == Option::TRUE,
+                 config.getPreshower() == Option::TRUE, filename.size());
+
+    // subblocks are used in place, as CORSIKA passes its output buffer
+    statistics.complete = file.forEachSubBlock(
+            [&library, &statistics](const CREAL * DataSubBlock) {
+                library.write(DataSubBlock);
+                ++statistics.subBlocks;
+                if (ShowerBoundary::getBlockType(DataSubBlock) ==
+                        ShowerBoundary::BlockType::EVENT_HEADER) {
+                    ++statistics.showers;
+                }
+            });
+
+    library.close();
+
+    statistics.seconds =
+        std::chrono::duration<double>(Clock::now() - start).count();
+    return statistics;
+}
+
+}
+
+
+int main(int argc, char ** argv) {
+    bool curved = false;
+    bool slant = false;
+    bool stackinput = false;
+    bool preshower = false;
+    int arg = 1;
+    for (; arg < argc && std::strncmp(argv[arg], "--", 2) == 0; ++arg) {
+        const std::string flag = argv[arg];
+        if (flag == "--curved") {
+            curved = true;
+        }
+        else if (flag == "--slant") {
+            slant = true;
+        }
+        else if (flag == "--stackinput") {
+            stackinput = true;
+        }
+        else if (flag == "--preshower") {
+            preshower = true;
+        }
+        else {
+            arg = argc;
+        }
+    }
+
+    if (argc - arg < 1 || argc - arg > 2) {
+        std::fprintf(stderr, "usage: %s [--curved] [--slant] [--stackinput] "
+                     "[--preshower] DAT [LIBRARY]\n", argv[0]);
+        return 2;
+    }
+
+    const std::string datPath = argv[arg];
+    const std::string libraryPath =
+        argc - arg == 2 ? argv[arg + 1] : "./libCOAST.so";
+
+    try {
+        const DatFile file(datPath);
+        const CorsikaConfig config(datPath.c_str(), datPath.size(),
+                                   file.getEntries() == 8, curved, slant,
+                                   stackinput, preshower);
+        const CoastLibrary library = loadLibrary(libraryPath);
+        const DatStatistics statistics = run(file, config, library);
+
+        if (!statistics.complete) {
+            std::fprintf(stderr, "coast_dat: warning: %s ends without RUNE\n",
+                         datPath.c_str());
+        }
+
+        const double megabytes = statistics.subBlocks * LINES *
+                                 file.getEntries() * sizeof(CREAL) / 1e6;
+        std::fprintf(stderr,
+                     "read %llu subblocks (%llu showers, %s) in %.3f s, "
+                     "%.1f MB/s\n",
+                     static_cast<unsigned long long>(statistics.subBlocks),
+                     static_cast<unsigned long long>(statistics.showers),
+                     file.getEntries() == 8 ? "thinned" : "not thinned",
+                     statistics.seconds,
+                     statistics.seconds > 0 ? megabytes / statistics.seconds
+                                            : 0.0);
+    }
+    catch (const std::exception & e) {
+        std::fprintf(stderr, "coast_dat: %s\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
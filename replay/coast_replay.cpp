@@ -0,0 +1,183 @@
+/** \file
+ * Standalone driver that replays a COAST call log against libCOAST.so.
+ *
+ * Logs are recorded by setting the environment variable
+ * CORSIKA_PYTHON_RECORD during a CORSIKA run (see CallRecorder). The replay
+ * loads the library with dlopen and issues the recorded calls as fast as
+ * possible or, with --paced, at the recorded times.
+ *
+ * Usage: coast_replay [--paced] LOG [LIBRARY]
+ */
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "../python/CallRecorder.h"
+#include "CoastLibrary.h"
+
+
+namespace {
+
+/** Read-only mapping of a call log. */
+class CallLog {
+
+    private:
+        const unsigned char * mData = NULL;
+        std::size_t mSize = 0;
+
+    public:
+        explicit CallLog(const std::string & path) {
+            const int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0) {
+                throw std::runtime_error("cannot open call log " + path);
+            }
+
+            struct stat info;
+            if (fstat(fd, &info) != 0 ||
+                info.st_size < static_cast<off_t>(
+                    sizeof(CallRecorder::FileHeader))) {
+                ::close(fd);
+                throw std::runtime_error("invalid call log " + path);
+            }
+
+            mSize = info.st_size;
+            void * data = mmap(NULL, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (data == MAP_FAILED) {
+                throw std::runtime_error("cannot map call log " + path);
+            }
+            mData = static_cast<const unsigned char *>(data);
+            madvise(data, mSize, MADV_SEQUENTIAL);
+
+            const CallRecorder::FileHeader expected =
+                CallRecorder::getFileHeader();
+            CallRecorder::FileHeader header;
+            std::memcpy(&header, mData, sizeof(header));
+            if (std::memcmp(header.magic, expected.magic,
+                            sizeof(header.magic)) != 0 ||
+                header.version != expected.version) {
+                throw std::runtime_error("not a call log of version " +
+                                         std::to_string(expected.version));
+            }
+            if (header.particleSize != expected.particleSize ||
+                header.interactionSize != expected.interactionSize) {
+                throw std::runtime_error("call log was recorded with "
+                                         "different COAST types");
+            }
+        }
+
+        CallLog(const CallLog &) = delete;
+        CallLog & operator=(const CallLog &) = delete;
+
+        ~CallLog() {
+            munmap(const_cast<unsigned char *>(mData), mSize);
+        }
+
+        const unsigned char * begin() const {
+            return mData + sizeof(CallRecorder::FileHeader);
+        }
+
+        const unsigned char * end() const {
+            return mData + mSize;
+        }
+
+};
+
+
+struct ReplayStatistics {
+    std::uint64_t calls[6] = {};
+    double seconds = 0.0;
+};
+
+
+ReplayStatistics replay(const CallLog & log, const CoastLibrary & library,
+                        bool paced) {
+    using Clock = std::chrono::steady_clock;
+
+    ReplayStatistics statistics;
+    const Clock::time_point start = Clock::now();
+
+    for (const unsigned char * position = log.begin();
+         position + sizeof(CallRecorder::CallHeader) <= log.end();) {
+        CallRecorder::CallHeader header;
+        std::memcpy(&header, position, sizeof(header));
+        const unsigned char * payload = position + sizeof(header);
+        position = payload + CallRecorder::getPaddedSize(header.size);
+        if (position > log.end()) {
+            throw std::runtime_error("call log is truncated");
+        }
+
+        if (paced) {
+            std::this_thread::sleep_until(
+                    start + std::chrono::nanoseconds(header.time));
+        }
+
+        // records are 8 byte aligned, so the payload is used in place
+        issueCall(library, header, payload);
+
+        ++statistics.calls[static_cast<std::uint32_t>(header.call)];
+    }
+
+    statistics.seconds =
+        std::chrono::duration<double>(Clock::now() - start).count();
+    return statistics;
+}
+
+}
+
+
+int main(int argc, char ** argv) {
+    bool paced = false;
+    int arg = 1;
+    if (arg < argc && std::strcmp(argv[arg], "--paced") == 0) {
+        paced = true;
+        ++arg;
+    }
+
+    if (argc - arg < 1 || argc - arg > 2) {
+        std::fprintf(stderr, "usage: %s [--paced] LOG [LIBRARY]\n", argv[0]);
+        return 2;
+    }
+
+    const std::string logPath = argv[arg];
+    const std::string libraryPath =
+        argc - arg == 2 ? argv[arg + 1] : "./libCOAST.so";
+
+    try {
+        const CallLog log(logPath);
+        const CoastLibrary library = loadLibrary(libraryPath);
+        const ReplayStatistics statistics = replay(log, library, paced);
+
+        using Call = CallRecorder::Call;
+        auto count = [&statistics](Call call) {
+            return static_cast<unsigned long long>(
+                    statistics.calls[static_cast<std::uint32_t>(call)]);
+        };
+        const unsigned long long total =
+            count(Call::INIT) + count(Call::WRITE) + count(Call::INTERACTION) +
+            count(Call::TRACK) + count(Call::CLOSE);
+
+        std::fprintf(stderr,
+                     "replayed %llu calls (%llu write, %llu interaction, "
+                     "%llu track) in %.3f s, %.1f ns/call\n",
+                     total, count(Call::WRITE), count(Call::INTERACTION),
+                     count(Call::TRACK), statistics.seconds,
+                     total > 0 ? statistics.seconds * 1e9 / total : 0.0);
+    }
+    catch (const std::exception & e) {
+        std::fprintf(stderr, "coast_replay: %s\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}